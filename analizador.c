@@ -0,0 +1,200 @@
+#include "src/hash.h"
+#include "src/hash_estructura_privada.h"
+#include "src/funciones_hash.h"
+#include "src/calidad_hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SEMILLA_POR_DEFECTO 0x9e3779b97f4a7c15ULL
+#define CLAVES_AVALANCHA 10000
+#define SEGUNDOS_VELOCIDAD 0.2
+#define FACTOR_CARGA_CHI 0.7
+
+const double factores_de_carga[] = { 0.25, 0.5, 0.7, 1, 2 };
+#define CANTIDAD_FACTORES (sizeof(factores_de_carga) / sizeof(double))
+
+uint64_t semilla = SEMILLA_POR_DEFECTO;
+
+uint64_t hash_suma(const char *clave)
+{
+	return (uint64_t)funcion_hash(clave);
+}
+
+uint64_t hash_con_semilla(const char *clave)
+{
+	return (uint64_t)hash_calcular_con_semilla(clave, semilla).suma;
+}
+
+uint64_t hash_fnv1a_mezclado(const char *clave)
+{
+	return mezclar_u64(hash_fnv1a(clave));
+}
+
+/*
+ * Funciones a comparar: el nombre, la función y cuántos bits bajos del
+ * resultado puede usar (las sumas son int no negativos).
+ */
+typedef struct funcion_analizada {
+	const char *nombre;
+	funcion_calidad_t funcion;
+	unsigned bits;
+} funcion_analizada_t;
+
+const funcion_analizada_t funciones[] = {
+	{ "funcion_hash (suma de caracteres)", hash_suma, 31 },
+	{ "hash con semilla", hash_con_semilla, 31 },
+	{ "hash_fnv1a", hash_fnv1a, 64 },
+	{ "hash_fnv1a + mezclar_u64", hash_fnv1a_mezclado, 64 },
+};
+#define CANTIDAD_FUNCIONES \
+	(sizeof(funciones) / sizeof(funcion_analizada_t))
+
+typedef struct corpus {
+	char *texto;
+	const char **claves;
+	size_t cantidad;
+	size_t bytes;
+} corpus_t;
+
+/**
+ * Devuelve el tiempo actual en segundos, medido con un reloj monótono.
+*/
+double segundos_actuales()
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (double)ahora.tv_sec + (double)ahora.tv_nsec / 1e9;
+}
+
+/**
+ * Lee el archivo completo de la ruta dada y lo separa en una clave por
+ * línea (sin el fin de línea, y sin contar las líneas vacías).
+ *
+ * Devuelve true si pudo o false en caso de error.
+*/
+bool leer_claves(const char *ruta, corpus_t *corpus)
+{
+	FILE *archivo = fopen(ruta, "rb");
+	if (!archivo)
+		return false;
+	long largo = -1;
+	if (fseek(archivo, 0, SEEK_END) == 0)
+		largo = ftell(archivo);
+	bool ok = largo >= 0 && fseek(archivo, 0, SEEK_SET) == 0;
+	if (ok)
+		corpus->texto = malloc((size_t)largo + 1);
+	ok = ok && corpus->texto &&
+	     fread(corpus->texto, 1, (size_t)largo, archivo) == (size_t)largo;
+	fclose(archivo);
+	if (!ok)
+		return false;
+	corpus->texto[largo] = 0;
+	size_t lineas = 1;
+	for (long i = 0; i < largo; i++)
+		lineas += corpus->texto[i] == '\n';
+	corpus->claves = malloc(lineas * sizeof(char *));
+	if (!corpus->claves)
+		return false;
+	for (char *linea = strtok(corpus->texto, "\r\n"); linea;
+	     linea = strtok(NULL, "\r\n")) {
+		corpus->claves[corpus->cantidad++] = linea;
+		corpus->bytes += strlen(linea);
+	}
+	return true;
+}
+
+/**
+ * Calcula el hash de todas las claves, repitiendo hasta que pasen al menos
+ * SEGUNDOS_VELOCIDAD segundos.
+ *
+ * Devuelve la cantidad de gigabytes de claves por segundo.
+*/
+double medir_velocidad(const corpus_t *corpus, funcion_calidad_t funcion)
+{
+	volatile uint64_t acumulado = 0;
+	size_t vueltas = 0;
+	double inicio = segundos_actuales(), segundos;
+	do {
+		uint64_t suma = 0;
+		for (size_t i = 0; i < corpus->cantidad; i++)
+			suma += funcion(corpus->claves[i]);
+		acumulado += suma;
+		vueltas++;
+		segundos = segundos_actuales() - inicio;
+	} while (segundos < SEGUNDOS_VELOCIDAD);
+	return (double)corpus->bytes * (double)vueltas / segundos / 1e9;
+}
+
+/**
+ * Imprime todas las medidas de una función sobre las claves.
+*/
+void analizar_funcion(const corpus_t *corpus,
+		      const funcion_analizada_t *analizada)
+{
+	printf("\n%s\n", analizada->nombre);
+	calidad_distribucion_t distribucion;
+	size_t posiciones =
+		(size_t)((double)corpus->cantidad / FACTOR_CARGA_CHI);
+	if (posiciones < 2)
+		posiciones = 2;
+	if (calidad_distribucion(corpus->claves, corpus->cantidad,
+				 analizada->funcion, posiciones,
+				 &distribucion))
+		printf("  %-38s %14.1f (relativo %.2f, %zu de %zu vacías)\n",
+		       "chi cuadrado con carga 0.7",
+		       distribucion.chi_cuadrado,
+		       distribucion.chi_cuadrado_relativo,
+		       distribucion.posiciones_vacias, posiciones);
+	printf("  %-38s", "lista más larga por carga");
+	for (size_t i = 0; i < CANTIDAD_FACTORES; i++) {
+		posiciones = (size_t)((double)corpus->cantidad /
+				      factores_de_carga[i]);
+		if (posiciones < 2)
+			posiciones = 2;
+		if (calidad_distribucion(corpus->claves, corpus->cantidad,
+					 analizada->funcion, posiciones,
+					 &distribucion))
+			printf(" %g: %zu", factores_de_carga[i],
+			       distribucion.lista_mas_larga);
+	}
+	printf("\n");
+	calidad_bits_t bits;
+	if (calidad_bits(corpus->claves, corpus->cantidad, analizada->funcion,
+			 analizada->bits, CLAVES_AVALANCHA, &bits)) {
+		printf("  %-38s %14.3f (de %u bits)\n",
+		       "sesgo máximo de un bit", bits.sesgo_maximo,
+		       analizada->bits);
+		printf("  %-38s %14.3f (peor %.3f)\n", "avalancha media",
+		       bits.avalancha_media, bits.avalancha_peor);
+	}
+	printf("  %-38s %14.2f GB/s\n", "velocidad",
+	       medir_velocidad(corpus, analizada->funcion));
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "Uso: %s <archivo de claves> [semilla]\n",
+			argv[0]);
+		return 1;
+	}
+	if (argc == 3)
+		semilla = strtoull(argv[2], NULL, 0);
+	corpus_t corpus = { 0 };
+	if (!leer_claves(argv[1], &corpus) || !corpus.cantidad) {
+		fprintf(stderr, "No se pudieron leer claves de %s\n",
+			argv[1]);
+		free(corpus.texto);
+		free(corpus.claves);
+		return 1;
+	}
+	printf("%zu claves, %zu bytes, semilla 0x%llx\n", corpus.cantidad,
+	       corpus.bytes, (unsigned long long)semilla);
+	for (size_t i = 0; i < CANTIDAD_FUNCIONES; i++)
+		analizar_funcion(&corpus, &funciones[i]);
+	free(corpus.texto);
+	free(corpus.claves);
+	return 0;
+}
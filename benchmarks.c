@@ -0,0 +1,1284 @@
+#include "src/hash.h"
+#include "src/cache_lru.h"
+#include "src/hash_u64.h"
+#include "src/lista.h"
+#include "src/tabla_cuckoo.h"
+#include "src/hash_durable.h"
+#include "src/hash_carga.h"
+#include "src/consulta.h"
+#include "src/hash_multi.h"
+#include "src/hash_compartido.h"
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CANTIDAD_CLAVES 20000
+#define LARGO_CLAVE 16
+#define CANTIDAD_OPERACIONES 1000000
+
+char claves[CANTIDAD_CLAVES][LARGO_CLAVE];
+
+/**
+ * Devuelve el tiempo actual en segundos, medido con un reloj monótono.
+*/
+double segundos_actuales()
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (double)ahora.tv_sec + (double)ahora.tv_nsec / 1e9;
+}
+
+/**
+ * Generador pseudoaleatorio xorshift, para que todas las corridas usen la
+ * misma secuencia.
+*/
+unsigned long long siguiente_aleatorio(unsigned long long *estado)
+{
+	*estado ^= *estado << 13;
+	*estado ^= *estado >> 7;
+	*estado ^= *estado << 17;
+	return *estado;
+}
+
+/**
+ * Devuelve el índice de una clave con distribución sesgada hacia los índices
+ * bajos, para simular una carga donde pocas claves son muy consultadas.
+*/
+size_t indice_sesgado(unsigned long long *estado)
+{
+	unsigned long long a = siguiente_aleatorio(estado) % CANTIDAD_CLAVES;
+	unsigned long long b = siguiente_aleatorio(estado) % CANTIDAD_CLAVES;
+	return (size_t)(a * b / CANTIDAD_CLAVES);
+}
+
+void generar_claves()
+{
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		snprintf(claves[i], LARGO_CLAVE, "clave%d", i);
+}
+
+void imprimir_resultado(const char *nombre, size_t operaciones,
+			double segundos)
+{
+	printf("%-40s %10.0f ops/s (%.3f s)\n", nombre,
+	       (double)operaciones / segundos, segundos);
+}
+
+void benchmark_cache_lru_contra_hash()
+{
+	int valor = 1;
+	unsigned long long estado = 88172645463325252ULL;
+	hash_t *hash = hash_crear(CANTIDAD_CLAVES);
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		const char *clave = claves[indice_sesgado(&estado)];
+		if (!hash_obtener(hash, clave))
+			hash_insertar(hash, clave, &valor, NULL);
+	}
+	imprimir_resultado("hash_t (sin límite)", CANTIDAD_OPERACIONES,
+			   segundos_actuales() - inicio);
+	hash_destruir(hash);
+
+	estado = 88172645463325252ULL;
+	cache_lru_t *cache = cache_lru_crear(CANTIDAD_CLAVES / 10, 0, NULL);
+	inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		const char *clave = claves[indice_sesgado(&estado)];
+		if (!cache_lru_obtener(cache, clave))
+			cache_lru_insertar(cache, clave, &valor, 1);
+	}
+	imprimir_resultado("cache_lru_t (10% de las claves)",
+			   CANTIDAD_OPERACIONES, segundos_actuales() - inicio);
+	cache_lru_estadisticas_t estadisticas = cache_lru_estadisticas(cache);
+	printf("%-40s %zu aciertos, %zu fallos, %zu desalojos\n", "",
+	       estadisticas.aciertos, estadisticas.fallos,
+	       estadisticas.desalojos);
+	cache_lru_destruir(cache);
+}
+
+void benchmark_hash_u64_contra_hash()
+{
+	int valor = 1;
+	char clave[24];
+	unsigned long long estado = 88172645463325252ULL;
+	uint64_t *ids = malloc(CANTIDAD_CLAVES * sizeof(uint64_t));
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		ids[i] = siguiente_aleatorio(&estado);
+
+	hash_t *hash = hash_crear(3);
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_CLAVES; i++) {
+		snprintf(clave, sizeof(clave), "%llu",
+			 (unsigned long long)ids[i]);
+		hash_insertar(hash, clave, &valor, NULL);
+	}
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		snprintf(clave, sizeof(clave), "%llu",
+			 (unsigned long long)ids[i % CANTIDAD_CLAVES]);
+		hash_obtener(hash, clave);
+	}
+	imprimir_resultado("hash_t (claves con sprintf)",
+			   CANTIDAD_CLAVES + CANTIDAD_OPERACIONES,
+			   segundos_actuales() - inicio);
+	hash_destruir(hash);
+
+	hash_u64_t *hash_u64 = hash_u64_crear(0);
+	inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		hash_u64_insertar(hash_u64, ids[i], &valor, NULL);
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++)
+		hash_u64_obtener(hash_u64, ids[i % CANTIDAD_CLAVES]);
+	imprimir_resultado("hash_u64_t", CANTIDAD_CLAVES + CANTIDAD_OPERACIONES,
+			   segundos_actuales() - inicio);
+	hash_u64_destruir(hash_u64);
+	free(ids);
+}
+
+/**
+ * Inserta las claves en el hash y mide el tiempo de buscar claves ausentes
+ * que empiezan con el prefijo dado. Con "ausente" las claves suman más que
+ * las insertadas y caen en posiciones vacías; con "evalc" (un anagrama de
+ * "clave") cada una cae en la posición de una clave insertada.
+*/
+double medir_busquedas_ausentes(hash_t *hash, const char *prefijo)
+{
+	char clave[LARGO_CLAVE];
+	int valor = 1;
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		hash_insertar(hash, claves[i], &valor, NULL);
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		snprintf(clave, sizeof(clave), "%s%d", prefijo,
+			 i % CANTIDAD_CLAVES);
+		hash_contiene(hash, clave);
+	}
+	return segundos_actuales() - inicio;
+}
+
+void benchmark_filtro_con_claves_ausentes()
+{
+	const char *prefijos[] = { "ausente", "evalc" };
+	const char *nombres[][2] = {
+		{ "hash_t (sin filtro, posiciones vacías)",
+		  "hash_t (con filtro, posiciones vacías)" },
+		{ "hash_t (sin filtro, posiciones ocupadas)",
+		  "hash_t (con filtro, posiciones ocupadas)" }
+	};
+	for (int i = 0; i < 2; i++) {
+		hash_t *hash = hash_crear(CANTIDAD_CLAVES);
+		imprimir_resultado(nombres[i][0], CANTIDAD_OPERACIONES,
+				   medir_busquedas_ausentes(hash, prefijos[i]));
+		hash_destruir(hash);
+
+		hash_opciones_t opciones = { .flags = HASH_FILTRO };
+		hash = hash_crear_con_opciones(CANTIDAD_CLAVES, &opciones);
+		imprimir_resultado(nombres[i][1], CANTIDAD_OPERACIONES,
+				   medir_busquedas_ausentes(hash, prefijos[i]));
+		hash_estadisticas_filtro_t estadisticas;
+		hash_estadisticas_filtro(hash, &estadisticas);
+		printf("%-40s %zu consultas, %zu descartadas, %zu falsos positivos (%.2f%%)\n",
+		       "", estadisticas.consultas, estadisticas.descartadas,
+		       estadisticas.falsos_positivos,
+		       estadisticas.tasa_falsos_positivos * 100);
+		hash_destruir(hash);
+	}
+}
+
+/**
+ * Escribe en clave la clave número i de un conjunto de claves distintas cuyos
+ * caracteres suman lo mismo, y que por lo tanto caen todas en la misma
+ * posición de la tabla.
+*/
+void clave_que_colisiona(char *clave, int i)
+{
+	for (int j = 0; j < 4; j++) {
+		clave[2 * j] = (char)('a' + i % 26);
+		clave[2 * j + 1] = (char)('z' - i % 26);
+		i /= 26;
+	}
+	clave[8] = 0;
+}
+
+void benchmark_claves_que_colisionan()
+{
+	int valor = 1;
+	char clave[LARGO_CLAVE];
+	unsigned long long estado = 88172645463325252ULL;
+	hash_t *hash = hash_crear(CANTIDAD_CLAVES);
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_CLAVES; i++) {
+		clave_que_colisiona(clave, i);
+		hash_insertar(hash, clave, &valor, NULL);
+	}
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		clave_que_colisiona(clave, (int)(siguiente_aleatorio(&estado) %
+						 CANTIDAD_CLAVES));
+		hash_obtener(hash, clave);
+	}
+	imprimir_resultado("hash_t (todas en la misma posición)",
+			   CANTIDAD_CLAVES + CANTIDAD_OPERACIONES,
+			   segundos_actuales() - inicio);
+	hash_destruir(hash);
+}
+
+#ifdef LISTA_DESENROLLADA
+#define NOMBRE_LISTA "lista_t desenrollada"
+#elif defined(LISTA_DOBLEMENTE_ENLAZADA)
+#define NOMBRE_LISTA "lista_t doblemente enlazada"
+#else
+#define NOMBRE_LISTA "lista_t con un nodo por elemento"
+#endif
+
+bool sumar_elemento(void *elemento, void *suma)
+{
+	*(size_t *)suma += *(int *)elemento;
+	return true;
+}
+
+void benchmark_lista()
+{
+	int valor = 1;
+	size_t suma = 0;
+	printf("%s\n", NOMBRE_LISTA);
+
+	lista_t *lista = lista_crear();
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++)
+		lista_insertar(lista, &valor);
+	imprimir_resultado("  insertar al final", CANTIDAD_OPERACIONES,
+			   segundos_actuales() - inicio);
+
+	inicio = segundos_actuales();
+	for (int i = 0; i < 20; i++)
+		lista_con_cada_elemento(lista, sumar_elemento, &suma);
+	imprimir_resultado("  recorrer", 20 * CANTIDAD_OPERACIONES,
+			   segundos_actuales() - inicio);
+	lista_destruir(lista);
+
+	lista = lista_crear();
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		lista_insertar(lista, &valor);
+	inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_CLAVES; i++) {
+		lista_quitar_de_posicion(lista, lista_tamanio(lista) / 2);
+		lista_insertar_en_posicion(lista, &valor,
+					   lista_tamanio(lista) / 2);
+	}
+	imprimir_resultado("  quitar e insertar en el medio",
+			   2 * CANTIDAD_CLAVES, segundos_actuales() - inicio);
+	lista_destruir(lista);
+
+	int *valores = malloc(CANTIDAD_CLAVES * sizeof(int));
+	lista_nodo_t **nodos = malloc(CANTIDAD_CLAVES * sizeof(lista_nodo_t *));
+	lista = lista_crear();
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		nodos[i] = lista_insertar_nodo(lista, &valores[i]);
+	inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_CLAVES; i += 2)
+		lista_quitar_nodo(lista, nodos[i]);
+	for (int i = CANTIDAD_CLAVES - 1; i > 0; i -= 2)
+		lista_quitar_nodo(lista, nodos[i]);
+	imprimir_resultado("  quitar por nodo", CANTIDAD_CLAVES,
+			   segundos_actuales() - inicio);
+	lista_destruir(lista);
+	free(nodos);
+	free(valores);
+}
+
+#define ELEMENTOS_POR_LOTE 100
+
+/**
+ * Llena CANTIDAD_CLAVES / ELEMENTOS_POR_LOTE listas de ELEMENTOS_POR_LOTE
+ * elementos cada una, en lote o de a uno, luego las concatena todas en la
+ * primera y la destruye. Devuelve los segundos que tardó en llenarlas.
+*/
+double medir_listas_en_lote(void **elementos, bool en_lote,
+			    double *segundos_concatenar)
+{
+	size_t cantidad_listas = CANTIDAD_CLAVES / ELEMENTOS_POR_LOTE;
+	lista_t **listas = malloc(cantidad_listas * sizeof(lista_t *));
+	double inicio = segundos_actuales();
+	for (size_t i = 0; i < cantidad_listas; i++) {
+		listas[i] = lista_crear();
+		if (en_lote) {
+			lista_insertar_lote(listas[i], elementos,
+					    ELEMENTOS_POR_LOTE);
+			continue;
+		}
+		for (size_t j = 0; j < ELEMENTOS_POR_LOTE; j++)
+			lista_insertar(listas[i], elementos[j]);
+	}
+	double segundos = segundos_actuales() - inicio;
+	inicio = segundos_actuales();
+	for (size_t i = 1; i < cantidad_listas; i++)
+		lista_concatenar(listas[0], listas[i]);
+	*segundos_concatenar = segundos_actuales() - inicio;
+	for (size_t i = 0; i < cantidad_listas; i++)
+		lista_destruir(listas[i]);
+	free(listas);
+	return segundos;
+}
+
+void benchmark_listas_en_lote()
+{
+	int valores[ELEMENTOS_POR_LOTE];
+	void *elementos[ELEMENTOS_POR_LOTE];
+	for (int i = 0; i < ELEMENTOS_POR_LOTE; i++)
+		elementos[i] = &valores[i];
+	double concatenar;
+	imprimir_resultado("  llenar listas de a uno", CANTIDAD_CLAVES,
+			   medir_listas_en_lote(elementos, false, &concatenar));
+	imprimir_resultado("  concatenar listas sin pool",
+			   CANTIDAD_CLAVES / ELEMENTOS_POR_LOTE - 1, concatenar);
+	imprimir_resultado("  llenar listas en lote", CANTIDAD_CLAVES,
+			   medir_listas_en_lote(elementos, true, &concatenar));
+	imprimir_resultado("  concatenar listas con pool propio",
+			   CANTIDAD_CLAVES / ELEMENTOS_POR_LOTE - 1, concatenar);
+}
+
+/**
+ * Inserta y quita claves en el hash de manera que la cantidad de elementos
+ * se mantenga estable, y devuelve los segundos que tardó.
+*/
+double medir_rotacion(hash_t *hash)
+{
+	int valor = 1;
+	unsigned long long estado = 88172645463325252ULL;
+	for (int i = 0; i < CANTIDAD_CLAVES / 2; i++)
+		hash_insertar(hash, claves[i], &valor, NULL);
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		const char *clave =
+			claves[siguiente_aleatorio(&estado) % CANTIDAD_CLAVES];
+		if (!hash_quitar(hash, clave))
+			hash_insertar(hash, clave, &valor, NULL);
+	}
+	return segundos_actuales() - inicio;
+}
+
+void benchmark_pool_de_nodos()
+{
+	hash_t *hash = hash_crear(CANTIDAD_CLAVES);
+	imprimir_resultado("hash_t (malloc por nodo)", CANTIDAD_OPERACIONES,
+			   medir_rotacion(hash));
+	hash_destruir(hash);
+
+	hash_opciones_t opciones = { .flags = HASH_POOL_NODOS };
+	hash = hash_crear_con_opciones(CANTIDAD_CLAVES, &opciones);
+	imprimir_resultado("hash_t (pool de nodos)", CANTIDAD_OPERACIONES,
+			   medir_rotacion(hash));
+	hash_destruir(hash);
+
+	int valor = 1;
+	pool_t *pool = lista_crear_pool_de_nodos();
+	lista_t *lista = lista_crear_con_pool(pool);
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		lista_insertar(lista, &valor);
+		if (i % 4 == 3)
+			while (!lista_vacia(lista))
+				lista_quitar_de_posicion(lista, 0);
+	}
+	printf("%-40s %zu inserciones, %zu llamadas a malloc\n",
+	       "lista_t con pool", (size_t)CANTIDAD_OPERACIONES,
+	       pool_cantidad_bloques(pool));
+	lista_destruir(lista);
+	pool_destruir(pool);
+}
+
+bool contar_clave(const char *clave, void *valor, void *contador)
+{
+	(*(size_t *)contador)++;
+	return true;
+}
+
+/**
+ * Inserta todas las claves en el hash, las busca al azar y las recorre,
+ * imprimiendo los resultados y los bytes reservados con malloc por clave.
+*/
+void medir_hash_completo(const char *nombre, hash_opciones_t *opciones)
+{
+	int valor = 1;
+	char titulo[64];
+	unsigned long long estado = 88172645463325252ULL;
+	size_t memoria_inicial = mallinfo2().uordblks;
+	hash_t *hash = hash_crear_con_opciones(3, opciones);
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		hash_insertar(hash, claves[i], &valor, NULL);
+	snprintf(titulo, sizeof(titulo), "%s insertar", nombre);
+	imprimir_resultado(titulo, CANTIDAD_CLAVES,
+			   segundos_actuales() - inicio);
+	size_t memoria = mallinfo2().uordblks - memoria_inicial;
+
+	inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++)
+		hash_obtener(hash, claves[siguiente_aleatorio(&estado) %
+					  CANTIDAD_CLAVES]);
+	snprintf(titulo, sizeof(titulo), "%s obtener", nombre);
+	imprimir_resultado(titulo, CANTIDAD_OPERACIONES,
+			   segundos_actuales() - inicio);
+
+	size_t recorridas = 0;
+	inicio = segundos_actuales();
+	for (int i = 0; i < 50; i++)
+		hash_con_cada_clave(hash, contar_clave, &recorridas);
+	snprintf(titulo, sizeof(titulo), "%s recorrer", nombre);
+	imprimir_resultado(titulo, recorridas, segundos_actuales() - inicio);
+	printf("%-40s %10zu bytes por clave\n", "", memoria / CANTIDAD_CLAVES);
+	hash_destruir(hash);
+}
+
+void benchmark_hash_compacto()
+{
+	hash_opciones_t opciones = { 0 };
+	medir_hash_completo("hash_t (listas)", &opciones);
+	opciones.flags = HASH_COMPACTO;
+	medir_hash_completo("hash_t (compacto)", &opciones);
+}
+
+/**
+ * Inserta todas las claves en el hash, quita todas menos 100 y recorre las
+ * restantes, imprimiendo los resultados. Si reservar es true, antes de
+ * insertar reserva lugar para todas las claves, y después de quitar compacta
+ * el hash.
+*/
+void medir_carga_y_vaciado(const char *nombre, hash_opciones_t *opciones,
+			   bool reservar)
+{
+	int valor = 1;
+	char titulo[64];
+	hash_t *hash = hash_crear_con_opciones(3, opciones);
+	double inicio = segundos_actuales();
+	if (reservar)
+		hash_reservar(hash, CANTIDAD_CLAVES);
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		hash_insertar(hash, claves[i], &valor, NULL);
+	snprintf(titulo, sizeof(titulo), "%s insertar", nombre);
+	imprimir_resultado(titulo, CANTIDAD_CLAVES,
+			   segundos_actuales() - inicio);
+	for (int i = 100; i < CANTIDAD_CLAVES; i++)
+		hash_quitar(hash, claves[i]);
+	if (reservar)
+		hash_compactar(hash);
+	size_t recorridas = 0;
+	inicio = segundos_actuales();
+	for (int i = 0; i < 10000; i++)
+		hash_con_cada_clave(hash, contar_clave, &recorridas);
+	snprintf(titulo, sizeof(titulo), "%s recorrer 100", nombre);
+	imprimir_resultado(titulo, recorridas, segundos_actuales() - inicio);
+	hash_destruir(hash);
+}
+
+void benchmark_capacidad()
+{
+	hash_opciones_t sin_achique = { .factor_carga_minimo = -1 };
+	medir_carga_y_vaciado("hash_t (sin achicar)", &sin_achique, false);
+	hash_opciones_t por_defecto = { 0 };
+	medir_carga_y_vaciado("hash_t (achicando)", &por_defecto, false);
+	medir_carga_y_vaciado("hash_t (reservar/compactar)", &por_defecto, true);
+}
+
+bool copiar_clave(const char *clave, void *valor, void *copia)
+{
+	return hash_insertar(copia, clave, valor, NULL) != NULL;
+}
+
+#define INSTANTANEAS 20
+
+/**
+ * Toma INSTANTANEAS copias del hash (copiando todo o con hash_clonar), y
+ * después de cada una hace la cantidad de escrituras dada en el original,
+ * imprimiendo el tiempo y los bytes reservados por copia.
+*/
+void medir_instantaneas(const char *nombre, hash_t *hash, bool clonar,
+			int escrituras)
+{
+	char titulo[64];
+	int valor = 2;
+	unsigned long long estado = 88172645463325252ULL;
+	hash_t *copias[INSTANTANEAS];
+	size_t memoria_inicial = mallinfo2().uordblks;
+	double inicio = segundos_actuales();
+	for (int i = 0; i < INSTANTANEAS; i++) {
+		if (clonar) {
+			copias[i] = hash_clonar(hash);
+		} else {
+			copias[i] = hash_crear(hash_cantidad(hash));
+			hash_con_cada_clave(hash, copiar_clave, copias[i]);
+		}
+		for (int j = 0; j < escrituras; j++)
+			hash_insertar(hash,
+				      claves[siguiente_aleatorio(&estado) %
+					     CANTIDAD_CLAVES],
+				      &valor, NULL);
+	}
+	snprintf(titulo, sizeof(titulo), "%s, %d escrituras", nombre,
+		 escrituras);
+	imprimir_resultado(titulo, INSTANTANEAS, segundos_actuales() - inicio);
+	printf("%-40s %10zu bytes por instantánea\n", "",
+	       (mallinfo2().uordblks - memoria_inicial) / INSTANTANEAS);
+	for (int i = 0; i < INSTANTANEAS; i++)
+		hash_destruir(copias[i]);
+}
+
+void benchmark_instantaneas()
+{
+	int valor = 1;
+	hash_t *hash = hash_crear(CANTIDAD_CLAVES);
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		hash_insertar(hash, claves[i], &valor, NULL);
+	int escrituras[] = { 0, 1, 100 };
+	for (int i = 0; i < 3; i++) {
+		medir_instantaneas("copia completa", hash, false,
+				   escrituras[i]);
+		medir_instantaneas("hash_clonar", hash, true, escrituras[i]);
+	}
+	hash_destruir(hash);
+}
+
+void benchmark_hash_con_limite_de_memoria()
+{
+	hash_opciones_t opciones = { 0 };
+	medir_hash_completo("hash_t (malloc)", &opciones);
+	opciones.limite_memoria = SIZE_MAX;
+	medir_hash_completo("hash_t (con limite)", &opciones);
+}
+
+#define CLAVES_CARGA_ALTA 30000
+#define BUSQUEDAS_LATENCIA 200000
+
+int comparar_segundos(const void *a, const void *b)
+{
+	double diferencia = *(const double *)a - *(const double *)b;
+	return (diferencia > 0) - (diferencia < 0);
+}
+
+/**
+ * Busca claves al azar midiendo cada búsqueda por separado, e imprime la
+ * mediana y los percentiles 99 y 99.9 de la latencia (que incluyen el
+ * costo de leer el reloj).
+*/
+void medir_latencias(const char *nombre, hash_t *hash,
+		     char (*claves_buscadas)[LARGO_CLAVE], size_t cantidad)
+{
+	double *latencias = malloc(BUSQUEDAS_LATENCIA * sizeof(double));
+	unsigned long long estado = 88172645463325252ULL;
+	for (int i = 0; i < BUSQUEDAS_LATENCIA; i++) {
+		const char *clave =
+			claves_buscadas[siguiente_aleatorio(&estado) % cantidad];
+		double inicio = segundos_actuales();
+		hash_obtener(hash, clave);
+		latencias[i] = segundos_actuales() - inicio;
+	}
+	qsort(latencias, BUSQUEDAS_LATENCIA, sizeof(double), comparar_segundos);
+	printf("%-40s p50 %5.0f ns  p99 %6.0f ns  p99.9 %6.0f ns\n", nombre,
+	       latencias[BUSQUEDAS_LATENCIA / 2] * 1e9,
+	       latencias[BUSQUEDAS_LATENCIA * 99 / 100] * 1e9,
+	       latencias[BUSQUEDAS_LATENCIA * 999 / 1000] * 1e9);
+	free(latencias);
+}
+
+void benchmark_hash_cuckoo()
+{
+	char (*claves_carga)[LARGO_CLAVE] =
+		malloc(CLAVES_CARGA_ALTA * sizeof(*claves_carga));
+	for (int i = 0; i < CLAVES_CARGA_ALTA; i++)
+		snprintf(claves_carga[i], LARGO_CLAVE, "clave%d", i);
+	int valor = 1;
+	hash_t *hash = hash_crear(CLAVES_CARGA_ALTA);
+	for (int i = 0; i < CLAVES_CARGA_ALTA; i++)
+		hash_insertar(hash, claves_carga[i], &valor, NULL);
+	medir_latencias("hash_t (listas)", hash, claves_carga,
+			CLAVES_CARGA_ALTA);
+	hash_destruir(hash);
+
+	tabla_cuckoo_t *tabla = tabla_cuckoo_crear(32768, NULL);
+	for (int i = 0; i < CLAVES_CARGA_ALTA; i++)
+		tabla_cuckoo_agregar(tabla, claves_carga[i], &valor);
+	printf("tabla cuckoo de 32768 lugares con %d claves: %.1f%% ocupada\n",
+	       CLAVES_CARGA_ALTA, tabla_cuckoo_factor_de_carga(tabla) * 100);
+	tabla_cuckoo_destruir(tabla);
+
+	hash_opciones_t opciones = { .flags = HASH_CUCKOO };
+	hash = hash_crear_con_opciones(32768, &opciones);
+	for (int i = 0; i < CLAVES_CARGA_ALTA; i++)
+		hash_insertar(hash, claves_carga[i], &valor, NULL);
+	medir_latencias("hash_t (cuckoo)", hash, claves_carga,
+			CLAVES_CARGA_ALTA);
+	hash_destruir(hash);
+	free(claves_carga);
+}
+
+#define RUTA_BENCHMARK_DURABLE "benchmark_hash_durable"
+#define ESCRITURAS_SINCRONIZADAS 1000
+
+/**
+ * Inserta en un hash durable nuevo las primeras claves (cada una con su
+ * clave como valor), sincronizando cada tantas operaciones, e imprime el
+ * resultado.
+*/
+void medir_escrituras_durables(const char *nombre, size_t claves_insertadas,
+			       size_t operaciones_por_sincronizacion)
+{
+	unlink(RUTA_BENCHMARK_DURABLE ".registro");
+	unlink(RUTA_BENCHMARK_DURABLE ".instantanea");
+	hash_durable_opciones_t opciones = {
+		.operaciones_por_sincronizacion = operaciones_por_sincronizacion
+	};
+	hash_durable_t *hash =
+		hash_durable_abrir(RUTA_BENCHMARK_DURABLE, &opciones);
+	double inicio = segundos_actuales();
+	for (size_t i = 0; i < claves_insertadas; i++)
+		hash_durable_insertar(hash, claves[i], claves[i], LARGO_CLAVE);
+	hash_durable_cerrar(hash);
+	imprimir_resultado(nombre, claves_insertadas,
+			   segundos_actuales() - inicio);
+}
+
+/**
+ * Reabre el hash durable que dejó medir_escrituras_durables, e imprime
+ * cuánto tarda en reconstruirlo.
+*/
+void medir_recuperacion(const char *nombre)
+{
+	double inicio = segundos_actuales();
+	hash_durable_t *hash = hash_durable_abrir(RUTA_BENCHMARK_DURABLE, NULL);
+	double segundos = segundos_actuales() - inicio;
+	imprimir_resultado(nombre, hash_durable_cantidad(hash), segundos);
+	hash_durable_cerrar(hash);
+}
+
+/**
+ * Reconstruye el mismo contenido sin hash durable: copia cada valor e
+ * inserta las claves de a una en un hash sin capacidad reservada.
+*/
+void medir_reconstruccion_con_inserciones()
+{
+	double inicio = segundos_actuales();
+	hash_t *hash = hash_crear(3);
+	for (int i = 0; i < CANTIDAD_CLAVES; i++) {
+		char *valor = malloc(LARGO_CLAVE);
+		memcpy(valor, claves[i], LARGO_CLAVE);
+		hash_insertar(hash, claves[i], valor, NULL);
+	}
+	imprimir_resultado("inserciones sueltas (en memoria)", CANTIDAD_CLAVES,
+			   segundos_actuales() - inicio);
+	hash_destruir_todo(hash, free);
+}
+
+void benchmark_hash_durable()
+{
+	medir_escrituras_durables("sincronizando cada operación",
+				  ESCRITURAS_SINCRONIZADAS, 1);
+	medir_escrituras_durables("sincronizando cada 64 operaciones",
+				  CANTIDAD_CLAVES, 64);
+	medir_recuperacion("recuperar desde el registro");
+	hash_durable_t *hash = hash_durable_abrir(RUTA_BENCHMARK_DURABLE, NULL);
+	hash_durable_compactar(hash);
+	hash_durable_cerrar(hash);
+	medir_recuperacion("recuperar desde la instantánea");
+	medir_reconstruccion_con_inserciones();
+	unlink(RUTA_BENCHMARK_DURABLE ".registro");
+	unlink(RUTA_BENCHMARK_DURABLE ".instantanea");
+}
+
+#define RUTA_BENCHMARK_CARGA "benchmark_hash_carga.tsv"
+#define LINEAS_CARGA 1000000
+
+/**
+ * Carga el archivo como se haría sin hash_carga_t: lee cada línea con
+ * fgets, copia el valor e inserta la clave (que el hash vuelve a copiar) en
+ * un hash sin capacidad reservada.
+*/
+void medir_carga_con_fgets()
+{
+	char linea[64];
+	double inicio = segundos_actuales();
+	FILE *archivo = fopen(RUTA_BENCHMARK_CARGA, "r");
+	hash_t *hash = hash_crear(3);
+	while (fgets(linea, sizeof(linea), archivo)) {
+		linea[strcspn(linea, "\n")] = 0;
+		char *tabulacion = strchr(linea, '\t');
+		if (!tabulacion)
+			continue;
+		*tabulacion = 0;
+		hash_insertar(hash, linea, strdup(tabulacion + 1), NULL);
+	}
+	fclose(archivo);
+	imprimir_resultado("fgets + hash_insertar", hash_cantidad(hash),
+			   segundos_actuales() - inicio);
+	hash_destruir_todo(hash, free);
+}
+
+/**
+ * Carga el archivo con hash_cargar_archivo y la cantidad de hilos dada.
+*/
+void medir_hash_carga(const char *nombre, size_t hilos)
+{
+	double inicio = segundos_actuales();
+	hash_carga_t *carga = hash_cargar_archivo(RUTA_BENCHMARK_CARGA, NULL,
+						  hilos);
+	imprimir_resultado(nombre, hash_cantidad(hash_carga_hash(carga)),
+			   segundos_actuales() - inicio);
+	hash_carga_destruir(carga);
+}
+
+void benchmark_hash_carga()
+{
+	FILE *archivo = fopen(RUTA_BENCHMARK_CARGA, "w");
+	unsigned long long estado = 88172645463325252ULL;
+	for (int i = 0; i < LINEAS_CARGA; i++)
+		fprintf(archivo, "%016llx\tvalor%d\n",
+			siguiente_aleatorio(&estado), i);
+	fclose(archivo);
+	medir_carga_con_fgets();
+	medir_hash_carga("hash_cargar_archivo (1 hilo)", 1);
+	medir_hash_carga("hash_cargar_archivo (un hilo por cpu)", 0);
+	unlink(RUTA_BENCHMARK_CARGA);
+}
+
+#define PEDIDOS 150000
+#define LINEAS_POR_PEDIDO 4
+#define CLIENTES 15000
+#define LOTE_SONDEO 10000
+
+/*
+ * Datos parecidos a los de TPC-H: pedidos (orders) con su cliente, y líneas
+ * de pedido (lineitem) con su pedido y su precio. La consulta reúne las
+ * líneas con sus pedidos y suma los precios por cliente.
+ */
+typedef struct datos_tpch {
+	char (*claves_pedidos)[16];
+	char (*claves_clientes)[16];
+	consulta_fila_t *pedidos;
+	consulta_fila_t *lineas;
+} datos_tpch_t;
+
+void generar_datos_tpch(datos_tpch_t *datos)
+{
+	unsigned long long estado = 88172645463325252ULL;
+	datos->claves_pedidos = malloc(PEDIDOS * sizeof(*datos->claves_pedidos));
+	datos->claves_clientes =
+		malloc(CLIENTES * sizeof(*datos->claves_clientes));
+	datos->pedidos = calloc(PEDIDOS, sizeof(consulta_fila_t));
+	datos->lineas =
+		calloc(PEDIDOS * LINEAS_POR_PEDIDO, sizeof(consulta_fila_t));
+	for (int i = 0; i < CLIENTES; i++)
+		snprintf(datos->claves_clientes[i], 16, "cliente%d", i);
+	for (int i = 0; i < PEDIDOS; i++) {
+		snprintf(datos->claves_pedidos[i], 16, "pedido%d", i);
+		datos->pedidos[i].clave = datos->claves_pedidos[i];
+		datos->pedidos[i].dato =
+			datos->claves_clientes[siguiente_aleatorio(&estado) %
+					       CLIENTES];
+	}
+	for (int i = 0; i < PEDIDOS * LINEAS_POR_PEDIDO; i++) {
+		datos->lineas[i].clave =
+			datos->claves_pedidos[siguiente_aleatorio(&estado) %
+					      PEDIDOS];
+		datos->lineas[i].valor =
+			(double)(siguiente_aleatorio(&estado) % 100000) / 100;
+	}
+}
+
+void liberar_datos_tpch(datos_tpch_t *datos)
+{
+	free(datos->claves_pedidos);
+	free(datos->claves_clientes);
+	free(datos->pedidos);
+	free(datos->lineas);
+}
+
+/**
+ * Resuelve la consulta con un único hash_t para los pedidos y otro para los
+ * totales por cliente, insertando y buscando de a una fila.
+*/
+void medir_consulta_con_hash(datos_tpch_t *datos)
+{
+	double inicio = segundos_actuales();
+	hash_t *pedidos = hash_crear(3);
+	for (int i = 0; i < PEDIDOS; i++)
+		hash_insertar(pedidos, datos->pedidos[i].clave,
+			      datos->pedidos[i].dato, NULL);
+	hash_t *totales = hash_crear(3);
+	for (int i = 0; i < PEDIDOS * LINEAS_POR_PEDIDO; i++) {
+		char *cliente = hash_obtener(pedidos, datos->lineas[i].clave);
+		double *total = hash_obtener(totales, cliente);
+		if (!total) {
+			total = calloc(1, sizeof(double));
+			hash_insertar(totales, cliente, total, NULL);
+		}
+		*total += datos->lineas[i].valor;
+	}
+	imprimir_resultado("hash_t (fila por fila)",
+			   PEDIDOS * LINEAS_POR_PEDIDO,
+			   segundos_actuales() - inicio);
+	hash_destruir_todo(totales, free);
+	hash_destruir(pedidos);
+}
+
+typedef struct lote_de_clientes {
+	consulta_fila_t *filas;
+	size_t cantidad;
+} lote_de_clientes_t;
+
+void agregar_al_lote(const consulta_fila_t *pedido,
+		     const consulta_fila_t *linea, void *lote)
+{
+	lote_de_clientes_t *clientes = lote;
+	clientes->filas[clientes->cantidad].clave = pedido->dato;
+	clientes->filas[clientes->cantidad].valor = linea->valor;
+	clientes->cantidad++;
+}
+
+/**
+ * Resuelve la consulta con una reunión (sondeando las líneas en lotes) y
+ * una agrupación por cliente.
+*/
+void medir_consulta_particionada(const char *nombre, datos_tpch_t *datos,
+				 size_t hilos)
+{
+	double inicio = segundos_actuales();
+	reunion_t *reunion = reunion_crear(datos->pedidos, PEDIDOS, hilos);
+	agrupacion_t *agrupacion = agrupacion_crear(CLIENTES, hilos);
+	lote_de_clientes_t lote = {
+		.filas = calloc(LOTE_SONDEO, sizeof(consulta_fila_t))
+	};
+	for (int i = 0; i < PEDIDOS * LINEAS_POR_PEDIDO; i += LOTE_SONDEO) {
+		lote.cantidad = 0;
+		reunion_sondear(reunion, datos->lineas + i, LOTE_SONDEO,
+				agregar_al_lote, &lote);
+		agrupacion_agregar(agrupacion, lote.filas, lote.cantidad);
+	}
+	imprimir_resultado(nombre, PEDIDOS * LINEAS_POR_PEDIDO,
+			   segundos_actuales() - inicio);
+	free(lote.filas);
+	agrupacion_destruir(agrupacion);
+	reunion_destruir(reunion);
+}
+
+void benchmark_consultas()
+{
+	datos_tpch_t datos;
+	generar_datos_tpch(&datos);
+	medir_consulta_con_hash(&datos);
+	medir_consulta_particionada("reunion + agrupacion (1 hilo)", &datos, 1);
+	medir_consulta_particionada("reunion + agrupacion (por cpu)", &datos,
+				    0);
+	liberar_datos_tpch(&datos);
+}
+
+#define REPETICIONES_CONJUNTOS 20
+
+/**
+ * Recibe un hash vacío y le inserta las claves en [desde, hasta).
+*/
+void insertar_rango_de_claves(hash_t *hash, int desde, int hasta)
+{
+	for (int i = desde; i < hasta; i++)
+		hash_insertar(hash, claves[i], claves[i], NULL);
+}
+
+bool insertar_si_esta_en_el_otro(const char *clave, void *valor, void *aux)
+{
+	hash_t **hashes = aux;
+	if (hash_contiene(hashes[0], clave))
+		hash_insertar(hashes[1], clave, valor, NULL);
+	return true;
+}
+
+/**
+ * Fusiona e interseca REPETICIONES_CONJUNTOS veces dos hash de 15000 claves
+ * que comparten 10000, a mano (recorriendo uno e insertando o buscando en el
+ * otro) o con las operaciones de conjuntos. Solo se mide la operación (y,
+ * en la fusión, destruir el otro hash), no armar los hash.
+*/
+void medir_conjuntos(bool a_mano)
+{
+	double fusionar = 0, intersecar = 0;
+	for (int i = 0; i < REPETICIONES_CONJUNTOS; i++) {
+		hash_t *hash = hash_crear(3);
+		hash_t *otro = hash_crear(3);
+		insertar_rango_de_claves(hash, 0, 15000);
+		insertar_rango_de_claves(otro, 5000, CANTIDAD_CLAVES);
+
+		double inicio = segundos_actuales();
+		hash_t *comunes;
+		if (a_mano) {
+			comunes = hash_crear(3);
+			hash_con_cada_clave(hash, insertar_si_esta_en_el_otro,
+					    (hash_t *[]){ otro, comunes });
+		} else {
+			comunes = hash_interseccion(hash, otro, NULL, NULL,
+						    NULL);
+		}
+		intersecar += segundos_actuales() - inicio;
+
+		inicio = segundos_actuales();
+		if (a_mano)
+			hash_con_cada_clave(otro, copiar_clave, hash);
+		else
+			hash_fusionar(hash, otro, NULL, NULL);
+		hash_destruir(otro);
+		fusionar += segundos_actuales() - inicio;
+
+		hash_destruir(comunes);
+		hash_destruir(hash);
+	}
+	imprimir_resultado(a_mano ? "interseccion a mano" : "hash_interseccion",
+			   REPETICIONES_CONJUNTOS, intersecar);
+	imprimir_resultado(a_mano ? "fusion a mano" : "hash_fusionar",
+			   REPETICIONES_CONJUNTOS, fusionar);
+}
+
+void benchmark_conjuntos()
+{
+	medir_conjuntos(true);
+	medir_conjuntos(false);
+}
+
+#define REPETICIONES_QUITAR_SI 20
+
+bool valor_par(const char *clave, void *valor, void *aux)
+{
+	return *(int *)valor % 2 == 0;
+}
+
+bool juntar_si_valor_par(const char *clave, void *valor, void *aux)
+{
+	if (valor_par(clave, valor, NULL))
+		((const char **)aux)[*(int *)valor / 2] = clave;
+	return true;
+}
+
+/**
+ * Quita REPETICIONES_QUITAR_SI veces la mitad de las claves de un hash con
+ * todas, juntando las claves y llamando a hash_quitar con cada una, o con
+ * hash_quitar_si. Solo se mide quitar, no armar el hash.
+*/
+void medir_quitar_si(bool a_mano)
+{
+	int *valores = malloc(CANTIDAD_CLAVES * sizeof(int));
+	const char **a_quitar = malloc(CANTIDAD_CLAVES / 2 * sizeof(char *));
+	double segundos = 0;
+	for (int i = 0; i < REPETICIONES_QUITAR_SI; i++) {
+		hash_t *hash = hash_crear(3);
+		for (int j = 0; j < CANTIDAD_CLAVES; j++) {
+			valores[j] = j;
+			hash_insertar(hash, claves[j], &valores[j], NULL);
+		}
+		double inicio = segundos_actuales();
+		if (a_mano) {
+			hash_con_cada_clave(hash, juntar_si_valor_par,
+					    a_quitar);
+			for (int j = 0; j < CANTIDAD_CLAVES / 2; j++)
+				hash_quitar(hash, a_quitar[j]);
+		} else {
+			hash_quitar_si(hash, valor_par, NULL, NULL);
+		}
+		segundos += segundos_actuales() - inicio;
+		hash_destruir(hash);
+	}
+	imprimir_resultado(a_mano ? "juntar claves + hash_quitar" :
+				    "hash_quitar_si",
+			   REPETICIONES_QUITAR_SI, segundos);
+	free(a_quitar);
+	free(valores);
+}
+
+void benchmark_quitar_si()
+{
+	medir_quitar_si(true);
+	medir_quitar_si(false);
+}
+
+#define POSTINGS 1000000
+#define CONSULTAS_INDICE 20000
+
+bool sumar_documentos(void *documento, void *suma)
+{
+	*(size_t *)suma += (size_t)(uintptr_t)documento;
+	return true;
+}
+
+bool destruir_lista_de_documentos(const char *clave, void *lista, void *aux)
+{
+	lista_destruir(lista);
+	return true;
+}
+
+/**
+ * Arma un índice invertido de POSTINGS apariciones (término, documento)
+ * sobre las claves, con términos de frecuencia sesgada, emulando el
+ * multimapa con un hash_t de lista_t por término, y después recorre todos
+ * los documentos de CONSULTAS_INDICE términos.
+*/
+void medir_indice_con_listas()
+{
+	unsigned long long estado = 88172645463325252ULL;
+	hash_t *indice = hash_crear(CANTIDAD_CLAVES);
+	double inicio = segundos_actuales();
+	for (uintptr_t documento = 0; documento < POSTINGS; documento++) {
+		const char *termino = claves[indice_sesgado(&estado)];
+		lista_t *documentos = hash_obtener(indice, termino);
+		if (!documentos) {
+			documentos = lista_crear();
+			hash_insertar(indice, termino, documentos, NULL);
+		}
+		lista_insertar(documentos, (void *)documento);
+	}
+	imprimir_resultado("hash_t + lista_t: armar", POSTINGS,
+			   segundos_actuales() - inicio);
+	size_t suma = 0;
+	inicio = segundos_actuales();
+	for (int i = 0; i < CONSULTAS_INDICE; i++)
+		lista_con_cada_elemento(
+			hash_obtener(indice, claves[indice_sesgado(&estado)]),
+			sumar_documentos, &suma);
+	imprimir_resultado("hash_t + lista_t: consultar", CONSULTAS_INDICE,
+			   segundos_actuales() - inicio);
+	hash_con_cada_clave(indice, destruir_lista_de_documentos, NULL);
+	hash_destruir(indice);
+	printf("%-40s %10zu\n", "", suma);
+}
+
+/**
+ * Igual que medir_indice_con_listas, con hash_multi_t.
+*/
+void medir_indice_con_hash_multi()
+{
+	unsigned long long estado = 88172645463325252ULL;
+	hash_multi_t *indice = hash_multi_crear(CANTIDAD_CLAVES, NULL);
+	double inicio = segundos_actuales();
+	for (uintptr_t documento = 0; documento < POSTINGS; documento++)
+		hash_multi_insertar(indice, claves[indice_sesgado(&estado)],
+				    (void *)documento);
+	imprimir_resultado("hash_multi_t: armar", POSTINGS,
+			   segundos_actuales() - inicio);
+	size_t suma = 0;
+	inicio = segundos_actuales();
+	for (int i = 0; i < CONSULTAS_INDICE; i++) {
+		size_t cantidad = 0;
+		void *const *documentos = hash_multi_obtener_todos(
+			indice, claves[indice_sesgado(&estado)], &cantidad);
+		for (size_t j = 0; j < cantidad; j++)
+			suma += (size_t)(uintptr_t)documentos[j];
+	}
+	imprimir_resultado("hash_multi_t: consultar", CONSULTAS_INDICE,
+			   segundos_actuales() - inicio);
+	hash_multi_destruir(indice);
+	printf("%-40s %10zu\n", "", suma);
+}
+
+void benchmark_hash_multi()
+{
+	medir_indice_con_listas();
+	medir_indice_con_hash_multi();
+}
+
+#define TABLAS_PRECALCULADAS 3
+#define SEMILLA_PRECALCULADA 0x9e3779b97f4a7c15ULL
+
+/**
+ * Busca CANTIDAD_OPERACIONES claves (cada una en TABLAS_PRECALCULADAS hash
+ * con la misma semilla y filtro) con hash_obtener, que calcula el hash de
+ * la clave en cada tabla, o con hash_calcular_con_semilla una vez y
+ * hash_obtener_h en cada tabla.
+*/
+void medir_hash_precalculado(bool precalculado)
+{
+	hash_opciones_t opciones = { .flags = HASH_FILTRO,
+				     .semilla = SEMILLA_PRECALCULADA };
+	hash_t *tablas[TABLAS_PRECALCULADAS];
+	for (int i = 0; i < TABLAS_PRECALCULADAS; i++) {
+		tablas[i] = hash_crear_con_opciones(CANTIDAD_CLAVES, &opciones);
+		for (int j = i; j < CANTIDAD_CLAVES; j += 2)
+			hash_insertar(tablas[i], claves[j], claves[j], NULL);
+	}
+	size_t encontradas = 0;
+	double inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++) {
+		const char *clave = claves[i % CANTIDAD_CLAVES];
+		if (precalculado) {
+			hash_clave_t calculada = hash_calcular_con_semilla(
+				clave, SEMILLA_PRECALCULADA);
+			for (int j = 0; j < TABLAS_PRECALCULADAS; j++)
+				encontradas += hash_obtener_h(tablas[j],
+							      &calculada) != NULL;
+		} else {
+			for (int j = 0; j < TABLAS_PRECALCULADAS; j++)
+				encontradas +=
+					hash_obtener(tablas[j], clave) != NULL;
+		}
+	}
+	imprimir_resultado(precalculado ? "hash_calcular + hash_obtener_h" :
+					  "hash_obtener en cada tabla",
+			   CANTIDAD_OPERACIONES, segundos_actuales() - inicio);
+	printf("%-40s %10zu\n", "", encontradas);
+	for (int i = 0; i < TABLAS_PRECALCULADAS; i++)
+		hash_destruir(tablas[i]);
+}
+
+void benchmark_hash_precalculado()
+{
+	medir_hash_precalculado(false);
+	medir_hash_precalculado(true);
+}
+
+#define TRABAJADORES 4
+#define NOMBRE_BENCHMARK_COMPARTIDO "/benchmark_hash_compartido"
+
+bool liberar_valor_copiado(const char *clave, void *valor, void *aux)
+{
+	free(valor);
+	return true;
+}
+
+/**
+ * Carga en un hash_t todas las claves, con una copia de la clave como
+ * valor, como haría cada trabajador por su cuenta, y las busca al azar.
+ * Imprime el tiempo de carga, el de búsqueda y la memoria reservada con
+ * malloc, que se repite en cada uno de los TRABAJADORES.
+*/
+void medir_tabla_por_proceso()
+{
+	unsigned long long estado = 88172645463325252ULL;
+	size_t memoria_inicial = mallinfo2().uordblks;
+	double inicio = segundos_actuales();
+	hash_t *hash = hash_crear(CANTIDAD_CLAVES);
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		hash_insertar(hash, claves[i], strdup(claves[i]), NULL);
+	imprimir_resultado("hash_t por proceso: cargar", CANTIDAD_CLAVES,
+			   segundos_actuales() - inicio);
+	size_t memoria = mallinfo2().uordblks - memoria_inicial;
+	size_t largos = 0;
+	inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++)
+		largos += strlen(hash_obtener(
+			hash, claves[siguiente_aleatorio(&estado) %
+				     CANTIDAD_CLAVES]));
+	imprimir_resultado("hash_t por proceso: obtener",
+			   CANTIDAD_OPERACIONES, segundos_actuales() - inicio);
+	printf("%-40s %10zu bytes (x%d procesos)\n", "", memoria,
+	       TRABAJADORES);
+	printf("%-40s %10zu\n", "", largos);
+	hash_con_cada_clave(hash, liberar_valor_copiado, NULL);
+	hash_destruir(hash);
+}
+
+/**
+ * Carga todas las claves en un hash compartido, y lo abre de nuevo (como
+ * haría cada trabajador) para buscarlas al azar. Imprime el tiempo de
+ * carga, el de apertura, el de búsqueda y el tamaño del segmento, que se
+ * comparte entre todos los TRABAJADORES.
+*/
+void medir_tabla_compartida()
+{
+	unsigned long long estado = 88172645463325252ULL;
+	hash_compartido_eliminar(NOMBRE_BENCHMARK_COMPARTIDO);
+	double inicio = segundos_actuales();
+	hash_compartido_t *cargador = hash_compartido_crear(
+		NOMBRE_BENCHMARK_COMPARTIDO, CANTIDAD_CLAVES,
+		(size_t)CANTIDAD_CLAVES * 64);
+	for (int i = 0; i < CANTIDAD_CLAVES; i++)
+		hash_compartido_insertar(cargador, claves[i], claves[i],
+					 strlen(claves[i]) + 1);
+	imprimir_resultado("hash_compartido_t: cargar", CANTIDAD_CLAVES,
+			   segundos_actuales() - inicio);
+	inicio = segundos_actuales();
+	hash_compartido_t *trabajador =
+		hash_compartido_abrir(NOMBRE_BENCHMARK_COMPARTIDO, false);
+	printf("%-40s %10.6f s\n", "hash_compartido_t: abrir",
+	       segundos_actuales() - inicio);
+	size_t largos = 0;
+	inicio = segundos_actuales();
+	for (int i = 0; i < CANTIDAD_OPERACIONES; i++)
+		largos += strlen(hash_compartido_obtener(
+			trabajador,
+			claves[siguiente_aleatorio(&estado) %
+			       CANTIDAD_CLAVES],
+			NULL));
+	imprimir_resultado("hash_compartido_t: obtener",
+			   CANTIDAD_OPERACIONES, segundos_actuales() - inicio);
+	printf("%-40s %10zu bytes (compartidos)\n", "",
+	       hash_compartido_bytes_usados(cargador));
+	printf("%-40s %10zu\n", "", largos);
+	hash_compartido_cerrar(trabajador);
+	hash_compartido_cerrar(cargador);
+	hash_compartido_eliminar(NOMBRE_BENCHMARK_COMPARTIDO);
+}
+
+void benchmark_hash_compartido()
+{
+	medir_tabla_por_proceso();
+	medir_tabla_compartida();
+}
+
+int main()
+{
+	generar_claves();
+
+	printf("\n==================== CACHE LRU ====================\n");
+	benchmark_cache_lru_contra_hash();
+
+	printf("\n================== CLAVES ENTERAS ==================\n");
+	benchmark_hash_u64_contra_hash();
+
+	printf("\n======================== FILTRO ========================\n");
+	benchmark_filtro_con_claves_ausentes();
+
+	printf("\n====================== COLISIONES ======================\n");
+	benchmark_claves_que_colisionan();
+
+	printf("\n========================= LISTA =========================\n");
+	benchmark_lista();
+	benchmark_listas_en_lote();
+
+	printf("\n===================== POOL DE NODOS =====================\n");
+	benchmark_pool_de_nodos();
+
+	printf("\n===================== HASH COMPACTO =====================\n");
+	benchmark_hash_compacto();
+
+	printf("\n====================== HASH CUCKOO ======================\n");
+	benchmark_hash_cuckoo();
+
+	printf("\n======================== MEMORIA ========================\n");
+	benchmark_hash_con_limite_de_memoria();
+
+	printf("\n======================= CAPACIDAD =======================\n");
+	benchmark_capacidad();
+
+	printf("\n===================== INSTANTÁNEAS =====================\n");
+	benchmark_instantaneas();
+
+	printf("\n======================== DURABLE ========================\n");
+	benchmark_hash_durable();
+
+	printf("\n========================= CARGA =========================\n");
+	benchmark_hash_carga();
+
+	printf("\n======================= CONSULTAS =======================\n");
+	benchmark_consultas();
+
+	printf("\n======================= CONJUNTOS =======================\n");
+	benchmark_conjuntos();
+
+	printf("\n======================= QUITAR SI =======================\n");
+	benchmark_quitar_si();
+
+	printf("\n====================== HASH MULTI ======================\n");
+	benchmark_hash_multi();
+
+	printf("\n=================== HASH PRECALCULADO ===================\n");
+	benchmark_hash_precalculado();
+
+	printf("\n==================== HASH COMPARTIDO ====================\n");
+	benchmark_hash_compartido();
+
+	return 0;
+}
@@ -2,8 +2,27 @@
 #include "src/hash.h"
 #include "src/hash_estructura_privada.h"
 #include "src/lista.h"
+#include "src/cache_lru.h"
+#include "src/hash_u64.h"
+#include "src/hash_generico.h"
+#include "src/pool.h"
+#include "src/tabla_cuckoo.h"
+#include "src/hash_durable.h"
+#include "src/hash_carga.h"
+#include "src/consulta.h"
+#include "src/hash_multi.h"
+#include "src/hash_compartido.h"
+#include "src/calidad_hash.h"
+#include "src/funciones_hash.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <signal.h>
 
 void crear_hash_con_capacidad_mayor_a_3()
 {
@@ -194,6 +213,24 @@ void quitar_elemento_que_no_se_encuentra_en_el_hash()
 	hash_destruir(hash);
 }
 
+void quitar_ultimo_elemento_de_una_colision_y_volver_a_insertar()
+{
+	hash_t *hash = hash_crear(3);
+	const char *clave1 = "fc3a", *clave2 = "fca3", *clave3 = "f3ca";
+	int valor1 = 1, valor2 = 2, valor3 = 3;
+	int posicion = posicion_correspondiente_a_clave(clave1, 3);
+	hash_insertar(hash, clave1, &valor1, NULL);
+	hash_insertar(hash, clave2, &valor2, NULL);
+	hash_quitar(hash, clave2);
+	hash_insertar(hash, clave3, &valor3, NULL);
+	par_cv_t *ultimo = lista_ultimo(hash->tabla[posicion]);
+	pa2m_afirmar(
+		*(int *)ultimo->valor == valor3 &&
+			lista_tamanio(hash->tabla[posicion]) == 2,
+		"Puedo quitar el último elemento de una colisión y volver a insertar.");
+	hash_destruir(hash);
+}
+
 void quitar_elemento_de_hash_nulo()
 {
 	pa2m_afirmar(
@@ -393,50 +430,2369 @@ void iterador_interno_pasando_funcion_nula()
 	hash_destruir(hash);
 }
 
-int main()
+void insertar_con_claves_prestadas_no_copia_la_clave()
 {
-	pa2m_nuevo_grupo(
-		"\n======================== CREAR ========================");
-	crear_hash_con_capacidad_mayor_a_3();
-	crear_hash_con_capacidad_menor_a_3_se_crea_con_capacidad_3();
+	hash_opciones_t opciones = { .flags = HASH_CLAVES_PRESTADAS };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[] = "fc3a";
+	int valor = 1;
+	hash_insertar(hash, clave, &valor, NULL);
+	par_cv_t *par = lista_primero(
+		hash->tabla[posicion_correspondiente_a_clave(clave, 3)]);
+	pa2m_afirmar(par->clave == clave &&
+			     *(int *)hash_obtener(hash, "fc3a") == valor,
+		     "Con claves prestadas el hash guarda el puntero del usuario.");
+	hash_destruir(hash);
+}
 
-	pa2m_nuevo_grupo(
-		"\n======================== INSERTAR ========================");
-	insertar_sin_llegar_al_rehash_sin_colision_sin_clave_repetida();
-	insertar_sin_llegar_al_rehash_con_colision_sin_clave_repetida();
-	insertar_sin_llegar_al_rehash_con_clave_repetida_anterior_no_nulo();
-	insertar_sin_llegar_al_rehash_con_clave_repetida_anterior_nulo();
-	insertar_con_rehash();
-	insertar_pasando_hash_nulo();
-	insertar_pasando_clave_nula();
+void crear_con_claves_prestadas_y_pool_falla()
+{
+	pool_claves_t *pool = pool_claves_crear();
+	hash_opciones_t opciones = { .flags = HASH_CLAVES_PRESTADAS,
+				     .pool_claves = pool };
+	pa2m_afirmar(!hash_crear_con_opciones(3, &opciones),
+		     "No se puede crear un hash con claves prestadas y pool.");
+	pool_claves_destruir(pool);
+}
 
-	pa2m_nuevo_grupo(
-		"\n======================== QUITAR ========================");
-	quitar_elemento_que_se_encuentra_en_el_hash();
-	quitar_elemento_que_no_se_encuentra_en_el_hash();
-	quitar_elemento_de_hash_nulo();
-	quitar_elemento_con_clave_nula();
+void hashes_con_pool_comparten_las_claves()
+{
+	pool_claves_t *pool = pool_claves_crear();
+	hash_opciones_t opciones = { .pool_claves = pool };
+	hash_t *hash1 = hash_crear_con_opciones(3, &opciones);
+	hash_t *hash2 = hash_crear_con_opciones(3, &opciones);
+	int valor1 = 1, valor2 = 2;
+	int posicion = posicion_correspondiente_a_clave("fc3a", 3);
+	hash_insertar(hash1, "fc3a", &valor1, NULL);
+	hash_insertar(hash2, "fc3a", &valor2, NULL);
+	par_cv_t *par1 = lista_primero(hash1->tabla[posicion]);
+	par_cv_t *par2 = lista_primero(hash2->tabla[posicion]);
+	pa2m_afirmar(par1->clave == par2->clave &&
+			     pool_claves_cantidad(pool) == 1,
+		     "Dos hash con el mismo pool comparten la clave internada.");
+	hash_quitar(hash1, "fc3a");
+	bool sigue_en_pool = pool_claves_cantidad(pool) == 1;
+	hash_destruir(hash2);
+	pa2m_afirmar(sigue_en_pool && pool_claves_cantidad(pool) == 0,
+		     "La clave se libera del pool al soltar la última referencia.");
+	hash_destruir(hash1);
+	pool_claves_destruir(pool);
+}
 
-	pa2m_nuevo_grupo(
-		"\n======================== BUSCAR ========================");
-	obtener_elemento_que_esta_en_el_hash();
-	obtener_elemento_que_no_esta_en_el_hash();
-	obtener_elemento_en_hash_nulo();
-	obtener_elemento_con_clave_nula();
+void rehash_con_pool_no_vuelve_a_internar_las_claves()
+{
+	pool_claves_t *pool = pool_claves_crear();
+	hash_opciones_t opciones = { .pool_claves = pool };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	const char *claves[] = { "sc12", "sc13", "sc14", "sc15", "sc16" };
+	int valor = 1;
+	for (int i = 0; i < 5; i++)
+		hash_insertar(hash, claves[i], &valor, NULL);
+	hash_destruir(hash);
+	pa2m_afirmar(pool_claves_cantidad(pool) == 0,
+		     "El rehash reubica las claves del pool sin duplicarlas.");
+	pool_claves_destruir(pool);
+}
 
-	pa2m_nuevo_grupo(
-		"\n======================= CONTIENE =======================");
-	ver_si_contiene_elemento_que_esta_en_el_hash();
-	ver_si_contiene_elemento_que_no_esta_en_el_hash();
-	hash_contiene_con_hash_nulo();
-	hash_contiene_con_clave_nula();
+void cache_desaloja_el_menos_usado_al_superar_entradas()
+{
+	cache_lru_t *cache = cache_lru_crear(2, 0, NULL);
+	int valor1 = 1, valor2 = 2, valor3 = 3;
+	cache_lru_insertar(cache, "a", &valor1, 1);
+	cache_lru_insertar(cache, "b", &valor2, 1);
+	cache_lru_obtener(cache, "a");
+	cache_lru_insertar(cache, "c", &valor3, 1);
+	pa2m_afirmar(cache_lru_contiene(cache, "a") &&
+			     !cache_lru_contiene(cache, "b") &&
+			     cache_lru_contiene(cache, "c") &&
+			     cache_lru_cantidad(cache) == 2,
+		     "La cache desaloja el elemento usado hace más tiempo.");
+	cache_lru_destruir(cache);
+}
 
-	pa2m_nuevo_grupo(
-		"\n======================= ITERADOR =======================");
-	iterador_interno_pasando_hash_sin_colisiones();
-	iterador_interno_pasando_hash_con_colisiones();
-	iterador_interno_pasando_hash_nulo();
-	iterador_interno_pasando_funcion_nula();
+void cache_desaloja_por_bytes_e_invoca_destructor()
+{
+	cache_lru_t *cache = cache_lru_crear(0, 10, free);
+	cache_lru_insertar(cache, "a", malloc(4), 4);
+	cache_lru_insertar(cache, "b", malloc(4), 4);
+	cache_lru_insertar(cache, "c", malloc(4), 4);
+	cache_lru_estadisticas_t estadisticas = cache_lru_estadisticas(cache);
+	pa2m_afirmar(!cache_lru_contiene(cache, "a") &&
+			     cache_lru_bytes(cache) == 8 &&
+			     estadisticas.desalojos == 1,
+		     "La cache desaloja elementos al superar el límite de bytes.");
+	pa2m_afirmar(!cache_lru_insertar(cache, "d", NULL, 11),
+		     "No se puede insertar un elemento más grande que la cache.");
+	cache_lru_destruir(cache);
+}
+
+void cache_cuenta_aciertos_y_fallos()
+{
+	cache_lru_t *cache = cache_lru_crear(4, 0, NULL);
+	int valor1 = 1, valor2 = 2;
+	cache_lru_insertar(cache, "a", &valor1, 1);
+	cache_lru_insertar(cache, "a", &valor2, 1);
+	void *obtenido = cache_lru_obtener(cache, "a");
+	cache_lru_obtener(cache, "b");
+	cache_lru_estadisticas_t estadisticas = cache_lru_estadisticas(cache);
+	pa2m_afirmar(obtenido == &valor2 && estadisticas.aciertos == 1 &&
+			     estadisticas.fallos == 1 &&
+			     cache_lru_cantidad(cache) == 1,
+		     "La cache actualiza valores y cuenta aciertos y fallos.");
+	pa2m_afirmar(cache_lru_quitar(cache, "a") == &valor2 &&
+			     cache_lru_cantidad(cache) == 0,
+		     "Puedo quitar un elemento de la cache.");
+	cache_lru_destruir(cache);
+}
+
+uint64_t reloj_de_prueba(void *tiempo)
+{
+	return *(uint64_t *)tiempo;
+}
+
+void contar_liberado(void *contador)
+{
+	(*(int *)contador)++;
+}
+
+void elemento_vencido_se_considera_ausente()
+{
+	uint64_t tiempo = 1000;
+	int liberados = 0;
+	hash_opciones_t opciones = { .reloj = reloj_de_prueba,
+				     .contexto_reloj = &tiempo,
+				     .destructor_expirados = contar_liberado };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	hash_insertar_con_ttl(hash, "fc3a", &liberados, 10, NULL);
+	bool presente_antes = hash_contiene(hash, "fc3a");
+	tiempo = 1010;
+	pa2m_afirmar(presente_antes && !hash_obtener(hash, "fc3a") &&
+			     hash_cantidad(hash) == 0 && liberados == 1,
+		     "Un elemento vencido se considera ausente y se libera al accederlo.");
+	hash_destruir(hash);
+}
+
+void insertar_sin_ttl_quita_el_vencimiento()
+{
+	uint64_t tiempo = 0;
+	int valor = 1;
+	hash_opciones_t opciones = { .reloj = reloj_de_prueba,
+				     .contexto_reloj = &tiempo };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	hash_insertar_con_ttl(hash, "fc3a", &valor, 10, NULL);
+	hash_insertar(hash, "fc3a", &valor, NULL);
+	tiempo = 100;
+	pa2m_afirmar(hash_contiene(hash, "fc3a") && hash_expirar(hash, 0) == 0,
+		     "Insertar sin ttl una clave existente le quita el vencimiento.");
+	hash_destruir(hash);
+}
+
+void hash_expirar_quita_solo_los_vencidos_de_a_tandas()
+{
+	uint64_t tiempo = 5;
+	int liberados = 0;
+	char claves[1000][8];
+	hash_opciones_t opciones = { .reloj = reloj_de_prueba,
+				     .contexto_reloj = &tiempo,
+				     .destructor_expirados = contar_liberado };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	for (int i = 0; i < 1000; i++) {
+		sprintf(claves[i], "k%d", i);
+		hash_insertar_con_ttl(hash, claves[i], &liberados,
+				      (uint64_t)(i * 7919) % 300000, NULL);
+	}
+	tiempo = 5 + 150000;
+	size_t quitados = 0, tanda;
+	while ((tanda = hash_expirar(hash, 100)) > 0)
+		quitados += tanda;
+	size_t esperados = 0;
+	for (int i = 0; i < 1000; i++)
+		if ((uint64_t)(i * 7919) % 300000 <= 150000)
+			esperados++;
+	pa2m_afirmar(quitados == esperados && liberados == (int)esperados &&
+			     hash_cantidad(hash) == 1000 - esperados,
+		     "hash_expirar quita de a tandas solo los elementos vencidos.");
+	tiempo = 5 + 300000;
+	hash_expirar(hash, 0);
+	pa2m_afirmar(hash_cantidad(hash) == 0,
+		     "Con el tiempo suficiente hash_expirar quita todos los elementos.");
+	hash_destruir(hash);
+}
+
+void hash_u64_inserta_actualiza_y_obtiene()
+{
+	hash_u64_t *hash = hash_u64_crear(0);
+	int valor1 = 1, valor2 = 2;
+	void *anterior = NULL;
+	hash_u64_insertar(hash, 42, &valor1, NULL);
+	hash_u64_insertar(hash, 42, &valor2, &anterior);
+	pa2m_afirmar(hash_u64_obtener(hash, 42) == &valor2 &&
+			     anterior == &valor1 &&
+			     hash_u64_cantidad(hash) == 1 &&
+			     !hash_u64_contiene(hash, 43),
+		     "Puedo insertar, actualizar y obtener claves enteras.");
+	hash_u64_destruir(hash);
+}
+
+void hash_u64_quitar_mantiene_accesibles_las_demas_claves()
+{
+	hash_u64_t *hash = hash_u64_crear(3);
+	int valores[2000];
+	for (int i = 0; i < 2000; i++) {
+		valores[i] = i;
+		hash_u64_insertar(hash, (uint64_t)i * 1000003, &valores[i],
+				  NULL);
+	}
+	bool quitados_bien = true, quedan_bien = true;
+	for (int i = 0; i < 2000; i += 2)
+		quitados_bien &= hash_u64_quitar(hash, (uint64_t)i * 1000003) ==
+				 &valores[i];
+	for (int i = 0; i < 2000; i++) {
+		int *valor = hash_u64_obtener(hash, (uint64_t)i * 1000003);
+		quedan_bien &= (i % 2 == 0) ? !valor : valor == &valores[i];
+	}
+	pa2m_afirmar(quitados_bien && quedan_bien &&
+			     hash_u64_cantidad(hash) == 1000,
+		     "Quitar claves enteras no afecta a las demás.");
+	hash_u64_destruir(hash);
+}
+
+bool sumar_clave_u64(uint64_t clave, void *valor, void *suma)
+{
+	*(uint64_t *)suma += clave;
+	return true;
+}
+
+void hash_u64_iterador_interno_recorre_todas_las_claves()
+{
+	hash_u64_t *hash = hash_u64_crear(3);
+	for (uint64_t i = 1; i <= 100; i++)
+		hash_u64_insertar(hash, i, NULL, NULL);
+	uint64_t suma = 0;
+	size_t iteradas = hash_u64_con_cada_clave(hash, sumar_clave_u64, &suma);
+	pa2m_afirmar(iteradas == 100 && suma == 5050,
+		     "El iterador interno recorre todas las claves enteras.");
+	hash_u64_destruir(hash);
+}
+
+bool juntar_clave_u64(uint64_t clave, void *valor, void *claves)
+{
+	uint64_t **siguiente = claves;
+	*(*siguiente)++ = clave;
+	return true;
+}
+
+void hash_u64_actualizar_en_el_umbral_no_agranda()
+{
+	hash_u64_t *hash = hash_u64_crear(0);
+	uint64_t antes[5], despues[5];
+	uint64_t *siguiente = antes;
+	int valor = 1;
+	for (uint64_t i = 1; i <= 5; i++)
+		hash_u64_insertar(hash, i * 7919, NULL, NULL);
+	hash_u64_con_cada_clave(hash, juntar_clave_u64, &siguiente);
+	hash_u64_insertar(hash, 3 * 7919, &valor, NULL);
+	siguiente = despues;
+	hash_u64_con_cada_clave(hash, juntar_clave_u64, &siguiente);
+	pa2m_afirmar(memcmp(antes, despues, sizeof(antes)) == 0 &&
+			     hash_u64_obtener(hash, 3 * 7919) == &valor,
+		     "Actualizar una clave entera con el hash en el umbral no lo agranda.");
+	hash_u64_destruir(hash);
+}
+
+size_t hash_cadena_de_prueba(const char *clave)
+{
+	size_t hash = 5381;
+	while (*clave)
+		hash = hash * 33 + (unsigned char)*clave++;
+	return hash;
+}
+
+bool cadenas_iguales(const char *clave1, const char *clave2)
+{
+	return strcmp(clave1, clave2) == 0;
+}
+
+uint64_t identidad_u64(uint64_t clave)
+{
+	return clave;
+}
+
+bool enteros_iguales(uint64_t clave1, uint64_t clave2)
+{
+	return clave1 == clave2;
+}
+
+typedef struct punto {
+	int x;
+	int y;
+} punto_t;
+
+HASH_DEFINIR(contador_palabras, const char *, int, hash_cadena_de_prueba,
+	     cadenas_iguales)
+HASH_DEFINIR(mapa_puntos, uint64_t, punto_t, identidad_u64, enteros_iguales)
+
+void hash_generico_cuenta_con_valores_en_linea()
+{
+	const char *palabras[] = { "hola", "chau", "hola", "que", "hola",
+				   "chau" };
+	contador_palabras_t *contador = contador_palabras_crear(0);
+	for (int i = 0; i < 6; i++)
+		(*contador_palabras_obtener_o_insertar(contador, palabras[i],
+						       0))++;
+	pa2m_afirmar(*contador_palabras_obtener(contador, "hola") == 3 &&
+			     *contador_palabras_obtener(contador, "chau") == 2 &&
+			     *contador_palabras_obtener(contador, "que") == 1 &&
+			     !contador_palabras_obtener(contador, "nada") &&
+			     contador_palabras_cantidad(contador) == 3,
+		     "Un hash generado por macros guarda los valores en línea.");
+	contador_palabras_destruir(contador);
+}
+
+void hash_generico_con_valores_struct_y_quitar()
+{
+	mapa_puntos_t *mapa = mapa_puntos_crear(2);
+	for (int i = 0; i < 500; i++) {
+		punto_t punto = { .x = i, .y = -i };
+		mapa_puntos_insertar(mapa, (uint64_t)i, punto);
+	}
+	punto_t quitado = { 0 };
+	bool quito = mapa_puntos_quitar(mapa, 250, &quitado);
+	bool quedan_bien = true;
+	for (int i = 0; i < 500; i++) {
+		punto_t *punto = mapa_puntos_obtener(mapa, (uint64_t)i);
+		quedan_bien &= i == 250 ? !punto : punto->y == -i;
+	}
+	pa2m_afirmar(quito && quitado.x == 250 && quedan_bien &&
+			     !mapa_puntos_quitar(mapa, 250, NULL) &&
+			     mapa_puntos_cantidad(mapa) == 499,
+		     "Un hash generado por macros admite structs como valor y quitar.");
+	mapa_puntos_destruir(mapa);
+}
+
+void hash_generico_actualizar_en_el_umbral_no_agranda()
+{
+	mapa_puntos_t *mapa = mapa_puntos_crear(0);
+	size_t capacidad = mapa->capacidad;
+	uint64_t clave = 0;
+	while ((double)(mapa_puntos_cantidad(mapa) + 1) <=
+	       (double)capacidad * HASH_GENERICO_FACTOR_CARGA)
+		mapa_puntos_insertar(mapa, clave++, (punto_t){ 0 });
+	mapa_puntos_insertar(mapa, 0, (punto_t){ .x = 1 });
+	mapa_puntos_obtener_o_insertar(mapa, 1, (punto_t){ 0 })->y = 2;
+	pa2m_afirmar(mapa->capacidad == capacidad &&
+			     mapa_puntos_obtener(mapa, 0)->x == 1 &&
+			     mapa_puntos_obtener(mapa, 1)->y == 2,
+		     "Actualizar una clave del hash generado en el umbral no lo agranda.");
+	mapa_puntos_insertar(mapa, clave, (punto_t){ 0 });
+	pa2m_afirmar(mapa->capacidad == capacidad * 2 &&
+			     mapa_puntos_cantidad(mapa) == clave + 1,
+		     "Insertar una clave nueva en el umbral sí lo agranda.");
+	mapa_puntos_destruir(mapa);
+}
+
+void hash_con_filtro_responde_igual_que_sin_filtro()
+{
+	hash_opciones_t opciones = { .flags = HASH_FILTRO };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[16];
+	int valores[500];
+	for (int i = 0; i < 500; i++) {
+		valores[i] = i;
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(hash, clave, &valores[i], NULL);
+	}
+	for (int i = 0; i < 500; i += 2) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_quitar(hash, clave);
+	}
+	bool respuestas_correctas = true;
+	for (int i = 0; i < 1000; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		void *esperado = (i < 500 && i % 2) ? &valores[i] : NULL;
+		respuestas_correctas &= hash_obtener(hash, clave) == esperado;
+	}
+	pa2m_afirmar(respuestas_correctas && hash_cantidad(hash) == 250,
+		     "Un hash con filtro encuentra sus claves luego de rehash y quitar.");
+	hash_destruir(hash);
+}
+
+void hash_con_filtro_descarta_claves_ausentes()
+{
+	hash_opciones_t opciones = { .flags = HASH_FILTRO };
+	hash_t *hash = hash_crear_con_opciones(1000, &opciones);
+	char clave[16];
+	for (int i = 0; i < 1000; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(hash, clave, NULL, NULL);
+	}
+	hash_estadisticas_filtro_t antes, despues;
+	hash_estadisticas_filtro(hash, &antes);
+	const char *anagramas[] = { "evalc", "lavec", "velac", "calve",
+				    "vecla", "aclev", "elvac", "cvale",
+				    "valce", "lcave" };
+	for (int i = 0; i < 10000; i++) {
+		snprintf(clave, sizeof(clave), "%s%d", anagramas[i / 1000],
+			 i % 1000);
+		hash_contiene(hash, clave);
+	}
+	bool hay_estadisticas = hash_estadisticas_filtro(hash, &despues);
+	size_t descartadas = despues.descartadas - antes.descartadas;
+	pa2m_afirmar(hay_estadisticas &&
+			     despues.consultas - antes.consultas == 10000 &&
+			     descartadas + despues.falsos_positivos -
+					     antes.falsos_positivos ==
+				     10000 &&
+			     descartadas > 9500,
+		     "El filtro descarta casi todas las búsquedas de claves ausentes en posiciones ocupadas.");
+	size_t consultas = despues.consultas;
+	for (int i = 1000; i < 2000; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_contiene(hash, clave);
+	}
+	hash_estadisticas_filtro(hash, &despues);
+	pa2m_afirmar(despues.consultas == consultas,
+		     "Las búsquedas que caen en posiciones vacías no consultan al filtro.");
+	hash_destruir(hash);
+}
+
+void hash_sin_filtro_no_tiene_estadisticas_de_filtro()
+{
+	hash_t *hash = hash_crear(3);
+	hash_estadisticas_filtro_t estadisticas;
+	pa2m_afirmar(!hash_estadisticas_filtro(hash, &estadisticas),
+		     "Un hash sin filtro no devuelve estadísticas de filtro.");
+	hash_destruir(hash);
+}
+
+/**
+ * Escribe en clave la clave número i de un conjunto de claves distintas que
+ * suman lo mismo (y por lo tanto caen en la misma posición de la tabla):
+ * cada par de caracteres es (x, 'a' + 'z' - x).
+*/
+void clave_que_colisiona(char *clave, int i)
+{
+	for (int j = 0; j < 3; j++) {
+		clave[2 * j] = (char)('a' + i % 26);
+		clave[2 * j + 1] = (char)('z' - i % 26);
+		i /= 26;
+	}
+	clave[6] = 0;
+}
+
+void colisiones_pasan_a_un_arbol_y_vuelven_a_lista()
+{
+	hash_t *hash = hash_crear(1000);
+	char clave[8];
+	int valores[100];
+	for (int i = 0; i < 100; i++) {
+		valores[i] = i;
+		clave_que_colisiona(clave, i);
+		hash_insertar(hash, clave, &valores[i], NULL);
+	}
+	int posicion = ('a' + 'z') * 3 % 1000;
+	bool es_arbol = hash->arboles && hash->arboles[posicion] &&
+			lista_vacia(hash->tabla[posicion]);
+	bool encontrados = true;
+	for (int i = 0; i < 100; i++) {
+		clave_que_colisiona(clave, i);
+		encontrados &= hash_obtener(hash, clave) == &valores[i];
+	}
+	pa2m_afirmar(es_arbol && encontrados && hash_cantidad(hash) == 100,
+		     "Una posición con muchas colisiones pasa a ser un árbol.");
+	for (int i = 0; i < 95; i++) {
+		clave_que_colisiona(clave, i);
+		hash_quitar(hash, clave);
+	}
+	clave_que_colisiona(clave, 97);
+	pa2m_afirmar(!hash->arboles[posicion] &&
+			     lista_tamanio(hash->tabla[posicion]) == 5 &&
+			     hash_obtener(hash, clave) == &valores[97],
+		     "Al quitar la mayoría de las claves el árbol vuelve a ser una lista.");
+	hash_destruir(hash);
+}
+
+bool contar_claves(const char *clave, void *valor, void *aux)
+{
+	return true;
+}
+
+void rehash_con_arboles_conserva_todas_las_claves()
+{
+	hash_t *hash = hash_crear(3);
+	char clave[8];
+	int liberados = 0;
+	for (int i = 0; i < 500; i++) {
+		clave_que_colisiona(clave, i);
+		hash_insertar(hash, clave, &liberados, NULL);
+	}
+	for (int i = 0; i < 500; i += 5) {
+		clave_que_colisiona(clave, i);
+		hash_quitar(hash, clave);
+	}
+	bool respuestas_correctas = true;
+	for (int i = 0; i < 500; i++) {
+		clave_que_colisiona(clave, i);
+		respuestas_correctas &= hash_contiene(hash, clave) == (i % 5 != 0);
+	}
+	size_t iteradas = hash_con_cada_clave(hash, contar_claves, NULL);
+	hash_destruir_todo(hash, contar_liberado);
+	pa2m_afirmar(respuestas_correctas && iteradas == 400 && liberados == 400,
+		     "Rehash, iterar y destruir funcionan con posiciones que son árboles.");
+}
+
+void claves_con_caracteres_no_ascii()
+{
+	hash_t *hash = hash_crear(3);
+	int valor = 1;
+	hash_insertar(hash, "\xff\xfe\xfd", &valor, NULL);
+	pa2m_afirmar(hash_obtener(hash, "\xff\xfe\xfd") == &valor &&
+			     hash_quitar(hash, "\xff\xfe\xfd") == &valor,
+		     "Puedo usar claves con caracteres fuera de ASCII.");
+	hash_destruir(hash);
+}
+
+void lista_insertar_y_quitar_en_posiciones_intermedias()
+{
+	lista_t *lista = lista_crear();
+	int numeros[200];
+	for (int i = 0; i < 200; i++)
+		numeros[i] = i;
+	for (int i = 0; i < 100; i++)
+		lista_insertar(lista, &numeros[2 * i]);
+	for (int i = 0; i < 100; i++)
+		lista_insertar_en_posicion(lista, &numeros[2 * i + 1], 2 * i + 1);
+	bool en_orden = lista_tamanio(lista) == 200;
+	for (int i = 0; i < 200; i++)
+		en_orden &= lista_elemento_en_posicion(lista, (size_t)i) ==
+			    &numeros[i];
+	pa2m_afirmar(en_orden,
+		     "Insertar en posiciones intermedias mantiene el orden.");
+	for (int i = 0; i < 100; i++)
+		lista_quitar_de_posicion(lista, (size_t)i);
+	bool quedan_impares = lista_tamanio(lista) == 100 &&
+			      lista_ultimo(lista) == &numeros[199];
+	lista_iterador_t *iterador = lista_iterador_crear(lista);
+	for (int i = 0; i < 100; i++) {
+		quedan_impares &= lista_iterador_elemento_actual(iterador) ==
+				  &numeros[2 * i + 1];
+		lista_iterador_avanzar(iterador);
+	}
+	quedan_impares &= !lista_iterador_tiene_siguiente(iterador);
+	lista_iterador_destruir(iterador);
+	pa2m_afirmar(quedan_impares,
+		     "Quitar de posiciones intermedias deja los elementos restantes en orden.");
+	while (!lista_vacia(lista))
+		lista_quitar(lista);
+	pa2m_afirmar(!lista_primero(lista) && !lista_ultimo(lista) &&
+			     lista_insertar(lista, &numeros[7]) &&
+			     lista_primero(lista) == &numeros[7] &&
+			     lista_ultimo(lista) == &numeros[7],
+		     "Una lista vaciada se puede volver a usar.");
+	lista_destruir(lista);
+}
+
+void lista_quitar_nodos_por_referencia()
+{
+	lista_t *lista = lista_crear();
+	int numeros[5] = { 0, 1, 2, 3, 4 };
+	lista_nodo_t *nodos[5];
+	for (int i = 0; i < 5; i++)
+		nodos[i] = lista_insertar_nodo(lista, &numeros[i]);
+	bool quitados = lista_nodo_elemento(nodos[2]) == &numeros[2] &&
+			lista_quitar_nodo(lista, nodos[2]) == &numeros[2] &&
+			lista_quitar_nodo(lista, nodos[0]) == &numeros[0] &&
+			lista_quitar_nodo(lista, nodos[4]) == &numeros[4];
+	pa2m_afirmar(quitados && lista_tamanio(lista) == 2 &&
+			     lista_primero(lista) == &numeros[1] &&
+			     lista_ultimo(lista) == &numeros[3],
+		     "Puedo quitar elementos a partir del nodo devuelto al insertarlos.");
+	lista_insertar(lista, &numeros[0]);
+	pa2m_afirmar(lista_ultimo(lista) == &numeros[0] &&
+			     lista_elemento_en_posicion(lista, 1) == &numeros[3],
+		     "Luego de quitar el último nodo se puede seguir insertando al final.");
+	lista_destruir(lista);
+}
+
+int comparar_con_entero(void *elemento, void *numero)
+{
+	return *(int *)elemento - *(int *)numero;
+}
+
+void lista_quitar_elemento_que_cumple_la_condicion()
+{
+	lista_t *lista = lista_crear();
+	int numeros[4] = { 5, 6, 7, 6 };
+	for (int i = 0; i < 4; i++)
+		lista_insertar(lista, &numeros[i]);
+	int buscado = 6, inexistente = 9;
+	pa2m_afirmar(lista_quitar_elemento(lista, comparar_con_entero,
+					   &buscado) == &numeros[1] &&
+			     !lista_quitar_elemento(lista, comparar_con_entero,
+						    &inexistente) &&
+			     lista_tamanio(lista) == 3 &&
+			     lista_elemento_en_posicion(lista, 1) == &numeros[2],
+		     "lista_quitar_elemento quita solo el primer elemento que cumple la condición.");
+	lista_destruir(lista);
+}
+
+bool es_par(void *elemento, void *aux)
+{
+	return *(int *)elemento % 2 == 0;
+}
+
+void lista_quitar_si_quita_todos_los_que_cumplen()
+{
+	lista_t *lista = lista_crear();
+	int numeros[40];
+	for (int i = 0; i < 40; i++) {
+		numeros[i] = i < 20 ? 2 * i : i;
+		lista_insertar(lista, &numeros[i]);
+	}
+	pa2m_afirmar(lista_quitar_si(lista, es_par, NULL) == 30 &&
+			     lista_tamanio(lista) == 10 &&
+			     lista_primero(lista) == &numeros[21] &&
+			     lista_ultimo(lista) == &numeros[39] &&
+			     lista_elemento_en_posicion(lista, 1) == &numeros[23],
+		     "lista_quitar_si quita todos los elementos que cumplen la condición, en orden.");
+	lista_insertar(lista, &numeros[0]);
+	pa2m_afirmar(lista_quitar_si(lista, es_par, NULL) == 1 &&
+			     lista_ultimo(lista) == &numeros[39] &&
+			     lista_quitar_si(lista, es_par, NULL) == 0,
+		     "Después de lista_quitar_si se puede seguir insertando al final.");
+	lista_destruir(lista);
+}
+
+bool elementos_en_orden(lista_t *lista, int *numeros, size_t cantidad)
+{
+	if (lista_tamanio(lista) != cantidad)
+		return false;
+	for (size_t i = 0; i < cantidad; i++)
+		if (lista_elemento_en_posicion(lista, i) != &numeros[i])
+			return false;
+	return cantidad == 0 || lista_ultimo(lista) == &numeros[cantidad - 1];
+}
+
+void lista_insertar_lote_agrega_todos_en_orden()
+{
+	int numeros[40];
+	void *elementos[40];
+	for (int i = 0; i < 40; i++)
+		elementos[i] = &numeros[i];
+	lista_t *lista = lista_crear();
+	bool insertados = lista_insertar_lote(lista, elementos, 30) &&
+			  lista_insertar(lista, &numeros[30]) &&
+			  lista_insertar_lote(lista, elementos + 31, 9);
+	pa2m_afirmar(insertados && elementos_en_orden(lista, numeros, 40),
+		     "lista_insertar_lote agrega todos los elementos al final y en orden.");
+	lista_quitar_de_posicion(lista, 0);
+	lista_quitar(lista);
+	pa2m_afirmar(lista_tamanio(lista) == 38 &&
+			     lista_primero(lista) == &numeros[1] &&
+			     lista_ultimo(lista) == &numeros[38],
+		     "Los elementos insertados en lote se pueden quitar normalmente.");
+	lista_destruir(lista);
+}
+
+void lista_concatenar_mueve_los_elementos_de_origen()
+{
+	int numeros[40];
+	void *elementos[40];
+	for (int i = 0; i < 40; i++)
+		elementos[i] = &numeros[i];
+	lista_t *destino = lista_crear();
+	lista_t *origen = lista_crear();
+	lista_insertar_lote(destino, elementos, 10);
+	for (int i = 10; i < 20; i++)
+		lista_insertar(origen, &numeros[i]);
+	bool concatenada = lista_concatenar(destino, origen) == destino;
+	pa2m_afirmar(concatenada && elementos_en_orden(destino, numeros, 20) &&
+			     lista_vacia(origen),
+		     "lista_concatenar mueve todos los elementos de origen al final de destino.");
+	pool_t *pool = lista_crear_pool_de_nodos();
+	lista_t *con_pool = lista_crear_con_pool(pool);
+	lista_insertar_lote(con_pool, elementos + 20, 20);
+	concatenada = lista_concatenar(destino, con_pool) == destino &&
+		      lista_concatenar(destino, origen) == destino;
+	lista_insertar(origen, &numeros[0]);
+	pa2m_afirmar(concatenada && elementos_en_orden(destino, numeros, 40) &&
+			     lista_vacia(con_pool) &&
+			     lista_ultimo(origen) == &numeros[0],
+		     "Se pueden concatenar listas con distinto pool o vacías, y seguir usando origen.");
+	lista_destruir(con_pool);
+	pool_destruir(pool);
+	lista_destruir(origen);
+	lista_destruir(destino);
+}
+
+void lista_concatenar_listas_cargadas_en_lote_no_copia_los_nodos()
+{
+	int numeros[60];
+	void *elementos[60];
+	for (int i = 0; i < 60; i++)
+		elementos[i] = &numeros[i];
+	memoria_t *memoria = memoria_crear(NULL, 0);
+	lista_t *destino = lista_crear_con_memoria(NULL, memoria);
+	lista_t *origen = lista_crear_con_memoria(NULL, memoria);
+	lista_t *vacia = lista_crear_con_memoria(NULL, memoria);
+	lista_insertar_lote(destino, elementos, 20);
+	lista_insertar_lote(origen, elementos + 20, 20);
+	size_t usada = memoria_usada(memoria);
+	bool concatenada = lista_concatenar(destino, origen) == destino;
+	pa2m_afirmar(concatenada && elementos_en_orden(destino, numeros, 40) &&
+			     lista_vacia(origen) &&
+			     memoria_usada(memoria) < usada,
+		     "Concatenar dos listas cargadas en lote engancha los nodos sin reservar nuevos.");
+	lista_insertar_lote(origen, elementos + 40, 20);
+	usada = memoria_usada(memoria);
+	concatenada = lista_concatenar(vacia, destino) == vacia &&
+		      memoria_usada(memoria) == usada &&
+		      lista_concatenar(vacia, origen) == vacia;
+	pa2m_afirmar(concatenada && elementos_en_orden(vacia, numeros, 60) &&
+			     memoria_usada(memoria) < usada,
+		     "Una lista vacía y sin pool adopta el pool propio de la que concatena.");
+	lista_destruir(destino);
+	lista_destruir(origen);
+	pa2m_afirmar(lista_tamanio(vacia) == 60 &&
+			     lista_elemento_en_posicion(vacia, 59) == &numeros[59],
+		     "Destruir las listas concatenadas no libera los nodos que pasaron a destino.");
+	lista_destruir(vacia);
+	pa2m_afirmar(memoria_usada(memoria) == 0,
+		     "Al destruir todas las listas se libera toda la memoria de sus pools.");
+	memoria_destruir(memoria);
+}
+
+void pool_reutiliza_los_objetos_liberados()
+{
+	pool_t *pool = pool_crear(sizeof(int));
+	void *objetos[1000];
+	for (int i = 0; i < 1000; i++)
+		objetos[i] = pool_reservar(pool);
+	size_t bloques = pool_cantidad_bloques(pool);
+	pool_liberar(pool, objetos[500]);
+	bool reutiliza = pool_reservar(pool) == objetos[500];
+	for (int i = 0; i < 1000; i++)
+		pool_liberar(pool, objetos[i]);
+	for (int i = 0; i < 1000; i++)
+		pool_reservar(pool);
+	pa2m_afirmar(bloques > 0 && bloques < 10 && reutiliza &&
+			     pool_cantidad_bloques(pool) == bloques,
+		     "El pool reserva de a bloques y reutiliza los objetos liberados.");
+	pool_destruir(pool);
+}
+
+void pool_preparar_reserva_solo_los_objetos_que_faltan()
+{
+	pool_t *pool = pool_crear(sizeof(int));
+	pool_reservar(pool);
+	bool preparado = pool_preparar(pool, 100);
+	size_t bloques = pool_cantidad_bloques(pool);
+	for (int i = 0; i < 100; i++)
+		pool_reservar(pool);
+	bool sin_bloques_nuevos = pool_cantidad_bloques(pool) == bloques;
+	pool_reservar(pool);
+	pa2m_afirmar(preparado && bloques == 2 && sin_bloques_nuevos &&
+			     pool_cantidad_bloques(pool) == bloques + 1,
+		     "pool_preparar cuenta los objetos sin usar y reserva solo los que faltan.");
+	pool_destruir(pool);
+}
+
+void hash_con_pool_de_nodos_funciona_igual()
+{
+	hash_opciones_t opciones = { .flags = HASH_POOL_NODOS };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[16];
+	int valores[300];
+	for (int ronda = 0; ronda < 3; ronda++) {
+		for (int i = 0; i < 300; i++) {
+			valores[i] = i;
+			snprintf(clave, sizeof(clave), "clave%d", i);
+			hash_insertar(hash, clave, &valores[i], NULL);
+		}
+		for (int i = 0; i < 300; i += 3) {
+			snprintf(clave, sizeof(clave), "clave%d", i);
+			hash_quitar(hash, clave);
+		}
+	}
+	bool respuestas_correctas = true;
+	for (int i = 0; i < 300; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		respuestas_correctas &= hash_obtener(hash, clave) ==
+					(i % 3 ? &valores[i] : NULL);
+	}
+	pa2m_afirmar(respuestas_correctas && hash_cantidad(hash) == 200,
+		     "Un hash con pool de nodos inserta, quita y hace rehash correctamente.");
+	hash_destruir(hash);
+}
+
+void hash_compacto_inserta_reemplaza_y_quita()
+{
+	hash_opciones_t opciones = { .flags = HASH_COMPACTO };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[16];
+	int valores[500];
+	void *anterior = &valores[0];
+	bool insertados = true;
+	for (int i = 0; i < 500; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		insertados &= hash_insertar(hash, clave, &valores[i],
+					    &anterior) == hash &&
+			      anterior == NULL;
+	}
+	for (int i = 0; i < 500; i += 2) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		insertados &= hash_quitar(hash, clave) == &valores[i];
+	}
+	hash_insertar(hash, "clave1", &valores[0], &anterior);
+	bool respuestas_correctas = anterior == &valores[1] &&
+				    hash_obtener(hash, "clave1") == &valores[0];
+	for (int i = 2; i < 500; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		respuestas_correctas &=
+			hash_obtener(hash, clave) ==
+				(i % 2 ? &valores[i] : NULL) &&
+			hash_contiene(hash, clave) == (i % 2 == 1);
+	}
+	pa2m_afirmar(insertados && respuestas_correctas &&
+			     hash_cantidad(hash) == 250,
+		     "Un hash compacto inserta, reemplaza, busca y quita correctamente.");
+	hash_destruir(hash);
+}
+
+bool anotar_numero_de_clave(const char *clave, void *valor, void *numeros)
+{
+	int *lista_numeros = numeros;
+	lista_numeros[++lista_numeros[0]] = atoi(clave + strlen("clave"));
+	return true;
+}
+
+void hash_compacto_recorre_en_orden_de_insercion()
+{
+	hash_opciones_t opciones = { .flags = HASH_COMPACTO };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[16];
+	for (int i = 99; i >= 0; i--) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(hash, clave, NULL, NULL);
+	}
+	for (int i = 0; i < 100; i += 3) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_quitar(hash, clave);
+	}
+	hash_insertar(hash, "clave0", NULL, NULL);
+	int numeros[101] = { 0 };
+	size_t iteradas =
+		hash_con_cada_clave(hash, anotar_numero_de_clave, numeros);
+	bool en_orden = numeros[numeros[0]] == 0;
+	for (int i = 2; i < numeros[0]; i++)
+		en_orden &= numeros[i] < numeros[i - 1] && numeros[i] % 3 != 0;
+	pa2m_afirmar(iteradas == 67 && numeros[0] == 67 && en_orden,
+		     "Un hash compacto recorre las claves en el orden en que se insertaron.");
+	pa2m_afirmar(!hash_insertar_con_ttl(hash, "clave1", NULL, 10, NULL),
+		     "Un hash compacto no admite vencimientos.");
+	hash_destruir(hash);
+	opciones.flags = HASH_COMPACTO | HASH_FILTRO;
+	pa2m_afirmar(!hash_crear_con_opciones(3, &opciones),
+		     "No se puede crear un hash compacto con filtro.");
+}
+
+bool contar_claves_iteradas(const char *clave, void *valor, void *contador)
+{
+	(*(size_t *)contador)++;
+	return true;
+}
+
+void hash_cuckoo_inserta_reemplaza_y_quita()
+{
+	hash_opciones_t opciones = { .flags = HASH_CUCKOO };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[16];
+	int valores[3000];
+	bool insertados = true;
+	for (int i = 0; i < 3000; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		insertados &= hash_insertar(hash, clave, &valores[i], NULL) ==
+			      hash;
+	}
+	for (int i = 0; i < 3000; i += 2) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		insertados &= hash_quitar(hash, clave) == &valores[i];
+	}
+	void *anterior = NULL;
+	hash_insertar(hash, "clave1", &valores[0], &anterior);
+	bool respuestas_correctas = anterior == &valores[1] &&
+				    hash_obtener(hash, "clave1") == &valores[0];
+	for (int i = 2; i < 3000; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		respuestas_correctas &=
+			hash_obtener(hash, clave) ==
+				(i % 2 ? &valores[i] : NULL) &&
+			hash_contiene(hash, clave) == (i % 2 == 1);
+	}
+	size_t iteradas = 0;
+	hash_con_cada_clave(hash, contar_claves_iteradas, &iteradas);
+	pa2m_afirmar(insertados && respuestas_correctas &&
+			     hash_cantidad(hash) == 1500 && iteradas == 1500,
+		     "Un hash cuckoo inserta, reemplaza, busca y quita correctamente.");
+	hash_destruir(hash);
+}
+
+void tabla_cuckoo_admite_factor_de_carga_alto()
+{
+	tabla_cuckoo_t *tabla = tabla_cuckoo_crear(4096, NULL);
+	char claves[3850][16];
+	bool encontradas = true;
+	for (int i = 0; i < 3850; i++) {
+		snprintf(claves[i], sizeof(claves[i]), "clave%d", i);
+		tabla_cuckoo_agregar(tabla, claves[i], claves[i]);
+	}
+	for (int i = 0; i < 3850; i++) {
+		void **valor = tabla_cuckoo_buscar(tabla, claves[i]);
+		encontradas &= valor && *valor == claves[i];
+	}
+	pa2m_afirmar(encontradas &&
+			     tabla_cuckoo_factor_de_carga(tabla) > 0.93,
+		     "La tabla cuckoo se llena a más del 93% sin agrandarse y encuentra todas las claves.");
+	tabla_cuckoo_destruir(tabla);
+}
+
+bool anotar_clave_cuckoo(char *clave, void *valor, void *aux)
+{
+	char **claves = aux;
+	while (*claves)
+		claves++;
+	*claves = clave;
+	return true;
+}
+
+void tabla_cuckoo_devuelve_el_deposito_a_los_baldes_al_quitar()
+{
+	tabla_cuckoo_t *tabla = tabla_cuckoo_crear(8, NULL);
+	char claves[16][16];
+	int agregadas = 0;
+	while (!tabla_cuckoo_en_deposito(tabla) && agregadas < 16) {
+		snprintf(claves[agregadas], sizeof(claves[agregadas]),
+			 "clave%d", agregadas);
+		tabla_cuckoo_agregar(tabla, claves[agregadas],
+				     claves[agregadas]);
+		agregadas++;
+	}
+	pa2m_afirmar(tabla_cuckoo_en_deposito(tabla) == 1,
+		     "Si los baldes de una clave no tienen lugar, la clave va al depósito.");
+	char *en_orden[17] = { 0 };
+	tabla_cuckoo_con_cada_entrada(tabla, anotar_clave_cuckoo, en_orden);
+	char *quitada;
+	void *valor;
+	bool quitadas = true;
+	for (int i = 0; i < agregadas - 1; i++)
+		quitadas &= tabla_cuckoo_quitar(tabla, en_orden[i], &quitada,
+						&valor);
+	void **en_deposito = tabla_cuckoo_buscar(tabla, en_orden[agregadas - 1]);
+	pa2m_afirmar(quitadas && !tabla_cuckoo_en_deposito(tabla) &&
+			     en_deposito &&
+			     *en_deposito == en_orden[agregadas - 1],
+		     "Al quitar claves de los baldes, la clave del depósito vuelve a un balde.");
+	tabla_cuckoo_destruir(tabla);
+}
+
+void insertar_claves_numeradas(hash_t *hash, int desde, int hasta)
+{
+	char clave[24];
+	for (int i = desde; i < hasta; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(hash, clave, NULL, NULL);
+	}
+}
+
+void quitar_claves_numeradas(hash_t *hash, int desde, int hasta)
+{
+	char clave[24];
+	for (int i = desde; i < hasta; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_quitar(hash, clave);
+	}
+}
+
+bool contiene_claves_numeradas(hash_t *hash, int desde, int hasta)
+{
+	char clave[24];
+	bool contiene = true;
+	for (int i = desde; i < hasta; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		contiene &= hash_contiene(hash, clave);
+	}
+	return contiene;
+}
+
+void hash_se_achica_al_quitar_casi_todos_los_elementos()
+{
+	hash_t *hash = hash_crear(3);
+	insertar_claves_numeradas(hash, 0, 1000);
+	size_t capacidad_llena = hash->capacidad;
+	quitar_claves_numeradas(hash, 10, 1000);
+	size_t iteradas = 0;
+	hash_con_cada_clave(hash, contar_claves_iteradas, &iteradas);
+	pa2m_afirmar(capacidad_llena > 1000 && hash->capacidad < 200 &&
+			     hash_cantidad(hash) == 10 && iteradas == 10 &&
+			     contiene_claves_numeradas(hash, 0, 10),
+		     "Al quitar casi todos los elementos el hash se achica y conserva los restantes.");
+	hash_destruir(hash);
+}
+
+void hash_reservar_evita_el_rehash_y_el_achique()
+{
+	hash_t *hash = hash_crear(3);
+	bool reservado = hash_reservar(hash, 1000);
+	size_t capacidad_reservada = hash->capacidad;
+	insertar_claves_numeradas(hash, 0, 1000);
+	bool sin_rehash = hash->capacidad == capacidad_reservada;
+	quitar_claves_numeradas(hash, 0, 1000);
+	pa2m_afirmar(reservado && capacidad_reservada >= 1000 / 0.7 &&
+			     sin_rehash &&
+			     hash->capacidad == capacidad_reservada,
+		     "hash_reservar agranda el hash una sola vez y el hash no se achica por debajo.");
+	insertar_claves_numeradas(hash, 0, 5);
+	pa2m_afirmar(hash_compactar(hash) && hash->capacidad < 10 &&
+			     contiene_claves_numeradas(hash, 0, 5),
+		     "hash_compactar achica el hash a lo justo para sus elementos.");
+	hash_destruir(hash);
+}
+
+void hash_con_factores_de_carga_propios()
+{
+	hash_opciones_t opciones = { .factor_carga_maximo = 2,
+				     .factor_crecimiento = 4 };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	insertar_claves_numeradas(hash, 0, 7);
+	size_t capacidad_con_7 = hash->capacidad;
+	insertar_claves_numeradas(hash, 7, 8);
+	pa2m_afirmar(capacidad_con_7 == 3 && hash->capacidad == 12 &&
+			     contiene_claves_numeradas(hash, 0, 8),
+		     "El hash respeta su factor de carga máximo y su factor de crecimiento.");
+	hash_destruir(hash);
+
+	hash_opciones_t sin_crecimiento = { .factor_crecimiento = 1 };
+	hash_opciones_t achique_inestable = { .factor_carga_minimo = 0.5 };
+	pa2m_afirmar(!hash_crear_con_opciones(3, &sin_crecimiento) &&
+			     !hash_crear_con_opciones(3, &achique_inestable),
+		     "No se puede crear un hash con factores de carga o de crecimiento inválidos.");
+}
+
+void hash_sin_listas_reserva_y_compacta()
+{
+	bool correctos = true;
+	unsigned int flags[] = { HASH_COMPACTO, HASH_CUCKOO };
+	for (int i = 0; i < 2; i++) {
+		hash_opciones_t opciones = { .flags = flags[i] };
+		hash_t *hash = hash_crear_con_opciones(3, &opciones);
+		correctos &= hash_reservar(hash, 2000);
+		insertar_claves_numeradas(hash, 0, 2000);
+		quitar_claves_numeradas(hash, 20, 2000);
+		correctos &= hash_compactar(hash) &&
+			     hash_cantidad(hash) == 20 &&
+			     contiene_claves_numeradas(hash, 0, 20);
+		hash_destruir(hash);
+	}
+	pa2m_afirmar(correctos,
+		     "Los hash compacto y cuckoo también se pueden reservar y compactar.");
+}
+
+size_t posiciones_distintas(hash_t *hash, hash_t *clon)
+{
+	size_t distintas = 0;
+	for (size_t i = 0; i < hash->capacidad; i++)
+		if (hash->tabla[i] != clon->tabla[i])
+			distintas++;
+	return distintas;
+}
+
+void hash_clonar_comparte_la_tabla_hasta_modificarla()
+{
+	hash_opciones_t opciones = { .flags = HASH_FILTRO };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	insertar_claves_numeradas(hash, 0, 1000);
+	hash_t *clon = hash_clonar(hash);
+	bool comparten = clon && clon->tabla == hash->tabla;
+	hash_insertar(hash, "clave nueva", NULL, NULL);
+	pa2m_afirmar(comparten && clon->tabla != hash->tabla &&
+			     posiciones_distintas(hash, clon) == 1,
+		     "El clon comparte la tabla y al modificar el original solo se copia una posición.");
+	int valor = 1;
+	quitar_claves_numeradas(hash, 0, 100);
+	hash_insertar(hash, "clave500", &valor, NULL);
+	size_t iteradas = 0;
+	hash_con_cada_clave(clon, contar_claves_iteradas, &iteradas);
+	pa2m_afirmar(hash_cantidad(clon) == 1000 && iteradas == 1000 &&
+			     contiene_claves_numeradas(clon, 0, 1000) &&
+			     !hash_contiene(clon, "clave nueva") &&
+			     hash_obtener(clon, "clave500") == NULL,
+		     "El clon no ve los cambios que se hacen en el original.");
+	pa2m_afirmar(hash_cantidad(hash) == 901 &&
+			     !hash_contiene(hash, "clave50") &&
+			     hash_obtener(hash, "clave500") == &valor &&
+			     hash_contiene(hash, "clave nueva"),
+		     "El original ve sus propios cambios.");
+	hash_destruir(hash);
+	pa2m_afirmar(contiene_claves_numeradas(clon, 0, 1000),
+		     "El clon sigue siendo válido después de destruir el original.");
+	hash_destruir(clon);
+}
+
+void hash_clonar_permite_modificar_el_clon()
+{
+	hash_t *hash = hash_crear(3);
+	insertar_claves_numeradas(hash, 0, 500);
+	hash_t *clon = hash_clonar(hash);
+	hash_t *clon_del_clon = hash_clonar(clon);
+	quitar_claves_numeradas(clon, 0, 250);
+	insertar_claves_numeradas(clon_del_clon, 500, 600);
+	pa2m_afirmar(hash_cantidad(hash) == 500 &&
+			     contiene_claves_numeradas(hash, 0, 500) &&
+			     hash_cantidad(clon) == 250 &&
+			     contiene_claves_numeradas(clon, 250, 500) &&
+			     hash_cantidad(clon_del_clon) == 600 &&
+			     contiene_claves_numeradas(clon_del_clon, 0, 600),
+		     "Se puede modificar un clon, y clonar un clon, sin afectar a los demás.");
+	hash_destruir(clon);
+	hash_destruir(clon_del_clon);
+	hash_destruir(hash);
+
+	hash_opciones_t opciones = { .flags = HASH_COMPACTO };
+	hash = hash_crear_con_opciones(3, &opciones);
+	pa2m_afirmar(hash_clonar(hash) == NULL,
+		     "No se puede clonar un hash compacto.");
+	hash_destruir(hash);
+}
+
+typedef struct contador_de_reservas {
+	size_t reservas;
+	size_t liberaciones;
+} contador_de_reservas_t;
+
+void *reservar_contando(void *contador, size_t tamanio)
+{
+	((contador_de_reservas_t *)contador)->reservas++;
+	return malloc(tamanio);
+}
+
+void *redimensionar_contando(void *contador, void *puntero, size_t tamanio)
+{
+	if (!puntero)
+		((contador_de_reservas_t *)contador)->reservas++;
+	return realloc(puntero, tamanio);
+}
+
+void liberar_contando(void *contador, void *puntero)
+{
+	if (puntero)
+		((contador_de_reservas_t *)contador)->liberaciones++;
+	free(puntero);
+}
+
+void hash_con_alocador_reserva_y_libera_todo_con_el()
+{
+	contador_de_reservas_t contador = { 0 };
+	alocador_t alocador = { .reservar = reservar_contando,
+				.redimensionar = redimensionar_contando,
+				.liberar = liberar_contando,
+				.contexto = &contador };
+	hash_opciones_t opciones = { .flags = HASH_FILTRO,
+				     .alocador = &alocador };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[16];
+	for (int i = 0; i < 200; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		if (i % 2)
+			hash_insertar_con_ttl(hash, clave, NULL, 1000, NULL);
+		else
+			hash_insertar(hash, clave, NULL, NULL);
+	}
+	for (int i = 0; i < 200; i += 3) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_quitar(hash, clave);
+	}
+	size_t usada = hash_memoria_usada(hash);
+	size_t reservas = contador.reservas;
+	hash_destruir(hash);
+	pa2m_afirmar(reservas > 400 && usada > 0,
+		     "Un hash con alocador reserva con sus funciones y cuenta la memoria usada.");
+	pa2m_afirmar(contador.reservas == contador.liberaciones,
+		     "Al destruirlo libera con el alocador todo lo que reservó.");
+}
+
+/**
+ * Crea un hash de 1000 posiciones que reserva con reservar_contando.
+*/
+hash_t *hash_contando_reservas(contador_de_reservas_t *contador,
+			       alocador_t *alocador)
+{
+	*alocador = (alocador_t){ .reservar = reservar_contando,
+				  .redimensionar = redimensionar_contando,
+				  .liberar = liberar_contando,
+				  .contexto = contador };
+	hash_opciones_t opciones = { .alocador = alocador };
+	return hash_crear_con_opciones(1000, &opciones);
+}
+
+bool insertar_en_aux(const char *clave, void *valor, void *aux)
+{
+	return hash_insertar(aux, clave, valor, NULL) != NULL;
+}
+
+void hash_fusionar_con_alocador_usa_el_alocador_para_el_arreglo_temporal()
+{
+	contador_de_reservas_t contador = { 0 }, contador_gemelo = { 0 };
+	alocador_t alocador, alocador_gemelo;
+	hash_t *hash = hash_contando_reservas(&contador, &alocador);
+	hash_t *gemelo = hash_contando_reservas(&contador_gemelo,
+						&alocador_gemelo);
+	hash_t *otro = hash_crear(3);
+	char clave[16];
+	for (int i = 0; i < 100; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(otro, clave, NULL, NULL);
+	}
+	hash_con_cada_clave(otro, insertar_en_aux, gemelo);
+	pa2m_afirmar(hash_fusionar(hash, otro, NULL, NULL) == hash &&
+			     hash_cantidad(hash) == 100 && !hash_cantidad(otro),
+		     "Se puede fusionar en un hash con alocador.");
+	pa2m_afirmar(contador.reservas == contador_gemelo.reservas + 1 &&
+			     contador.liberaciones ==
+				     contador_gemelo.liberaciones + 1,
+		     "La fusión reserva y libera su arreglo temporal con el alocador del hash.");
+	hash_destruir(otro);
+	hash_destruir(gemelo);
+	hash_destruir(hash);
+	pa2m_afirmar(contador.reservas == contador.liberaciones,
+		     "Al destruirlo libera con el alocador todo lo que reservó.");
+}
+
+bool clave_multiplo_de_diez(const char *clave, void *valor, void *aux)
+{
+	return atoi(clave + strlen("clave")) % 10 == 0;
+}
+
+void hash_quitar_si_con_alocador_usa_el_alocador_para_el_arreglo_temporal()
+{
+	contador_de_reservas_t contador = { 0 }, contador_gemelo = { 0 };
+	alocador_t alocador, alocador_gemelo;
+	hash_t *hash = hash_contando_reservas(&contador, &alocador);
+	hash_t *gemelo = hash_contando_reservas(&contador_gemelo,
+						&alocador_gemelo);
+	char clave[16];
+	for (int i = 0; i < 500; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(hash, clave, NULL, NULL);
+		hash_insertar(gemelo, clave, NULL, NULL);
+	}
+	for (int i = 0; i < 500; i += 10) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_quitar(gemelo, clave);
+	}
+	pa2m_afirmar(hash_quitar_si(hash, clave_multiplo_de_diez, NULL,
+				    NULL) == 50 &&
+			     hash_cantidad(hash) == hash_cantidad(gemelo),
+		     "Se puede usar hash_quitar_si en un hash con alocador.");
+	pa2m_afirmar(contador.reservas == contador_gemelo.reservas + 1 &&
+			     contador.liberaciones ==
+				     contador_gemelo.liberaciones + 1,
+		     "hash_quitar_si reserva y libera su arreglo temporal con el alocador del hash.");
+	hash_destruir(gemelo);
+	hash_destruir(hash);
+	pa2m_afirmar(contador.reservas == contador.liberaciones,
+		     "Al destruirlo libera con el alocador todo lo que reservó.");
+}
+
+void hash_con_limite_de_memoria_falla_sin_modificarse()
+{
+	hash_opciones_t opciones = { .limite_memoria = 8192 };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[16];
+	int insertadas = 0;
+	size_t usada_antes_del_fallo = 0;
+	while (true) {
+		usada_antes_del_fallo = hash_memoria_usada(hash);
+		snprintf(clave, sizeof(clave), "clave%d", insertadas);
+		if (!hash_insertar(hash, clave, NULL, NULL))
+			break;
+		insertadas++;
+	}
+	pa2m_afirmar(insertadas > 0 && hash_cantidad(hash) == insertadas &&
+			     !hash_contiene(hash, clave) &&
+			     hash_memoria_usada(hash) == usada_antes_del_fallo &&
+			     usada_antes_del_fallo <= 8192,
+		     "Insertar más allá del límite de memoria falla sin modificar el hash.");
+	for (int i = 0; i < insertadas; i += 2) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_quitar(hash, clave);
+	}
+	pa2m_afirmar(hash_memoria_usada(hash) < usada_antes_del_fallo &&
+			     hash_insertar(hash, "otra clave", NULL, NULL),
+		     "Quitar elementos libera memoria y permite volver a insertar.");
+	hash_destruir(hash);
+}
+
+void hash_sin_alocador_ni_limite_no_cuenta_memoria()
+{
+	hash_t *hash = hash_crear(3);
+	hash_insertar(hash, "clave", NULL, NULL);
+	pa2m_afirmar(hash_memoria_usada(hash) == 0,
+		     "Un hash sin alocador ni límite no cuenta su memoria.");
+	hash_destruir(hash);
+}
+
+#define RUTA_DURABLE "prueba_hash_durable"
+
+void borrar_hash_durable()
+{
+	unlink(RUTA_DURABLE ".registro");
+	unlink(RUTA_DURABLE ".instantanea");
+}
+
+bool valor_durable_es(hash_durable_t *hash, const char *clave,
+		      const char *esperado)
+{
+	size_t tamanio = 0;
+	const char *valor = hash_durable_obtener(hash, clave, &tamanio);
+	return valor && tamanio == strlen(esperado) + 1 &&
+	       strcmp(valor, esperado) == 0;
+}
+
+void hash_durable_recupera_las_operaciones_del_registro()
+{
+	borrar_hash_durable();
+	hash_durable_t *hash = hash_durable_abrir(RUTA_DURABLE, NULL);
+	hash_durable_insertar(hash, "a", "uno", 4);
+	hash_durable_insertar(hash, "b", "dos", 4);
+	hash_durable_insertar(hash, "c", "tres", 5);
+	hash_durable_insertar(hash, "a", "otro uno", 9);
+	hash_durable_quitar(hash, "b");
+	pa2m_afirmar(hash_durable_cerrar(hash),
+		     "Se puede cerrar un hash durable con operaciones.");
+
+	hash = hash_durable_abrir(RUTA_DURABLE, NULL);
+	pa2m_afirmar(hash_durable_cantidad(hash) == 2,
+		     "Al reabrirlo tiene las claves que quedaron.");
+	pa2m_afirmar(valor_durable_es(hash, "a", "otro uno") &&
+			     valor_durable_es(hash, "c", "tres"),
+		     "Los valores son los últimos que se insertaron.");
+	pa2m_afirmar(!hash_durable_obtener(hash, "b", NULL) &&
+			     !hash_durable_quitar(hash, "b"),
+		     "La clave quitada sigue sin estar.");
+	hash_durable_cerrar(hash);
+	borrar_hash_durable();
+}
+
+void hash_durable_compacta_el_registro_en_una_instantanea()
+{
+	borrar_hash_durable();
+	hash_durable_opciones_t opciones = { .operaciones_por_sincronizacion = 1,
+					     .bytes_para_compactar = 1024 };
+	hash_durable_t *hash = hash_durable_abrir(RUTA_DURABLE, &opciones);
+	char clave[24];
+	for (int i = 0; i < 200; i++) {
+		snprintf(clave, sizeof(clave), "clave%i", i);
+		hash_durable_insertar(hash, clave, &i, sizeof(i));
+	}
+	for (int i = 0; i < 200; i += 2) {
+		snprintf(clave, sizeof(clave), "clave%i", i);
+		hash_durable_quitar(hash, clave);
+	}
+	FILE *registro = fopen(RUTA_DURABLE ".registro", "r");
+	fseek(registro, 0, SEEK_END);
+	long largo_registro = ftell(registro);
+	fclose(registro);
+	pa2m_afirmar(access(RUTA_DURABLE ".instantanea", F_OK) == 0 &&
+			     largo_registro < 4096,
+		     "El registro se compacta al crecer (8 KB sin compactar).");
+	pa2m_afirmar(hash_durable_compactar(hash),
+		     "Se puede compactar el hash a mano.");
+	hash_durable_cerrar(hash);
+
+	hash = hash_durable_abrir(RUTA_DURABLE, NULL);
+	bool correctos = hash_durable_cantidad(hash) == 100;
+	for (int i = 0; i < 200; i++) {
+		snprintf(clave, sizeof(clave), "clave%i", i);
+		size_t tamanio = 0;
+		const int *valor = hash_durable_obtener(hash, clave, &tamanio);
+		if (i % 2 == 0)
+			correctos = correctos && !valor;
+		else
+			correctos = correctos && valor && *valor == i &&
+				    tamanio == sizeof(int);
+	}
+	pa2m_afirmar(correctos,
+		     "Al reabrirlo desde la instantánea tiene las mismas claves.");
+	hash_durable_cerrar(hash);
+	borrar_hash_durable();
+}
+
+void hash_durable_descarta_una_operacion_escrita_a_medias()
+{
+	borrar_hash_durable();
+	hash_durable_t *hash = hash_durable_abrir(RUTA_DURABLE, NULL);
+	hash_durable_insertar(hash, "a", "uno", 4);
+	hash_durable_sincronizar(hash);
+	hash_durable_insertar(hash, "b", "dos", 4);
+	hash_durable_cerrar(hash);
+	FILE *registro = fopen(RUTA_DURABLE ".registro", "r");
+	fseek(registro, 0, SEEK_END);
+	long largo = ftell(registro);
+	fclose(registro);
+	pa2m_afirmar(truncate(RUTA_DURABLE ".registro", largo - 3) == 0,
+		     "Se corta la última operación del registro a la mitad.");
+
+	hash = hash_durable_abrir(RUTA_DURABLE, NULL);
+	pa2m_afirmar(hash && hash_durable_cantidad(hash) == 1 &&
+			     valor_durable_es(hash, "a", "uno"),
+		     "Al reabrirlo se recuperan las operaciones completas.");
+	hash_durable_insertar(hash, "c", "tres", 5);
+	hash_durable_cerrar(hash);
+	hash = hash_durable_abrir(RUTA_DURABLE, NULL);
+	pa2m_afirmar(hash_durable_cantidad(hash) == 2 &&
+			     valor_durable_es(hash, "c", "tres"),
+		     "Las operaciones nuevas se recuperan después de las viejas.");
+	hash_durable_cerrar(hash);
+	borrar_hash_durable();
+}
+
+size_t largo_del_registro_durable()
+{
+	struct stat estado;
+	if (stat(RUTA_DURABLE ".registro", &estado) < 0)
+		return 0;
+	return (size_t)estado.st_size;
+}
+
+void hash_durable_descarta_una_sincronizacion_escrita_a_medias()
+{
+	borrar_hash_durable();
+	hash_durable_opciones_t opciones = { .operaciones_por_sincronizacion =
+						     1000 };
+	hash_durable_t *hash = hash_durable_abrir(RUTA_DURABLE, &opciones);
+	hash_durable_insertar(hash, "a", "uno", 4);
+	hash_durable_sincronizar(hash);
+	size_t sincronizado = largo_del_registro_durable();
+	char valor[4096];
+	memset(valor, 'x', sizeof(valor) - 1);
+	valor[sizeof(valor) - 1] = 0;
+	hash_durable_insertar(hash, "b", valor, sizeof(valor));
+	hash_durable_insertar(hash, "c", "tres", 5);
+
+	struct rlimit limite_original, limite;
+	getrlimit(RLIMIT_FSIZE, &limite_original);
+	limite = limite_original;
+	limite.rlim_cur = (rlim_t)sincronizado + 100;
+	void (*senial_original)(int) = signal(SIGXFSZ, SIG_IGN);
+	setrlimit(RLIMIT_FSIZE, &limite);
+	bool fallo = !hash_durable_sincronizar(hash);
+	setrlimit(RLIMIT_FSIZE, &limite_original);
+	signal(SIGXFSZ, senial_original);
+	pa2m_afirmar(fallo && largo_del_registro_durable() == sincronizado,
+		     "Si la escritura del registro queda a medias, sincronizar falla y la descarta.");
+	pa2m_afirmar(hash_durable_sincronizar(hash) && hash_durable_cerrar(hash),
+		     "Se puede volver a sincronizar después del error.");
+
+	hash = hash_durable_abrir(RUTA_DURABLE, NULL);
+	pa2m_afirmar(hash && hash_durable_cantidad(hash) == 3 &&
+			     valor_durable_es(hash, "a", "uno") &&
+			     valor_durable_es(hash, "b", valor) &&
+			     valor_durable_es(hash, "c", "tres"),
+		     "Al reabrirlo se recuperan las operaciones del reintento.");
+	hash_durable_cerrar(hash);
+	borrar_hash_durable();
+}
+
+#define RUTA_CARGA "prueba_hash_carga.tsv"
+
+void escribir_archivo_de_carga(const char *contenido)
+{
+	FILE *archivo = fopen(RUTA_CARGA, "w");
+	fputs(contenido, archivo);
+	fclose(archivo);
+}
+
+bool valor_cargado_es(hash_t *hash, const char *clave, const char *esperado)
+{
+	char *valor = hash_obtener(hash, clave);
+	return valor && strcmp(valor, esperado) == 0;
+}
+
+void hash_cargar_archivo_separa_claves_y_valores()
+{
+	escribir_archivo_de_carga("a\tuno\nb\tdos\r\nsin tabulacion\n\n"
+				  "c\t\na\totro uno\nd\tcon\ttab\nfin\tultima");
+	hash_carga_t *carga = hash_cargar_archivo(RUTA_CARGA, NULL, 3);
+	hash_t *hash = hash_carga_hash(carga);
+	pa2m_afirmar(carga && hash_cantidad(hash) == 5,
+		     "Se cargan las líneas con tabulación.");
+	pa2m_afirmar(hash_carga_lineas_ignoradas(carga) == 2,
+		     "Se cuentan las líneas sin tabulación.");
+	pa2m_afirmar(valor_cargado_es(hash, "a", "otro uno"),
+		     "Si una clave se repite queda el último valor.");
+	pa2m_afirmar(valor_cargado_es(hash, "b", "dos") &&
+			     valor_cargado_es(hash, "c", "") &&
+			     valor_cargado_es(hash, "d", "con\ttab"),
+		     "Los valores no incluyen el \\r final, y pueden estar "
+		     "vacíos o tener tabulaciones.");
+	pa2m_afirmar(valor_cargado_es(hash, "fin", "ultima"),
+		     "Se carga la última línea aunque no tenga fin de línea.");
+	hash_carga_destruir(carga);
+
+	escribir_archivo_de_carga("");
+	carga = hash_cargar_archivo(RUTA_CARGA, NULL, 0);
+	pa2m_afirmar(carga && hash_cantidad(hash_carga_hash(carga)) == 0,
+		     "Se puede cargar un archivo vacío.");
+	hash_carga_destruir(carga);
+	unlink(RUTA_CARGA);
+	pa2m_afirmar(!hash_cargar_archivo(RUTA_CARGA, NULL, 0),
+		     "No se puede cargar un archivo que no existe.");
+}
+
+void hash_cargar_archivo_en_paralelo_respeta_el_orden()
+{
+	FILE *archivo = fopen(RUTA_CARGA, "w");
+	for (int i = 0; i < 5000; i++)
+		fprintf(archivo, "clave%i\t%i\n", i % 3000, i);
+	fclose(archivo);
+	hash_carga_t *en_paralelo = hash_cargar_archivo(RUTA_CARGA, NULL, 7);
+	hash_carga_t *secuencial = hash_cargar_archivo(RUTA_CARGA, NULL, 1);
+	hash_t *hash = hash_carga_hash(en_paralelo);
+	bool iguales = hash_cantidad(hash) == 3000 &&
+		       hash_cantidad(hash_carga_hash(secuencial)) == 3000;
+	char clave[24], valor[24];
+	for (int i = 0; i < 3000; i++) {
+		snprintf(clave, sizeof(clave), "clave%i", i);
+		snprintf(valor, sizeof(valor), "%i", i < 2000 ? i + 3000 : i);
+		iguales = iguales && valor_cargado_es(hash, clave, valor) &&
+			  valor_cargado_es(hash_carga_hash(secuencial), clave,
+					   valor);
+	}
+	pa2m_afirmar(iguales, "Cargar con 7 hilos da lo mismo que con 1, con "
+			      "el último valor de cada clave.");
+	hash_carga_destruir(en_paralelo);
+	hash_carga_destruir(secuencial);
+	unlink(RUTA_CARGA);
+}
+
+void contar_pares_reunidos(const consulta_fila_t *construida,
+			   const consulta_fila_t *sondeada, void *aux)
+{
+	int *suma = aux;
+	if (strcmp(construida->clave, sondeada->clave) == 0)
+		*suma += *(int *)construida->dato * *(int *)sondeada->dato;
+}
+
+void reunion_encuentra_todos_los_pares_con_la_misma_clave()
+{
+	int numeros[] = { 1, 2, 3, 10, 100 };
+	consulta_fila_t construidas[] = { { "a", &numeros[0] },
+					  { "b", &numeros[1] },
+					  { "a", &numeros[2] } };
+	consulta_fila_t sondeadas[] = { { "a", &numeros[3] },
+					{ "c", &numeros[3] },
+					{ "b", &numeros[4] } };
+	reunion_t *reunion = reunion_crear(construidas, 3, 2);
+	int suma = 0;
+	pa2m_afirmar(reunion_sondear(reunion, sondeadas, 3,
+				     contar_pares_reunidos, &suma) == 3,
+		     "Se encuentran los pares con la misma clave, incluso si la "
+		     "clave se repite.");
+	pa2m_afirmar(suma == 1 * 10 + 3 * 10 + 2 * 100,
+		     "La función recibe la fila construida y la sondeada.");
+	suma = 0;
+	pa2m_afirmar(reunion_sondear(reunion, sondeadas + 1, 1,
+				     contar_pares_reunidos, &suma) == 0 &&
+			     suma == 0,
+		     "Un lote sin claves en común no encuentra pares.");
+	reunion_destruir(reunion);
+}
+
+#define FILAS_CONSULTA 20000
+
+void contar_pares_correctos(const consulta_fila_t *construida,
+			    const consulta_fila_t *sondeada, void *aux)
+{
+	if (construida == sondeada->dato)
+		(*(size_t *)aux)++;
+}
+
+void reunion_y_agrupacion_con_particiones_en_paralelo()
+{
+	char(*claves)[24] = malloc(FILAS_CONSULTA * sizeof(*claves));
+	consulta_fila_t *filas = calloc(FILAS_CONSULTA, sizeof(consulta_fila_t));
+	for (int i = 0; i < FILAS_CONSULTA; i++) {
+		snprintf(claves[i], sizeof(claves[i]), "clave%i", i);
+		filas[i].clave = claves[i];
+		filas[i].dato = &filas[i];
+	}
+	reunion_t *reunion = reunion_crear(filas, FILAS_CONSULTA, 4);
+	size_t pares = 0, correctos = 0;
+	for (int lote = 0; lote < FILAS_CONSULTA; lote += 1000)
+		pares += reunion_sondear(reunion, filas + lote, 1000,
+					 contar_pares_correctos, &correctos);
+	pa2m_afirmar(pares == FILAS_CONSULTA && correctos == FILAS_CONSULTA,
+		     "Sondear 20000 filas en lotes encuentra cada una una vez.");
+	reunion_destruir(reunion);
+
+	for (int i = 0; i < FILAS_CONSULTA; i++) {
+		filas[i].clave = claves[i % 100];
+		filas[i].valor = i;
+	}
+	agrupacion_t *agrupacion = agrupacion_crear(FILAS_CONSULTA, 4);
+	bool ok = agrupacion_agregar(agrupacion, filas, FILAS_CONSULTA / 2) &&
+		  agrupacion_agregar(agrupacion, filas + FILAS_CONSULTA / 2,
+				     FILAS_CONSULTA / 2);
+	pa2m_afirmar(ok && agrupacion_cantidad(agrupacion) == 100,
+		     "Agrupar 20000 filas en lotes da un grupo por clave.");
+	const agregado_t *agregado = agrupacion_obtener(agrupacion, "clave7");
+	pa2m_afirmar(agregado && agregado->cantidad == 200 &&
+			     agregado->minimo == 7 &&
+			     agregado->maximo == FILAS_CONSULTA - 93 &&
+			     agregado->suma == 200 * 7 + 100.0 * 199 * 200 / 2,
+		     "Cada grupo tiene la cantidad, la suma, el mínimo y el "
+		     "máximo de sus filas.");
+	pa2m_afirmar(!agrupacion_obtener(agrupacion, "clave100"),
+		     "No hay grupos para claves que no se agregaron.");
+	agrupacion_destruir(agrupacion);
+	free(filas);
+	free(claves);
+}
+
+void *sumar_valores(const char *clave, void *valor, void *valor_otro,
+		    void *aux)
+{
+	*(int *)valor += *(int *)valor_otro;
+	(*(int *)aux)++;
+	return valor;
+}
+
+void *restar_valores(const char *clave, void *valor, void *valor_otro,
+		     void *aux)
+{
+	int *resta = aux;
+	*resta += *(int *)valor - *(int *)valor_otro;
+	return resta;
+}
+
+void hash_fusionar_mueve_los_elementos_del_otro()
+{
+	int valores[400];
+	char clave[24];
+	hash_t *hash = hash_crear(3);
+	hash_t *otro = hash_crear_con_opciones(3, &(hash_opciones_t){
+							  .flags = HASH_FILTRO });
+	for (int i = 0; i < 400; i++) {
+		valores[i] = i;
+		snprintf(clave, sizeof(clave), "clave%i", i);
+		hash_insertar(i < 300 ? hash : otro, clave, &valores[i], NULL);
+		if (i >= 200 && i < 300) {
+			snprintf(clave, sizeof(clave), "clave%i", i + 200);
+			hash_insertar(otro, clave, &valores[i], NULL);
+		}
+	}
+	hash_t *clon = hash_clonar(otro);
+	int conflictos = 0;
+	pa2m_afirmar(hash_fusionar(hash, otro, sumar_valores, &conflictos) ==
+			     hash,
+		     "Se puede fusionar un hash con otro.");
+	pa2m_afirmar(hash_cantidad(hash) == 500 && hash_cantidad(otro) == 0,
+		     "Los elementos del otro pasan al hash y el otro queda "
+		     "vacío.");
+	pa2m_afirmar(conflictos == 0 && *(int *)hash_obtener(hash, "clave450") ==
+						 250,
+		     "Las claves que no se repiten conservan su valor.");
+	pa2m_afirmar(hash_cantidad(clon) == 200 && hash_contiene(clon, "clave350"),
+		     "Un clon del otro no cambia.");
+	hash_destruir(clon);
+	hash_destruir(otro);
+	pa2m_afirmar(contiene_claves_numeradas(hash, 0, 500),
+		     "Las claves movidas siguen en el hash después de destruir "
+		     "el otro.");
+
+	otro = hash_crear_con_opciones(3, &(hash_opciones_t){
+						  .flags = HASH_COMPACTO });
+	int cien = 100;
+	hash_insertar(otro, "clave1", &cien, NULL);
+	hash_insertar(otro, "nueva", &cien, NULL);
+	pa2m_afirmar(hash_fusionar(hash, otro, sumar_valores, &conflictos) &&
+			     conflictos == 1 && valores[1] == 101 &&
+			     hash_cantidad(hash) == 501 &&
+			     hash_cantidad(otro) == 0,
+		     "Con un hash compacto las claves se copian, y resolver "
+		     "decide el valor de las repetidas.");
+	pa2m_afirmar(!hash_fusionar(hash, hash, NULL, NULL),
+		     "No se puede fusionar un hash consigo mismo.");
+	hash_destruir(otro);
+	hash_destruir(hash);
+}
+
+void hash_interseccion_y_diferencia_crean_un_hash_nuevo()
+{
+	int numeros[] = { 1, 2, 3, 10, 20 };
+	hash_t *hash = hash_crear(3);
+	hash_t *otro = hash_crear(3);
+	hash_insertar(hash, "a", &numeros[0], NULL);
+	hash_insertar(hash, "b", &numeros[1], NULL);
+	hash_insertar(hash, "c", &numeros[2], NULL);
+	hash_insertar(otro, "b", &numeros[3], NULL);
+	hash_insertar(otro, "c", &numeros[4], NULL);
+	int resta = 0;
+	hash_t *comunes = hash_interseccion(hash, otro, NULL, NULL, NULL);
+	pa2m_afirmar(comunes && hash_cantidad(comunes) == 2 &&
+			     hash_obtener(comunes, "b") == &numeros[1] &&
+			     !hash_contiene(comunes, "a"),
+		     "La intersección tiene las claves comunes con el valor del "
+		     "primer hash.");
+	hash_destruir(comunes);
+	comunes = hash_interseccion(hash, otro, NULL, restar_valores, &resta);
+	pa2m_afirmar(comunes && hash_cantidad(comunes) == 2 &&
+			     resta == (2 - 10) + (3 - 20),
+		     "resolver recibe el valor del primer hash y el del otro, "
+		     "aunque se recorra el otro.");
+	hash_destruir(comunes);
+	hash_t *diferencia = hash_diferencia(hash, otro, &(hash_opciones_t){
+								 .flags = HASH_CUCKOO });
+	pa2m_afirmar(diferencia && hash_cantidad(diferencia) == 1 &&
+			     hash_obtener(diferencia, "a") == &numeros[0],
+		     "La diferencia tiene las claves del primero que no están "
+		     "en el otro, con las opciones dadas.");
+	hash_destruir(diferencia);
+	diferencia = hash_diferencia(otro, hash, NULL);
+	pa2m_afirmar(diferencia && hash_cantidad(diferencia) == 0,
+		     "La diferencia puede quedar vacía.");
+	hash_destruir(diferencia);
+	pa2m_afirmar(hash_cantidad(hash) == 3 && hash_cantidad(otro) == 2,
+		     "La intersección y la diferencia no modifican los hash.");
+	hash_destruir(hash);
+	hash_destruir(otro);
+}
+
+bool valor_par(const char *clave, void *valor, void *aux)
+{
+	return *(int *)valor % 2 == 0;
+}
+
+int destruidos_por_quitar_si = 0;
+
+void contar_destruido(void *valor)
+{
+	destruidos_por_quitar_si++;
+}
+
+bool contar_valores_pares(const char *clave, void *valor, void *aux)
+{
+	(*(int *)aux) += *(int *)valor % 2 == 0;
+	return true;
+}
+
+void hash_quitar_si_quita_los_elementos_que_cumplen()
+{
+	int valores[1000];
+	char clave[24];
+	hash_t *hash = hash_crear(3);
+	for (int i = 0; i < 1000; i++) {
+		valores[i] = i;
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(hash, clave, &valores[i], NULL);
+	}
+	hash_t *clon = hash_clonar(hash);
+	destruidos_por_quitar_si = 0;
+	int pares_que_quedan = 0;
+	pa2m_afirmar(hash_quitar_si(hash, valor_par, NULL, contar_destruido) ==
+				     500 &&
+			     destruidos_por_quitar_si == 500 &&
+			     hash_cantidad(hash) == 500,
+		     "hash_quitar_si quita los elementos que cumplen el predicado y los pasa al destructor.");
+	hash_con_cada_clave(hash, contar_valores_pares, &pares_que_quedan);
+	pa2m_afirmar(pares_que_quedan == 0 && hash_contiene(hash, "clave999") &&
+			     !hash_contiene(hash, "clave998"),
+		     "Quedan solo los elementos que no cumplen el predicado.");
+	pa2m_afirmar(hash_cantidad(clon) == 1000 &&
+			     hash_contiene(clon, "clave998"),
+		     "Un clon del hash no cambia.");
+	pa2m_afirmar(hash_quitar_si(clon, valor_par, NULL, NULL) == 500 &&
+			     hash_cantidad(clon) == 500 &&
+			     hash_obtener(hash, "clave1") == &valores[1],
+		     "hash_quitar_si en el clon no cambia el original.");
+	hash_destruir(clon);
+	hash_destruir(hash);
+
+	hash = hash_crear_con_opciones(3, &(hash_opciones_t){
+						  .flags = HASH_COMPACTO });
+	for (int i = 0; i < 100; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_insertar(hash, clave, &valores[i], NULL);
+	}
+	pa2m_afirmar(hash_quitar_si(hash, valor_par, NULL, NULL) == 50 &&
+			     hash_cantidad(hash) == 50 &&
+			     !hash_contiene(hash, "clave0") &&
+			     hash_contiene(hash, "clave1"),
+		     "hash_quitar_si funciona con un hash compacto.");
+	pa2m_afirmar(!hash_quitar_si(NULL, valor_par, NULL, NULL) &&
+			     !hash_quitar_si(hash, NULL, NULL, NULL),
+		     "hash_quitar_si sin hash o sin predicado no quita nada.");
+	hash_destruir(hash);
+}
+
+void hash_multi_guarda_los_valores_contiguos_en_orden()
+{
+	int numeros[100];
+	char clave[24];
+	hash_multi_t *multi = hash_multi_crear(3, NULL);
+	for (int i = 0; i < 100; i++) {
+		numeros[i] = i;
+		snprintf(clave, sizeof(clave), "termino%d", i % 7);
+		hash_multi_insertar(multi, clave, &numeros[i]);
+	}
+	hash_multi_insertar(multi, "termino0", &numeros[0]);
+	size_t cantidad = 0;
+	void *const *valores =
+		hash_multi_obtener_todos(multi, "termino3", &cantidad);
+	bool en_orden = valores && cantidad == 14;
+	for (size_t i = 0; en_orden && i < cantidad; i++)
+		en_orden = valores[i] == &numeros[3 + 7 * i];
+	pa2m_afirmar(en_orden,
+		     "Los valores de una clave se obtienen juntos y en orden de inserción.");
+	pa2m_afirmar(hash_multi_cantidad(multi) == 7 &&
+			     hash_multi_cantidad_valores(multi) == 101,
+		     "El hash cuenta las claves y los valores por separado.");
+	hash_multi_obtener_todos(multi, "termino0", &cantidad);
+	pa2m_afirmar(cantidad == 16,
+		     "Un valor repetido se agrega otra vez.");
+	pa2m_afirmar(!hash_multi_obtener_todos(multi, "ausente", &cantidad) &&
+			     cantidad == 0 && !hash_multi_contiene(multi, "ausente"),
+		     "Una clave sin valores no existe.");
+
+	pa2m_afirmar(hash_multi_quitar_valor(multi, "termino3", &numeros[10]) &&
+			     !hash_multi_quitar_valor(multi, "termino3",
+						      &numeros[10]),
+		     "Se puede quitar un valor de una clave.");
+	valores = hash_multi_obtener_todos(multi, "termino3", &cantidad);
+	pa2m_afirmar(cantidad == 13 && valores[0] == &numeros[3] &&
+			     valores[1] == &numeros[17],
+		     "Los demás valores conservan el orden.");
+	pa2m_afirmar(hash_multi_quitar(multi, "termino3", NULL) == 13 &&
+			     !hash_multi_contiene(multi, "termino3") &&
+			     hash_multi_cantidad_valores(multi) == 101 - 14,
+		     "Se puede quitar una clave con todos sus valores.");
+	hash_multi_insertar(multi, "solo", &numeros[0]);
+	pa2m_afirmar(hash_multi_quitar_valor(multi, "solo", &numeros[0]) &&
+			     !hash_multi_contiene(multi, "solo"),
+		     "Quitar el último valor de una clave quita la clave.");
+	hash_multi_destruir(multi);
+}
+
+void liberar_int(void *elemento)
+{
+	free(elemento);
+}
+
+bool sumar_cantidades(const char *clave, void *const *valores,
+		      size_t cantidad, void *aux)
+{
+	*(size_t *)aux += cantidad;
+	return true;
+}
+
+void hash_multi_recorre_y_destruye_los_valores()
+{
+	hash_multi_t *multi = hash_multi_crear(
+		3, &(hash_opciones_t){ .flags = HASH_COMPACTO });
+	char clave[24];
+	for (int i = 0; i < 50; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i % 5);
+		hash_multi_insertar(multi, clave, malloc(sizeof(int)));
+	}
+	size_t total = 0;
+	pa2m_afirmar(hash_multi_con_cada_clave(multi, sumar_cantidades,
+					       &total) == 5 &&
+			     total == 50,
+		     "hash_multi_con_cada_clave pasa cada clave con todos sus valores.");
+	pa2m_afirmar(hash_multi_quitar(multi, "clave0", liberar_int) == 10,
+		     "hash_multi_quitar pasa los valores al destructor.");
+	hash_multi_destruir_todo(multi, liberar_int);
+	pa2m_afirmar(!hash_multi_insertar(NULL, "a", NULL) &&
+			     !hash_multi_cantidad(NULL),
+		     "Las operaciones sin hash fallan.");
+}
+
+void hash_multi_reserva_los_grupos_con_el_alocador()
+{
+	contador_de_reservas_t contador = { 0 };
+	alocador_t alocador = { .reservar = reservar_contando,
+				.redimensionar = redimensionar_contando,
+				.liberar = liberar_contando,
+				.contexto = &contador };
+	hash_multi_t *multi = hash_multi_crear(
+		3, &(hash_opciones_t){ .alocador = &alocador });
+	int valores[3];
+	hash_multi_insertar(multi, "clave", &valores[0]);
+	hash_multi_insertar(multi, "clave", &valores[1]);
+	contador_de_reservas_t antes = contador;
+	hash_multi_insertar(multi, "clave", &valores[2]);
+	pa2m_afirmar(contador.reservas == antes.reservas + 1 &&
+			     contador.liberaciones == antes.liberaciones + 1,
+		     "Agrandar el grupo de una clave reserva y libera con el alocador de las opciones.");
+	hash_multi_destruir(multi);
+	pa2m_afirmar(contador.reservas == contador.liberaciones,
+		     "Al destruir el hash multi libera con el alocador todo lo que reservó.");
+
+	multi = hash_multi_crear(3, &(hash_opciones_t){ .limite_memoria =
+								4096 });
+	size_t insertados = 0;
+	while (insertados < 512 && hash_multi_insertar(multi, "clave", NULL))
+		insertados++;
+	size_t cantidad;
+	hash_multi_obtener_todos(multi, "clave", &cantidad);
+	pa2m_afirmar(insertados > 0 && insertados < 512 &&
+			     cantidad == insertados,
+		     "Los grupos de valores cuentan para el límite de memoria.");
+	hash_multi_destruir(multi);
+}
+
+void hash_calcular_sirve_para_varios_hash()
+{
+	int uno = 1, dos = 2, tres = 3;
+	hash_opciones_t compacto = { .flags = HASH_COMPACTO };
+	hash_opciones_t con_semilla = { .semilla = 0x5eed };
+	hash_t *hashes[] = { hash_crear(3),
+			     hash_crear_con_opciones(3, &compacto),
+			     hash_crear_con_opciones(3, &con_semilla) };
+	hash_insertar(hashes[0], "clave", &uno, NULL);
+	hash_insertar(hashes[1], "clave", &dos, NULL);
+	hash_insertar(hashes[2], "clave", &tres, NULL);
+	hash_clave_t clave = hash_calcular("clave");
+	pa2m_afirmar(hash_obtener_h(hashes[0], &clave) == &uno &&
+			     hash_obtener_h(hashes[1], &clave) == &dos &&
+			     hash_obtener_h(hashes[2], &clave) == &tres,
+		     "Una clave calculada una vez se encuentra en varios hash.");
+	hash_clave_t con_otra_semilla =
+		hash_calcular_con_semilla("clave", 0x5eed);
+	pa2m_afirmar(hash_contiene_h(hashes[0], &con_otra_semilla) &&
+			     hash_contiene_h(hashes[2], &con_otra_semilla),
+		     "Una clave calculada con otra semilla también se encuentra.");
+	hash_clave_t ausente = hash_calcular("ausente");
+	pa2m_afirmar(!hash_contiene_h(hashes[0], &ausente) &&
+			     !hash_obtener_h(hashes[1], &ausente) &&
+			     !hash_contiene_h(hashes[2], &ausente),
+		     "Una clave calculada que no está no se encuentra.");
+	hash_clave_t nula = hash_calcular(NULL);
+	pa2m_afirmar(!hash_insertar_h(hashes[0], &nula, &uno, NULL) &&
+			     !hash_insertar_h(NULL, &clave, &uno, NULL),
+		     "No se puede insertar una clave calculada NULL ni en un hash NULL.");
+	for (size_t i = 0; i < 3; i++)
+		hash_destruir(hashes[i]);
+}
+
+void hash_con_semilla_funciona_como_uno_sin_semilla()
+{
+	hash_opciones_t opciones = { .semilla = 12345, .flags = HASH_FILTRO };
+	hash_t *hash = hash_crear_con_opciones(3, &opciones);
+	char clave[24];
+	int numeros[500];
+	bool insertados = true;
+	for (int i = 0; i < 500; i++) {
+		numeros[i] = i;
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		hash_clave_t calculada = hash_calcular_con_semilla(clave, 12345);
+		insertados &= hash_insertar_h(hash, &calculada, &numeros[i],
+					      NULL) != NULL;
+	}
+	pa2m_afirmar(insertados && hash_cantidad(hash) == 500 &&
+			     contiene_claves_numeradas(hash, 0, 500),
+		     "Las claves insertadas con _h se encuentran con hash_contiene.");
+	void *anterior = NULL;
+	hash_clave_t calculada = hash_calcular_con_semilla("clave7", 12345);
+	hash_insertar_h(hash, &calculada, &numeros[0], &anterior);
+	pa2m_afirmar(anterior == &numeros[7] &&
+			     hash_obtener(hash, "clave7") == &numeros[0],
+		     "hash_insertar_h reemplaza el elemento de una clave existente.");
+	pa2m_afirmar(hash_quitar_h(hash, &calculada) == &numeros[0] &&
+			     !hash_contiene(hash, "clave7") &&
+			     !hash_quitar_h(hash, &calculada),
+		     "hash_quitar_h quita el elemento de la clave.");
+	quitar_claves_numeradas(hash, 0, 400);
+	pa2m_afirmar(hash_cantidad(hash) == 100 &&
+			     contiene_claves_numeradas(hash, 400, 500),
+		     "Un hash con semilla sigue funcionando después de achicarse.");
+	hash_destruir(hash);
+}
+
+#define NOMBRE_COMPARTIDO "/prueba_hash_compartido"
+
+bool contiene_numeros_compartidos(hash_compartido_t *hash, int desde,
+				  int hasta)
+{
+	char clave[24];
+	bool contiene = true;
+	for (int i = desde; i < hasta; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		size_t tamanio = 0;
+		const int *valor = hash_compartido_obtener(hash, clave, &tamanio);
+		contiene &= valor && tamanio == sizeof(int) && *valor == i;
+	}
+	return contiene;
+}
+
+/**
+ * Abre el hash compartido desde un proceso hijo: verifica que se lean las
+ * claves que cargó el padre, que no se pueda escribir si se abrió solo para
+ * lectura, y escribe en él. Devuelve 0 si todo salió bien.
+*/
+int usar_hash_compartido_desde_el_hijo()
+{
+	hash_compartido_t *lector =
+		hash_compartido_abrir(NOMBRE_COMPARTIDO, false);
+	int numero = -1;
+	bool ok = lector && contiene_numeros_compartidos(lector, 0, 1000) &&
+		  !hash_compartido_insertar(lector, "del_hijo", &numero,
+					    sizeof(numero));
+	hash_compartido_cerrar(lector);
+	hash_compartido_t *escritor =
+		hash_compartido_abrir(NOMBRE_COMPARTIDO, true);
+	ok = ok && escritor &&
+	     hash_compartido_insertar(escritor, "del_hijo", &numero,
+				      sizeof(numero)) &&
+	     hash_compartido_quitar(escritor, "clave0");
+	hash_compartido_cerrar(escritor);
+	return ok ? 0 : 1;
+}
+
+void hash_compartido_se_comparte_entre_procesos()
+{
+	hash_compartido_eliminar(NOMBRE_COMPARTIDO);
+	hash_compartido_t *hash =
+		hash_compartido_crear(NOMBRE_COMPARTIDO, 1000, 1 << 20);
+	char clave[24];
+	bool insertados = hash != NULL;
+	for (int i = 0; insertados && i < 1000; i++) {
+		snprintf(clave, sizeof(clave), "clave%d", i);
+		insertados = hash_compartido_insertar(hash, clave, &i, sizeof(i));
+	}
+	pa2m_afirmar(insertados && hash_compartido_cantidad(hash) == 1000 &&
+			     contiene_numeros_compartidos(hash, 0, 1000),
+		     "Se pueden cargar claves en un hash compartido.");
+	pa2m_afirmar(!hash_compartido_crear(NOMBRE_COMPARTIDO, 10, 1024),
+		     "No se puede crear un hash compartido con un nombre que ya existe.");
+
+	pid_t hijo = fork();
+	if (hijo == 0)
+		_exit(usar_hash_compartido_desde_el_hijo());
+	int estado = -1;
+	waitpid(hijo, &estado, 0);
+	pa2m_afirmar(hijo > 0 && WIFEXITED(estado) && WEXITSTATUS(estado) == 0,
+		     "Otro proceso lee las claves y solo escribe si lo abrió para escritura.");
+	const int *del_hijo = hash_compartido_obtener(hash, "del_hijo", NULL);
+	pa2m_afirmar(del_hijo && *del_hijo == -1 &&
+			     !hash_compartido_obtener(hash, "clave0", NULL) &&
+			     hash_compartido_cantidad(hash) == 1000,
+		     "Lo que escribe otro proceso se ve sin volver a abrir el hash.");
+	hash_compartido_cerrar(hash);
+	pa2m_afirmar(hash_compartido_eliminar(NOMBRE_COMPARTIDO) &&
+			     !hash_compartido_abrir(NOMBRE_COMPARTIDO, false),
+		     "Un hash compartido eliminado ya no se puede abrir.");
+}
+
+void hash_compartido_reemplaza_y_quita_sin_mover_valores()
+{
+	hash_compartido_eliminar(NOMBRE_COMPARTIDO);
+	hash_compartido_t *hash =
+		hash_compartido_crear(NOMBRE_COMPARTIDO, 4, 512);
+	hash_compartido_insertar(hash, "clave", "viejo", 6);
+	const char *viejo = hash_compartido_obtener(hash, "clave", NULL);
+	hash_compartido_insertar(hash, "clave", "nuevo", 6);
+	size_t tamanio = 0;
+	const char *nuevo = hash_compartido_obtener(hash, "clave", &tamanio);
+	pa2m_afirmar(nuevo && strcmp(nuevo, "nuevo") == 0 && tamanio == 6 &&
+			     hash_compartido_cantidad(hash) == 1,
+		     "Insertar una clave existente reemplaza su valor.");
+	pa2m_afirmar(viejo && strcmp(viejo, "viejo") == 0,
+		     "El valor reemplazado sigue siendo válido.");
+	pa2m_afirmar(hash_compartido_quitar(hash, "clave") &&
+			     !hash_compartido_obtener(hash, "clave", NULL) &&
+			     !hash_compartido_quitar(hash, "clave") &&
+			     hash_compartido_cantidad(hash) == 0,
+		     "Se puede quitar una clave.");
+	pa2m_afirmar(hash_compartido_insertar(hash, "clave", NULL, 0) &&
+			     hash_compartido_obtener(hash, "clave", &tamanio) &&
+			     tamanio == 0 && hash_compartido_cantidad(hash) == 1,
+		     "Se puede volver a insertar una clave quitada, con un valor vacío.");
+	char grande[512] = { 0 };
+	size_t usados = hash_compartido_bytes_usados(hash);
+	pa2m_afirmar(!hash_compartido_insertar(hash, "otra", grande,
+					       sizeof(grande)) &&
+			     !hash_compartido_obtener(hash, "otra", NULL) &&
+			     hash_compartido_bytes_usados(hash) == usados,
+		     "Insertar falla sin modificar el hash si no queda lugar.");
+	hash_compartido_cerrar(hash);
+	hash_compartido_eliminar(NOMBRE_COMPARTIDO);
+}
+
+uint64_t suma_de_caracteres(const char *clave)
+{
+	return (uint64_t)hash_calcular(clave).suma;
+}
+
+uint64_t fnv1a_mezclado(const char *clave)
+{
+	return mezclar_u64(hash_fnv1a(clave));
+}
+
+/**
+ * Guarda en claves cantidad claves "usuario:<número>" con números al azar,
+ * escritas en texto (de a 16 bytes por clave).
+*/
+void generar_claves_de_usuarios(char *texto, const char **claves,
+				size_t cantidad)
+{
+	unsigned long long estado = 88172645463325252ULL;
+	for (size_t i = 0; i < cantidad; i++) {
+		estado ^= estado << 13;
+		estado ^= estado >> 7;
+		estado ^= estado << 17;
+		snprintf(texto + i * 16, 16, "usuario:%llu",
+			 estado % 10000000);
+		claves[i] = texto + i * 16;
+	}
+}
+
+void calidad_distribucion_detecta_una_funcion_que_agrupa()
+{
+	char *texto = malloc(2000 * 16);
+	const char **claves = malloc(2000 * sizeof(char *));
+	generar_claves_de_usuarios(texto, claves, 2000);
+	calidad_distribucion_t suma, fnv;
+	pa2m_afirmar(calidad_distribucion(claves, 2000, suma_de_caracteres,
+					  2857, &suma) &&
+			     calidad_distribucion(claves, 2000, fnv1a_mezclado,
+						  2857, &fnv),
+		     "Se puede medir la distribución de las claves en una tabla.");
+	pa2m_afirmar(suma.chi_cuadrado_relativo > 50 &&
+			     fnv.chi_cuadrado_relativo < 1.5,
+		     "El chi cuadrado relativo es alto si las claves se agrupan y cerca de 1 si no.");
+	pa2m_afirmar(suma.lista_mas_larga > 5 * fnv.lista_mas_larga &&
+			     suma.posiciones_vacias > fnv.posiciones_vacias,
+		     "Las claves agrupadas dejan listas más largas y más posiciones vacías.");
+	calidad_distribucion_t distribucion;
+	pa2m_afirmar(!calidad_distribucion(claves, 2000, fnv1a_mezclado, 1,
+					   &distribucion) &&
+			     !calidad_distribucion(NULL, 2000, fnv1a_mezclado,
+						   10, &distribucion),
+		     "No se puede medir con menos de 2 posiciones ni sin claves.");
+	free(claves);
+	free(texto);
+}
+
+void calidad_bits_mide_el_sesgo_y_la_avalancha()
+{
+	char *texto = malloc(2000 * 16);
+	const char **claves = malloc(2000 * sizeof(char *));
+	generar_claves_de_usuarios(texto, claves, 2000);
+	calidad_bits_t suma, fnv;
+	pa2m_afirmar(calidad_bits(claves, 2000, suma_de_caracteres, 31, 500,
+				  &suma) &&
+			     calidad_bits(claves, 2000, fnv1a_mezclado, 64, 500,
+					  &fnv),
+		     "Se puede medir la calidad de los bits del hash.");
+	pa2m_afirmar(suma.sesgo_maximo == 0.5 && fnv.sesgo_maximo < 0.05,
+		     "Un bit que nunca cambia tiene sesgo 0.5.");
+	pa2m_afirmar(suma.avalancha_media < 0.2 &&
+			     fnv.avalancha_media > 0.45 &&
+			     fnv.avalancha_media < 0.55 &&
+			     fnv.avalancha_peor < 0.1,
+		     "Invertir un bit de la clave cambia la mitad de los bits de un buen hash.");
+	pa2m_afirmar(!calidad_bits(claves, 2000, fnv1a_mezclado, 65, 0, &fnv) &&
+			     !calidad_bits(claves, 0, fnv1a_mezclado, 64, 0,
+					   &fnv),
+		     "No se puede medir más de 64 bits ni sin claves.");
+	free(claves);
+	free(texto);
+}
+
+int main()
+{
+	pa2m_nuevo_grupo(
+		"\n======================== CREAR ========================");
+	crear_hash_con_capacidad_mayor_a_3();
+	crear_hash_con_capacidad_menor_a_3_se_crea_con_capacidad_3();
+
+	pa2m_nuevo_grupo(
+		"\n======================== INSERTAR ========================");
+	insertar_sin_llegar_al_rehash_sin_colision_sin_clave_repetida();
+	insertar_sin_llegar_al_rehash_con_colision_sin_clave_repetida();
+	insertar_sin_llegar_al_rehash_con_clave_repetida_anterior_no_nulo();
+	insertar_sin_llegar_al_rehash_con_clave_repetida_anterior_nulo();
+	insertar_con_rehash();
+	insertar_pasando_hash_nulo();
+	insertar_pasando_clave_nula();
+
+	pa2m_nuevo_grupo(
+		"\n======================== QUITAR ========================");
+	quitar_elemento_que_se_encuentra_en_el_hash();
+	quitar_elemento_que_no_se_encuentra_en_el_hash();
+	quitar_ultimo_elemento_de_una_colision_y_volver_a_insertar();
+	quitar_elemento_de_hash_nulo();
+	quitar_elemento_con_clave_nula();
+
+	pa2m_nuevo_grupo(
+		"\n======================== BUSCAR ========================");
+	obtener_elemento_que_esta_en_el_hash();
+	obtener_elemento_que_no_esta_en_el_hash();
+	obtener_elemento_en_hash_nulo();
+	obtener_elemento_con_clave_nula();
+
+	pa2m_nuevo_grupo(
+		"\n======================= CONTIENE =======================");
+	ver_si_contiene_elemento_que_esta_en_el_hash();
+	ver_si_contiene_elemento_que_no_esta_en_el_hash();
+	hash_contiene_con_hash_nulo();
+	hash_contiene_con_clave_nula();
+
+	pa2m_nuevo_grupo(
+		"\n======================= ITERADOR =======================");
+	iterador_interno_pasando_hash_sin_colisiones();
+	iterador_interno_pasando_hash_con_colisiones();
+	iterador_interno_pasando_hash_nulo();
+	iterador_interno_pasando_funcion_nula();
+
+	pa2m_nuevo_grupo(
+		"\n=================== CLAVES PRESTADAS ===================");
+	insertar_con_claves_prestadas_no_copia_la_clave();
+	crear_con_claves_prestadas_y_pool_falla();
+	hashes_con_pool_comparten_las_claves();
+	rehash_con_pool_no_vuelve_a_internar_las_claves();
+
+	pa2m_nuevo_grupo(
+		"\n====================== CACHE LRU ======================");
+	cache_desaloja_el_menos_usado_al_superar_entradas();
+	cache_desaloja_por_bytes_e_invoca_destructor();
+	cache_cuenta_aciertos_y_fallos();
+
+	pa2m_nuevo_grupo(
+		"\n====================== VENCIMIENTOS ======================");
+	elemento_vencido_se_considera_ausente();
+	insertar_sin_ttl_quita_el_vencimiento();
+	hash_expirar_quita_solo_los_vencidos_de_a_tandas();
+
+	pa2m_nuevo_grupo(
+		"\n==================== CLAVES ENTERAS ====================");
+	hash_u64_inserta_actualiza_y_obtiene();
+	hash_u64_quitar_mantiene_accesibles_las_demas_claves();
+	hash_u64_iterador_interno_recorre_todas_las_claves();
+	hash_u64_actualizar_en_el_umbral_no_agranda();
+
+	pa2m_nuevo_grupo(
+		"\n===================== HASH GENERICO =====================");
+	hash_generico_cuenta_con_valores_en_linea();
+	hash_generico_con_valores_struct_y_quitar();
+	hash_generico_actualizar_en_el_umbral_no_agranda();
+
+	pa2m_nuevo_grupo(
+		"\n======================== FILTRO ========================");
+	hash_con_filtro_responde_igual_que_sin_filtro();
+	hash_con_filtro_descarta_claves_ausentes();
+	hash_sin_filtro_no_tiene_estadisticas_de_filtro();
+
+	pa2m_nuevo_grupo(
+		"\n====================== COLISIONES ======================");
+	colisiones_pasan_a_un_arbol_y_vuelven_a_lista();
+	rehash_con_arboles_conserva_todas_las_claves();
+	claves_con_caracteres_no_ascii();
+
+	pa2m_nuevo_grupo(
+		"\n========================= LISTA =========================");
+	lista_insertar_y_quitar_en_posiciones_intermedias();
+	lista_quitar_nodos_por_referencia();
+	lista_quitar_elemento_que_cumple_la_condicion();
+	lista_quitar_si_quita_todos_los_que_cumplen();
+	lista_insertar_lote_agrega_todos_en_orden();
+	lista_concatenar_mueve_los_elementos_de_origen();
+	lista_concatenar_listas_cargadas_en_lote_no_copia_los_nodos();
+
+	pa2m_nuevo_grupo(
+		"\n===================== POOL DE NODOS =====================");
+	pool_reutiliza_los_objetos_liberados();
+	pool_preparar_reserva_solo_los_objetos_que_faltan();
+	hash_con_pool_de_nodos_funciona_igual();
+
+	pa2m_nuevo_grupo(
+		"\n===================== HASH COMPACTO =====================");
+	hash_compacto_inserta_reemplaza_y_quita();
+	hash_compacto_recorre_en_orden_de_insercion();
+
+	pa2m_nuevo_grupo(
+		"\n====================== HASH CUCKOO ======================");
+	hash_cuckoo_inserta_reemplaza_y_quita();
+	tabla_cuckoo_admite_factor_de_carga_alto();
+	tabla_cuckoo_devuelve_el_deposito_a_los_baldes_al_quitar();
+
+	pa2m_nuevo_grupo(
+		"\n======================= CAPACIDAD =======================");
+	hash_se_achica_al_quitar_casi_todos_los_elementos();
+	hash_reservar_evita_el_rehash_y_el_achique();
+	hash_con_factores_de_carga_propios();
+	hash_sin_listas_reserva_y_compacta();
+
+	pa2m_nuevo_grupo(
+		"\n========================= CLONES ========================");
+	hash_clonar_comparte_la_tabla_hasta_modificarla();
+	hash_clonar_permite_modificar_el_clon();
+
+	pa2m_nuevo_grupo(
+		"\n======================= CONJUNTOS =======================");
+	hash_fusionar_mueve_los_elementos_del_otro();
+	hash_interseccion_y_diferencia_crean_un_hash_nuevo();
+
+	pa2m_nuevo_grupo(
+		"\n======================= QUITAR SI =======================");
+	hash_quitar_si_quita_los_elementos_que_cumplen();
+
+	pa2m_nuevo_grupo(
+		"\n====================== HASH MULTI ======================");
+	hash_multi_guarda_los_valores_contiguos_en_orden();
+	hash_multi_recorre_y_destruye_los_valores();
+	hash_multi_reserva_los_grupos_con_el_alocador();
+
+	pa2m_nuevo_grupo(
+		"\n=================== HASH PRECALCULADO ===================");
+	hash_calcular_sirve_para_varios_hash();
+	hash_con_semilla_funciona_como_uno_sin_semilla();
+
+	pa2m_nuevo_grupo(
+		"\n==================== HASH COMPARTIDO ====================");
+	hash_compartido_se_comparte_entre_procesos();
+	hash_compartido_reemplaza_y_quita_sin_mover_valores();
+
+	pa2m_nuevo_grupo(
+		"\n=================== CALIDAD DEL HASH ===================");
+	calidad_distribucion_detecta_una_funcion_que_agrupa();
+	calidad_bits_mide_el_sesgo_y_la_avalancha();
+
+	pa2m_nuevo_grupo(
+		"\n======================== MEMORIA ========================");
+	hash_con_alocador_reserva_y_libera_todo_con_el();
+	hash_fusionar_con_alocador_usa_el_alocador_para_el_arreglo_temporal();
+	hash_quitar_si_con_alocador_usa_el_alocador_para_el_arreglo_temporal();
+	hash_con_limite_de_memoria_falla_sin_modificarse();
+	hash_sin_alocador_ni_limite_no_cuenta_memoria();
+
+	pa2m_nuevo_grupo(
+		"\n======================== DURABLE ========================");
+	hash_durable_recupera_las_operaciones_del_registro();
+	hash_durable_compacta_el_registro_en_una_instantanea();
+	hash_durable_descarta_una_operacion_escrita_a_medias();
+	hash_durable_descarta_una_sincronizacion_escrita_a_medias();
+
+	pa2m_nuevo_grupo(
+		"\n========================= CARGA =========================");
+	hash_cargar_archivo_separa_claves_y_valores();
+	hash_cargar_archivo_en_paralelo_respeta_el_orden();
+
+	pa2m_nuevo_grupo(
+		"\n======================= CONSULTAS =======================");
+	reunion_encuentra_todos_los_pares_con_la_misma_clave();
+	reunion_y_agrupacion_con_particiones_en_paralelo();
 
 	return pa2m_mostrar_reporte();
 }
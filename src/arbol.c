@@ -0,0 +1,424 @@
+#include <stdlib.h>
+#include "arbol.h"
+
+typedef struct nodo_arbol {
+	uint64_t hash;
+	void *elemento;
+	struct nodo_arbol *izquierda;
+	struct nodo_arbol *derecha;
+	int altura;
+} nodo_arbol_t;
+
+struct arbol {
+	nodo_arbol_t *raiz;
+	size_t tamanio;
+	int (*comparador)(void *, void *);
+	memoria_t *memoria;
+	size_t referencias_extra;
+};
+
+/*
+ * Crea un árbol vacío. El comparador recibe un elemento del árbol y una
+ * clave, y devuelve un número mayor que cero si el elemento es mayor, menor
+ * que cero si es menor, o cero si corresponde a la clave. El árbol y sus
+ * nodos se reservan con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al árbol creado o NULL en caso de error.
+ */
+arbol_t *arbol_crear(int (*comparador)(void *elemento, void *clave),
+		     memoria_t *memoria)
+{
+	if (!comparador)
+		return NULL;
+	arbol_t *arbol = memoria_reservar_ceros(memoria, 1, sizeof(arbol_t));
+	if (!arbol)
+		return NULL;
+	arbol->comparador = comparador;
+	arbol->memoria = memoria;
+	return arbol;
+}
+
+/**
+ * Recibe un árbol, un nodo, y el hash y la clave buscados.
+ *
+ * Devuelve un número mayor que cero si el nodo es mayor que lo buscado,
+ * menor que cero si es menor, o cero si es el nodo buscado.
+*/
+int comparar_con_nodo(arbol_t *arbol, nodo_arbol_t *nodo, uint64_t hash,
+		      void *clave)
+{
+	if (nodo->hash != hash)
+		return nodo->hash > hash ? 1 : -1;
+	return arbol->comparador(nodo->elemento, clave);
+}
+
+/**
+ * Devuelve la altura del nodo, o 0 si es NULL.
+*/
+int altura_nodo(nodo_arbol_t *nodo)
+{
+	return nodo ? nodo->altura : 0;
+}
+
+/**
+ * Recalcula la altura del nodo a partir de las de sus hijos.
+*/
+void actualizar_altura(nodo_arbol_t *nodo)
+{
+	int izquierda = altura_nodo(nodo->izquierda);
+	int derecha = altura_nodo(nodo->derecha);
+	nodo->altura = 1 + (izquierda > derecha ? izquierda : derecha);
+}
+
+/**
+ * Rota el subárbol hacia la derecha y devuelve su nueva raíz.
+*/
+nodo_arbol_t *rotar_a_derecha(nodo_arbol_t *nodo)
+{
+	nodo_arbol_t *nueva_raiz = nodo->izquierda;
+	nodo->izquierda = nueva_raiz->derecha;
+	nueva_raiz->derecha = nodo;
+	actualizar_altura(nodo);
+	actualizar_altura(nueva_raiz);
+	return nueva_raiz;
+}
+
+/**
+ * Rota el subárbol hacia la izquierda y devuelve su nueva raíz.
+*/
+nodo_arbol_t *rotar_a_izquierda(nodo_arbol_t *nodo)
+{
+	nodo_arbol_t *nueva_raiz = nodo->derecha;
+	nodo->derecha = nueva_raiz->izquierda;
+	nueva_raiz->izquierda = nodo;
+	actualizar_altura(nodo);
+	actualizar_altura(nueva_raiz);
+	return nueva_raiz;
+}
+
+/**
+ * Recibe la raíz de un subárbol cuyos hijos están balanceados, actualiza su
+ * altura y la rota si quedó desbalanceada.
+ *
+ * Devuelve la nueva raíz del subárbol.
+*/
+nodo_arbol_t *balancear(nodo_arbol_t *nodo)
+{
+	actualizar_altura(nodo);
+	int balance = altura_nodo(nodo->izquierda) - altura_nodo(nodo->derecha);
+	if (balance > 1) {
+		if (altura_nodo(nodo->izquierda->izquierda) <
+		    altura_nodo(nodo->izquierda->derecha))
+			nodo->izquierda = rotar_a_izquierda(nodo->izquierda);
+		return rotar_a_derecha(nodo);
+	}
+	if (balance < -1) {
+		if (altura_nodo(nodo->derecha->derecha) <
+		    altura_nodo(nodo->derecha->izquierda))
+			nodo->derecha = rotar_a_derecha(nodo->derecha);
+		return rotar_a_izquierda(nodo);
+	}
+	return nodo;
+}
+
+/**
+ * Recibe un árbol, la raíz de un subárbol y un nodo nuevo, e inserta el nodo
+ * en el subárbol.
+ *
+ * Devuelve la nueva raíz del subárbol.
+*/
+nodo_arbol_t *insertar_nodo(arbol_t *arbol, nodo_arbol_t *raiz,
+			    nodo_arbol_t *nuevo, void *clave)
+{
+	if (!raiz)
+		return nuevo;
+	if (comparar_con_nodo(arbol, raiz, nuevo->hash, clave) > 0)
+		raiz->izquierda =
+			insertar_nodo(arbol, raiz->izquierda, nuevo, clave);
+	else
+		raiz->derecha = insertar_nodo(arbol, raiz->derecha, nuevo, clave);
+	return balancear(raiz);
+}
+
+/*
+ * Inserta en el árbol un elemento (que no puede ser NULL) con el hash y la
+ * clave dados. La clave no debe estar en el árbol.
+ *
+ * Devuelve el árbol o NULL en caso de error.
+ */
+arbol_t *arbol_insertar(arbol_t *arbol, uint64_t hash, void *clave,
+			void *elemento)
+{
+	if (!arbol || !elemento)
+		return NULL;
+	nodo_arbol_t *nuevo =
+		memoria_reservar_ceros(arbol->memoria, 1, sizeof(nodo_arbol_t));
+	if (!nuevo)
+		return NULL;
+	nuevo->hash = hash;
+	nuevo->elemento = elemento;
+	nuevo->altura = 1;
+	arbol->raiz = insertar_nodo(arbol, arbol->raiz, nuevo, clave);
+	arbol->tamanio++;
+	return arbol;
+}
+
+/*
+ * Devuelve el elemento con el hash y la clave dados, o NULL si no está (o en
+ * caso de error).
+ */
+void *arbol_buscar(arbol_t *arbol, uint64_t hash, void *clave)
+{
+	if (!arbol)
+		return NULL;
+	nodo_arbol_t *actual = arbol->raiz;
+	while (actual) {
+		int comparacion = comparar_con_nodo(arbol, actual, hash, clave);
+		if (comparacion == 0)
+			return actual->elemento;
+		actual = comparacion > 0 ? actual->izquierda : actual->derecha;
+	}
+	return NULL;
+}
+
+/**
+ * Recibe la raíz de un subárbol no vacío y desengancha su nodo mínimo, que
+ * se guarda en *minimo.
+ *
+ * Devuelve la nueva raíz del subárbol.
+*/
+nodo_arbol_t *desenganchar_minimo(nodo_arbol_t *raiz, nodo_arbol_t **minimo)
+{
+	if (!raiz->izquierda) {
+		*minimo = raiz;
+		return raiz->derecha;
+	}
+	raiz->izquierda = desenganchar_minimo(raiz->izquierda, minimo);
+	return balancear(raiz);
+}
+
+/**
+ * Recibe un árbol, la raíz de un subárbol, y el hash y la clave a quitar.
+ * Quita el nodo correspondiente (si está), guardando su elemento en
+ * *quitado, y libera el nodo.
+ *
+ * Devuelve la nueva raíz del subárbol.
+*/
+nodo_arbol_t *quitar_nodo(arbol_t *arbol, nodo_arbol_t *raiz, uint64_t hash,
+			  void *clave, void **quitado)
+{
+	if (!raiz)
+		return NULL;
+	int comparacion = comparar_con_nodo(arbol, raiz, hash, clave);
+	if (comparacion > 0) {
+		raiz->izquierda = quitar_nodo(arbol, raiz->izquierda, hash,
+					      clave, quitado);
+		return balancear(raiz);
+	}
+	if (comparacion < 0) {
+		raiz->derecha =
+			quitar_nodo(arbol, raiz->derecha, hash, clave, quitado);
+		return balancear(raiz);
+	}
+	*quitado = raiz->elemento;
+	nodo_arbol_t *reemplazo = NULL;
+	if (!raiz->izquierda || !raiz->derecha) {
+		reemplazo = raiz->izquierda ? raiz->izquierda : raiz->derecha;
+	} else {
+		nodo_arbol_t *derecha =
+			desenganchar_minimo(raiz->derecha, &reemplazo);
+		reemplazo->derecha = derecha;
+		reemplazo->izquierda = raiz->izquierda;
+		reemplazo = balancear(reemplazo);
+	}
+	memoria_liberar(arbol->memoria, raiz);
+	return reemplazo;
+}
+
+/*
+ * Quita del árbol el elemento con el hash y la clave dados y lo devuelve.
+ *
+ * Devuelve NULL si no está o en caso de error.
+ */
+void *arbol_quitar(arbol_t *arbol, uint64_t hash, void *clave)
+{
+	if (!arbol)
+		return NULL;
+	void *quitado = NULL;
+	arbol->raiz = quitar_nodo(arbol, arbol->raiz, hash, clave, &quitado);
+	if (quitado)
+		arbol->tamanio--;
+	return quitado;
+}
+
+/*
+ * Devuelve la cantidad de elementos del árbol o 0 en caso de error.
+ */
+size_t arbol_tamanio(arbol_t *arbol)
+{
+	if (!arbol)
+		return 0;
+	return arbol->tamanio;
+}
+
+/**
+ * Recorre en orden el subárbol invocando a la función con cada elemento, y
+ * suma en *iterados la cantidad de elementos para los que devolvió true.
+ *
+ * Devuelve false si la función devolvió false (y el recorrido se cortó), o
+ * true en caso contrario.
+*/
+bool recorrer_en_orden(nodo_arbol_t *nodo, bool (*funcion)(void *, void *),
+		       void *aux, size_t *iterados)
+{
+	if (!nodo)
+		return true;
+	if (!recorrer_en_orden(nodo->izquierda, funcion, aux, iterados))
+		return false;
+	if (!funcion(nodo->elemento, aux))
+		return false;
+	(*iterados)++;
+	return recorrer_en_orden(nodo->derecha, funcion, aux, iterados);
+}
+
+/*
+ * Recorre los elementos del árbol en orden e invoca a la función con cada
+ * elemento y el puntero auxiliar, mientras la función devuelva true.
+ *
+ * Devuelve la cantidad de elementos iterados (igual que
+ * lista_con_cada_elemento, no cuenta al elemento para el que la función
+ * devolvió false) o 0 en caso de error.
+ */
+size_t arbol_con_cada_elemento(arbol_t *arbol, bool (*funcion)(void *, void *),
+			       void *aux)
+{
+	size_t iterados = 0;
+	if (!arbol || !funcion)
+		return iterados;
+	recorrer_en_orden(arbol->raiz, funcion, aux, &iterados);
+	return iterados;
+}
+
+/**
+ * Recorre en orden el subárbol, liberando los nodos cuyo elemento cumple el
+ * predicado (que suma en *quitados) y enganchando los demás en una cadena
+ * ordenada a través de su hijo derecho, cuyo final es *cola.
+ *
+ * Devuelve el nuevo final de la cadena.
+*/
+nodo_arbol_t **filtrar_en_orden(arbol_t *arbol, nodo_arbol_t *nodo,
+				bool (*predicado)(void *, void *), void *aux,
+				nodo_arbol_t **cola, size_t *quitados)
+{
+	if (!nodo)
+		return cola;
+	nodo_arbol_t *derecha = nodo->derecha;
+	cola = filtrar_en_orden(arbol, nodo->izquierda, predicado, aux, cola,
+				quitados);
+	if (predicado(nodo->elemento, aux)) {
+		memoria_liberar(arbol->memoria, nodo);
+		(*quitados)++;
+	} else {
+		*cola = nodo;
+		cola = &nodo->derecha;
+	}
+	return filtrar_en_orden(arbol, derecha, predicado, aux, cola,
+				quitados);
+}
+
+/**
+ * Recibe el principio de una cadena ordenada de al menos cantidad nodos
+ * (enlazados por su hijo derecho) y arma con los primeros cantidad un
+ * subárbol perfectamente balanceado, dejando en *cadena el resto.
+ *
+ * Devuelve la raíz del subárbol.
+*/
+nodo_arbol_t *armar_balanceado(nodo_arbol_t **cadena, size_t cantidad)
+{
+	if (cantidad == 0)
+		return NULL;
+	nodo_arbol_t *izquierda = armar_balanceado(cadena, cantidad / 2);
+	nodo_arbol_t *raiz = *cadena;
+	*cadena = raiz->derecha;
+	raiz->izquierda = izquierda;
+	raiz->derecha = armar_balanceado(cadena, cantidad - cantidad / 2 - 1);
+	actualizar_altura(raiz);
+	return raiz;
+}
+
+/*
+ * Quita del árbol todos los elementos para los que
+ * predicado(elemento, aux) devuelve true, invocándolo una vez con cada
+ * elemento, en orden.
+ *
+ * En lugar de quitar los nodos de a uno (rebalanceando cada vez), recorre el
+ * árbol una sola vez enganchando los nodos que quedan en una cadena
+ * ordenada, y con ella vuelve a armar un árbol balanceado, así que es O(n).
+ *
+ * Devuelve la cantidad de elementos quitados o 0 en caso de error.
+ */
+size_t arbol_quitar_si(arbol_t *arbol, bool (*predicado)(void *, void *),
+		       void *aux)
+{
+	if (!arbol || !predicado)
+		return 0;
+	size_t quitados = 0;
+	nodo_arbol_t *cadena = NULL;
+	nodo_arbol_t **cola = filtrar_en_orden(arbol, arbol->raiz, predicado,
+					       aux, &cadena, &quitados);
+	*cola = NULL;
+	arbol->tamanio -= quitados;
+	arbol->raiz = armar_balanceado(&cadena, arbol->tamanio);
+	return quitados;
+}
+
+/**
+ * Libera el subárbol de un árbol sin liberar sus elementos.
+*/
+void destruir_nodos(arbol_t *arbol, nodo_arbol_t *nodo)
+{
+	if (!nodo)
+		return;
+	destruir_nodos(arbol, nodo->izquierda);
+	destruir_nodos(arbol, nodo->derecha);
+	memoria_liberar(arbol->memoria, nodo);
+}
+
+/*
+ * Agrega una referencia al árbol, que desde ahora se comparte: cada
+ * arbol_destruir suelta una, y el árbol solo se destruye al soltar la
+ * última. Mientras el árbol esté compartido no debe modificarse.
+ *
+ * Devuelve el árbol, o NULL en caso de error.
+ */
+arbol_t *arbol_compartir(arbol_t *arbol)
+{
+	if (!arbol)
+		return NULL;
+	arbol->referencias_extra++;
+	return arbol;
+}
+
+/*
+ * Devuelve true si el árbol tiene más de una referencia (ver
+ * arbol_compartir) o false en caso contrario o de error.
+ */
+bool arbol_compartido(arbol_t *arbol)
+{
+	return arbol && arbol->referencias_extra > 0;
+}
+
+/*
+ * Destruye el árbol. No libera los elementos.
+ */
+void arbol_destruir(arbol_t *arbol)
+{
+	if (!arbol)
+		return;
+	if (arbol->referencias_extra > 0) {
+		arbol->referencias_extra--;
+		return;
+	}
+	destruir_nodos(arbol, arbol->raiz);
+	memoria_liberar(arbol->memoria, arbol);
+}
@@ -0,0 +1,97 @@
+#ifndef __ARBOL_H__
+#define __ARBOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "memoria.h"
+
+/*
+ * Árbol AVL de elementos ordenados por (hash, clave): primero por un hash de
+ * 64 bits y, si los hashes son iguales, con la función comparadora. Como el
+ * árbol se mantiene balanceado, buscar, insertar y quitar son O(log n) aunque
+ * todos los elementos tengan el mismo hash.
+ */
+typedef struct arbol arbol_t;
+
+/*
+ * Crea un árbol vacío. El comparador recibe un elemento del árbol y una
+ * clave, y devuelve un número mayor que cero si el elemento es mayor, menor
+ * que cero si es menor, o cero si corresponde a la clave. El árbol y sus
+ * nodos se reservan con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al árbol creado o NULL en caso de error.
+ */
+arbol_t *arbol_crear(int (*comparador)(void *elemento, void *clave),
+		     memoria_t *memoria);
+
+/*
+ * Inserta en el árbol un elemento (que no puede ser NULL) con el hash y la
+ * clave dados. La clave no debe estar en el árbol.
+ *
+ * Devuelve el árbol o NULL en caso de error.
+ */
+arbol_t *arbol_insertar(arbol_t *arbol, uint64_t hash, void *clave,
+			void *elemento);
+
+/*
+ * Devuelve el elemento con el hash y la clave dados, o NULL si no está (o en
+ * caso de error).
+ */
+void *arbol_buscar(arbol_t *arbol, uint64_t hash, void *clave);
+
+/*
+ * Quita del árbol el elemento con el hash y la clave dados y lo devuelve.
+ *
+ * Devuelve NULL si no está o en caso de error.
+ */
+void *arbol_quitar(arbol_t *arbol, uint64_t hash, void *clave);
+
+/*
+ * Quita del árbol todos los elementos para los que
+ * predicado(elemento, aux) devuelve true, invocándolo una vez con cada
+ * elemento, en orden. Es O(n): recorre el árbol una sola vez y vuelve a
+ * armarlo balanceado con los nodos que quedan.
+ *
+ * Devuelve la cantidad de elementos quitados o 0 en caso de error.
+ */
+size_t arbol_quitar_si(arbol_t *arbol, bool (*predicado)(void *, void *),
+		       void *aux);
+
+/*
+ * Devuelve la cantidad de elementos del árbol o 0 en caso de error.
+ */
+size_t arbol_tamanio(arbol_t *arbol);
+
+/*
+ * Recorre los elementos del árbol en orden e invoca a la función con cada
+ * elemento y el puntero auxiliar, mientras la función devuelva true.
+ *
+ * Devuelve la cantidad de elementos iterados (igual que
+ * lista_con_cada_elemento, no cuenta al elemento para el que la función
+ * devolvió false) o 0 en caso de error.
+ */
+size_t arbol_con_cada_elemento(arbol_t *arbol, bool (*funcion)(void *, void *),
+			       void *aux);
+
+/*
+ * Agrega una referencia al árbol, que desde ahora se comparte: cada
+ * arbol_destruir suelta una, y el árbol solo se destruye al soltar la
+ * última. Mientras el árbol esté compartido no debe modificarse.
+ *
+ * Devuelve el árbol, o NULL en caso de error.
+ */
+arbol_t *arbol_compartir(arbol_t *arbol);
+
+/*
+ * Devuelve true si el árbol tiene más de una referencia (ver
+ * arbol_compartir) o false en caso contrario o de error.
+ */
+bool arbol_compartido(arbol_t *arbol);
+
+/*
+ * Destruye el árbol. No libera los elementos.
+ */
+void arbol_destruir(arbol_t *arbol);
+
+#endif /* __ARBOL_H__ */
@@ -0,0 +1,277 @@
+#include <string.h>
+#include <stdlib.h>
+#include "hash.h"
+#include "cache_lru.h"
+
+#define CAPACIDAD_CACHE_INICIAL 16
+
+typedef struct entrada_lru {
+	void *valor;
+	size_t tamanio;
+	struct entrada_lru *anterior;
+	struct entrada_lru *siguiente;
+	char clave[];
+} entrada_lru_t;
+
+struct cache_lru {
+	hash_t *entradas;
+	entrada_lru_t *mas_reciente;
+	entrada_lru_t *menos_reciente;
+	size_t max_entradas;
+	size_t max_bytes;
+	size_t bytes;
+	void (*destructor)(void *);
+	cache_lru_estadisticas_t estadisticas;
+};
+
+/*
+ * Crea una cache que admite a lo sumo max_entradas elementos y a lo sumo
+ * max_bytes bytes. Un límite en 0 significa que ese límite no se controla.
+ *
+ * Las claves se guardan una sola vez, dentro de cada entrada, y el hash
+ * interno las usa como claves prestadas.
+ *
+ * Devuelve un puntero a la cache creada o NULL en caso de error.
+ */
+cache_lru_t *cache_lru_crear(size_t max_entradas, size_t max_bytes,
+			     void (*destructor)(void *))
+{
+	cache_lru_t *cache = calloc(1, sizeof(cache_lru_t));
+	if (!cache)
+		return NULL;
+	hash_opciones_t opciones = { .flags = HASH_CLAVES_PRESTADAS };
+	cache->entradas =
+		hash_crear_con_opciones(CAPACIDAD_CACHE_INICIAL, &opciones);
+	if (!cache->entradas) {
+		free(cache);
+		return NULL;
+	}
+	cache->max_entradas = max_entradas;
+	cache->max_bytes = max_bytes;
+	cache->destructor = destructor;
+	return cache;
+}
+
+/**
+ * Recibe una cache y una de sus entradas, y la desengancha de la lista de
+ * recencia.
+*/
+void desenganchar_entrada(cache_lru_t *cache, entrada_lru_t *entrada)
+{
+	if (entrada->anterior)
+		entrada->anterior->siguiente = entrada->siguiente;
+	else
+		cache->mas_reciente = entrada->siguiente;
+	if (entrada->siguiente)
+		entrada->siguiente->anterior = entrada->anterior;
+	else
+		cache->menos_reciente = entrada->anterior;
+	entrada->anterior = NULL;
+	entrada->siguiente = NULL;
+}
+
+/**
+ * Recibe una cache y una entrada desenganchada, y la engancha al principio
+ * de la lista de recencia (como la usada más recientemente).
+*/
+void enganchar_al_principio(cache_lru_t *cache, entrada_lru_t *entrada)
+{
+	entrada->anterior = NULL;
+	entrada->siguiente = cache->mas_reciente;
+	if (cache->mas_reciente)
+		cache->mas_reciente->anterior = entrada;
+	else
+		cache->menos_reciente = entrada;
+	cache->mas_reciente = entrada;
+}
+
+/**
+ * Recibe una cache y una de sus entradas, y la quita del hash y de la lista
+ * de recencia. Libera la entrada y devuelve su valor.
+*/
+void *quitar_entrada(cache_lru_t *cache, entrada_lru_t *entrada)
+{
+	hash_quitar(cache->entradas, entrada->clave);
+	desenganchar_entrada(cache, entrada);
+	cache->bytes -= entrada->tamanio;
+	void *valor = entrada->valor;
+	free(entrada);
+	return valor;
+}
+
+/**
+ * Recibe una cache y desaloja las entradas usadas hace más tiempo hasta que
+ * se respeten los límites de cantidad y de bytes.
+*/
+void desalojar_excedentes(cache_lru_t *cache)
+{
+	while (cache->menos_reciente &&
+	       ((cache->max_entradas &&
+		 hash_cantidad(cache->entradas) > cache->max_entradas) ||
+		(cache->max_bytes && cache->bytes > cache->max_bytes))) {
+		void *valor = quitar_entrada(cache, cache->menos_reciente);
+		if (cache->destructor)
+			cache->destructor(valor);
+		cache->estadisticas.desalojos++;
+	}
+}
+
+/**
+ * Recibe una cache, una clave, un elemento y su tamaño, y crea una entrada
+ * nueva que se inserta en el hash y al principio de la lista de recencia.
+ *
+ * Devuelve la entrada creada o NULL en caso de error.
+*/
+entrada_lru_t *agregar_entrada(cache_lru_t *cache, const char *clave,
+			       void *elemento, size_t tamanio)
+{
+	size_t largo = strlen(clave);
+	entrada_lru_t *entrada = malloc(sizeof(entrada_lru_t) + largo + 1);
+	if (!entrada)
+		return NULL;
+	memcpy(entrada->clave, clave, largo + 1);
+	entrada->valor = elemento;
+	entrada->tamanio = tamanio;
+	if (!hash_insertar(cache->entradas, entrada->clave, entrada, NULL)) {
+		free(entrada);
+		return NULL;
+	}
+	enganchar_al_principio(cache, entrada);
+	cache->bytes += tamanio;
+	return entrada;
+}
+
+/*
+ * Inserta o actualiza un elemento de la cache asociado a la clave dada, con
+ * el tamaño en bytes dado, y lo marca como el usado más recientemente. Si la
+ * clave ya existía, el elemento anterior se pasa a la función destructora.
+ *
+ * Si luego de insertar se excede algún límite, se desalojan los elementos
+ * usados hace más tiempo hasta volver a respetarlos.
+ *
+ * Devuelve la cache si pudo guardar el elemento o NULL si no pudo (o si el
+ * tamaño del elemento excede por sí solo el límite de bytes).
+ */
+cache_lru_t *cache_lru_insertar(cache_lru_t *cache, const char *clave,
+				void *elemento, size_t tamanio)
+{
+	if (!cache || !clave)
+		return NULL;
+	if (cache->max_bytes && tamanio > cache->max_bytes)
+		return NULL;
+	entrada_lru_t *entrada = hash_obtener(cache->entradas, clave);
+	if (entrada) {
+		void *anterior = entrada->valor;
+		entrada->valor = elemento;
+		cache->bytes = cache->bytes - entrada->tamanio + tamanio;
+		entrada->tamanio = tamanio;
+		desenganchar_entrada(cache, entrada);
+		enganchar_al_principio(cache, entrada);
+		if (cache->destructor && anterior != elemento)
+			cache->destructor(anterior);
+	} else if (!agregar_entrada(cache, clave, elemento, tamanio)) {
+		return NULL;
+	}
+	desalojar_excedentes(cache);
+	return cache;
+}
+
+/*
+ * Devuelve el elemento de la cache con la clave dada y lo marca como el
+ * usado más recientemente, o NULL si no existe (o en caso de error).
+ */
+void *cache_lru_obtener(cache_lru_t *cache, const char *clave)
+{
+	if (!cache || !clave)
+		return NULL;
+	entrada_lru_t *entrada = hash_obtener(cache->entradas, clave);
+	if (!entrada) {
+		cache->estadisticas.fallos++;
+		return NULL;
+	}
+	cache->estadisticas.aciertos++;
+	if (entrada != cache->mas_reciente) {
+		desenganchar_entrada(cache, entrada);
+		enganchar_al_principio(cache, entrada);
+	}
+	return entrada->valor;
+}
+
+/*
+ * Devuelve true si la cache contiene la clave dada o false en caso
+ * contrario. No modifica el orden de recencia ni las estadísticas.
+ */
+bool cache_lru_contiene(cache_lru_t *cache, const char *clave)
+{
+	if (!cache || !clave)
+		return false;
+	return hash_contiene(cache->entradas, clave);
+}
+
+/*
+ * Quita un elemento de la cache y lo devuelve, sin invocar la función
+ * destructora.
+ *
+ * Si no encuentra el elemento o en caso de error devuelve NULL.
+ */
+void *cache_lru_quitar(cache_lru_t *cache, const char *clave)
+{
+	if (!cache || !clave)
+		return NULL;
+	entrada_lru_t *entrada = hash_obtener(cache->entradas, clave);
+	if (!entrada)
+		return NULL;
+	return quitar_entrada(cache, entrada);
+}
+
+/*
+ * Devuelve la cantidad de elementos de la cache o 0 en caso de error.
+ */
+size_t cache_lru_cantidad(cache_lru_t *cache)
+{
+	if (!cache)
+		return 0;
+	return hash_cantidad(cache->entradas);
+}
+
+/*
+ * Devuelve la suma de los tamaños de los elementos de la cache o 0 en caso
+ * de error.
+ */
+size_t cache_lru_bytes(cache_lru_t *cache)
+{
+	if (!cache)
+		return 0;
+	return cache->bytes;
+}
+
+/*
+ * Devuelve la cantidad de aciertos y fallos de cache_lru_obtener, y la
+ * cantidad de elementos desalojados desde la creación de la cache.
+ */
+cache_lru_estadisticas_t cache_lru_estadisticas(cache_lru_t *cache)
+{
+	cache_lru_estadisticas_t vacias = { 0 };
+	if (!cache)
+		return vacias;
+	return cache->estadisticas;
+}
+
+/*
+ * Destruye la cache invocando la función destructora con cada elemento.
+ */
+void cache_lru_destruir(cache_lru_t *cache)
+{
+	if (!cache)
+		return;
+	entrada_lru_t *entrada = cache->mas_reciente;
+	while (entrada) {
+		entrada_lru_t *siguiente = entrada->siguiente;
+		if (cache->destructor)
+			cache->destructor(entrada->valor);
+		free(entrada);
+		entrada = siguiente;
+	}
+	hash_destruir(cache->entradas);
+	free(cache);
+}
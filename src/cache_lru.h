@@ -0,0 +1,89 @@
+#ifndef __CACHE_LRU_H__
+#define __CACHE_LRU_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Cache acotada con desalojo LRU (se desaloja el elemento usado hace más
+ * tiempo), construida sobre un hash y una lista doblemente enlazada
+ * intrusiva de recencia.
+ */
+typedef struct cache_lru cache_lru_t;
+
+typedef struct cache_lru_estadisticas {
+	size_t aciertos;
+	size_t fallos;
+	size_t desalojos;
+} cache_lru_estadisticas_t;
+
+/*
+ * Crea una cache que admite a lo sumo max_entradas elementos y a lo sumo
+ * max_bytes bytes (sumando el tamaño informado de cada elemento). Un límite
+ * en 0 significa que ese límite no se controla.
+ *
+ * La función destructora (si no es NULL) se invoca con cada elemento que se
+ * desaloja, se reemplaza o sigue en la cache al destruirla.
+ *
+ * Devuelve un puntero a la cache creada o NULL en caso de error.
+ */
+cache_lru_t *cache_lru_crear(size_t max_entradas, size_t max_bytes,
+			     void (*destructor)(void *));
+
+/*
+ * Inserta o actualiza un elemento de la cache asociado a la clave dada, con
+ * el tamaño en bytes dado, y lo marca como el usado más recientemente. Si la
+ * clave ya existía, el elemento anterior se pasa a la función destructora.
+ *
+ * Si luego de insertar se excede algún límite, se desalojan los elementos
+ * usados hace más tiempo hasta volver a respetarlos.
+ *
+ * Devuelve la cache si pudo guardar el elemento o NULL si no pudo (o si el
+ * tamaño del elemento excede por sí solo el límite de bytes).
+ */
+cache_lru_t *cache_lru_insertar(cache_lru_t *cache, const char *clave,
+				void *elemento, size_t tamanio);
+
+/*
+ * Devuelve el elemento de la cache con la clave dada y lo marca como el
+ * usado más recientemente, o NULL si no existe (o en caso de error).
+ */
+void *cache_lru_obtener(cache_lru_t *cache, const char *clave);
+
+/*
+ * Devuelve true si la cache contiene la clave dada o false en caso
+ * contrario. No modifica el orden de recencia ni las estadísticas.
+ */
+bool cache_lru_contiene(cache_lru_t *cache, const char *clave);
+
+/*
+ * Quita un elemento de la cache y lo devuelve, sin invocar la función
+ * destructora.
+ *
+ * Si no encuentra el elemento o en caso de error devuelve NULL.
+ */
+void *cache_lru_quitar(cache_lru_t *cache, const char *clave);
+
+/*
+ * Devuelve la cantidad de elementos de la cache o 0 en caso de error.
+ */
+size_t cache_lru_cantidad(cache_lru_t *cache);
+
+/*
+ * Devuelve la suma de los tamaños de los elementos de la cache o 0 en caso
+ * de error.
+ */
+size_t cache_lru_bytes(cache_lru_t *cache);
+
+/*
+ * Devuelve la cantidad de aciertos y fallos de cache_lru_obtener, y la
+ * cantidad de elementos desalojados desde la creación de la cache.
+ */
+cache_lru_estadisticas_t cache_lru_estadisticas(cache_lru_t *cache);
+
+/*
+ * Destruye la cache invocando la función destructora con cada elemento.
+ */
+void cache_lru_destruir(cache_lru_t *cache);
+
+#endif /* __CACHE_LRU_H__ */
@@ -0,0 +1,176 @@
+#include <stdlib.h>
+#include <string.h>
+#include "calidad_hash.h"
+
+/*
+ * El efecto avalancha se mide invirtiendo los bits de los primeros
+ * BYTES_AVALANCHA bytes de cada clave.
+ */
+#define BYTES_AVALANCHA 16
+#define BITS_ENTRADA (BYTES_AVALANCHA * 8)
+#define BITS_HASH 64
+
+/*
+ * Reparte las claves en una tabla con la cantidad de posiciones dada,
+ * contando las claves de cada posición, y guarda en *distribucion cómo
+ * quedaron repartidas.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+ */
+bool calidad_distribucion(const char *const *claves, size_t cantidad,
+			  funcion_calidad_t hash, size_t posiciones,
+			  calidad_distribucion_t *distribucion)
+{
+	if (!claves || !hash || posiciones < 2 || !distribucion)
+		return false;
+	size_t *listas = calloc(posiciones, sizeof(size_t));
+	if (!listas)
+		return false;
+	for (size_t i = 0; i < cantidad; i++)
+		listas[hash(claves[i]) % posiciones]++;
+	double esperado = (double)cantidad / (double)posiciones;
+	*distribucion = (calidad_distribucion_t){ 0 };
+	for (size_t i = 0; i < posiciones; i++) {
+		double diferencia = (double)listas[i] - esperado;
+		if (esperado > 0)
+			distribucion->chi_cuadrado +=
+				diferencia * diferencia / esperado;
+		if (listas[i] > distribucion->lista_mas_larga)
+			distribucion->lista_mas_larga = listas[i];
+		if (!listas[i])
+			distribucion->posiciones_vacias++;
+	}
+	distribucion->chi_cuadrado_relativo =
+		distribucion->chi_cuadrado / (double)(posiciones - 1);
+	free(listas);
+	return true;
+}
+
+/**
+ * Recibe el hash de una clave y el de la misma clave con el bit de entrada
+ * dado invertido, y suma en cambios[entrada][salida] los bits del hash que
+ * cambiaron.
+*/
+void contar_cambios(uint64_t original, uint64_t invertido, uint64_t mascara,
+		    unsigned entrada, size_t (*cambios)[BITS_HASH])
+{
+	uint64_t diferencia = (original ^ invertido) & mascara;
+	while (diferencia) {
+		cambios[entrada][__builtin_ctzll(diferencia)]++;
+		diferencia &= diferencia - 1;
+	}
+}
+
+/**
+ * Recibe una copia modificable de una clave y la función hash, e invierte
+ * de a uno los bits de sus primeros BYTES_AVALANCHA bytes (salvo los que
+ * la cortarían con un 0), contando en cambios los bits del hash que cambian y
+ * en pruebas cuántas veces se invirtió cada bit de entrada.
+*/
+void invertir_bits_de_clave(char *clave, funcion_calidad_t hash,
+			    uint64_t mascara, size_t (*cambios)[BITS_HASH],
+			    size_t *pruebas)
+{
+	uint64_t original = hash(clave);
+	size_t largo = strlen(clave);
+	for (size_t i = 0; i < largo && i < BYTES_AVALANCHA; i++) {
+		for (unsigned bit = 0; bit < 8; bit++) {
+			char byte = clave[i];
+			clave[i] = (char)(byte ^ (1 << bit));
+			if (clave[i]) {
+				unsigned entrada = (unsigned)i * 8 + bit;
+				contar_cambios(original, hash(clave), mascara,
+					       entrada, cambios);
+				pruebas[entrada]++;
+			}
+			clave[i] = byte;
+		}
+	}
+}
+
+/**
+ * Recibe la cantidad de veces que cada bit de entrada cambió cada bit del
+ * hash y cuántas veces se invirtió cada bit de entrada, y guarda en *bits
+ * la avalancha media y la peor.
+*/
+void resumir_avalancha(size_t (*cambios)[BITS_HASH], const size_t *pruebas,
+		       unsigned bits_salida, calidad_bits_t *bits)
+{
+	double suma = 0;
+	size_t celdas = 0;
+	for (unsigned entrada = 0; entrada < BITS_ENTRADA; entrada++) {
+		if (!pruebas[entrada])
+			continue;
+		for (unsigned salida = 0; salida < bits_salida; salida++) {
+			double probabilidad = (double)cambios[entrada][salida] /
+					      (double)pruebas[entrada];
+			double desvio = probabilidad > 0.5 ?
+						probabilidad - 0.5 :
+						0.5 - probabilidad;
+			if (desvio > bits->avalancha_peor)
+				bits->avalancha_peor = desvio;
+			suma += probabilidad;
+			celdas++;
+		}
+	}
+	bits->avalancha_media = celdas ? suma / (double)celdas : 0;
+}
+
+/*
+ * Mide el sesgo de los bits_salida bits bajos del hash sobre todas las
+ * claves, y el efecto avalancha sobre las primeras maximo_claves claves (o
+ * todas si es 0), copiando cada clave para poder invertir sus bits.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+ */
+bool calidad_bits(const char *const *claves, size_t cantidad,
+		  funcion_calidad_t hash, unsigned bits_salida,
+		  size_t maximo_claves, calidad_bits_t *bits)
+{
+	if (!claves || !cantidad || !hash || !bits_salida ||
+	    bits_salida > BITS_HASH || !bits)
+		return false;
+	uint64_t mascara = bits_salida == BITS_HASH ?
+				   UINT64_MAX :
+				   (UINT64_C(1) << bits_salida) - 1;
+	size_t unos[BITS_HASH] = { 0 };
+	size_t pruebas[BITS_ENTRADA] = { 0 };
+	size_t(*cambios)[BITS_HASH] = calloc(BITS_ENTRADA, sizeof(*cambios));
+	if (!cambios)
+		return false;
+	char *copia = NULL;
+	size_t capacidad_copia = 0;
+	bool ok = true;
+	if (!maximo_claves || maximo_claves > cantidad)
+		maximo_claves = cantidad;
+	for (size_t i = 0; i < cantidad; i++) {
+		uint64_t valor = hash(claves[i]) & mascara;
+		for (unsigned bit = 0; bit < bits_salida; bit++)
+			unos[bit] += (valor >> bit) & 1;
+		if (i >= maximo_claves)
+			continue;
+		size_t largo = strlen(claves[i]) + 1;
+		if (largo > capacidad_copia) {
+			char *agrandada = realloc(copia, largo * 2);
+			ok = agrandada != NULL;
+			if (!ok)
+				break;
+			copia = agrandada;
+			capacidad_copia = largo * 2;
+		}
+		memcpy(copia, claves[i], largo);
+		invertir_bits_de_clave(copia, hash, mascara, cambios, pruebas);
+	}
+	*bits = (calidad_bits_t){ 0 };
+	for (unsigned bit = 0; bit < bits_salida; bit++) {
+		double proporcion = (double)unos[bit] / (double)cantidad;
+		double sesgo = proporcion > 0.5 ? proporcion - 0.5 :
+						  0.5 - proporcion;
+		if (sesgo > bits->sesgo_maximo)
+			bits->sesgo_maximo = sesgo;
+	}
+	resumir_avalancha(cambios, pruebas, bits_salida, bits);
+	free(cambios);
+	free(copia);
+	return ok;
+}
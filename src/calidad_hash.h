@@ -0,0 +1,71 @@
+#ifndef __CALIDAD_HASH_H__
+#define __CALIDAD_HASH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Medidas de la calidad de una función hash sobre un conjunto real de
+ * claves, para comparar funciones antes de cambiar la que usa el hash (ver
+ * analizador.c). La función hash recibe una clave y devuelve su hash, del
+ * que la posición en una tabla de n posiciones es hash % n, como en hash_t.
+ */
+typedef uint64_t (*funcion_calidad_t)(const char *clave);
+
+/*
+ * Distribución de las claves en una tabla.
+ *
+ * chi_cuadrado compara la cantidad de claves de cada posición con la que
+ * tendría una función uniforme, y chi_cuadrado_relativo es chi_cuadrado
+ * dividido por sus grados de libertad (posiciones - 1): cerca de 1 para una
+ * función uniforme, y cuanto más grande, peor.
+ */
+typedef struct calidad_distribucion {
+	double chi_cuadrado;
+	double chi_cuadrado_relativo;
+	size_t lista_mas_larga;
+	size_t posiciones_vacias;
+} calidad_distribucion_t;
+
+/*
+ * Calidad de los bits del hash, mirando solo los bits_salida bits bajos.
+ *
+ * sesgo_maximo es, entre todos los bits, la mayor diferencia entre la
+ * proporción de claves que lo tienen en 1 y 0.5 (0 es ideal y 0.5 es un bit
+ * que nunca cambia).
+ *
+ * Para medir el efecto avalancha se invierte, de a uno, cada bit de los
+ * primeros bytes de cada clave, y se cuenta qué bits del hash cambian.
+ * avalancha_media es la proporción de bits del hash que cambian en
+ * promedio (0.5 es ideal), y avalancha_peor es la mayor diferencia con 0.5
+ * de la probabilidad de que un bit de la clave cambie un bit del hash.
+ */
+typedef struct calidad_bits {
+	double sesgo_maximo;
+	double avalancha_media;
+	double avalancha_peor;
+} calidad_bits_t;
+
+/*
+ * Reparte las claves en una tabla con la cantidad de posiciones dada y
+ * guarda en *distribucion cómo quedaron repartidas.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+ */
+bool calidad_distribucion(const char *const *claves, size_t cantidad,
+			  funcion_calidad_t hash, size_t posiciones,
+			  calidad_distribucion_t *distribucion);
+
+/*
+ * Mide el sesgo de los bits_salida bits bajos del hash (entre 1 y 64) sobre
+ * todas las claves, y el efecto avalancha sobre las primeras maximo_claves
+ * claves (o todas si es 0), y lo guarda en *bits.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+ */
+bool calidad_bits(const char *const *claves, size_t cantidad,
+		  funcion_calidad_t hash, unsigned bits_salida,
+		  size_t maximo_claves, calidad_bits_t *bits);
+
+#endif /* __CALIDAD_HASH_H__ */
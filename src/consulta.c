@@ -0,0 +1,597 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "hash.h"
+#include "pool.h"
+#include "funciones_hash.h"
+#include "consulta.h"
+
+/*
+ * Cada partición debería tener a lo sumo BYTES_CACHE bytes de hash, contando
+ * BYTES_POR_ELEMENTO por elemento (el par, el nodo de la lista o del árbol,
+ * y el eslabón o el agregado).
+ */
+#define BYTES_CACHE (256 * 1024)
+#define BYTES_POR_ELEMENTO 96
+#define MAXIMO_BITS_PARTICION 10
+#define COINCIDENCIAS_INICIALES 64
+
+typedef struct eslabon_reunion {
+	const consulta_fila_t *fila;
+	struct eslabon_reunion *siguiente;
+} eslabon_reunion_t;
+
+/*
+ * Una partición es un hash propio, y un pool para los eslabones (en las
+ * reuniones) o los agregados (en las agrupaciones), así que dos hilos que
+ * procesan particiones distintas nunca comparten memoria.
+ */
+typedef struct particion {
+	hash_t *hash;
+	pool_t *pool;
+} particion_t;
+
+struct reunion {
+	particion_t *particiones;
+	unsigned int bits;
+	size_t hilos;
+};
+
+struct agrupacion {
+	particion_t *particiones;
+	unsigned int bits;
+	size_t hilos;
+};
+
+/*
+ * Filas de un lote ordenadas por partición: las de la partición p son
+ * indices[inicios[p]] hasta indices[inicios[p + 1]] (sin incluirla).
+ */
+typedef struct reparto {
+	size_t *inicios;
+	size_t *indices;
+} reparto_t;
+
+/**
+ * Recibe la cantidad de elementos que se espera guardar.
+ *
+ * Devuelve la cantidad de bits de partición necesaria para que cada
+ * partición entre en BYTES_CACHE.
+*/
+unsigned int bits_de_particion(size_t elementos)
+{
+	unsigned int bits = 0;
+	while (bits < MAXIMO_BITS_PARTICION &&
+	       (elementos >> bits) * BYTES_POR_ELEMENTO > BYTES_CACHE)
+		bits++;
+	return bits;
+}
+
+/**
+ * Devuelve la partición de la clave (los bits altos de su hash FNV-1a).
+*/
+size_t particion_de_clave(const char *clave, unsigned int bits)
+{
+	if (!bits)
+		return 0;
+	return (size_t)(hash_fnv1a(clave) >> (64 - bits));
+}
+
+/**
+ * Devuelve la cantidad de hilos pedida, o la cantidad de procesadores si es
+ * 0.
+*/
+size_t hilos_o_procesadores(size_t hilos)
+{
+	if (hilos)
+		return hilos;
+	long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+	return procesadores > 0 ? (size_t)procesadores : 1;
+}
+
+/**
+ * Libera un reparto.
+*/
+void liberar_reparto(reparto_t *reparto)
+{
+	free(reparto->inicios);
+	free(reparto->indices);
+}
+
+/**
+ * Recibe las filas de un lote y reparte sus índices por partición con un
+ * histograma y una sola pasada de distribución (radix).
+ *
+ * Devuelve true si pudo o false en caso de error.
+*/
+bool repartir_filas(const consulta_fila_t *filas, size_t cantidad,
+		    unsigned int bits, reparto_t *reparto)
+{
+	size_t particiones = (size_t)1 << bits;
+	size_t filas_reservadas = cantidad ? cantidad : 1;
+	reparto->inicios = calloc(particiones + 1, sizeof(size_t));
+	reparto->indices = malloc(filas_reservadas * sizeof(size_t));
+	uint16_t *destinos = malloc(filas_reservadas * sizeof(uint16_t));
+	size_t *siguientes = malloc(particiones * sizeof(size_t));
+	if (!reparto->inicios || !reparto->indices || !destinos ||
+	    !siguientes) {
+		liberar_reparto(reparto);
+		free(destinos);
+		free(siguientes);
+		return false;
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		destinos[i] = (uint16_t)particion_de_clave(filas[i].clave, bits);
+		reparto->inicios[destinos[i] + 1]++;
+	}
+	for (size_t p = 0; p < particiones; p++)
+		reparto->inicios[p + 1] += reparto->inicios[p];
+	for (size_t p = 0; p < particiones; p++)
+		siguientes[p] = reparto->inicios[p];
+	for (size_t i = 0; i < cantidad; i++)
+		reparto->indices[siguientes[destinos[i]]++] = i;
+	free(siguientes);
+	free(destinos);
+	return true;
+}
+
+typedef struct trabajo_paralelo {
+	size_t tareas;
+	atomic_size_t siguiente;
+	void (*funcion)(size_t tarea, void *aux);
+	void *aux;
+} trabajo_paralelo_t;
+
+/**
+ * Recibe un trabajo_paralelo_t y ejecuta tareas del trabajo (tomando cada
+ * vez la siguiente que nadie tomó) hasta que no quedan.
+ *
+ * Es la función que corre cada hilo, y siempre devuelve NULL.
+*/
+void *ejecutar_tareas(void *argumento)
+{
+	trabajo_paralelo_t *trabajo = argumento;
+	size_t tarea;
+	while ((tarea = atomic_fetch_add(&trabajo->siguiente, 1)) <
+	       trabajo->tareas)
+		trabajo->funcion(tarea, trabajo->aux);
+	return NULL;
+}
+
+/**
+ * Ejecuta la función con cada tarea entre 0 y tareas (sin incluirla),
+ * repartiendo las tareas entre la cantidad de hilos dada (contando al hilo
+ * que llama). Si no se pueden crear todos los hilos, se usan menos.
+*/
+void ejecutar_en_paralelo(size_t tareas, size_t hilos,
+			  void (*funcion)(size_t tarea, void *aux), void *aux)
+{
+	trabajo_paralelo_t trabajo = { .tareas = tareas,
+				       .funcion = funcion,
+				       .aux = aux };
+	atomic_init(&trabajo.siguiente, 0);
+	if (hilos > tareas)
+		hilos = tareas;
+	pthread_t *creados = hilos > 1 ? calloc(hilos - 1, sizeof(pthread_t)) :
+					 NULL;
+	size_t cantidad_creados = 0;
+	while (creados && cantidad_creados + 1 < hilos &&
+	       pthread_create(&creados[cantidad_creados], NULL,
+			      ejecutar_tareas, &trabajo) == 0)
+		cantidad_creados++;
+	ejecutar_tareas(&trabajo);
+	for (size_t i = 0; i < cantidad_creados; i++)
+		pthread_join(creados[i], NULL);
+	free(creados);
+}
+
+/**
+ * Recibe un arreglo de particiones y las destruye.
+*/
+void destruir_particiones(particion_t *particiones, unsigned int bits)
+{
+	if (!particiones)
+		return;
+	for (size_t p = 0; p < (size_t)1 << bits; p++) {
+		hash_destruir(particiones[p].hash);
+		pool_destruir(particiones[p].pool);
+	}
+	free(particiones);
+}
+
+/**
+ * Recibe la cantidad de bits de partición, las opciones del hash de cada
+ * partición y el tamaño de los objetos de su pool.
+ *
+ * Devuelve un arreglo de particiones vacías, o NULL en caso de error.
+*/
+particion_t *crear_particiones(unsigned int bits, unsigned int flags,
+			       size_t tamanio_objeto)
+{
+	size_t cantidad = (size_t)1 << bits;
+	particion_t *particiones = calloc(cantidad, sizeof(particion_t));
+	if (!particiones)
+		return NULL;
+	hash_opciones_t opciones = { .flags = flags };
+	for (size_t p = 0; p < cantidad; p++) {
+		particiones[p].hash = hash_crear_con_opciones(3, &opciones);
+		particiones[p].pool = pool_crear(tamanio_objeto);
+		if (!particiones[p].hash || !particiones[p].pool) {
+			destruir_particiones(particiones, bits);
+			return NULL;
+		}
+	}
+	return particiones;
+}
+
+typedef struct construccion_reunion {
+	reunion_t *reunion;
+	const consulta_fila_t *filas;
+	reparto_t reparto;
+	bool *errores;
+} construccion_reunion_t;
+
+/**
+ * Recibe el número de una partición y una construccion_reunion_t, y carga
+ * en el hash de la partición las filas de construcción que le tocan. Cada
+ * clave guarda una cadena de eslabones con todas sus filas.
+*/
+void construir_particion(size_t p, void *aux)
+{
+	construccion_reunion_t *construccion = aux;
+	particion_t *particion = &construccion->reunion->particiones[p];
+	size_t inicio = construccion->reparto.inicios[p];
+	size_t fin = construccion->reparto.inicios[p + 1];
+	bool ok = hash_reservar(particion->hash, fin - inicio) &&
+		  pool_preparar(particion->pool, fin - inicio);
+	for (size_t i = inicio; ok && i < fin; i++) {
+		const consulta_fila_t *fila =
+			&construccion->filas[construccion->reparto.indices[i]];
+		eslabon_reunion_t *eslabon = pool_reservar(particion->pool);
+		ok = eslabon != NULL;
+		if (!ok)
+			break;
+		void *anterior = NULL;
+		eslabon->fila = fila;
+		ok = hash_insertar(particion->hash, fila->clave, eslabon,
+				   &anterior) != NULL;
+		eslabon->siguiente = anterior;
+	}
+	construccion->errores[p] = !ok;
+}
+
+/*
+ * Crea una reunión cuyo lado de construcción son las filas dadas: las
+ * reparte en particiones y carga cada partición en paralelo. Los hash de las
+ * particiones usan claves prestadas (las de las filas).
+ *
+ * Devuelve la reunión o NULL en caso de error.
+ */
+reunion_t *reunion_crear(const consulta_fila_t *filas, size_t cantidad,
+			 size_t hilos)
+{
+	if (!filas && cantidad)
+		return NULL;
+	reunion_t *reunion = calloc(1, sizeof(reunion_t));
+	if (!reunion)
+		return NULL;
+	reunion->bits = bits_de_particion(cantidad);
+	reunion->hilos = hilos_o_procesadores(hilos);
+	size_t particiones = (size_t)1 << reunion->bits;
+	reunion->particiones = crear_particiones(
+		reunion->bits, HASH_CLAVES_PRESTADAS, sizeof(eslabon_reunion_t));
+	construccion_reunion_t construccion = { .reunion = reunion,
+						.filas = filas };
+	construccion.errores = calloc(particiones, sizeof(bool));
+	bool ok = reunion->particiones && construccion.errores &&
+		  repartir_filas(filas, cantidad, reunion->bits,
+				 &construccion.reparto);
+	if (ok) {
+		ejecutar_en_paralelo(particiones, reunion->hilos,
+				     construir_particion, &construccion);
+		liberar_reparto(&construccion.reparto);
+		for (size_t p = 0; p < particiones; p++)
+			ok = ok && !construccion.errores[p];
+	}
+	free(construccion.errores);
+	if (!ok) {
+		reunion_destruir(reunion);
+		return NULL;
+	}
+	return reunion;
+}
+
+/*
+ * Pares de filas encontrados en una partición (construida y sondeada,
+ * alternadas).
+ */
+typedef struct coincidencias {
+	const consulta_fila_t **filas;
+	size_t cantidad;
+	size_t capacidad;
+	bool error;
+} coincidencias_t;
+
+typedef struct sondeo_reunion {
+	reunion_t *reunion;
+	const consulta_fila_t *filas;
+	reparto_t reparto;
+	coincidencias_t *coincidencias;
+} sondeo_reunion_t;
+
+/**
+ * Recibe las coincidencias de una partición y les agrega un par de filas.
+*/
+void agregar_coincidencia(coincidencias_t *coincidencias,
+			  const consulta_fila_t *construida,
+			  const consulta_fila_t *sondeada)
+{
+	if (coincidencias->cantidad == coincidencias->capacidad) {
+		size_t capacidad = coincidencias->capacidad ?
+					   coincidencias->capacidad * 2 :
+					   COINCIDENCIAS_INICIALES;
+		const consulta_fila_t **filas =
+			realloc(coincidencias->filas,
+				capacidad * 2 * sizeof(consulta_fila_t *));
+		if (!filas) {
+			coincidencias->error = true;
+			return;
+		}
+		coincidencias->filas = filas;
+		coincidencias->capacidad = capacidad;
+	}
+	coincidencias->filas[2 * coincidencias->cantidad] = construida;
+	coincidencias->filas[2 * coincidencias->cantidad + 1] = sondeada;
+	coincidencias->cantidad++;
+}
+
+/**
+ * Recibe el número de una partición y un sondeo_reunion_t, y busca en el
+ * hash de la partición las filas sondeadas que le tocan, guardando los pares
+ * que encuentra.
+*/
+void sondear_particion(size_t p, void *aux)
+{
+	sondeo_reunion_t *sondeo = aux;
+	particion_t *particion = &sondeo->reunion->particiones[p];
+	coincidencias_t *coincidencias = &sondeo->coincidencias[p];
+	for (size_t i = sondeo->reparto.inicios[p];
+	     i < sondeo->reparto.inicios[p + 1] && !coincidencias->error; i++) {
+		const consulta_fila_t *sondeada =
+			&sondeo->filas[sondeo->reparto.indices[i]];
+		for (eslabon_reunion_t *eslabon =
+			     hash_obtener(particion->hash, sondeada->clave);
+		     eslabon; eslabon = eslabon->siguiente)
+			agregar_coincidencia(coincidencias, eslabon->fila,
+					     sondeada);
+	}
+}
+
+/*
+ * Reparte el lote en particiones, busca cada partición en paralelo guardando
+ * los pares encontrados, y después invoca a la función con cada par desde
+ * este hilo, así que la función no necesita sincronizarse.
+ *
+ * Devuelve la cantidad de pares encontrados o 0 en caso de error.
+ */
+size_t reunion_sondear(reunion_t *reunion, const consulta_fila_t *filas,
+		       size_t cantidad,
+		       void (*funcion)(const consulta_fila_t *construida,
+				       const consulta_fila_t *sondeada,
+				       void *aux),
+		       void *aux)
+{
+	if (!reunion || !funcion || (!filas && cantidad))
+		return 0;
+	size_t particiones = (size_t)1 << reunion->bits;
+	sondeo_reunion_t sondeo = { .reunion = reunion, .filas = filas };
+	sondeo.coincidencias = calloc(particiones, sizeof(coincidencias_t));
+	if (!sondeo.coincidencias ||
+	    !repartir_filas(filas, cantidad, reunion->bits, &sondeo.reparto)) {
+		free(sondeo.coincidencias);
+		return 0;
+	}
+	ejecutar_en_paralelo(particiones, reunion->hilos, sondear_particion,
+			     &sondeo);
+	liberar_reparto(&sondeo.reparto);
+	bool ok = true;
+	for (size_t p = 0; p < particiones; p++)
+		ok = ok && !sondeo.coincidencias[p].error;
+	size_t total = 0;
+	for (size_t p = 0; p < particiones; p++) {
+		coincidencias_t *coincidencias = &sondeo.coincidencias[p];
+		for (size_t i = 0; ok && i < coincidencias->cantidad; i++)
+			funcion(coincidencias->filas[2 * i],
+				coincidencias->filas[2 * i + 1], aux);
+		total += coincidencias->cantidad;
+		free(coincidencias->filas);
+	}
+	free(sondeo.coincidencias);
+	return ok ? total : 0;
+}
+
+/*
+ * Destruye la reunión (sin liberar las filas).
+ */
+void reunion_destruir(reunion_t *reunion)
+{
+	if (!reunion)
+		return;
+	destruir_particiones(reunion->particiones, reunion->bits);
+	free(reunion);
+}
+
+/*
+ * Crea una agrupación vacía con una partición por cada BYTES_CACHE de
+ * grupos estimados.
+ *
+ * Devuelve la agrupación o NULL en caso de error.
+ */
+agrupacion_t *agrupacion_crear(size_t grupos_estimados, size_t hilos)
+{
+	agrupacion_t *agrupacion = calloc(1, sizeof(agrupacion_t));
+	if (!agrupacion)
+		return NULL;
+	agrupacion->bits = bits_de_particion(grupos_estimados);
+	agrupacion->hilos = hilos_o_procesadores(hilos);
+	agrupacion->particiones =
+		crear_particiones(agrupacion->bits, 0, sizeof(agregado_t));
+	if (!agrupacion->particiones) {
+		free(agrupacion);
+		return NULL;
+	}
+	return agrupacion;
+}
+
+typedef struct agregacion {
+	agrupacion_t *agrupacion;
+	const consulta_fila_t *filas;
+	reparto_t reparto;
+	bool *errores;
+} agregacion_t;
+
+/**
+ * Recibe el número de una partición y un agregacion_t, y agrega las filas
+ * que le tocan a los grupos de la partición.
+*/
+void agregar_particion(size_t p, void *aux)
+{
+	agregacion_t *agregacion = aux;
+	particion_t *particion = &agregacion->agrupacion->particiones[p];
+	bool ok = true;
+	for (size_t i = agregacion->reparto.inicios[p];
+	     ok && i < agregacion->reparto.inicios[p + 1]; i++) {
+		const consulta_fila_t *fila =
+			&agregacion->filas[agregacion->reparto.indices[i]];
+		agregado_t *agregado = hash_obtener(particion->hash, fila->clave);
+		if (!agregado) {
+			agregado = pool_reservar(particion->pool);
+			ok = agregado && hash_insertar(particion->hash,
+						       fila->clave, agregado,
+						       NULL);
+			if (!ok) {
+				pool_liberar(particion->pool, agregado);
+				break;
+			}
+			*agregado = (agregado_t){ .minimo = fila->valor,
+						  .maximo = fila->valor };
+		}
+		agregado->cantidad++;
+		agregado->suma += fila->valor;
+		if (fila->valor < agregado->minimo)
+			agregado->minimo = fila->valor;
+		if (fila->valor > agregado->maximo)
+			agregado->maximo = fila->valor;
+	}
+	agregacion->errores[p] = !ok;
+}
+
+/*
+ * Reparte el lote en particiones y agrega cada partición en paralelo.
+ *
+ * Devuelve true si pudo o false en caso de error.
+ */
+bool agrupacion_agregar(agrupacion_t *agrupacion, const consulta_fila_t *filas,
+			size_t cantidad)
+{
+	if (!agrupacion || (!filas && cantidad))
+		return false;
+	size_t particiones = (size_t)1 << agrupacion->bits;
+	agregacion_t agregacion = { .agrupacion = agrupacion, .filas = filas };
+	agregacion.errores = calloc(particiones, sizeof(bool));
+	if (!agregacion.errores ||
+	    !repartir_filas(filas, cantidad, agrupacion->bits,
+			    &agregacion.reparto)) {
+		free(agregacion.errores);
+		return false;
+	}
+	ejecutar_en_paralelo(particiones, agrupacion->hilos, agregar_particion,
+			     &agregacion);
+	liberar_reparto(&agregacion.reparto);
+	bool ok = true;
+	for (size_t p = 0; p < particiones; p++)
+		ok = ok && !agregacion.errores[p];
+	free(agregacion.errores);
+	return ok;
+}
+
+/*
+ * Devuelve los agregados del grupo con la clave dada o NULL si no existe.
+ */
+const agregado_t *agrupacion_obtener(agrupacion_t *agrupacion,
+				     const char *clave)
+{
+	if (!agrupacion || !clave)
+		return NULL;
+	size_t p = particion_de_clave(clave, agrupacion->bits);
+	return hash_obtener(agrupacion->particiones[p].hash, clave);
+}
+
+/*
+ * Devuelve la cantidad de grupos o 0 en caso de error.
+ */
+size_t agrupacion_cantidad(agrupacion_t *agrupacion)
+{
+	if (!agrupacion)
+		return 0;
+	size_t cantidad = 0;
+	for (size_t p = 0; p < (size_t)1 << agrupacion->bits; p++)
+		cantidad += hash_cantidad(agrupacion->particiones[p].hash);
+	return cantidad;
+}
+
+typedef struct recorrido_grupos {
+	bool (*funcion)(const char *clave, const agregado_t *agregado,
+			void *aux);
+	void *aux;
+	bool cortado;
+} recorrido_grupos_t;
+
+/**
+ * Recibe una clave, su agregado y un recorrido_grupos_t, e invoca a la
+ * función del recorrido, anotando si devolvió false.
+*/
+bool visitar_grupo(const char *clave, void *agregado, void *aux)
+{
+	recorrido_grupos_t *recorrido = aux;
+	recorrido->cortado =
+		!recorrido->funcion(clave, agregado, recorrido->aux);
+	return !recorrido->cortado;
+}
+
+/*
+ * Recorre los grupos de cada partición, mientras la función devuelva true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función o 0 en caso de
+ * error.
+ */
+size_t agrupacion_con_cada_grupo(agrupacion_t *agrupacion,
+				 bool (*funcion)(const char *clave,
+						 const agregado_t *agregado,
+						 void *aux),
+				 void *aux)
+{
+	if (!agrupacion || !funcion)
+		return 0;
+	recorrido_grupos_t recorrido = { .funcion = funcion, .aux = aux };
+	size_t invocaciones = 0;
+	for (size_t p = 0; p < (size_t)1 << agrupacion->bits && !recorrido.cortado;
+	     p++)
+		invocaciones += hash_con_cada_clave(
+			agrupacion->particiones[p].hash, visitar_grupo,
+			&recorrido);
+	return invocaciones;
+}
+
+/*
+ * Destruye la agrupación.
+ */
+void agrupacion_destruir(agrupacion_t *agrupacion)
+{
+	if (!agrupacion)
+		return;
+	destruir_particiones(agrupacion->particiones, agrupacion->bits);
+	free(agrupacion);
+}
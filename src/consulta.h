@@ -0,0 +1,117 @@
+#ifndef __CONSULTA_H__
+#define __CONSULTA_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Reuniones (hash join) y agrupaciones (group by) sobre hash_t. Las filas se
+ * reparten por los bits altos del hash de su clave en particiones lo
+ * bastante chicas como para que el hash de cada una entre en la cache, y
+ * las particiones se procesan en paralelo, cada una en un único hilo.
+ */
+
+/*
+ * Fila de una reunión o una agrupación: la clave, un dato del usuario (que
+ * usan las reuniones) y un valor numérico (que usan las agrupaciones).
+ */
+typedef struct consulta_fila {
+	const char *clave;
+	void *dato;
+	double valor;
+} consulta_fila_t;
+
+/*
+ * Agregados de las filas de un grupo.
+ */
+typedef struct agregado {
+	size_t cantidad;
+	double suma;
+	double minimo;
+	double maximo;
+} agregado_t;
+
+typedef struct reunion reunion_t;
+typedef struct agrupacion agrupacion_t;
+
+/*
+ * Crea una reunión cuyo lado de construcción son las filas dadas, usando la
+ * cantidad de hilos dada (o uno por procesador si es 0). Las filas no se
+ * copian, así que deben seguir existiendo (sin modificarse) mientras exista
+ * la reunión. Una clave puede repetirse en varias filas.
+ *
+ * Devuelve la reunión o NULL en caso de error.
+ */
+reunion_t *reunion_crear(const consulta_fila_t *filas, size_t cantidad,
+			 size_t hilos);
+
+/*
+ * Busca cada una de las filas dadas (un lote del lado de sondeo) entre las
+ * filas de construcción, e invoca a la función con cada par de filas con la
+ * misma clave y el puntero auxiliar. La función se invoca desde el hilo que
+ * llama a reunion_sondear, con los pares en un orden cualquiera.
+ *
+ * Devuelve la cantidad de pares encontrados o 0 en caso de error.
+ */
+size_t reunion_sondear(reunion_t *reunion, const consulta_fila_t *filas,
+		       size_t cantidad,
+		       void (*funcion)(const consulta_fila_t *construida,
+				       const consulta_fila_t *sondeada,
+				       void *aux),
+		       void *aux);
+
+/*
+ * Destruye la reunión (sin liberar las filas).
+ */
+void reunion_destruir(reunion_t *reunion);
+
+/*
+ * Crea una agrupación vacía, que espera tener alrededor de grupos_estimados
+ * grupos (para decidir cuántas particiones usar) y agrega usando la cantidad
+ * de hilos dada (o uno por procesador si es 0).
+ *
+ * Devuelve la agrupación o NULL en caso de error.
+ */
+agrupacion_t *agrupacion_crear(size_t grupos_estimados, size_t hilos);
+
+/*
+ * Agrega el valor de cada una de las filas dadas (un lote) al grupo de su
+ * clave, creando los grupos que no existían. Las claves se copian.
+ *
+ * Devuelve true si pudo agregarlas o false en caso de error (en cuyo caso
+ * algunas filas pueden haberse agregado).
+ */
+bool agrupacion_agregar(agrupacion_t *agrupacion, const consulta_fila_t *filas,
+			size_t cantidad);
+
+/*
+ * Devuelve los agregados del grupo con la clave dada o NULL si no existe.
+ */
+const agregado_t *agrupacion_obtener(agrupacion_t *agrupacion,
+				     const char *clave);
+
+/*
+ * Devuelve la cantidad de grupos o 0 en caso de error.
+ */
+size_t agrupacion_cantidad(agrupacion_t *agrupacion);
+
+/*
+ * Recorre los grupos (sin un orden en particular) e invoca a la función con
+ * la clave, los agregados y el puntero auxiliar, mientras la función
+ * devuelva true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función o 0 en caso de
+ * error.
+ */
+size_t agrupacion_con_cada_grupo(agrupacion_t *agrupacion,
+				 bool (*funcion)(const char *clave,
+						 const agregado_t *agregado,
+						 void *aux),
+				 void *aux);
+
+/*
+ * Destruye la agrupación.
+ */
+void agrupacion_destruir(agrupacion_t *agrupacion);
+
+#endif /* __CONSULTA_H__ */
@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <string.h>
+#include "filtro.h"
+#include "funciones_hash.h"
+
+#define BYTES_POR_BLOQUE 64
+#define CONTADORES_POR_BLOQUE (BYTES_POR_BLOQUE * 2)
+#define CONTADORES_POR_CLAVE 12
+#define SONDEOS_POR_CLAVE 4
+#define BITS_POR_SONDEO 7
+#define CONTADOR_SATURADO 0xf
+
+typedef struct bloque_filtro {
+	uint8_t contadores[BYTES_POR_BLOQUE];
+} bloque_filtro_t;
+
+/*
+ * bloques apunta a la primera dirección alineada a BYTES_POR_BLOQUE dentro
+ * de reserva, que tiene BYTES_POR_BLOQUE - 1 bytes de más para eso.
+ */
+struct filtro {
+	bloque_filtro_t *bloques;
+	size_t cantidad_bloques;
+	void *reserva;
+	memoria_t *memoria;
+};
+
+/*
+ * Crea un filtro dimensionado para la cantidad de claves dada, reservando
+ * unos 12 contadores (6 bytes) por clave, con la cuenta de memoria dada (que
+ * puede ser NULL).
+ *
+ * Devuelve un puntero al filtro creado o NULL en caso de error.
+ */
+filtro_t *filtro_crear(size_t cantidad_esperada, memoria_t *memoria)
+{
+	filtro_t *filtro = memoria_reservar(memoria, sizeof(filtro_t));
+	if (!filtro)
+		return NULL;
+	filtro->memoria = memoria;
+	filtro->cantidad_bloques =
+		cantidad_esperada * CONTADORES_POR_CLAVE /
+			CONTADORES_POR_BLOQUE +
+		1;
+	filtro->reserva = memoria_reservar(
+		memoria, filtro->cantidad_bloques * sizeof(bloque_filtro_t) +
+				 BYTES_POR_BLOQUE - 1);
+	if (!filtro->reserva) {
+		memoria_liberar(memoria, filtro);
+		return NULL;
+	}
+	filtro->bloques =
+		(bloque_filtro_t *)(((uintptr_t)filtro->reserva +
+				     BYTES_POR_BLOQUE - 1) &
+				    ~(uintptr_t)(BYTES_POR_BLOQUE - 1));
+	memset(filtro->bloques, 0,
+	       filtro->cantidad_bloques * sizeof(bloque_filtro_t));
+	return filtro;
+}
+
+/**
+ * Recibe un filtro y el hash de una clave.
+ *
+ * Devuelve el bloque que le corresponde a la clave, elegido con los 32 bits
+ * altos del hash.
+*/
+bloque_filtro_t *bloque_de_hash(filtro_t *filtro, uint64_t hash)
+{
+	uint64_t indice = ((hash >> 32) * filtro->cantidad_bloques) >> 32;
+	return &filtro->bloques[indice];
+}
+
+/**
+ * Recibe el hash de una clave y un número de sondeo.
+ *
+ * Devuelve la posición del contador que le corresponde a ese sondeo dentro
+ * del bloque, tomada de los bits bajos del hash.
+*/
+unsigned int contador_de_sondeo(uint64_t hash, unsigned int sondeo)
+{
+	return (hash >> (sondeo * BITS_POR_SONDEO)) &
+	       (CONTADORES_POR_BLOQUE - 1);
+}
+
+/**
+ * Recibe un bloque y la posición de un contador, y devuelve su valor.
+*/
+unsigned int leer_contador(bloque_filtro_t *bloque, unsigned int posicion)
+{
+	return (bloque->contadores[posicion / 2] >> ((posicion % 2) * 4)) &
+	       CONTADOR_SATURADO;
+}
+
+/**
+ * Recibe un bloque, la posición de un contador y un valor, y lo guarda en el
+ * contador.
+*/
+void escribir_contador(bloque_filtro_t *bloque, unsigned int posicion,
+		       unsigned int valor)
+{
+	unsigned int desplazamiento = (posicion % 2) * 4;
+	uint8_t *byte = &bloque->contadores[posicion / 2];
+	*byte = (uint8_t)((*byte & ~(CONTADOR_SATURADO << desplazamiento)) |
+			  (valor << desplazamiento));
+}
+
+/*
+ * Agrega al filtro una clave, representada por su hash de 64 bits.
+ *
+ * Los contadores que llegan al máximo quedan saturados y ya no se
+ * decrementan, para no generar falsos negativos.
+ */
+void filtro_agregar(filtro_t *filtro, uint64_t hash)
+{
+	if (!filtro)
+		return;
+	hash = mezclar_u64(hash);
+	bloque_filtro_t *bloque = bloque_de_hash(filtro, hash);
+	for (unsigned int i = 0; i < SONDEOS_POR_CLAVE; i++) {
+		unsigned int posicion = contador_de_sondeo(hash, i);
+		unsigned int valor = leer_contador(bloque, posicion);
+		if (valor < CONTADOR_SATURADO)
+			escribir_contador(bloque, posicion, valor + 1);
+	}
+}
+
+/*
+ * Quita del filtro una clave agregada previamente, representada por su hash
+ * de 64 bits.
+ */
+void filtro_quitar(filtro_t *filtro, uint64_t hash)
+{
+	if (!filtro)
+		return;
+	hash = mezclar_u64(hash);
+	bloque_filtro_t *bloque = bloque_de_hash(filtro, hash);
+	for (unsigned int i = 0; i < SONDEOS_POR_CLAVE; i++) {
+		unsigned int posicion = contador_de_sondeo(hash, i);
+		unsigned int valor = leer_contador(bloque, posicion);
+		if (valor > 0 && valor < CONTADOR_SATURADO)
+			escribir_contador(bloque, posicion, valor - 1);
+	}
+}
+
+/*
+ * Devuelve false si la clave con el hash dado seguro no fue agregada al
+ * filtro, o true si puede haber sido agregada.
+ */
+bool filtro_puede_contener(filtro_t *filtro, uint64_t hash)
+{
+	if (!filtro)
+		return true;
+	hash = mezclar_u64(hash);
+	bloque_filtro_t *bloque = bloque_de_hash(filtro, hash);
+	for (unsigned int i = 0; i < SONDEOS_POR_CLAVE; i++)
+		if (leer_contador(bloque, contador_de_sondeo(hash, i)) == 0)
+			return false;
+	return true;
+}
+
+/*
+ * Destruye el filtro liberando la memoria reservada.
+ */
+void filtro_destruir(filtro_t *filtro)
+{
+	if (!filtro)
+		return;
+	memoria_liberar(filtro->memoria, filtro->reserva);
+	memoria_liberar(filtro->memoria, filtro);
+}
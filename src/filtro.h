@@ -0,0 +1,50 @@
+#ifndef __FILTRO_H__
+#define __FILTRO_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "memoria.h"
+
+/*
+ * Filtro de Bloom por bloques con contadores. Cada clave se representa con
+ * 4 contadores de 4 bits dentro de un único bloque de 64 bytes (una línea de
+ * cache), por lo que consultar una clave toca una sola línea. Al usar
+ * contadores en vez de bits, las claves también se pueden quitar.
+ *
+ * El filtro puede dar falsos positivos (decir que una clave puede estar
+ * cuando no está) pero nunca falsos negativos.
+ */
+typedef struct filtro filtro_t;
+
+/*
+ * Crea un filtro dimensionado para la cantidad de claves dada, que se
+ * reserva con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al filtro creado o NULL en caso de error.
+ */
+filtro_t *filtro_crear(size_t cantidad_esperada, memoria_t *memoria);
+
+/*
+ * Agrega al filtro una clave, representada por su hash de 64 bits.
+ */
+void filtro_agregar(filtro_t *filtro, uint64_t hash);
+
+/*
+ * Quita del filtro una clave agregada previamente, representada por su hash
+ * de 64 bits.
+ */
+void filtro_quitar(filtro_t *filtro, uint64_t hash);
+
+/*
+ * Devuelve false si la clave con el hash dado seguro no fue agregada al
+ * filtro, o true si puede haber sido agregada.
+ */
+bool filtro_puede_contener(filtro_t *filtro, uint64_t hash);
+
+/*
+ * Destruye el filtro liberando la memoria reservada.
+ */
+void filtro_destruir(filtro_t *filtro);
+
+#endif /* __FILTRO_H__ */
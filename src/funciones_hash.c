@@ -0,0 +1,59 @@
+#include "funciones_hash.h"
+
+#define FNV_BASE 0xcbf29ce484222325ULL
+#define FNV_PRIMO 0x100000001b3ULL
+
+/*
+ * Función hash FNV-1a de 64 bits para strings.
+ *
+ * Recorre la clave aplicando un xor con cada byte y multiplicando por el
+ * primo FNV, por lo que cada byte afecta a todos los bits del resultado.
+ *
+ * Devuelve el hash de la clave.
+ */
+uint64_t hash_fnv1a(const char *clave)
+{
+	uint64_t hash = FNV_BASE;
+	while (*clave) {
+		hash ^= (unsigned char)*clave++;
+		hash *= FNV_PRIMO;
+	}
+	return hash;
+}
+
+/*
+ * Función hash FNV-1a de 64 bits para bytes.
+ *
+ * Igual que hash_fnv1a, pero recorre largo bytes (que pueden ser 0) en vez
+ * de cortar en el primer 0, y parte del hash dado, así que sirve para
+ * calcular el hash de datos que están en varios pedazos.
+ *
+ * Devuelve el hash de los datos.
+ */
+uint64_t hash_fnv1a_bytes(uint64_t hash, const void *datos, size_t largo)
+{
+	const unsigned char *bytes = datos;
+	for (size_t i = 0; i < largo; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIMO;
+	}
+	return hash;
+}
+
+/*
+ * Función hash para enteros de 64 bits.
+ *
+ * Recibe una clave y mezcla sus bits (finalizador de splitmix64), de manera
+ * que claves consecutivas quedan bien distribuidas en la tabla.
+ *
+ * Devuelve la clave mezclada.
+ */
+uint64_t mezclar_u64(uint64_t clave)
+{
+	clave ^= clave >> 30;
+	clave *= 0xbf58476d1ce4e5b9ULL;
+	clave ^= clave >> 27;
+	clave *= 0x94d049bb133111ebULL;
+	clave ^= clave >> 31;
+	return clave;
+}
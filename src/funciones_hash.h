@@ -0,0 +1,30 @@
+#ifndef __FUNCIONES_HASH_H__
+#define __FUNCIONES_HASH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Función hash FNV-1a de 64 bits para strings.
+ *
+ * Devuelve el hash de la clave.
+ */
+uint64_t hash_fnv1a(const char *clave);
+
+/*
+ * Función hash FNV-1a de 64 bits para los primeros largo bytes de datos,
+ * continuando a partir de hash (que al empezar debe ser hash_fnv1a("")).
+ *
+ * Devuelve el hash de los datos.
+ */
+uint64_t hash_fnv1a_bytes(uint64_t hash, const void *datos, size_t largo);
+
+/*
+ * Función hash para enteros de 64 bits (finalizador de splitmix64). También
+ * sirve para mejorar la distribución de los bits de otro hash.
+ *
+ * Devuelve la clave mezclada.
+ */
+uint64_t mezclar_u64(uint64_t clave);
+
+#endif /* __FUNCIONES_HASH_H__ */
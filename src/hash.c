@@ -1,362 +1,2232 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include "lista.h"
 #include "hash.h"
 #include "hash_estructura_privada.h"
+#include "funciones_hash.h"
 
 #define FACTOR_CARGA_MAXIMO 0.7
+#define FACTOR_CARGA_MINIMO 0.1
+#define FACTOR_CRECIMIENTO 2
 #define TAMANIO_HASH_MINIMO 3
+#define UMBRAL_ARBOL 8
+#define UMBRAL_LISTA 6
+
+/**
+ * Recibe una tabla, su capacidad y la cuenta de memoria con la que se creó,
+ * y libera la tabla y sus listas. No libera los elementos de las listas.
+*/
+void destruir_tabla(lista_t **tabla, size_t capacidad, memoria_t *memoria)
+{
+	for (int i = 0; i < capacidad; i++)
+		lista_destruir(tabla[i]);
+	memoria_liberar(memoria, tabla);
+}
+
+/**
+ * Recibe el arreglo de árboles de un hash (que puede ser NULL), su capacidad
+ * y la cuenta de memoria del hash, y libera el arreglo y sus árboles. No
+ * libera los pares.
+*/
+void destruir_arboles(arbol_t **arboles, size_t capacidad, memoria_t *memoria)
+{
+	for (int i = 0; arboles && i < capacidad; i++)
+		arbol_destruir(arboles[i]);
+	memoria_liberar(memoria, arboles);
+}
+
+/**
+ * Recibe una capacidad, un pool de nodos (que puede ser NULL) y una cuenta
+ * de memoria (que puede ser NULL), y crea una tabla con una lista enlazada
+ * vacía en cada espacio, que usa ese pool. La tabla y las listas se reservan
+ * con esa cuenta.
+ * 
+ * Devuelve la tabla creada o NULL en caso de error.
+*/
+lista_t **crear_tabla(size_t capacidad, pool_t *pool_nodos, memoria_t *memoria)
+{
+	lista_t **tabla =
+		memoria_reservar_ceros(memoria, capacidad, sizeof(lista_t *));
+	if (!tabla)
+		return NULL;
+	for (int i = 0; i < capacidad; i++) {
+		tabla[i] = lista_crear_con_memoria(pool_nodos, memoria);
+		if (!tabla[i]) {
+			destruir_tabla(tabla, i, memoria);
+			return NULL;
+		}
+	}
+	return tabla;
+}
+
+/**
+ * Recibe un hash cuyas tablas ya se liberaron (o que no llegó a tenerlas), y
+ * libera el hash y su cuenta de memoria.
+*/
+void liberar_hash(hash_t *hash)
+{
+	memoria_t *memoria = hash->memoria;
+	memoria_liberar(memoria, hash);
+	memoria_destruir(memoria);
+}
 
 /**
  * Recibe un puntero a hash con tabla NULL, y la inicializa creando una lista
  * enlazada vacía en cada espacio de la tabla. 
  * 
- * Devuelve el hash con la tabla inicializada.
+ * Devuelve el hash con la tabla inicializada, o NULL en caso de error (en
+ * cuyo caso el hash y su pool de nodos se liberan).
+*/
+hash_t *inicializar_tabla(hash_t *hash)
+{
+	hash->tabla =
+		crear_tabla(hash->capacidad, hash->pool_nodos, hash->memoria);
+	if (!hash->tabla) {
+		pool_destruir(hash->pool_nodos);
+		liberar_hash(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+/**
+ * Recibe un hash y una capacidad, y devuelve la cantidad de elementos que
+ * puede tener el hash con esa capacidad antes de hacer rehash.
+*/
+size_t elementos_maximos(hash_t *hash, size_t capacidad)
+{
+	return (size_t)((double)capacidad * hash->factor_carga_maximo) + 1;
+}
+
+/**
+ * Recibe un hash y una cantidad de elementos, y devuelve la menor capacidad
+ * con la que el hash los puede tener sin hacer rehash (y al menos la
+ * capacidad mínima de un hash).
+*/
+size_t capacidad_para(hash_t *hash, size_t cantidad)
+{
+	size_t capacidad =
+		(size_t)((double)cantidad / hash->factor_carga_maximo) + 1;
+	return capacidad < TAMANIO_HASH_MINIMO ? TAMANIO_HASH_MINIMO :
+						 capacidad;
+}
+
+/**
+ * Recibe un factor de las opciones de creación y su valor por defecto, y
+ * devuelve el factor, o el valor por defecto si el factor es 0.
+*/
+double factor_o_defecto(double factor, double por_defecto)
+{
+	return factor != 0 ? factor : por_defecto;
+}
+
+/**
+ * Recibe un hash recién reservado y sus opciones de creación, y guarda en el
+ * hash sus factores de carga y de crecimiento.
+ *
+ * Devuelve true si los factores son válidos: el máximo debe ser positivo, el
+ * crecimiento mayor a 1, y el mínimo (si no es negativo) tan chico que al
+ * achicar el hash no quede por encima del máximo.
+*/
+bool inicializar_factores(hash_t *hash, const hash_opciones_t *opciones)
+{
+	hash->factor_carga_maximo = factor_o_defecto(
+		opciones->factor_carga_maximo, FACTOR_CARGA_MAXIMO);
+	hash->factor_carga_minimo = factor_o_defecto(
+		opciones->factor_carga_minimo, FACTOR_CARGA_MINIMO);
+	hash->factor_crecimiento = factor_o_defecto(
+		opciones->factor_crecimiento, FACTOR_CRECIMIENTO);
+	return hash->factor_carga_maximo > 0 && hash->factor_crecimiento > 1 &&
+	       hash->factor_carga_minimo * hash->factor_crecimiento <
+		       hash->factor_carga_maximo;
+}
+
+/*
+ * Crea el hash reservando la memoria necesaria para el.
+ *
+ * Capacidad indica la capacidad inicial con la que se crea el hash. La
+ * capacidad inicial no puede ser menor a 3. Si se solicita una capacidad menor,
+ * el hash se creará con una capacidad de 3.
+ *
+ * Devuelve un puntero al hash creado o NULL en caso de no poder crearlo.
+ */
+hash_t *hash_crear(size_t capacidad)
+{
+	return hash_crear_con_opciones(capacidad, NULL);
+}
+
+/*
+ * Crea el hash igual que hash_crear, pero con las opciones dadas. Si opciones
+ * es NULL, el hash se crea con las opciones por defecto.
+ *
+ * Devuelve un puntero al hash creado o NULL en caso de no poder crearlo o si
+ * las opciones son inválidas.
+ */
+hash_t *hash_crear_con_opciones(size_t capacidad,
+				const hash_opciones_t *opciones)
+{
+	hash_opciones_t por_defecto = { 0 };
+	if (!opciones)
+		opciones = &por_defecto;
+	if ((opciones->flags & HASH_CLAVES_PRESTADAS) && opciones->pool_claves)
+		return NULL;
+	unsigned int sin_listas = opciones->flags & (HASH_COMPACTO | HASH_CUCKOO);
+	if (sin_listas == (HASH_COMPACTO | HASH_CUCKOO) ||
+	    (sin_listas && (opciones->flags & (HASH_FILTRO | HASH_POOL_NODOS))))
+		return NULL;
+	if (capacidad < TAMANIO_HASH_MINIMO)
+		capacidad = 3;
+	memoria_t *memoria = NULL;
+	if (opciones->alocador || opciones->limite_memoria) {
+		memoria = memoria_crear(opciones->alocador,
+					opciones->limite_memoria);
+		if (!memoria)
+			return NULL;
+	}
+	hash_t *hash = memoria_reservar(memoria, sizeof(hash_t));
+	if (!hash) {
+		memoria_destruir(memoria);
+		return NULL;
+	}
+	hash->memoria = memoria;
+	if (!inicializar_factores(hash, opciones)) {
+		liberar_hash(hash);
+		return NULL;
+	}
+	hash->cantidad = 0;
+	hash->capacidad = capacidad;
+	hash->capacidad_minima = capacidad;
+	hash->flags = opciones->flags;
+	hash->pool_claves = opciones->pool_claves;
+	hash->rueda = NULL;
+	hash->reloj = opciones->reloj;
+	hash->contexto_reloj = opciones->contexto_reloj;
+	hash->destructor_expirados = opciones->destructor_expirados;
+	hash->arboles = NULL;
+	hash->filtro = NULL;
+	hash->pool_nodos = NULL;
+	hash->estadisticas_filtro = (hash_estadisticas_filtro_t){ 0 };
+	hash->compacta = NULL;
+	hash->cuckoo = NULL;
+	hash->referencias_tablas = NULL;
+	hash->semilla = opciones->semilla;
+	if (sin_listas) {
+		hash->tabla = NULL;
+		if (hash->flags & HASH_COMPACTO)
+			hash->compacta = tabla_compacta_crear(capacidad, memoria);
+		else
+			hash->cuckoo = tabla_cuckoo_crear(capacidad, memoria);
+		if (!hash->compacta && !hash->cuckoo) {
+			liberar_hash(hash);
+			return NULL;
+		}
+		return hash;
+	}
+	if (hash->flags & HASH_POOL_NODOS) {
+		hash->pool_nodos = lista_crear_pool_de_nodos_con_memoria(memoria);
+		if (!hash->pool_nodos) {
+			liberar_hash(hash);
+			return NULL;
+		}
+	}
+	if (!inicializar_tabla(hash))
+		return NULL;
+	if (hash->flags & HASH_FILTRO) {
+		hash->filtro = filtro_crear(
+			elementos_maximos(hash, hash->capacidad), memoria);
+		if (!hash->filtro) {
+			hash_destruir(hash);
+			return NULL;
+		}
+	}
+	return hash;
+}
+
+/**
+ * Recibe un hash y una clave provista por el usuario.
+ * 
+ * Devuelve la clave que debe guardarse en un par nuevo: la misma clave si el
+ * hash usa claves prestadas, la clave internada si el hash usa un pool de
+ * claves, o una copia de la clave en otro caso. Devuelve NULL en caso de
+ * error.
+*/
+char *almacenar_clave(hash_t *hash, const char *clave)
+{
+	if (hash->flags & HASH_CLAVES_PRESTADAS)
+		return (char *)clave;
+	if (hash->pool_claves)
+		return (char *)pool_claves_internar(hash->pool_claves, clave);
+	char *clave_copia = memoria_reservar(hash->memoria, strlen(clave) + 1);
+	if (!clave_copia)
+		return NULL;
+	strcpy(clave_copia, clave);
+	return clave_copia;
+}
+
+/**
+ * Recibe un hash y una clave devuelta por almacenar_clave, y la libera según
+ * corresponda.
+*/
+void liberar_clave(hash_t *hash, char *clave)
+{
+	if (hash->flags & HASH_CLAVES_PRESTADAS)
+		return;
+	if (hash->pool_claves)
+		pool_claves_soltar(hash->pool_claves, clave);
+	else
+		memoria_liberar(hash->memoria, clave);
+}
+
+/**
+ * Función hash.
+ * 
+ * Recibe una clave que es un string, y suma sus valores ascii (tomando cada
+ * caracter sin signo, para que la suma nunca sea negativa).
+ * 
+ * Devuelve la suma.
+*/
+int funcion_hash(const char *clave)
+{
+	int i = 0, suma = 0;
+	while (clave[i]) {
+		suma = suma + (unsigned char)clave[i];
+		i++;
+	}
+	return suma;
+}
+
+/**
+ * Recibe la huella de una clave (hash_fnv1a) y una semilla distinta de 0, y
+ * mezcla la huella con la semilla.
+ *
+ * Devuelve un número no negativo que se usa en lugar de funcion_hash para
+ * elegir la posición de la clave.
+*/
+int suma_de_huella(uint64_t huella, uint64_t semilla)
+{
+	return (int)(mezclar_u64(huella ^ semilla) >> 33);
+}
+
+/**
+ * Recibe una clave y una semilla.
+ *
+ * Devuelve el número que elige la posición de la clave en los hash creados
+ * con esa semilla: funcion_hash si la semilla es 0, o suma_de_huella si no.
+*/
+int suma_con_semilla(const char *clave, uint64_t semilla)
+{
+	if (!semilla)
+		return funcion_hash(clave);
+	return suma_de_huella(hash_fnv1a(clave), semilla);
+}
+
+/**
+ * Recibe un hash y una clave calculada con hash_calcular_con_semilla.
+ *
+ * Devuelve el número que elige la posición de la clave en el hash, que es el
+ * de la clave calculada si tiene la misma semilla que el hash, o se vuelve a
+ * calcular (a partir de la huella, si se puede) si no.
+*/
+int suma_para(hash_t *hash, const hash_clave_t *clave)
+{
+	if (clave->semilla == hash->semilla)
+		return clave->suma;
+	if (!hash->semilla)
+		return funcion_hash(clave->clave);
+	return suma_de_huella(clave->huella, hash->semilla);
+}
+
+/**
+ * Recibe un par_cv_t pointer y una clave.
+ * 
+ * Compara la clave con la clave del par y devuelve un número mayor que cero
+ * si la clave del par es mayor, o menor que cero si es menor, o cero si son
+ * iguales.
+*/
+int comparador_claves(void *par, void *clave)
+{
+	const char *clave1 = ((par_cv_t *)par)->clave;
+	return strcmp(clave1, clave);
+}
+
+/**
+ * Recibe un hash y devuelve el tiempo actual según su reloj.
+*/
+uint64_t tiempo_actual(hash_t *hash)
+{
+	if (hash->reloj)
+		return hash->reloj(hash->contexto_reloj);
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t)ahora.tv_sec * 1000 + (uint64_t)ahora.tv_nsec / 1000000;
+}
+
+/**
+ * Recibe un hash y un par del mismo.
+ * 
+ * Devuelve true si el par tiene un vencimiento y ya venció, o false en caso
+ * contrario.
+*/
+bool par_vencido(hash_t *hash, par_cv_t *par)
+{
+	return par->temporizador &&
+	       par->temporizador->vencimiento <= tiempo_actual(hash);
+}
+
+/**
+ * Recibe un hash y un par del mismo, y le quita el vencimiento al par (si
+ * tenía).
+*/
+void quitar_vencimiento(hash_t *hash, par_cv_t *par)
+{
+	if (!par->temporizador)
+		return;
+	rueda_temporal_quitar(hash->rueda, par->temporizador);
+	memoria_liberar(hash->memoria, par->temporizador);
+	par->temporizador = NULL;
+}
+
+/**
+ * Recibe un hash y un par que ya no está en ninguna lista del hash. Quita el
+ * vencimiento del par de la rueda (si tenía), y libera el vencimiento, la
+ * clave y el par.
+*/
+void liberar_par(hash_t *hash, par_cv_t *par)
+{
+	quitar_vencimiento(hash, par);
+	liberar_clave(hash, par->clave);
+	memoria_liberar(hash->memoria, par);
+}
+
+/**
+ * Recibe un hash y una posición de su tabla.
+ * 
+ * Devuelve el árbol en el que están los pares de esa posición, o NULL si los
+ * pares están en la lista de la tabla.
+*/
+arbol_t *arbol_de_posicion(hash_t *hash, int posicion)
+{
+	return hash->arboles ? hash->arboles[posicion] : NULL;
+}
+
+/**
+ * Recibe un hash y una posición de su tabla, y devuelve la cantidad de pares
+ * en esa posición.
+*/
+size_t tamanio_de_posicion(hash_t *hash, int posicion)
+{
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	if (arbol)
+		return arbol_tamanio(arbol);
+	return lista_tamanio(hash->tabla[posicion]);
+}
+
+/**
+ * Recibe un hash, una posición de su tabla, una función y un puntero
+ * auxiliar, e invoca a la función con cada par de esa posición (esté en la
+ * lista o en un árbol) mientras devuelva true.
+ * 
+ * Devuelve la cantidad de pares iterados, igual que lista_con_cada_elemento.
+*/
+size_t con_cada_par_de_posicion(hash_t *hash, int posicion,
+				bool (*funcion)(void *, void *), void *aux)
+{
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	if (arbol)
+		return arbol_con_cada_elemento(arbol, funcion, aux);
+	return lista_con_cada_elemento(hash->tabla[posicion], funcion, aux);
+}
+
+/**
+ * Recibe un par_cv_t pointer y un árbol, e inserta el par en el árbol
+ * ordenado por (hash_fnv1a(clave), clave).
+ * 
+ * Devuelve true si se pudo insertar, o false si no se pudo.
+*/
+bool agregar_par_al_arbol(void *par, void *arbol)
+{
+	char *clave = ((par_cv_t *)par)->clave;
+	return arbol_insertar(arbol, hash_fnv1a(clave), clave, par) != NULL;
+}
+
+/**
+ * Recibe un hash y una posición de su tabla cuya lista es demasiado larga, y
+ * pasa sus pares a un árbol balanceado. Si no hay memoria para el árbol la
+ * posición queda como lista, que sigue siendo válida aunque más lenta.
+*/
+void convertir_en_arbol(hash_t *hash, int posicion)
+{
+	if (!hash->arboles) {
+		hash->arboles = memoria_reservar_ceros(
+			hash->memoria, hash->capacidad, sizeof(arbol_t *));
+		if (!hash->arboles)
+			return;
+	}
+	arbol_t *arbol = arbol_crear(comparador_claves, hash->memoria);
+	if (!arbol)
+		return;
+	lista_t *lista = hash->tabla[posicion];
+	if (lista_con_cada_elemento(lista, agregar_par_al_arbol, arbol) <
+	    lista_tamanio(lista)) {
+		arbol_destruir(arbol);
+		return;
+	}
+	while (!lista_vacia(lista))
+		lista_quitar_de_posicion(lista, 0);
+	hash->arboles[posicion] = arbol;
+}
+
+/**
+ * Recibe un par_cv_t pointer y una lista, e inserta el par en la lista.
+ * 
+ * Devuelve true si se pudo insertar, o false si no se pudo.
+*/
+bool agregar_par_a_la_lista(void *par, void *lista)
+{
+	return lista_insertar(lista, par) != NULL;
+}
+
+/**
+ * Recibe un hash y una posición de su tabla cuyo árbol quedó chico, y pasa
+ * sus pares de vuelta a la lista de la tabla. Si no hay memoria para los
+ * nodos de la lista la posición queda como árbol.
+*/
+void convertir_en_lista(hash_t *hash, int posicion)
+{
+	arbol_t *arbol = hash->arboles[posicion];
+	lista_t *lista = hash->tabla[posicion];
+	if (arbol_con_cada_elemento(arbol, agregar_par_a_la_lista, lista) <
+	    arbol_tamanio(arbol)) {
+		while (!lista_vacia(lista))
+			lista_quitar_de_posicion(lista, 0);
+		return;
+	}
+	arbol_destruir(arbol);
+	hash->arboles[posicion] = NULL;
+}
+
+/**
+ * Recibe un hash, una posición de su tabla, un par nuevo y el hash
+ * hash_fnv1a de su clave (solo se usa si la posición es un árbol).
+ * 
+ * Inserta el par en la lista o en el árbol de la posición. Si la lista
+ * alcanza UMBRAL_ARBOL pares, la convierte en árbol.
+ * 
+ * Devuelve true si se pudo insertar, o false si no se pudo.
+*/
+bool insertar_en_posicion(hash_t *hash, int posicion, par_cv_t *par,
+			  uint64_t huella)
+{
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	if (arbol)
+		return arbol_insertar(arbol, huella, par->clave, par) != NULL;
+	if (!lista_insertar(hash->tabla[posicion], par))
+		return false;
+	if (lista_tamanio(hash->tabla[posicion]) >= UMBRAL_ARBOL)
+		convertir_en_arbol(hash, posicion);
+	return true;
+}
+
+/**
+ * Recibe un hash, una clave, su huella y la posición de la tabla que le
+ * corresponde.
+ * 
+ * Devuelve el par con esa clave (esté en la lista o en un árbol), o NULL si
+ * no existe.
+*/
+par_cv_t *buscar_en_posicion(hash_t *hash, const char *clave, uint64_t huella,
+			     int posicion)
+{
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	if (arbol)
+		return arbol_buscar(arbol, huella, (void *)clave);
+	return lista_buscar_elemento(hash->tabla[posicion], comparador_claves,
+				     (void *)clave);
+}
+
+/**
+ * Recibe un hash, una clave, su huella y la posición de la tabla que le
+ * corresponde.
+ * 
+ * Busca el par con esa clave y lo saca de la lista o del árbol de la
+ * posición, sin liberarlo. Si el árbol queda con UMBRAL_LISTA pares o menos,
+ * lo vuelve a convertir en lista.
+ * 
+ * Devuelve el par quitado, o NULL si no existe.
+*/
+par_cv_t *quitar_de_posicion(hash_t *hash, const char *clave, uint64_t huella,
+			     int posicion)
+{
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	if (arbol) {
+		par_cv_t *par = arbol_quitar(arbol, huella, (void *)clave);
+		if (par && arbol_tamanio(arbol) <= UMBRAL_LISTA)
+			convertir_en_lista(hash, posicion);
+		return par;
+	}
+	return lista_quitar_elemento(hash->tabla[posicion], comparador_claves,
+				     (void *)clave);
+}
+
+/**
+ * Recibe un hash y un par que ya se sacó de su posición en la tabla.
+ * 
+ * Quita la clave del filtro (si lo hay), libera el par y la clave, y
+ * devuelve el valor del par.
+*/
+void *quitar_elemento(hash_t *hash, par_cv_t *par_quitado)
+{
+	void *elemento_quitado = par_quitado->valor;
+	if (hash->filtro)
+		filtro_quitar(hash->filtro, hash_fnv1a(par_quitado->clave));
+	liberar_par(hash, par_quitado);
+	hash->cantidad--;
+	return elemento_quitado;
+}
+
+/**
+ * Recibe un hash, un par del mismo, el hash hash_fnv1a de su clave y la
+ * posición de la tabla en la que se encuentra. Quita el par del hash, libera
+ * el par y la clave, y pasa el valor a la función destructora de elementos
+ * vencidos (si la hay).
+*/
+void reclamar_par_vencido(hash_t *hash, par_cv_t *par, uint64_t huella,
+			  int posicion)
+{
+	quitar_de_posicion(hash, par->clave, huella, posicion);
+	void *valor = quitar_elemento(hash, par);
+	if (hash->destructor_expirados)
+		hash->destructor_expirados(valor);
+}
+
+/**
+ * Recibe un hash, una clave y la posición de la tabla que le corresponde.
+ * 
+ * Devuelve el hash hash_fnv1a de la clave si lo necesita el filtro del hash o
+ * el árbol de la posición, o 0 si no hace falta calcularlo.
+*/
+uint64_t huella_de_clave(hash_t *hash, const char *clave, int posicion)
+{
+	if (!hash->filtro && !arbol_de_posicion(hash, posicion))
+		return 0;
+	return hash_fnv1a(clave);
+}
+
+/**
+ * Recibe un hash y la huella de una clave.
+ * 
+ * Devuelve true si el filtro del hash asegura que la clave no está, o false
+ * si no hay filtro o si la clave puede estar (en cuyo caso hay que recorrer
+ * la lista). Actualiza las estadísticas del filtro.
+*/
+bool descartada_por_filtro(hash_t *hash, uint64_t huella)
+{
+	if (!hash->filtro)
+		return false;
+	hash->estadisticas_filtro.consultas++;
+	if (filtro_puede_contener(hash->filtro, huella))
+		return false;
+	hash->estadisticas_filtro.descartadas++;
+	return true;
+}
+
+/**
+ * Recibe un hash en el que se buscó una clave que el filtro no descartó,
+ * pero que no estaba en la lista, y cuenta el falso positivo del filtro.
+*/
+void contar_falso_positivo(hash_t *hash)
+{
+	if (hash->filtro)
+		hash->estadisticas_filtro.falsos_positivos++;
+}
+
+/**
+ * Recibe un hash, una clave, su huella y la posición de la tabla que le
+ * corresponde a la clave. El filtro solo se consulta si la posición tiene
+ * pares, porque una posición vacía ya descarta la clave sin consultarlo.
+ * 
+ * Devuelve el par con esa clave, o NULL si no existe. Si el par existe pero
+ * ya venció, lo quita del hash y devuelve NULL.
+*/
+par_cv_t *buscar_par_vigente(hash_t *hash, const char *clave, uint64_t huella,
+			     int posicion)
+{
+	if (!tamanio_de_posicion(hash, posicion) ||
+	    descartada_por_filtro(hash, huella))
+		return NULL;
+	par_cv_t *par = buscar_en_posicion(hash, clave, huella, posicion);
+	if (!par)
+		contar_falso_positivo(hash);
+	if (par && par_vencido(hash, par)) {
+		reclamar_par_vencido(hash, par, huella, posicion);
+		return NULL;
+	}
+	return par;
+}
+
+/**
+ * Recibe un hash y una posición de su tabla.
+ *
+ * Devuelve true si el hash comparte la lista (o el árbol) de esa posición
+ * con algún clon, en cuyo caso no se puede modificar.
+*/
+bool posicion_compartida(hash_t *hash, int posicion)
+{
+	return hash->referencias_tablas ||
+	       lista_compartida(hash->tabla[posicion]);
+}
+
+/**
+ * Recibe un hash que comparte sus arreglos de listas y de árboles con algún
+ * clon, y se hace arreglos propios que apuntan a las mismas listas y árboles
+ * (que pasan a estar compartidos uno por uno). Si el hash era el último que
+ * usaba los arreglos, simplemente se queda con ellos.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (el hash queda como
+ * estaba).
+*/
+bool separar_tablas(hash_t *hash)
+{
+	if (!hash->referencias_tablas)
+		return true;
+	if (*hash->referencias_tablas > 1) {
+		lista_t **tabla = memoria_reservar(
+			hash->memoria, hash->capacidad * sizeof(lista_t *));
+		arbol_t **arboles = NULL;
+		if (tabla && hash->arboles)
+			arboles = memoria_reservar(
+				hash->memoria,
+				hash->capacidad * sizeof(arbol_t *));
+		if (!tabla || (hash->arboles && !arboles)) {
+			memoria_liberar(hash->memoria, tabla);
+			return false;
+		}
+		for (int i = 0; i < hash->capacidad; i++) {
+			tabla[i] = lista_compartir(hash->tabla[i]);
+			if (arboles)
+				arboles[i] = arbol_compartir(hash->arboles[i]);
+		}
+		(*hash->referencias_tablas)--;
+		hash->tabla = tabla;
+		hash->arboles = arboles;
+	} else {
+		memoria_liberar(hash->memoria, hash->referencias_tablas);
+	}
+	hash->referencias_tablas = NULL;
+	return true;
+}
+
+typedef struct estructura_auxiliar_para_duplicar {
+	hash_t *hash;
+	lista_t *lista;
+	arbol_t *arbol;
+} aux_duplicar_t;
+
+/**
+ * Recibe un par_cv_t pointer de una posición compartida y un puntero a
+ * aux_duplicar_t, y agrega una copia del par (con el mismo valor) a la lista
+ * o al árbol nuevos de la posición.
+ *
+ * Devuelve true si se pudo copiar, o false si no se pudo.
+*/
+bool copiar_par(void *par, void *destino_aux)
+{
+	aux_duplicar_t *destino = destino_aux;
+	hash_t *hash = destino->hash;
+	par_cv_t *original = par;
+	par_cv_t *copia = memoria_reservar(hash->memoria, sizeof(par_cv_t));
+	if (!copia)
+		return false;
+	copia->clave = almacenar_clave(hash, original->clave);
+	copia->valor = original->valor;
+	copia->temporizador = NULL;
+	bool copiado =
+		copia->clave &&
+		(destino->arbol ?
+			 arbol_insertar(destino->arbol, hash_fnv1a(copia->clave),
+					copia->clave, copia) != NULL :
+			 lista_insertar(destino->lista, copia) != NULL);
+	if (!copiado) {
+		if (copia->clave)
+			liberar_clave(hash, copia->clave);
+		memoria_liberar(hash->memoria, copia);
+	}
+	return copiado;
+}
+
+/**
+ * Recibe un par_cv_t pointer copiado con copiar_par y el hash, y libera el
+ * par y su clave.
+ *
+ * Devuelve true.
+*/
+bool liberar_copia(void *par, void *hash)
+{
+	liberar_par(hash, par);
+	return true;
+}
+
+/**
+ * Recibe un hash y una posición de su tabla, y si la posición está
+ * compartida con algún clon, la reemplaza por una lista (o un árbol) propia
+ * con copias de sus pares, para poder modificarla. Los valores no se copian.
+ *
+ * Devuelve true si la posición quedó propia del hash o false en caso de
+ * error (el hash queda como estaba).
+*/
+bool preparar_escritura(hash_t *hash, int posicion)
+{
+	if (!separar_tablas(hash))
+		return false;
+	if (!lista_compartida(hash->tabla[posicion]))
+		return true;
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	aux_duplicar_t destino = { .hash = hash };
+	destino.lista = lista_crear_con_memoria(hash->pool_nodos, hash->memoria);
+	if (arbol)
+		destino.arbol = arbol_crear(comparador_claves, hash->memoria);
+	if (!destino.lista || (arbol && !destino.arbol) ||
+	    con_cada_par_de_posicion(hash, posicion, copiar_par, &destino) <
+		    tamanio_de_posicion(hash, posicion)) {
+		if (destino.arbol)
+			arbol_con_cada_elemento(destino.arbol, liberar_copia,
+						hash);
+		else
+			lista_con_cada_elemento(destino.lista, liberar_copia,
+						hash);
+		arbol_destruir(destino.arbol);
+		lista_destruir(destino.lista);
+		return false;
+	}
+	lista_destruir(hash->tabla[posicion]);
+	hash->tabla[posicion] = destino.lista;
+	if (arbol) {
+		arbol_destruir(arbol);
+		hash->arboles[posicion] = destino.arbol;
+	}
+	return true;
+}
+
+/**
+ * Recibe un hash y hace propias todas las posiciones que comparte con algún
+ * clon (ver preparar_escritura).
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (las posiciones que
+ * ya se copiaron quedan propias, y el hash sigue siendo válido).
+*/
+bool preparar_escritura_total(hash_t *hash)
+{
+	for (int i = 0; i < hash->capacidad; i++)
+		if (!preparar_escritura(hash, i))
+			return false;
+	return true;
+}
+
+/**
+ * Recibe los mismos parámetros que insertar_sin_rehash, más la suma de la
+ * clave (funcion_hash) y su huella (hash_fnv1a, o 0 si huella_de_clave no
+ * la necesita), para no volver a calcularlas si ya se tienen.
+ *
+ * Devuelve el par insertado o actualizado, o NULL si no pudo guardar el
+ * elemento.
+*/
+par_cv_t *insertar_con_hashes(hash_t *hash, const char *clave, int suma,
+			      uint64_t huella, void *elemento, void **anterior,
+			      bool hash_buscar_duplicado)
+{
+	int posicion = suma % (int)hash->capacidad;
+	if (!preparar_escritura(hash, posicion))
+		return NULL;
+	if (hash_buscar_duplicado) {
+		par_cv_t *par_repetido =
+			buscar_par_vigente(hash, clave, huella, posicion);
+		if (par_repetido) {
+			if (anterior)
+				*anterior = par_repetido->valor;
+			par_repetido->valor = elemento;
+			return par_repetido;
+		}
+	}
+	if (anterior)
+		*anterior = NULL;
+	par_cv_t *par = memoria_reservar(hash->memoria, sizeof(par_cv_t));
+	if (!par)
+		return NULL;
+	char *clave_almacenada = almacenar_clave(hash, clave);
+	if (!clave_almacenada) {
+		memoria_liberar(hash->memoria, par);
+		return NULL;
+	}
+	par->clave = clave_almacenada;
+	par->valor = elemento;
+	par->temporizador = NULL;
+	if (!insertar_en_posicion(hash, posicion, par, huella)) {
+		liberar_clave(hash, clave_almacenada);
+		memoria_liberar(hash->memoria, par);
+		return NULL;
+	}
+	filtro_agregar(hash->filtro, huella);
+	hash->cantidad++;
+	return par;
+}
+
+/*
+ * Inserta o actualiza un elemento en el hash asociado a la clave dada.
+ *
+ * Si la clave ya existía y se reemplaza el elemento, se almacena un puntero al
+ * elemento reemplazado en *anterior, si anterior no es NULL.
+ *
+ * Si la clave no existía y anterior no es NULL, se almacena NULL en *anterior.
+ *
+ * La clave se guarda con almacenar_clave: una copia de la clave provista
+ * por el usuario, salvo que el hash se haya creado con claves prestadas o
+ * con un pool de claves.
+ *
+ * Devuelve el par insertado o actualizado, o NULL si no pudo guardar el
+ * elemento.
+ */
+par_cv_t *insertar_sin_rehash(hash_t *hash, const char *clave, void *elemento,
+			      void **anterior, bool hash_buscar_duplicado)
+{
+	int suma = suma_con_semilla(clave, hash->semilla);
+	int posicion = suma % (int)hash->capacidad;
+	return insertar_con_hashes(hash, clave, suma,
+				   huella_de_clave(hash, clave, posicion),
+				   elemento, anterior, hash_buscar_duplicado);
+}
+
+typedef struct estructura_auxiliar_para_rehash {
+	lista_t **tabla;
+	size_t capacidad;
+	filtro_t *filtro;
+	uint64_t semilla;
+} aux_rehash_t;
+
+/**
+ * Recibe un par_cv_t pointer y un puntero a aux_rehash_t, que contiene una
+ * tabla nueva y su capacidad.
+ * 
+ * Inserta el par (sin copiarlo) en la lista que le corresponde en la tabla
+ * nueva, y si hay un filtro nuevo agrega la clave al mismo. Devuelve true si
+ * se pudo insertar, o false si no se pudo.
+*/
+bool mover_par(void *par, void *tabla_nueva)
+{
+	aux_rehash_t *destino = tabla_nueva;
+	int posicion =
+		suma_con_semilla(((par_cv_t *)par)->clave, destino->semilla) %
+		(int)destino->capacidad;
+	if (!lista_insertar(destino->tabla[posicion], par))
+		return false;
+	if (destino->filtro)
+		filtro_agregar(destino->filtro,
+			       hash_fnv1a(((par_cv_t *)par)->clave));
+	return true;
+}
+
+/**
+ * Recibe un puntero a hash y una capacidad nueva (mayor o menor a la
+ * actual), y mueve sus pares a una tabla nueva con esa capacidad. Los pares
+ * y las claves no se copian, solo se reubican. Si el hash tiene filtro, se
+ * reconstruye con el tamaño adecuado para la nueva capacidad. Los pares de
+ * las posiciones que eran árboles se mueven a listas, y las listas de la
+ * tabla nueva que quedan largas se vuelven a convertir en árboles.
+ * 
+ * Devuelve cero si se pudo redimensionar el hash, o -1 en caso de error (el
+ * hash queda como se recibió).
+*/
+int rehash(hash_t *hash, size_t capacidad)
+{
+	if (!preparar_escritura_total(hash))
+		return -1;
+	aux_rehash_t destino = { .capacidad = capacidad,
+				 .semilla = hash->semilla };
+	if (hash->filtro) {
+		destino.filtro =
+			filtro_crear(elementos_maximos(hash, destino.capacidad),
+				     hash->memoria);
+		if (!destino.filtro)
+			return -1;
+	}
+	destino.tabla = crear_tabla(destino.capacidad, hash->pool_nodos,
+				    hash->memoria);
+	if (!destino.tabla) {
+		filtro_destruir(destino.filtro);
+		return -1;
+	}
+	for (int i = 0; i < hash->capacidad; i++) {
+		size_t pares_movidos =
+			con_cada_par_de_posicion(hash, i, mover_par, &destino);
+		if (pares_movidos < tamanio_de_posicion(hash, i)) {
+			destruir_tabla(destino.tabla, destino.capacidad,
+				       hash->memoria);
+			filtro_destruir(destino.filtro);
+			return -1;
+		}
+	}
+	destruir_tabla(hash->tabla, hash->capacidad, hash->memoria);
+	destruir_arboles(hash->arboles, hash->capacidad, hash->memoria);
+	filtro_destruir(hash->filtro);
+	hash->tabla = destino.tabla;
+	hash->arboles = NULL;
+	hash->capacidad = destino.capacidad;
+	hash->filtro = destino.filtro;
+	for (int i = 0; i < hash->capacidad; i++)
+		if (lista_tamanio(hash->tabla[i]) >= UMBRAL_ARBOL)
+			convertir_en_arbol(hash, i);
+	return 0;
+}
+
+/**
+ * Recibe un hash en el que se va a insertar. Si su factor de carga
+ * (cantidad / capacidad) es mayor a su factor de carga máximo (0.7 por
+ * defecto), multiplica la capacidad del hash por su factor de crecimiento (2
+ * por defecto) para evitar futuras colisiones.
+ *
+ * Devuelve true si pudo (o no hacía falta) o false en caso de error.
+*/
+bool agrandar_si_hace_falta(hash_t *hash)
+{
+	double factor_de_carga =
+		(double)hash->cantidad / (double)hash->capacidad;
+	if (factor_de_carga <= hash->factor_carga_maximo)
+		return true;
+	size_t capacidad =
+		(size_t)((double)hash->capacidad * hash->factor_crecimiento);
+	if (capacidad <= hash->capacidad)
+		capacidad = hash->capacidad + 1;
+	return rehash(hash, capacidad) == 0;
+}
+
+/**
+ * Recibe los mismos parámetros que hash_insertar. Agranda el hash si hace
+ * falta (ver agrandar_si_hace_falta), y luego inserta o actualiza el
+ * elemento.
+ * 
+ * Devuelve el par insertado o actualizado, o NULL si no pudo guardar el
+ * elemento.
+*/
+par_cv_t *insertar_controlando_carga(hash_t *hash, const char *clave,
+				     void *elemento, void **anterior)
+{
+	if (!agrandar_si_hace_falta(hash))
+		return NULL;
+	return insertar_sin_rehash(hash, clave, elemento, anterior, true);
+}
+
+/**
+ * Recibe un hash del que se acaban de quitar elementos. Si su factor de
+ * carga quedó por debajo del mínimo, divide su capacidad por el factor de
+ * crecimiento (sin bajar de su capacidad mínima). Si no hay memoria para la
+ * tabla nueva, el hash queda como estaba.
+*/
+void achicar_si_hace_falta(hash_t *hash)
+{
+	if (hash->factor_carga_minimo <= 0 ||
+	    hash->capacidad <= hash->capacidad_minima ||
+	    (double)hash->cantidad >=
+		    (double)hash->capacidad * hash->factor_carga_minimo)
+		return;
+	size_t capacidad =
+		(size_t)((double)hash->capacidad / hash->factor_crecimiento);
+	if (capacidad < hash->capacidad_minima)
+		capacidad = hash->capacidad_minima;
+	rehash(hash, capacidad);
+}
+
+/**
+ * Recibe un hash y devuelve true si guarda sus elementos en una tabla
+ * compacta o cuckoo en vez de en listas.
+*/
+bool usa_tabla_sin_listas(hash_t *hash)
+{
+	return hash->compacta || hash->cuckoo;
+}
+
+/**
+ * Recibe un hash que no usa listas y una clave.
+ *
+ * Devuelve un puntero al valor guardado con esa clave, o NULL si no está.
+*/
+void **buscar_sin_listas(hash_t *hash, const char *clave)
+{
+	if (hash->compacta)
+		return tabla_compacta_buscar(hash->compacta, hash_fnv1a(clave),
+					     clave);
+	return tabla_cuckoo_buscar(hash->cuckoo, clave);
+}
+
+/**
+ * Recibe un hash que no usa listas y una clave, y quita la clave. Libera la
+ * clave almacenada y guarda el valor que tenía en *elemento.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario.
+*/
+bool quitar_sin_listas(hash_t *hash, const char *clave, void **elemento)
+{
+	char *clave_quitada;
+	bool quitada = hash->compacta ?
+			       tabla_compacta_quitar(hash->compacta,
+						     hash_fnv1a(clave), clave,
+						     &clave_quitada, elemento) :
+			       tabla_cuckoo_quitar(hash->cuckoo, clave,
+						   &clave_quitada, elemento);
+	if (!quitada)
+		return false;
+	liberar_clave(hash, clave_quitada);
+	hash->cantidad--;
+	return true;
+}
+
+/**
+ * Recibe un hash que no usa listas y una función, e invoca a la función con
+ * cada clave y valor del hash y el puntero auxiliar, mientras devuelva true.
+*/
+void con_cada_entrada_sin_listas(hash_t *hash,
+				 bool (*funcion)(char *, void *, void *),
+				 void *aux)
+{
+	if (hash->compacta)
+		tabla_compacta_con_cada_entrada(hash->compacta, funcion, aux);
+	else
+		tabla_cuckoo_con_cada_entrada(hash->cuckoo, funcion, aux);
+}
+
+/**
+ * Recibe los mismos parámetros que hash_insertar, para un hash que no usa
+ * listas, e inserta o actualiza el elemento en su tabla.
+ *
+ * Devuelve el hash o NULL si no pudo guardar el elemento.
+*/
+hash_t *insertar_sin_listas(hash_t *hash, const char *clave, void *elemento,
+			    void **anterior)
+{
+	void **valor = buscar_sin_listas(hash, clave);
+	if (anterior)
+		*anterior = valor ? *valor : NULL;
+	if (valor) {
+		*valor = elemento;
+		return hash;
+	}
+	char *clave_almacenada = almacenar_clave(hash, clave);
+	if (!clave_almacenada)
+		return NULL;
+	bool agregada =
+		hash->compacta ?
+			tabla_compacta_agregar(hash->compacta,
+					       hash_fnv1a(clave),
+					       clave_almacenada, elemento) :
+			tabla_cuckoo_agregar(hash->cuckoo, clave_almacenada,
+					     elemento);
+	if (!agregada) {
+		liberar_clave(hash, clave_almacenada);
+		return NULL;
+	}
+	hash->cantidad++;
+	return hash;
+}
+
+/*
+ * Inserta o actualiza un elemento en el hash asociado a la clave dada.
+ *
+ * Si el factor de carga del hash (cantidad / capacidad) es mayor a su
+ * factor_carga_maximo, multiplica la capacidad del hash por su
+ * factor_crecimiento para evitar futuras colisiones (ver
+ * agrandar_si_hace_falta).
+ * 
+ * Si la clave ya existía y se reemplaza el elemento, se almacena un puntero al
+ * elemento reemplazado en *anterior, si anterior no es NULL.
+ *
+ * Si la clave no existía y anterior no es NULL, se almacena NULL en *anterior.
+ *
+ * La función almacena una copia de la clave provista por el usuario, salvo
+ * que el hash se haya creado con claves prestadas o con un pool de claves.
+ *
+ * Devuelve el hash si pudo guardar el elemento o NULL si no pudo.
+ */
+hash_t *hash_insertar(hash_t *hash, const char *clave, void *elemento,
+		      void **anterior)
+{
+	if (!hash || !clave)
+		return NULL;
+	if (usa_tabla_sin_listas(hash))
+		return insertar_sin_listas(hash, clave, elemento, anterior);
+	par_cv_t *par =
+		insertar_controlando_carga(hash, clave, elemento, anterior);
+	if (!par)
+		return NULL;
+	quitar_vencimiento(hash, par);
+	return hash;
+}
+
+/*
+ * Inserta o actualiza un elemento en el hash igual que hash_insertar, pero
+ * el elemento vence luego de ttl unidades de tiempo del reloj del hash.
+ *
+ * Devuelve el hash si pudo guardar el elemento o NULL si no pudo.
+ */
+hash_t *hash_insertar_con_ttl(hash_t *hash, const char *clave, void *elemento,
+			      uint64_t ttl, void **anterior)
+{
+	if (!hash || !clave || usa_tabla_sin_listas(hash))
+		return NULL;
+	if (!hash->rueda) {
+		hash->rueda =
+			rueda_temporal_crear(tiempo_actual(hash), hash->memoria);
+		if (!hash->rueda)
+			return NULL;
+	}
+	temporizador_t *temporizador =
+		memoria_reservar(hash->memoria, sizeof(temporizador_t));
+	if (!temporizador)
+		return NULL;
+	par_cv_t *par =
+		insertar_controlando_carga(hash, clave, elemento, anterior);
+	if (!par) {
+		memoria_liberar(hash->memoria, temporizador);
+		return NULL;
+	}
+	quitar_vencimiento(hash, par);
+	temporizador->vencimiento = tiempo_actual(hash) + ttl;
+	temporizador->dato = par;
+	par->temporizador = temporizador;
+	rueda_temporal_agregar(hash->rueda, temporizador);
+	return hash;
+}
+
+/**
+ * Recibe un hash con listas, una clave, su huella (o 0 si huella_de_clave no
+ * la necesita) y la posición que le corresponde, y quita la clave como
+ * hash_quitar.
+ *
+ * Devuelve el elemento quitado o NULL si no estaba (o si estaba vencido, o
+ * en caso de error).
+*/
+void *quitar_en_posicion(hash_t *hash, const char *clave, uint64_t huella,
+			 int posicion)
+{
+	if (!tamanio_de_posicion(hash, posicion) ||
+	    descartada_por_filtro(hash, huella))
+		return NULL;
+	if (posicion_compartida(hash, posicion) &&
+	    buscar_en_posicion(hash, clave, huella, posicion) &&
+	    !preparar_escritura(hash, posicion))
+		return NULL;
+	par_cv_t *par = quitar_de_posicion(hash, clave, huella, posicion);
+	if (!par) {
+		contar_falso_positivo(hash);
+		return NULL;
+	}
+	bool vencido = par_vencido(hash, par);
+	void *elemento = quitar_elemento(hash, par);
+	achicar_si_hace_falta(hash);
+	if (!vencido)
+		return elemento;
+	if (hash->destructor_expirados)
+		hash->destructor_expirados(elemento);
+	return NULL;
+}
+
+/*
+ * Quita un elemento del hash y lo devuelve.
+ *
+ * Si no encuentra el elemento o en caso de error devuelve NULL
+ */
+void *hash_quitar(hash_t *hash, const char *clave)
+{
+	if (!hash || !clave)
+		return NULL;
+	if (usa_tabla_sin_listas(hash)) {
+		void *elemento = NULL;
+		quitar_sin_listas(hash, clave, &elemento);
+		return elemento;
+	}
+	int posicion = suma_con_semilla(clave, hash->semilla) %
+		       (int)hash->capacidad;
+	return quitar_en_posicion(hash, clave,
+				  huella_de_clave(hash, clave, posicion),
+				  posicion);
+}
+
+/*
+ * Devuelve un elemento del hash con la clave dada o NULL si dicho
+ * elemento no existe (o en caso de error).
+ */
+void *hash_obtener(hash_t *hash, const char *clave)
+{
+	if (!hash || !clave)
+		return NULL;
+	if (usa_tabla_sin_listas(hash)) {
+		void **valor = buscar_sin_listas(hash, clave);
+		return valor ? *valor : NULL;
+	}
+	int posicion = suma_con_semilla(clave, hash->semilla) %
+		       (int)hash->capacidad;
+	if (!tamanio_de_posicion(hash, posicion))
+		return NULL;
+	par_cv_t *par_encontrado = buscar_par_vigente(
+		hash, clave, huella_de_clave(hash, clave, posicion), posicion);
+	if (par_encontrado)
+		return par_encontrado->valor;
+	return NULL;
+}
+
+/*
+ * Devuelve true si el hash contiene un elemento almacenado con la
+ * clave dada o false en caso contrario (o en caso de error).
+ */
+bool hash_contiene(hash_t *hash, const char *clave)
+{
+	if (!hash || !clave)
+		return false;
+	if (usa_tabla_sin_listas(hash))
+		return buscar_sin_listas(hash, clave) != NULL;
+	int posicion = suma_con_semilla(clave, hash->semilla) %
+		       (int)hash->capacidad;
+	if (!tamanio_de_posicion(hash, posicion))
+		return false;
+	par_cv_t *par_encontrado = buscar_par_vigente(
+		hash, clave, huella_de_clave(hash, clave, posicion), posicion);
+	return par_encontrado != NULL;
+}
+
+/**
+ * Recibe un temporizador vencido (que ya no está en la rueda) y el hash al
+ * que pertenece, y quita del hash el par correspondiente.
+*/
+void vencer_par(temporizador_t *temporizador, void *hash)
+{
+	par_cv_t *par = temporizador->dato;
+	memoria_liberar(((hash_t *)hash)->memoria, temporizador);
+	par->temporizador = NULL;
+	int posicion = suma_con_semilla(par->clave, ((hash_t *)hash)->semilla) %
+		       (int)((hash_t *)hash)->capacidad;
+	reclamar_par_vencido(hash, par,
+			     huella_de_clave(hash, par->clave, posicion),
+			     posicion);
+}
+
+/*
+ * Quita del hash los elementos vencidos, procesando a lo sumo maximo
+ * elementos (o todos los vencidos si maximo es 0).
+ *
+ * Devuelve la cantidad de elementos quitados.
+ */
+size_t hash_expirar(hash_t *hash, size_t maximo)
+{
+	if (!hash || !hash->rueda)
+		return 0;
+	size_t vencidos = rueda_temporal_avanzar(
+		hash->rueda, tiempo_actual(hash), maximo, vencer_par, hash);
+	achicar_si_hace_falta(hash);
+	return vencidos;
+}
+
+/*
+ * Devuelve la cantidad de elementos almacenados en el hash o 0 en
+ * caso de error. Incluye a los elementos vencidos que todavía no se
+ * quitaron del hash.
+ */
+size_t hash_cantidad(hash_t *hash)
+{
+	if (!hash)
+		return 0;
+	return hash->cantidad;
+}
+
+/*
+ * Agranda el hash (si hace falta) para que pueda tener cantidad elementos
+ * sin hacer rehash, y hace que no se achique automáticamente por debajo de
+ * esa capacidad. Conviene usarlo antes de insertar muchos elementos.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (el hash queda como
+ * estaba).
+ */
+bool hash_reservar(hash_t *hash, size_t cantidad)
+{
+	if (!hash)
+		return false;
+	if (usa_tabla_sin_listas(hash)) {
+		if (cantidad <= hash->cantidad)
+			return true;
+		if (hash->compacta)
+			return tabla_compacta_redimensionar(hash->compacta,
+							    cantidad);
+		return tabla_cuckoo_redimensionar(hash->cuckoo, cantidad);
+	}
+	size_t capacidad = capacidad_para(hash, cantidad);
+	if (capacidad > hash->capacidad && rehash(hash, capacidad) == -1)
+		return false;
+	if (capacidad > hash->capacidad_minima)
+		hash->capacidad_minima = capacidad;
+	return true;
+}
+
+/*
+ * Achica el hash a la menor capacidad en la que entran sus elementos sin
+ * superar el factor de carga máximo, y deshace el efecto de hash_reservar y
+ * de la capacidad inicial sobre el achique automático.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (el hash queda como
+ * estaba).
+ */
+bool hash_compactar(hash_t *hash)
+{
+	if (!hash)
+		return false;
+	if (hash->compacta)
+		return tabla_compacta_redimensionar(hash->compacta, 0);
+	if (hash->cuckoo)
+		return tabla_cuckoo_redimensionar(hash->cuckoo, 0);
+	hash->capacidad_minima = TAMANIO_HASH_MINIMO;
+	size_t capacidad = capacidad_para(hash, hash->cantidad);
+	if (capacidad >= hash->capacidad)
+		return true;
+	return rehash(hash, capacidad) == 0;
+}
+
+/*
+ * Crea un clon del hash: una copia con los mismos elementos en el momento de
+ * la llamada, que después se puede leer y modificar independientemente del
+ * original. Clonar es O(1): el clon comparte la tabla con el original, y
+ * cada uno copia solo las posiciones que modifica después (la primera
+ * modificación de cada uno copia además el arreglo de posiciones). Los
+ * elementos no se copian, así que si se destruyen con hash_destruir_todo
+ * solo debe hacerse con el último hash que los tenga.
+ *
+ * El clon no tiene filtro. No se pueden clonar los hash con HASH_COMPACTO,
+ * HASH_CUCKOO o HASH_POOL_NODOS, con alocador o límite de memoria, ni los
+ * que alguna vez usaron hash_insertar_con_ttl.
+ *
+ * Devuelve el clon o NULL en caso de error.
+ */
+hash_t *hash_clonar(hash_t *hash)
+{
+	if (!hash || usa_tabla_sin_listas(hash) || hash->pool_nodos ||
+	    hash->memoria || hash->rueda)
+		return NULL;
+	hash_t *clon = memoria_reservar(hash->memoria, sizeof(hash_t));
+	if (!clon)
+		return NULL;
+	if (!hash->referencias_tablas) {
+		hash->referencias_tablas =
+			memoria_reservar(hash->memoria, sizeof(size_t));
+		if (!hash->referencias_tablas) {
+			memoria_liberar(hash->memoria, clon);
+			return NULL;
+		}
+		*hash->referencias_tablas = 1;
+	}
+	*clon = *hash;
+	clon->flags &= ~HASH_FILTRO;
+	clon->filtro = NULL;
+	clon->estadisticas_filtro = (hash_estadisticas_filtro_t){ 0 };
+	(*hash->referencias_tablas)++;
+	return clon;
+}
+
+/**
+ * Recibe un hash y una cantidad de elementos, y agranda el hash para que
+ * entren sin rehash. A diferencia de hash_reservar, no cambia la capacidad
+ * mínima del hash, así que después puede volver a achicarse.
+ *
+ * Devuelve true si pudo o false en caso de error.
+*/
+bool agrandar_para(hash_t *hash, size_t cantidad)
+{
+	if (usa_tabla_sin_listas(hash))
+		return hash_reservar(hash, cantidad);
+	size_t capacidad = capacidad_para(hash, cantidad);
+	return capacidad <= hash->capacidad || rehash(hash, capacidad) == 0;
+}
+
+/**
+ * Recibe un hash, una clave, su suma (funcion_hash) y su huella
+ * (hash_fnv1a), y busca la clave sin volver a calcularlas (salvo en un hash
+ * cuckoo, que usa sus propias funciones). Si la clave está, guarda su valor
+ * en *valor.
+ *
+ * Devuelve true si la clave está o false en caso contrario.
+*/
+bool buscar_con_hashes(hash_t *hash, const char *clave, int suma,
+		       uint64_t huella, void **valor)
+{
+	void **encontrado = NULL;
+	if (hash->compacta) {
+		encontrado = tabla_compacta_buscar(hash->compacta, huella, clave);
+	} else if (hash->cuckoo) {
+		encontrado = tabla_cuckoo_buscar(hash->cuckoo, clave);
+	} else {
+		par_cv_t *par = buscar_par_vigente(
+			hash, clave, huella, suma % (int)hash->capacidad);
+		encontrado = par ? &par->valor : NULL;
+	}
+	if (encontrado)
+		*valor = *encontrado;
+	return encontrado != NULL;
+}
+
+/*
+ * Calcula una sola vez el hash de la clave para los hash creados sin
+ * semilla.
+ *
+ * Devuelve la clave calculada (con la clave NULL si la clave es NULL).
+ */
+hash_clave_t hash_calcular(const char *clave)
+{
+	return hash_calcular_con_semilla(clave, 0);
+}
+
+/*
+ * Calcula una sola vez el hash de la clave para los hash creados con la
+ * semilla dada: la huella (que usan los árboles, el filtro y la tabla
+ * compacta) y la suma de la que sale la posición en las tablas con listas.
+ *
+ * Devuelve la clave calculada (con la clave NULL si la clave es NULL).
+ */
+hash_clave_t hash_calcular_con_semilla(const char *clave, uint64_t semilla)
+{
+	hash_clave_t calculada = { .clave = clave, .semilla = semilla };
+	if (!clave)
+		return calculada;
+	calculada.huella = hash_fnv1a(clave);
+	calculada.suma = semilla ? suma_de_huella(calculada.huella, semilla) :
+				   funcion_hash(clave);
+	return calculada;
+}
+
+/*
+ * Inserta o actualiza un elemento igual que hash_insertar, pero con una
+ * clave ya calculada.
+ *
+ * Devuelve el hash si pudo guardar el elemento o NULL si no pudo.
+ */
+hash_t *hash_insertar_h(hash_t *hash, const hash_clave_t *clave,
+			void *elemento, void **anterior)
+{
+	if (!hash || !clave || !clave->clave)
+		return NULL;
+	if (usa_tabla_sin_listas(hash))
+		return insertar_sin_listas(hash, clave->clave, elemento,
+					   anterior);
+	if (!agrandar_si_hace_falta(hash))
+		return NULL;
+	par_cv_t *par = insertar_con_hashes(hash, clave->clave,
+					    suma_para(hash, clave),
+					    clave->huella, elemento, anterior,
+					    true);
+	if (!par)
+		return NULL;
+	quitar_vencimiento(hash, par);
+	return hash;
+}
+
+/*
+ * Devuelve el elemento con la clave ya calculada o NULL si no existe (o en
+ * caso de error).
+ */
+void *hash_obtener_h(hash_t *hash, const hash_clave_t *clave)
+{
+	void *valor = NULL;
+	if (hash && clave && clave->clave)
+		buscar_con_hashes(hash, clave->clave, suma_para(hash, clave),
+				  clave->huella, &valor);
+	return valor;
+}
+
+/*
+ * Devuelve true si el hash contiene la clave ya calculada o false en caso
+ * contrario (o en caso de error).
+ */
+bool hash_contiene_h(hash_t *hash, const hash_clave_t *clave)
+{
+	void *valor;
+	if (!hash || !clave || !clave->clave)
+		return false;
+	return buscar_con_hashes(hash, clave->clave, suma_para(hash, clave),
+				 clave->huella, &valor);
+}
+
+/*
+ * Quita el elemento con la clave ya calculada y lo devuelve.
+ *
+ * Si no encuentra el elemento o en caso de error devuelve NULL
+ */
+void *hash_quitar_h(hash_t *hash, const hash_clave_t *clave)
+{
+	if (!hash || !clave || !clave->clave)
+		return NULL;
+	if (usa_tabla_sin_listas(hash))
+		return hash_quitar(hash, clave->clave);
+	return quitar_en_posicion(hash, clave->clave, clave->huella,
+				  suma_para(hash, clave) %
+					  (int)hash->capacidad);
+}
+
+typedef struct estructura_auxiliar_conjuntos {
+	hash_t *otro;
+	hash_t *resultado;
+	bool recorre_el_primero;
+	bool quedan_las_comunes;
+	void *(*resolver)(const char *clave, void *valor, void *valor_otro,
+			  void *aux);
+	void *aux;
+	bool error;
+} aux_conjuntos_t;
+
+/**
+ * Recibe una clave y un valor del hash que se recorre, y un puntero a
+ * aux_conjuntos_t. Busca la clave en el otro hash y, si la clave está y
+ * quedan las comunes (intersección) o no está y quedan las que no son
+ * comunes (diferencia), la agrega al resultado. La clave se calcula una sola
+ * vez para buscar y para agregar (si el resultado tiene otra semilla, solo
+ * se vuelve a mezclar su huella).
+ *
+ * Devuelve false (para cortar el recorrido) en caso de error.
 */
-hash_t *inicializar_tabla(hash_t *hash)
+bool agregar_segun_el_otro(const char *clave, void *valor, void *aux)
+{
+	aux_conjuntos_t *conjuntos = aux;
+	hash_clave_t calculada =
+		hash_calcular_con_semilla(clave, conjuntos->otro->semilla);
+	void *valor_otro = NULL;
+	bool esta = buscar_con_hashes(conjuntos->otro, clave, calculada.suma,
+				      calculada.huella, &valor_otro);
+	if (esta != conjuntos->quedan_las_comunes)
+		return true;
+	if (esta) {
+		void *primero = conjuntos->recorre_el_primero ? valor :
+								valor_otro;
+		void *segundo = conjuntos->recorre_el_primero ? valor_otro :
+								valor;
+		valor = conjuntos->resolver ?
+				conjuntos->resolver(clave, primero, segundo,
+						    conjuntos->aux) :
+				primero;
+	}
+	hash_t *resultado = conjuntos->resultado;
+	if (usa_tabla_sin_listas(resultado))
+		conjuntos->error =
+			!insertar_sin_listas(resultado, clave, valor, NULL);
+	else
+		conjuntos->error = !insertar_con_hashes(
+			resultado, clave, suma_para(resultado, &calculada),
+			calculada.huella, valor, NULL, false);
+	return !conjuntos->error;
+}
+
+/**
+ * Recibe los parámetros de hash_interseccion o hash_diferencia, y arma el
+ * hash resultado recorriendo el hash recorrido y buscando cada clave en el
+ * otro.
+ *
+ * Devuelve el resultado o NULL en caso de error.
+*/
+hash_t *operar_conjuntos(hash_t *recorrido, aux_conjuntos_t *conjuntos,
+			 const hash_opciones_t *opciones, size_t cantidad)
 {
-	hash->tabla = calloc(hash->capacidad, sizeof(lista_t *));
-	if (!hash->tabla)
+	conjuntos->resultado = hash_crear_con_opciones(TAMANIO_HASH_MINIMO,
+						       opciones);
+	if (!conjuntos->resultado)
+		return NULL;
+	if (!agrandar_para(conjuntos->resultado, cantidad)) {
+		hash_destruir(conjuntos->resultado);
 		return NULL;
-	for (int i = 0; i < hash->capacidad; i++) {
-		hash->tabla[i] = lista_crear();
 	}
-	return hash;
+	hash_con_cada_clave(recorrido, agregar_segun_el_otro, conjuntos);
+	if (conjuntos->error) {
+		hash_destruir(conjuntos->resultado);
+		return NULL;
+	}
+	return conjuntos->resultado;
 }
 
 /*
- * Crea el hash reservando la memoria necesaria para el.
+ * Crea un hash con las opciones dadas (que pueden ser NULL) con las claves
+ * que están en ambos hash. El valor de cada clave es el que devuelve
+ * resolver con la clave, el valor en hash, el valor en otro y el puntero
+ * auxiliar, o el valor en hash si resolver es NULL.
  *
- * Capacidad indica la capacidad inicial con la que se crea el hash. La
- * capacidad inicial no puede ser menor a 3. Si se solicita una capacidad menor,
- * el hash se creará con una capacidad de 3.
+ * Se recorre el hash con menos elementos y se busca cada clave en el otro,
+ * calculando el hash de cada clave una sola vez. El resultado se crea con
+ * lugar para todas las claves del menor. Si el resultado usa claves
+ * prestadas, sus claves son las de hash o las de otro.
  *
- * Devuelve un puntero al hash creado o NULL en caso de no poder crearlo.
+ * Devuelve el resultado o NULL en caso de error.
  */
-hash_t *hash_crear(size_t capacidad)
+hash_t *hash_interseccion(hash_t *hash, hash_t *otro,
+			  const hash_opciones_t *opciones,
+			  void *(*resolver)(const char *clave, void *valor,
+					    void *valor_otro, void *aux),
+			  void *aux)
 {
-	if (capacidad < TAMANIO_HASH_MINIMO)
-		capacidad = 3;
-	hash_t *hash = malloc(sizeof(hash_t));
-	if (!hash)
+	if (!hash || !otro)
 		return NULL;
-	hash->cantidad = 0;
-	hash->capacidad = capacidad;
-	return inicializar_tabla(hash);
+	bool recorre_el_primero = hash->cantidad <= otro->cantidad;
+	aux_conjuntos_t conjuntos = {
+		.otro = recorre_el_primero ? otro : hash,
+		.recorre_el_primero = recorre_el_primero,
+		.quedan_las_comunes = true,
+		.resolver = resolver,
+		.aux = aux
+	};
+	return operar_conjuntos(recorre_el_primero ? hash : otro, &conjuntos,
+				opciones,
+				recorre_el_primero ? hash->cantidad :
+						     otro->cantidad);
+}
+
+/*
+ * Crea un hash con las opciones dadas (que pueden ser NULL) con las claves
+ * de hash que no están en otro, con sus valores.
+ *
+ * Devuelve el resultado o NULL en caso de error.
+ */
+hash_t *hash_diferencia(hash_t *hash, hash_t *otro,
+			const hash_opciones_t *opciones)
+{
+	if (!hash || !otro)
+		return NULL;
+	aux_conjuntos_t conjuntos = { .otro = otro, .recorre_el_primero = true };
+	return operar_conjuntos(hash, &conjuntos, opciones, hash->cantidad);
 }
 
 /**
- * Función hash.
- * 
- * Recibe una clave que es un string, y suma sus valores ascii.
- * 
- * Devuelve la suma.
+ * Recibe el hash destino y el hash origen de una fusión.
+ *
+ * Devuelve true si los pares del origen se pueden mover al destino sin
+ * copiarlos: los dos usan listas, guardan las claves de la misma manera,
+ * reservan con malloc, y el origen no tiene vencimientos.
 */
-int funcion_hash(const char *clave)
+bool se_pueden_mover_pares(hash_t *hash, hash_t *otro)
 {
-	int i = 0, suma = 0;
-	while (i < strlen(clave)) {
-		suma = suma + clave[i];
-		i++;
+	return !usa_tabla_sin_listas(hash) && !usa_tabla_sin_listas(otro) &&
+	       (hash->flags & HASH_CLAVES_PRESTADAS) ==
+		       (otro->flags & HASH_CLAVES_PRESTADAS) &&
+	       hash->pool_claves == otro->pool_claves && !hash->memoria &&
+	       !otro->memoria && !otro->rueda;
+}
+
+typedef struct estructura_auxiliar_juntados {
+	memoria_t *memoria;
+	void **elementos;
+	size_t cantidad;
+	size_t capacidad;
+} juntados_t;
+
+/**
+ * Recibe un elemento (un par o una clave) y un puntero a juntados_t, y
+ * agrega el elemento al final del arreglo, agrandándolo (con la memoria del
+ * hash) si hace falta.
+ *
+ * Devuelve false en caso de error.
+*/
+bool juntar_elemento(void *elemento, void *aux)
+{
+	juntados_t *juntados = aux;
+	if (juntados->cantidad == juntados->capacidad) {
+		size_t capacidad = juntados->capacidad ?
+					   juntados->capacidad * 2 :
+					   UMBRAL_ARBOL;
+		void **elementos = memoria_redimensionar(
+			juntados->memoria, juntados->elementos,
+			capacidad * sizeof(void *));
+		if (!elementos)
+			return false;
+		juntados->elementos = elementos;
+		juntados->capacidad = capacidad;
 	}
-	return suma;
+	juntados->elementos[juntados->cantidad++] = elemento;
+	return true;
 }
 
+typedef struct estructura_auxiliar_fusion {
+	hash_t *hash;
+	void *(*resolver)(const char *clave, void *valor, void *valor_otro,
+			  void *aux);
+	void *aux;
+	juntados_t juntados;
+	bool error;
+} aux_fusion_t;
+
 /**
- * Recibe un par_cv_t pointer y una clave.
- * 
- * Compara la clave con la clave del par y devuelve un número mayor que cero
- * si la clave del par es mayor, o menor que cero si es menor, o cero si son
- * iguales.
+ * Recibe el destino de una fusión y un par del otro hash.
+ *
+ * Devuelve la posición del destino que le corresponde a la clave del par,
+ * dejándola lista para escribir, o -1 en caso de error.
 */
-int comparador_claves(void *par, void *clave)
+int posicion_en_el_destino(hash_t *hash, par_cv_t *par)
 {
-	const char *clave1 = ((par_cv_t *)par)->clave;
-	return strcmp(clave1, clave);
+	int posicion = suma_con_semilla(par->clave, hash->semilla) %
+		       (int)hash->capacidad;
+	return preparar_escritura(hash, posicion) ? posicion : -1;
 }
 
 /**
- * Recibe dos par_cv_t pointers y compara sus claves. 
- * 
- * Si son iguales se reemplaza el valor del primero por el del segundo 
- * y devuelve false. Si no son iguales devuelve true.
+ * Recibe el destino de una fusión y los pares que se insertaron en él (sin
+ * sacarlos todavía del otro), y los vuelve a sacar del destino.
 */
-bool cambiar_valor_de_clave_repetida(void *par1, void *par2)
+void deshacer_movidos(hash_t *hash, void **movidos, size_t cantidad)
 {
-	const char *clave = ((par_cv_t *)par2)->clave;
-	void *valor = ((par_cv_t *)par2)->valor;
-	if (comparador_claves(par1, (void *)clave) == 0) {
-		((par_cv_t *)par1)->valor = valor;
-		return false;
+	for (size_t i = 0; i < cantidad; i++) {
+		par_cv_t *par = movidos[i];
+		quitar_de_posicion(hash, par->clave, hash_fnv1a(par->clave),
+				   posicion_en_el_destino(hash, par));
 	}
-	return true;
 }
 
 /**
- * Recibe un puntero a hash, un doble puntero a void (anterior), una clave
- * y una posición de la tabla hash. 
- * 
- * Si el anterior no es NULL, busca si hay algún elemento en la lista que
- * se encuentra en la posición pasada por parámetro de la tabla que tenga
- * la misma clave que la pasada por parámetro.
- * 
- * Si la hay, reemplaza lo que había en *anterior por el valor de ese par
- * encontrado. Caso contrario, *anterior pasa a ser NULL. 
+ * Recibe un hash y una posición de su tabla, y la deja vacía sin liberar
+ * sus pares.
 */
-void actualizar_anterior(hash_t *hash, void **anterior, const char *clave,
-			 int posicion)
+void vaciar_posicion(hash_t *hash, int posicion)
 {
-	if (anterior) {
-		par_cv_t *par_anterior =
-			lista_buscar_elemento(hash->tabla[posicion],
-					      comparador_claves, (void *)clave);
-		if (par_anterior)
-			*anterior = par_anterior->valor;
-		else
-			*anterior = NULL;
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	if (arbol) {
+		arbol_destruir(arbol);
+		hash->arboles[posicion] = NULL;
+		return;
 	}
+	lista_t *lista = hash->tabla[posicion];
+	while (!lista_vacia(lista))
+		lista_quitar_de_posicion(lista, 0);
 }
 
-/*
- * Inserta o actualiza un elemento en el hash asociado a la clave dada.
- *
- * Si la clave ya existía y se reemplaza el elemento, se almacena un puntero al
- * elemento reemplazado en *anterior, si anterior no es NULL.
- *
- * Si la clave no existía y anterior no es NULL, se almacena NULL en *anterior.
+/**
+ * Recibe el otro hash de una fusión, una posición de su tabla cuyos pares
+ * ya están juntados en el aux_fusion_t, y el aux_fusion_t.
  *
- * La función almacena una copia de la clave provista por el usuario.
+ * Primero inserta en el destino (sin copiarlos) los pares cuya clave no
+ * está en el destino, dejando al principio de los juntados los movidos y al
+ * final los repetidos. Si todos entran, vacía la posición del otro de una
+ * vez, resuelve los valores de las claves repetidas y libera sus pares. Si
+ * alguno no entra, saca del destino los que ya había insertado y la
+ * posición queda como estaba.
  *
- * Devuelve el hash si pudo guardar el elemento o NULL si no pudo.
- */
-hash_t *insertar_sin_rehash(hash_t *hash, const char *clave, void *elemento,
-			    void **anterior, bool hash_buscar_duplicado)
+ * Devuelve true si pudo hacerlo o false en caso de error.
+*/
+bool mover_posicion(hash_t *otro, int posicion_otro, aux_fusion_t *fusion)
 {
-	par_cv_t *par = malloc(sizeof(par_cv_t));
-	if (!par)
-		return NULL;
-	char *clave_copia = malloc((strlen(clave) + 1));
-	if (!clave_copia) {
-		free(par);
-		return NULL;
-	}
-	strcpy(clave_copia, clave);
-	par->clave = clave_copia;
-	par->valor = elemento;
-	int posicion = funcion_hash(clave) % (int)((hash_t *)hash)->capacidad;
-	actualizar_anterior(hash, anterior, clave, posicion);
-	if (hash_buscar_duplicado) {
-		size_t pares_iterados = lista_con_cada_elemento(
-			hash->tabla[posicion], cambiar_valor_de_clave_repetida,
-			par);
-		if (pares_iterados < lista_tamanio(hash->tabla[posicion])) {
-			free(clave_copia);
-			free(par);
-			return hash;
+	hash_t *hash = fusion->hash;
+	void **juntados = fusion->juntados.elementos;
+	size_t movidos = 0;
+	for (size_t i = 0; i < fusion->juntados.cantidad; i++) {
+		par_cv_t *par = juntados[i];
+		uint64_t huella = hash_fnv1a(par->clave);
+		int posicion = posicion_en_el_destino(hash, par);
+		if (posicion >= 0 &&
+		    buscar_par_vigente(hash, par->clave, huella, posicion))
+			continue;
+		if (posicion < 0 ||
+		    !insertar_en_posicion(hash, posicion, par, huella)) {
+			deshacer_movidos(hash, juntados, movidos);
+			return false;
 		}
+		juntados[i] = juntados[movidos];
+		juntados[movidos++] = par;
 	}
-	if (!lista_insertar(((hash_t *)hash)->tabla[posicion], par)) {
-		free(clave_copia);
-		free(par);
-		return NULL;
+	vaciar_posicion(otro, posicion_otro);
+	for (size_t i = 0; i < movidos; i++) {
+		uint64_t huella = hash_fnv1a(((par_cv_t *)juntados[i])->clave);
+		filtro_quitar(otro->filtro, huella);
+		filtro_agregar(hash->filtro, huella);
 	}
-	hash->cantidad++;
-	return hash;
+	otro->cantidad -= movidos;
+	hash->cantidad += movidos;
+	for (size_t i = movidos; i < fusion->juntados.cantidad; i++) {
+		par_cv_t *par = juntados[i];
+		par_cv_t *existente = buscar_en_posicion(
+			hash, par->clave, hash_fnv1a(par->clave),
+			posicion_en_el_destino(hash, par));
+		existente->valor =
+			fusion->resolver ?
+				fusion->resolver(par->clave, existente->valor,
+						 par->valor, fusion->aux) :
+				par->valor;
+		quitar_elemento(otro, par);
+	}
+	return true;
 }
 
 /**
- * Recibe dos punteros a hash, donde el primero tiene el doble de capacidad
- * que el primero (y obviamente su tabla es el doble de grande).
- * 
- * Intercambia las tablas de cada hash, duplica la capacidad del primer
- * hash y demedia la del segundo, y por último destruye el segundo hash.
- * 
- * Es decir que los datos de ambos hash se intercambian, y el segundo se
- * libera.
+ * Recibe el destino de una fusión y la cantidad de pares que se le van a
+ * mover. Si con ellos el destino superaría su factor de carga máximo, lo
+ * agranda como al insertar: multiplicando la capacidad por el factor de
+ * crecimiento (o más, si no alcanza).
+ *
+ * Devuelve true si pudo o false en caso de error.
 */
-void hash_swap_y_liberar_uno(hash_t *hash, hash_t *hash_a_quitar)
+bool agrandar_antes_de_mover(hash_t *hash, size_t cantidad)
 {
-	lista_t **tabla_aux = hash->tabla;
-	hash->tabla = hash_a_quitar->tabla;
-	hash_a_quitar->tabla = tabla_aux;
-	hash->capacidad = hash->capacidad * 2;
-	hash_a_quitar->capacidad = hash_a_quitar->capacidad / 2;
-	hash_destruir(hash_a_quitar);
+	size_t total = hash->cantidad + cantidad;
+	if (total <= elementos_maximos(hash, hash->capacidad))
+		return true;
+	size_t capacidad =
+		(size_t)((double)hash->capacidad * hash->factor_crecimiento);
+	if (capacidad < capacidad_para(hash, total))
+		capacidad = capacidad_para(hash, total);
+	return rehash(hash, capacidad) == 0;
 }
 
 /**
- * Recibe una clave, un valor y un hash.
- * 
- * Inserta un par clave-valor con los pasados por parámetro en el hash.
- * 
- * Devuelve true si se pudo insertar, o false si no se pudo.
+ * Recibe el destino y el origen de una fusión en la que se pueden mover los
+ * pares, y los mueve posición por posición, agrandando el destino cuando
+ * hace falta.
+ *
+ * Devuelve true si pudo o false en caso de error.
 */
-bool hash_insertar_par(const char *clave, void *valor, void *hash)
+bool mover_pares(hash_t *otro, aux_fusion_t *fusion)
 {
-	if (!insertar_sin_rehash(hash, clave, valor, NULL, false))
-		return false;
-	return true;
+	for (int i = 0; i < otro->capacidad && !fusion->error; i++) {
+		if (!tamanio_de_posicion(otro, i))
+			continue;
+		fusion->juntados.cantidad = 0;
+		fusion->error = !agrandar_antes_de_mover(
+					fusion->hash,
+					tamanio_de_posicion(otro, i)) ||
+				!preparar_escritura(otro, i) ||
+				con_cada_par_de_posicion(otro, i,
+							 juntar_elemento,
+							 &fusion->juntados) <
+					tamanio_de_posicion(otro, i) ||
+				!mover_posicion(otro, i, fusion);
+	}
+	return !fusion->error;
 }
 
 /**
- * Recibe un puntero a hash, duplica su capacidad y re-inserta sus elementos
- * con la nueva capacidad.
- * 
- * Devuelve cero si se pudo agrandar el hash, o -1 en caso de error (el hash
- * queda como se recibió).
+ * Recibe una clave y un valor del otro hash de una fusión, y un puntero a
+ * aux_fusion_t. Inserta la clave en el destino (resolviendo el valor si ya
+ * estaba) y la anota para quitarla después del otro.
+ *
+ * Devuelve false (para cortar el recorrido) en caso de error.
 */
-int rehash(hash_t *hash)
+bool copiar_al_destino(const char *clave, void *valor, void *aux)
 {
-	hash_t *nuevo_hash = hash_crear(hash->capacidad * 2);
-	if (!nuevo_hash)
-		return -1;
-	size_t pares_insertados =
-		hash_con_cada_clave(hash, hash_insertar_par, nuevo_hash);
-	if (pares_insertados < hash->cantidad) {
-		hash_destruir(nuevo_hash);
-		return -1;
-	}
-	hash_swap_y_liberar_uno(hash, nuevo_hash);
-	return 0;
+	aux_fusion_t *fusion = aux;
+	void *valor_destino = NULL;
+	if (fusion->resolver &&
+	    buscar_con_hashes(fusion->hash, clave,
+			      suma_con_semilla(clave, fusion->hash->semilla),
+			      hash_fnv1a(clave), &valor_destino))
+		valor = fusion->resolver(clave, valor_destino, valor,
+					 fusion->aux);
+	fusion->error = !hash_insertar(fusion->hash, clave, valor, NULL) ||
+			!juntar_elemento((void *)clave, &fusion->juntados);
+	return !fusion->error;
 }
 
-/*
- * Inserta o actualiza un elemento en el hash asociado a la clave dada.
- *
- * Si el factor de carga del hash (cantidad / capacidad) es mayor a 0.7,
- * duplica la capacidad del hash para evitar futuras colisiones.
- * 
- * Si la clave ya existía y se reemplaza el elemento, se almacena un puntero al
- * elemento reemplazado en *anterior, si anterior no es NULL.
+/**
+ * Recibe el destino y el origen de una fusión en la que no se pueden mover
+ * los pares, y copia las claves al destino. Después quita del otro las
+ * claves que copió.
  *
- * Si la clave no existía y anterior no es NULL, se almacena NULL en *anterior.
+ * Devuelve true si pudo o false en caso de error.
+*/
+bool copiar_pares(hash_t *otro, aux_fusion_t *fusion)
+{
+	if (otro->rueda)
+		hash_expirar(otro, 0);
+	hash_con_cada_clave(otro, copiar_al_destino, fusion);
+	for (size_t i = 0; i < fusion->juntados.cantidad; i++)
+		hash_quitar(otro, fusion->juntados.elementos[i]);
+	return !fusion->error;
+}
+
+/*
+ * Mueve todos los elementos de otro a hash, dejando a otro vacío. Si una
+ * clave está en los dos, su valor pasa a ser el que devuelve resolver con la
+ * clave, el valor en hash, el valor en otro y el puntero auxiliar, o el
+ * valor en otro si resolver es NULL.
  *
- * La función almacena una copia de la clave provista por el usuario.
+ * Antes de mover, hash se agranda para que entren tantos elementos como
+ * tiene el mayor de los dos (la unión tiene al menos esos), y después crece
+ * como al insertar si hace falta. Si los dos hash usan listas, guardan las
+ * claves de la misma manera, no tienen alocador y otro no tiene
+ * vencimientos, los pares pasan de una tabla a la otra sin copiar las
+ * claves. Si no, las claves se insertan en hash y se quitan de otro. Si hash
+ * usa claves prestadas, otro también debe usarlas.
  *
- * Devuelve el hash si pudo guardar el elemento o NULL si no pudo.
+ * Devuelve hash o NULL en caso de error (en cuyo caso algunos elementos
+ * pueden haber pasado a hash, y el resto sigue en otro).
  */
-hash_t *hash_insertar(hash_t *hash, const char *clave, void *elemento,
-		      void **anterior)
+hash_t *hash_fusionar(hash_t *hash, hash_t *otro,
+		      void *(*resolver)(const char *clave, void *valor,
+					void *valor_otro, void *aux),
+		      void *aux)
 {
-	if (!hash || !clave)
+	if (!hash || !otro || hash == otro ||
+	    ((hash->flags & HASH_CLAVES_PRESTADAS) &&
+	     !(otro->flags & HASH_CLAVES_PRESTADAS)))
 		return NULL;
-	float factor_de_carga = (float)hash->cantidad / (float)hash->capacidad;
-	if (factor_de_carga > FACTOR_CARGA_MAXIMO)
-		if (rehash(hash) == -1)
-			return NULL;
-	return insertar_sin_rehash(hash, clave, elemento, anterior, true);
+	if (!agrandar_para(hash, hash->cantidad > otro->cantidad ?
+					 hash->cantidad :
+					 otro->cantidad))
+		return NULL;
+	aux_fusion_t fusion = { .hash = hash,
+				.resolver = resolver,
+				.aux = aux,
+				.juntados = { .memoria = hash->memoria } };
+	bool ok = se_pueden_mover_pares(hash, otro) ?
+			  mover_pares(otro, &fusion) :
+			  copiar_pares(otro, &fusion);
+	memoria_liberar(hash->memoria, fusion.juntados.elementos);
+	if (!usa_tabla_sin_listas(otro))
+		achicar_si_hace_falta(otro);
+	return ok ? hash : NULL;
 }
 
+typedef struct estructura_auxiliar_quitar_si {
+	bool (*predicado)(const char *clave, void *valor, void *aux);
+	void *aux;
+	uint64_t ahora;
+	juntados_t quitados;
+	bool error;
+} aux_quitar_si_t;
+
 /**
- * Recibe un par_cv_t pointer y una clave.
- * 
- * Compara la clave con la clave del par y devuelve true si son distintas, o
- * false si son iguales.
+ * Recibe un par y un puntero a aux_quitar_si_t. Si el par no venció y
+ * cumple el predicado, lo agrega a los quitados.
+ *
+ * Devuelve true si el par se debe quitar, o false si no (o si no se pudo
+ * agregar a los quitados, en cuyo caso marca el error).
 */
-bool encontrar_elemento_con_clave(void *par, void *clave)
+bool par_a_quitar(void *par, void *aux)
 {
-	return (comparador_claves(par, clave) != 0);
+	aux_quitar_si_t *quitar = aux;
+	par_cv_t *par_cv = par;
+	if (quitar->error || (par_cv->temporizador &&
+			      par_cv->temporizador->vencimiento <= quitar->ahora))
+		return false;
+	if (!quitar->predicado(par_cv->clave, par_cv->valor, quitar->aux))
+		return false;
+	quitar->error = !juntar_elemento(par, &quitar->quitados);
+	return !quitar->error;
 }
 
 /**
- * Recibe un hash, una posición de la tabla del hash, y una posición de la
- * lista a la que apunta la tabla en posicion_hash.
- * 
- * Quita el elemento que se encuentra en posicion_lista, de la lista que se
- * encuentra en posición_hash. Libera el par y la clave quitados, y devuelve
- * el valor del par.
+ * Recibe un par y un puntero a aux_quitar_si_t, y junta el par si hay que
+ * quitarlo, sin sacarlo de su posición.
+ *
+ * Devuelve false (para cortar el recorrido) en caso de error.
 */
-void *quitar_elemento(hash_t *hash, size_t posicion_lista, int posicion_hash)
+bool juntar_par_a_quitar(void *par, void *aux)
 {
-	par_cv_t *par_quitado = lista_quitar_de_posicion(
-		hash->tabla[posicion_hash], posicion_lista);
-	void *elemento_quitado = par_quitado->valor;
-	free(par_quitado->clave);
-	free(par_quitado);
-	hash->cantidad--;
-	return elemento_quitado;
+	par_a_quitar(par, aux);
+	return !((aux_quitar_si_t *)aux)->error;
 }
 
-/*
- * Quita un elemento del hash y lo devuelve.
+/**
+ * Recibe una clave y un valor de un hash sin listas, y un puntero a
+ * aux_quitar_si_t. Si la entrada cumple el predicado, junta su clave.
  *
- * Si no encuentra el elemento o en caso de error devuelve NULL
- */
-void *hash_quitar(hash_t *hash, const char *clave)
+ * Devuelve false (para cortar el recorrido) en caso de error.
+*/
+bool juntar_entrada_a_quitar(char *clave, void *valor, void *aux)
 {
-	if (!hash || !clave)
-		return NULL;
-	int posicion = funcion_hash(clave) % (int)((hash_t *)hash)->capacidad;
-	size_t posicion_a_quitar = lista_con_cada_elemento(
-		hash->tabla[posicion], encontrar_elemento_con_clave,
-		(void *)clave);
-	if (posicion_a_quitar < lista_tamanio(hash->tabla[posicion])) {
-		return quitar_elemento(hash, posicion_a_quitar, posicion);
+	aux_quitar_si_t *quitar = aux;
+	if (quitar->predicado(clave, valor, quitar->aux))
+		quitar->error = !juntar_elemento(clave, &quitar->quitados);
+	return !quitar->error;
+}
+
+/**
+ * Recibe un hash con listas, una posición de su tabla y un puntero a
+ * aux_quitar_si_t, y saca de la posición los pares que cumplen el
+ * predicado, dejándolos en los quitados (sin liberarlos).
+ *
+ * Si la posición es propia, la recorre una sola vez con lista_quitar_si o
+ * arbol_quitar_si. Si está compartida con un clon, primero junta los pares
+ * a quitar, y solo si hay alguno copia la posición y los saca de la copia.
+*/
+void quitar_de_posicion_si(hash_t *hash, int posicion, aux_quitar_si_t *quitar)
+{
+	arbol_t *arbol = arbol_de_posicion(hash, posicion);
+	if (!posicion_compartida(hash, posicion)) {
+		if (!arbol) {
+			lista_quitar_si(hash->tabla[posicion], par_a_quitar,
+					quitar);
+		} else if (arbol_quitar_si(arbol, par_a_quitar, quitar) &&
+			   arbol_tamanio(arbol) <= UMBRAL_LISTA) {
+			convertir_en_lista(hash, posicion);
+		}
+		return;
+	}
+	con_cada_par_de_posicion(hash, posicion, juntar_par_a_quitar, quitar);
+	if (!quitar->quitados.cantidad)
+		return;
+	if (!preparar_escritura(hash, posicion)) {
+		quitar->quitados.cantidad = 0;
+		quitar->error = true;
+		return;
+	}
+	void **quitados = quitar->quitados.elementos;
+	for (size_t i = 0; i < quitar->quitados.cantidad; i++) {
+		const char *clave = ((par_cv_t *)quitados[i])->clave;
+		quitados[i] = quitar_de_posicion(hash, clave, hash_fnv1a(clave),
+						 posicion);
 	}
-	return NULL;
 }
 
-/*
- * Devuelve un elemento del hash con la clave dada o NULL si dicho
- * elemento no existe (o en caso de error).
- */
-void *hash_obtener(hash_t *hash, const char *clave)
+/**
+ * Recibe un hash y un puntero a aux_quitar_si_t con los pares que se
+ * sacaron de una posición, y los libera todos juntos, pasando cada valor al
+ * destructor (si lo hay).
+*/
+void liberar_quitados(hash_t *hash, aux_quitar_si_t *quitar,
+		      void (*destructor)(void *))
 {
-	if (!hash || !clave)
-		return NULL;
-	int posicion = funcion_hash(clave) % (int)((hash_t *)hash)->capacidad;
-	par_cv_t *par_encontrado = lista_buscar_elemento(
-		hash->tabla[posicion], comparador_claves, (void *)clave);
-	if (par_encontrado)
-		return par_encontrado->valor;
-	return NULL;
+	for (size_t i = 0; i < quitar->quitados.cantidad; i++) {
+		void *valor = quitar_elemento(hash, quitar->quitados.elementos[i]);
+		if (destructor)
+			destructor(valor);
+	}
+	quitar->quitados.cantidad = 0;
+}
+
+/**
+ * Recibe los parámetros de hash_quitar_si para un hash sin listas. Junta
+ * las claves que cumplen el predicado y después las quita.
+ *
+ * Devuelve la cantidad de elementos quitados.
+*/
+size_t quitar_si_sin_listas(hash_t *hash, aux_quitar_si_t *quitar,
+			    void (*destructor)(void *))
+{
+	con_cada_entrada_sin_listas(hash, juntar_entrada_a_quitar, quitar);
+	size_t quitados = 0;
+	for (size_t i = 0; i < quitar->quitados.cantidad; i++) {
+		void *valor = NULL;
+		if (!quitar_sin_listas(hash, quitar->quitados.elementos[i],
+				       &valor))
+			continue;
+		quitados++;
+		if (destructor)
+			destructor(valor);
+	}
+	return quitados;
 }
 
 /*
- * Devuelve true si el hash contiene un elemento almacenado con la
- * clave dada o false en caso contrario (o en caso de error).
+ * Quita del hash todos los elementos para los que predicado(clave, valor,
+ * aux) devuelve true, recorriendo la tabla una sola vez, y pasa cada valor
+ * quitado al destructor (si no es NULL).
+ *
+ * Los pares de cada posición se sacan sin volver a calcular la posición de
+ * sus claves, y se liberan todos juntos al terminar la posición.
+ * Al final, el hash se achica si quedó por debajo de su factor de carga
+ * mínimo.
+ *
+ * Devuelve la cantidad de elementos quitados (en caso de error, los que se
+ * llegaron a quitar).
  */
-bool hash_contiene(hash_t *hash, const char *clave)
+size_t hash_quitar_si(hash_t *hash,
+		      bool (*predicado)(const char *clave, void *valor,
+					void *aux),
+		      void *aux, void (*destructor)(void *))
 {
-	if (!hash || !clave)
-		return false;
-	int posicion = funcion_hash(clave) % (int)((hash_t *)hash)->capacidad;
-	par_cv_t *par_encontrado = lista_buscar_elemento(
-		hash->tabla[posicion], comparador_claves, (void *)clave);
-	return par_encontrado != NULL;
+	if (!hash || !predicado)
+		return 0;
+	aux_quitar_si_t quitar = { .predicado = predicado,
+				   .aux = aux,
+				   .quitados = { .memoria = hash->memoria } };
+	size_t quitados = 0;
+	if (usa_tabla_sin_listas(hash)) {
+		quitados = quitar_si_sin_listas(hash, &quitar, destructor);
+		memoria_liberar(hash->memoria, quitar.quitados.elementos);
+		return quitados;
+	}
+	if (hash->rueda)
+		quitar.ahora = tiempo_actual(hash);
+	for (int i = 0; i < hash->capacidad && !quitar.error; i++) {
+		if (!tamanio_de_posicion(hash, i))
+			continue;
+		quitar_de_posicion_si(hash, i, &quitar);
+		quitados += quitar.quitados.cantidad;
+		liberar_quitados(hash, &quitar, destructor);
+	}
+	memoria_liberar(hash->memoria, quitar.quitados.elementos);
+	achicar_si_hace_falta(hash);
+	return quitados;
 }
 
 /*
- * Devuelve la cantidad de elementos almacenados en el hash o 0 en
- * caso de error.
+ * Devuelve la cantidad de bytes que el hash tiene reservados, si se creó con
+ * un alocador o un límite de memoria, o 0 en otro caso (o en caso de error).
  */
-size_t hash_cantidad(hash_t *hash)
+size_t hash_memoria_usada(hash_t *hash)
 {
 	if (!hash)
 		return 0;
-	return hash->cantidad;
+	return memoria_usada(hash->memoria);
 }
 
 typedef struct estructura_auxiliar_para_destructor {
 	void (*destructor)(void *);
+	hash_t *hash;
+	uint64_t ahora;
 } destructor_t;
 
 /**
- * Recibe una clave, un valor y un puntero a destructor_t que contiene una
- * función destructora. Si la función no es NULL la invoca pasándole el valor
- * por parámetro, y luego libera la clave.
+ * Recibe un par_cv_t pointer y un puntero a destructor_t que contiene una
+ * función destructora y el hash destruido. Si el par ya venció, invoca a la
+ * función destructora de elementos vencidos del hash con el valor, y si no,
+ * invoca a la función destructora recibida (si no son NULL). Luego libera la
+ * clave, el vencimiento y el par.
  *
  * Devuelve true.
 */
-bool destruir_todo(const char *clave, void *valor, void *destructor_aux)
+bool destruir_par(void *par, void *destructor_aux)
 {
-	void (*destructor)(void *) =
-		((destructor_t *)destructor_aux)->destructor;
-	if (destructor) {
-		destructor(valor);
-	}
-	free((void *)clave);
+	destructor_t *aux = destructor_aux;
+	par_cv_t *par_destruido = par;
+	void (*destructor)(void *) = aux->destructor;
+	if (par_destruido->temporizador &&
+	    par_destruido->temporizador->vencimiento <= aux->ahora)
+		destructor = aux->hash->destructor_expirados;
+	if (destructor)
+		destructor(par_destruido->valor);
+	memoria_liberar(aux->hash->memoria, par_destruido->temporizador);
+	liberar_clave(aux->hash, par_destruido->clave);
+	memoria_liberar(aux->hash->memoria, par_destruido);
+	return true;
+}
+
+/**
+ * Recibe una clave y un valor de un hash que no usa listas, y un puntero a
+ * destructor_t. Invoca a la función destructora con el valor (si no es
+ * NULL) y libera la clave.
+ *
+ * Devuelve true.
+*/
+bool destruir_entrada(char *clave, void *valor, void *destructor_aux)
+{
+	destructor_t *aux = destructor_aux;
+	if (aux->destructor)
+		aux->destructor(valor);
+	liberar_clave(aux->hash, clave);
+	return true;
+}
+
+/*
+ * Si el hash tiene filtro, guarda sus estadísticas en *estadisticas y
+ * devuelve true. Devuelve false si el hash no tiene filtro (o en caso de
+ * error).
+ */
+bool hash_estadisticas_filtro(hash_t *hash,
+			      hash_estadisticas_filtro_t *estadisticas)
+{
+	if (!hash || !hash->filtro || !estadisticas)
+		return false;
+	*estadisticas = hash->estadisticas_filtro;
+	size_t ausentes = estadisticas->descartadas +
+			  estadisticas->falsos_positivos;
+	estadisticas->tasa_falsos_positivos =
+		ausentes ? (double)estadisticas->falsos_positivos /
+				   (double)ausentes :
+			   0;
 	return true;
 }
 
@@ -377,18 +2247,42 @@ void hash_destruir_todo(hash_t *hash, void (*destructor)(void *))
 {
 	if (!hash)
 		return;
-	destructor_t destructor_aux = { .destructor = destructor };
-	hash_con_cada_clave(hash, destruir_todo, (void *)&destructor_aux);
-	for (int i = 0; i < hash->capacidad; i++) {
-		lista_destruir_todo(hash->tabla[i], free);
+	destructor_t destructor_aux = { .destructor = destructor,
+					.hash = hash };
+	if (usa_tabla_sin_listas(hash)) {
+		con_cada_entrada_sin_listas(hash, destruir_entrada,
+					    &destructor_aux);
+		tabla_compacta_destruir(hash->compacta);
+		tabla_cuckoo_destruir(hash->cuckoo);
+		liberar_hash(hash);
+		return;
 	}
-	free(hash->tabla);
-	free(hash);
+	if (hash->rueda)
+		destructor_aux.ahora = tiempo_actual(hash);
+	if (hash->referencias_tablas && *hash->referencias_tablas > 1) {
+		(*hash->referencias_tablas)--;
+	} else {
+		memoria_liberar(hash->memoria, hash->referencias_tablas);
+		for (int i = 0; i < hash->capacidad; i++)
+			if (!lista_compartida(hash->tabla[i]))
+				con_cada_par_de_posicion(hash, i, destruir_par,
+							 &destructor_aux);
+		destruir_tabla(hash->tabla, hash->capacidad, hash->memoria);
+		destruir_arboles(hash->arboles, hash->capacidad,
+				 hash->memoria);
+	}
+	pool_destruir(hash->pool_nodos);
+	rueda_temporal_destruir(hash->rueda);
+	filtro_destruir(hash->filtro);
+	liberar_hash(hash);
 }
 
 typedef struct estructura_auxiliar_para_iterador {
 	bool (*f)(const char *, void *, void *);
 	void *aux;
+	hash_t *hash;
+	uint64_t ahora;
+	size_t invocaciones;
 } aux_iterador_t;
 
 /**
@@ -397,15 +2291,31 @@ typedef struct estructura_auxiliar_para_iterador {
  * 
  * Se invoca a la función f pasándole como parámetro la clave y el valor
  * del par, y el puntero auxiliar. Se devuelve el valor de retorno de f.
+ * 
+ * Los pares vencidos se saltean sin invocar a f.
 */
 bool llamar_funcion_con_clave_y_valor(void *par, void *f_y_aux)
 {
-	void *aux = ((aux_iterador_t *)f_y_aux)->aux;
-	bool (*f)(const char *, void *, void *) =
-		((aux_iterador_t *)f_y_aux)->f;
+	aux_iterador_t *iterador = f_y_aux;
+	temporizador_t *temporizador = ((par_cv_t *)par)->temporizador;
+	if (temporizador && temporizador->vencimiento <= iterador->ahora)
+		return true;
 	const char *clave = ((par_cv_t *)par)->clave;
 	void *valor = ((par_cv_t *)par)->valor;
-	return f(clave, valor, aux);
+	iterador->invocaciones++;
+	return iterador->f(clave, valor, iterador->aux);
+}
+
+/**
+ * Recibe una clave y un valor de un hash que no usa listas, y un puntero a
+ * aux_iterador_t. Invoca a la función f con la clave, el valor y el
+ * puntero auxiliar, y devuelve su valor de retorno.
+*/
+bool llamar_funcion_con_entrada(char *clave, void *valor, void *f_y_aux)
+{
+	aux_iterador_t *iterador = f_y_aux;
+	iterador->invocaciones++;
+	return iterador->f(clave, valor, iterador->aux);
 }
 
 /*
@@ -425,19 +2335,23 @@ size_t hash_con_cada_clave(hash_t *hash,
 			   bool (*f)(const char *clave, void *valor, void *aux),
 			   void *aux)
 {
-	size_t resultado = 0, pares_iterados = 0;
+	size_t pares_iterados = 0;
 	if (!hash || !f)
-		return resultado;
-	aux_iterador_t f_y_aux = { .f = f, .aux = aux };
+		return 0;
+	aux_iterador_t f_y_aux = { .f = f, .aux = aux, .hash = hash };
+	if (usa_tabla_sin_listas(hash)) {
+		con_cada_entrada_sin_listas(hash, llamar_funcion_con_entrada,
+					    &f_y_aux);
+		return f_y_aux.invocaciones;
+	}
+	if (hash->rueda)
+		f_y_aux.ahora = tiempo_actual(hash);
 	for (int i = 0; i < hash->capacidad; i++) {
-		pares_iterados = lista_con_cada_elemento(
-			hash->tabla[i], llamar_funcion_con_clave_y_valor,
+		pares_iterados = con_cada_par_de_posicion(
+			hash, i, llamar_funcion_con_clave_y_valor,
 			(void *)&f_y_aux);
-		resultado = resultado + pares_iterados;
-		if (pares_iterados < lista_tamanio(hash->tabla[i])) {
-			resultado++;
-			return resultado;
-		}
+		if (pares_iterados < tamanio_de_posicion(hash, i))
+			return f_y_aux.invocaciones;
 	}
-	return resultado;
+	return f_y_aux.invocaciones;
 }
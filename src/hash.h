@@ -3,9 +3,120 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include "pool_claves.h"
+#include "memoria.h"
 
 typedef struct hash hash_t;
 
+/*
+ * Flags de creación para hash_crear_con_opciones.
+ *
+ * HASH_CLAVES_PRESTADAS: el hash no copia las claves, sino que almacena el
+ * puntero provisto por el usuario. El usuario es responsable de que la clave
+ * no se modifique ni se libere mientras el elemento esté en el hash.
+ */
+#define HASH_CLAVES_PRESTADAS 0x1
+
+/*
+ * HASH_FILTRO: el hash mantiene un filtro de Bloom con contadores que
+ * responde la mayoría de las búsquedas de claves ausentes sin recorrer la
+ * lista correspondiente (ver hash_estadisticas_filtro).
+ */
+#define HASH_FILTRO 0x2
+
+/*
+ * HASH_POOL_NODOS: todas las listas del hash reservan sus nodos en un único
+ * pool compartido, que recicla los nodos quitados en vez de llamar a malloc
+ * y free por cada inserción y cada quitado.
+ */
+#define HASH_POOL_NODOS 0x4
+
+/*
+ * HASH_COMPACTO: el hash guarda sus elementos en una tabla compacta (como los
+ * diccionarios de CPython) en vez de en listas: un vector de entradas en
+ * orden de inserción y un índice disperso de números de entrada. Usa menos
+ * memoria por elemento, y hash_con_cada_clave recorre las claves en el orden
+ * en que se insertaron. No se puede combinar con HASH_FILTRO ni con
+ * HASH_POOL_NODOS, y no admite hash_insertar_con_ttl.
+ */
+#define HASH_COMPACTO 0x8
+
+/*
+ * HASH_CUCKOO: el hash guarda sus elementos en una tabla cuckoo por baldes
+ * en vez de en listas: cada clave solo puede estar en uno de dos baldes de 4
+ * lugares, así que hash_obtener revisa a lo sumo dos baldes aunque la tabla
+ * esté casi llena (más de 90% de los lugares ocupados). Tiene las mismas
+ * restricciones que HASH_COMPACTO, y no se puede combinar con él.
+ */
+#define HASH_CUCKOO 0x10
+
+/*
+ * Opciones de creación de un hash.
+ *
+ * Si pool_claves no es NULL, las claves se internan en dicho pool en vez de
+ * copiarse, de manera que varios hash que comparten el pool comparten también
+ * una única copia de cada clave. El pool debe seguir existiendo mientras
+ * exista alguno de los hash que lo usan. No se puede combinar con
+ * HASH_CLAVES_PRESTADAS.
+ *
+ * reloj (si no es NULL) devuelve el tiempo actual que se usa para los
+ * vencimientos de hash_insertar_con_ttl, y recibe contexto_reloj. Por defecto
+ * se usa un reloj monótono en milisegundos.
+ *
+ * destructor_expirados (si no es NULL) se invoca con cada elemento vencido
+ * que el hash quita.
+ *
+ * Si alocador no es NULL, toda la memoria del hash (el hash, sus tablas,
+ * listas, árboles, pares y copias de las claves) se reserva y libera con sus
+ * funciones en vez de con malloc y free. Si limite_memoria no es 0, la
+ * memoria usada por el hash (ver hash_memoria_usada) no puede superarlo: las
+ * inserciones que lo superarían fallan sin modificar el hash. Las claves
+ * internadas en un pool_claves no se cuentan, porque el pool es del usuario.
+ *
+ * factor_carga_maximo (0.7 por defecto) es la cantidad de elementos por
+ * posición de la tabla a partir de la cual el hash multiplica su capacidad
+ * por factor_crecimiento (2 por defecto, y debe ser mayor a 1). Cuando al
+ * quitar elementos la carga queda por debajo de factor_carga_minimo (0.1 por
+ * defecto, o nunca si es negativo), el hash divide su capacidad por
+ * factor_crecimiento, sin bajar de la capacidad inicial ni de la reservada
+ * con hash_reservar. factor_carga_minimo * factor_crecimiento debe ser menor
+ * a factor_carga_maximo, para que el hash no se agrande apenas se achica. En
+ * los hash con HASH_COMPACTO o HASH_CUCKOO estos factores no se usan.
+ *
+ * semilla elige la función que reparte las claves en la tabla: con 0 (por
+ * defecto) es funcion_hash, y con cualquier otro valor es FNV-1a mezclado
+ * con la semilla, que un atacante no puede predecir si no la conoce. Todos
+ * los hash con la misma semilla usan la misma función, así que una clave
+ * calculada con hash_calcular_con_semilla sirve para todos ellos. Los hash
+ * con HASH_COMPACTO o HASH_CUCKOO la ignoran.
+ */
+typedef struct hash_opciones {
+	unsigned int flags;
+	pool_claves_t *pool_claves;
+	uint64_t (*reloj)(void *contexto);
+	void *contexto_reloj;
+	void (*destructor_expirados)(void *);
+	const alocador_t *alocador;
+	size_t limite_memoria;
+	double factor_carga_maximo;
+	double factor_carga_minimo;
+	double factor_crecimiento;
+	uint64_t semilla;
+} hash_opciones_t;
+
+/*
+ * Clave con su hash ya calculado (ver hash_calcular). Sus campos son
+ * privados. La clave no se copia, así que debe seguir existiendo mientras
+ * se use la clave calculada.
+ */
+typedef struct hash_clave {
+	const char *clave;
+	uint64_t huella;
+	uint64_t semilla;
+	int suma;
+} hash_clave_t;
+
 /*
  * Crea el hash reservando la memoria necesaria para el.
  *
@@ -17,6 +128,16 @@ typedef struct hash hash_t;
  */
 hash_t *hash_crear(size_t capacidad);
 
+/*
+ * Crea el hash igual que hash_crear, pero con las opciones dadas. Si opciones
+ * es NULL, el hash se crea con las opciones por defecto.
+ *
+ * Devuelve un puntero al hash creado o NULL en caso de no poder crearlo o si
+ * las opciones son inválidas.
+ */
+hash_t *hash_crear_con_opciones(size_t capacidad,
+				const hash_opciones_t *opciones);
+
 /*
  * Inserta o actualiza un elemento en el hash asociado a la clave dada.
  *
@@ -25,7 +146,8 @@ hash_t *hash_crear(size_t capacidad);
  *
  * Si la clave no existía y anterior no es NULL, se almacena NULL en *anterior.
  *
- * La función almacena una copia de la clave provista por el usuario,
+ * La función almacena una copia de la clave provista por el usuario, salvo
+ * que el hash se haya creado con claves prestadas o con un pool de claves.
  *
  * Nota para los alumnos: Recordar que si insertar un elemento provoca
  * que el factor de carga exceda cierto umbral, SE DEBE AJUSTAR EL
@@ -36,6 +158,33 @@ hash_t *hash_crear(size_t capacidad);
 hash_t *hash_insertar(hash_t *hash, const char *clave, void *elemento,
 		      void **anterior);
 
+/*
+ * Inserta o actualiza un elemento en el hash igual que hash_insertar, pero
+ * el elemento vence luego de ttl unidades de tiempo del reloj del hash
+ * (milisegundos por defecto). Insertar la misma clave con hash_insertar le
+ * quita el vencimiento.
+ *
+ * Un elemento vencido se considera ausente: hash_obtener, hash_contiene,
+ * hash_quitar y hash_con_cada_clave lo ignoran. El elemento se quita del
+ * hash (pasándolo a destructor_expirados) la próxima vez que se accede a su
+ * clave o en la próxima invocación a hash_expirar.
+ *
+ * Devuelve el hash si pudo guardar el elemento o NULL si no pudo (o si el
+ * hash se creó con HASH_COMPACTO o HASH_CUCKOO).
+ */
+hash_t *hash_insertar_con_ttl(hash_t *hash, const char *clave, void *elemento,
+			      uint64_t ttl, void **anterior);
+
+/*
+ * Quita del hash los elementos vencidos, procesando a lo sumo maximo
+ * elementos (o todos los vencidos si maximo es 0). Los vencimientos están
+ * agendados en una rueda temporal jerárquica, por lo que solo se visitan los
+ * elementos vencidos y no todo el hash.
+ *
+ * Devuelve la cantidad de elementos quitados.
+ */
+size_t hash_expirar(hash_t *hash, size_t maximo);
+
 /*
  * Quita un elemento del hash y lo devuelve.
  *
@@ -43,6 +192,23 @@ hash_t *hash_insertar(hash_t *hash, const char *clave, void *elemento,
  */
 void *hash_quitar(hash_t *hash, const char *clave);
 
+/*
+ * Quita del hash todos los elementos para los que predicado(clave, valor,
+ * aux) devuelve true, y pasa cada valor quitado al destructor (si no es
+ * NULL). El predicado se invoca una vez con cada elemento (salvo los
+ * vencidos, que se ignoran) y no debe modificar el hash.
+ *
+ * Recorre la tabla una sola vez, sin buscar cada clave, y al final achica el
+ * hash si quedó por debajo de su factor de carga mínimo.
+ *
+ * Devuelve la cantidad de elementos quitados (en caso de error, los que se
+ * llegaron a quitar).
+ */
+size_t hash_quitar_si(hash_t *hash,
+		      bool (*predicado)(const char *clave, void *valor,
+					void *aux),
+		      void *aux, void (*destructor)(void *));
+
 /*
  * Devuelve un elemento del hash con la clave dada o NULL si dicho
  * elemento no existe (o en caso de error).
@@ -55,12 +221,147 @@ void *hash_obtener(hash_t *hash, const char *clave);
  */
 bool hash_contiene(hash_t *hash, const char *clave);
 
+/*
+ * Calcula una sola vez el hash de la clave para los hash creados sin
+ * semilla, de manera que buscarla en varios hash con las funciones _h no la
+ * vuelva a recorrer en cada uno.
+ *
+ * Devuelve la clave calculada (con la clave NULL si la clave es NULL).
+ */
+hash_clave_t hash_calcular(const char *clave);
+
+/*
+ * Igual que hash_calcular, pero para los hash creados con la semilla dada.
+ */
+hash_clave_t hash_calcular_con_semilla(const char *clave, uint64_t semilla);
+
+/*
+ * Igual que hash_insertar, hash_obtener, hash_contiene y hash_quitar, pero
+ * con una clave calculada con hash_calcular o hash_calcular_con_semilla.
+ *
+ * Si la clave se calculó con una semilla distinta a la del hash, funcionan
+ * igual, pero recalculando la posición de la clave en el hash.
+ */
+hash_t *hash_insertar_h(hash_t *hash, const hash_clave_t *clave,
+			void *elemento, void **anterior);
+void *hash_obtener_h(hash_t *hash, const hash_clave_t *clave);
+bool hash_contiene_h(hash_t *hash, const hash_clave_t *clave);
+void *hash_quitar_h(hash_t *hash, const hash_clave_t *clave);
+
 /*
  * Devuelve la cantidad de elementos almacenados en el hash o 0 en
- * caso de error.
+ * caso de error. Incluye a los elementos vencidos que todavía no se
+ * quitaron del hash.
  */
 size_t hash_cantidad(hash_t *hash);
 
+/*
+ * Agranda el hash (si hace falta) para que pueda tener cantidad elementos
+ * sin hacer rehash, y hace que no se achique automáticamente por debajo de
+ * esa capacidad. Conviene usarlo antes de insertar muchos elementos.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (el hash queda como
+ * estaba).
+ */
+bool hash_reservar(hash_t *hash, size_t cantidad);
+
+/*
+ * Achica el hash a la menor capacidad en la que entran sus elementos sin
+ * superar el factor de carga máximo, y deshace el efecto de hash_reservar y
+ * de la capacidad inicial sobre el achique automático.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (el hash queda como
+ * estaba).
+ */
+bool hash_compactar(hash_t *hash);
+
+/*
+ * Crea un clon del hash: una copia con los mismos elementos en el momento de
+ * la llamada, que después se puede leer y modificar independientemente del
+ * original. Clonar es O(1): el clon comparte la tabla con el original, y
+ * cada uno copia solo las posiciones que modifica después (la primera
+ * modificación de cada uno copia además el arreglo de posiciones). Los
+ * elementos no se copian, así que si se destruyen con hash_destruir_todo
+ * solo debe hacerse con el último hash que los tenga.
+ *
+ * El clon no tiene filtro. No se pueden clonar los hash con HASH_COMPACTO,
+ * HASH_CUCKOO o HASH_POOL_NODOS, con alocador o límite de memoria, ni los
+ * que alguna vez usaron hash_insertar_con_ttl.
+ *
+ * Devuelve el clon o NULL en caso de error.
+ */
+hash_t *hash_clonar(hash_t *hash);
+
+/*
+ * Mueve todos los elementos de otro a hash, dejando a otro vacío (pero sin
+ * destruirlo). Si una clave está en los dos, su valor pasa a ser el que
+ * devuelve resolver con la clave, el valor en hash, el valor en otro y el
+ * puntero auxiliar, o el valor en otro si resolver es NULL. Si hash usa
+ * claves prestadas, otro también debe usarlas.
+ *
+ * Devuelve hash o NULL en caso de error (en cuyo caso algunos elementos
+ * pueden haber pasado a hash, y el resto sigue en otro).
+ */
+hash_t *hash_fusionar(hash_t *hash, hash_t *otro,
+		      void *(*resolver)(const char *clave, void *valor,
+					void *valor_otro, void *aux),
+		      void *aux);
+
+/*
+ * Crea un hash con las opciones dadas (que pueden ser NULL) con las claves
+ * que están en hash y en otro. El valor de cada clave es el que devuelve
+ * resolver con la clave, el valor en hash, el valor en otro y el puntero
+ * auxiliar, o el valor en hash si resolver es NULL. Si el resultado usa
+ * claves prestadas, sus claves son las de hash o las de otro.
+ *
+ * Devuelve el resultado o NULL en caso de error.
+ */
+hash_t *hash_interseccion(hash_t *hash, hash_t *otro,
+			  const hash_opciones_t *opciones,
+			  void *(*resolver)(const char *clave, void *valor,
+					    void *valor_otro, void *aux),
+			  void *aux);
+
+/*
+ * Crea un hash con las opciones dadas (que pueden ser NULL) con las claves
+ * de hash que no están en otro, y sus valores. Si el resultado usa claves
+ * prestadas, sus claves son las de hash.
+ *
+ * Devuelve el resultado o NULL en caso de error.
+ */
+hash_t *hash_diferencia(hash_t *hash, hash_t *otro,
+			const hash_opciones_t *opciones);
+
+/*
+ * Devuelve la cantidad de bytes que el hash tiene reservados, si se creó con
+ * un alocador o un límite de memoria, o 0 en otro caso (o en caso de error).
+ */
+size_t hash_memoria_usada(hash_t *hash);
+
+/*
+ * Estadísticas del filtro de un hash creado con HASH_FILTRO.
+ *
+ * consultas es la cantidad de búsquedas que consultaron al filtro (las que
+ * caen en una posición vacía no lo consultan), descartadas las que el filtro respondió sin recorrer la lista, y
+ * falsos_positivos las que el filtro no descartó pero la clave no estaba.
+ * tasa_falsos_positivos es la proporción de falsos positivos sobre las
+ * búsquedas de claves ausentes.
+ */
+typedef struct hash_estadisticas_filtro {
+	size_t consultas;
+	size_t descartadas;
+	size_t falsos_positivos;
+	double tasa_falsos_positivos;
+} hash_estadisticas_filtro_t;
+
+/*
+ * Si el hash tiene filtro, guarda sus estadísticas en *estadisticas y
+ * devuelve true. Devuelve false si el hash no tiene filtro (o en caso de
+ * error).
+ */
+bool hash_estadisticas_filtro(hash_t *hash,
+			      hash_estadisticas_filtro_t *estadisticas);
+
 /*
  * Destruye el hash liberando la memoria reservada.
  */
@@ -83,6 +384,9 @@ void hash_destruir_todo(hash_t *hash, void (*destructor)(void *));
  * devuelve false, la iteración se corta y la función principal
  * retorna.
  *
+ * En un hash creado con HASH_COMPACTO las claves se recorren en el orden en
+ * que se insertaron (reemplazar el valor de una clave no cambia su orden).
+ *
  * Devuelve la cantidad de claves totales iteradas (la cantidad de
  * veces que fue invocada la función) o 0 en caso de error.
  *
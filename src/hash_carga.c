@@ -0,0 +1,285 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hash_carga.h"
+
+#define BYTES_POR_HILO (1024 * 1024)
+#define PARES_INICIALES 1024
+
+typedef struct par_cargado {
+	char *clave;
+	char *valor;
+} par_cargado_t;
+
+/*
+ * Parte del archivo que procesa un hilo: empieza al principio de una línea y
+ * termina después de un fin de línea (o al final del archivo).
+ */
+typedef struct pedazo_carga {
+	char *inicio;
+	char *fin;
+	par_cargado_t *pares;
+	size_t cantidad;
+	size_t capacidad;
+	size_t ignoradas;
+	char *ultima_linea;
+	bool error;
+} pedazo_carga_t;
+
+struct hash_carga {
+	hash_t *hash;
+	char *mapeo;
+	size_t largo;
+	char *ultima_linea;
+	size_t ignoradas;
+};
+
+/**
+ * Recibe un pedazo y una línea de largo bytes que termina en un lugar
+ * escribible (el fin de línea), y la separa en clave y valor cortándola con
+ * ceros, sin copiarla. Si no tiene tabulación, la cuenta como ignorada.
+*/
+void separar_linea(pedazo_carga_t *pedazo, char *linea, size_t largo)
+{
+	linea[largo] = 0;
+	if (largo > 0 && linea[largo - 1] == '\r')
+		linea[--largo] = 0;
+	char *tabulacion = memchr(linea, '\t', largo);
+	if (!tabulacion) {
+		pedazo->ignoradas++;
+		return;
+	}
+	if (pedazo->cantidad == pedazo->capacidad) {
+		size_t capacidad = pedazo->capacidad ? pedazo->capacidad * 2 :
+						       PARES_INICIALES;
+		par_cargado_t *pares =
+			realloc(pedazo->pares, capacidad * sizeof(par_cargado_t));
+		if (!pares) {
+			pedazo->error = true;
+			return;
+		}
+		pedazo->pares = pares;
+		pedazo->capacidad = capacidad;
+	}
+	*tabulacion = 0;
+	pedazo->pares[pedazo->cantidad].clave = linea;
+	pedazo->pares[pedazo->cantidad].valor = tabulacion + 1;
+	pedazo->cantidad++;
+}
+
+/**
+ * Recibe un pedazo_carga_t y separa todas sus líneas. Si el pedazo termina
+ * sin fin de línea (porque es el final del archivo), la última línea se
+ * copia, porque no hay lugar en el archivo para terminarla con un cero.
+ *
+ * Es la función que corre cada hilo, y siempre devuelve NULL.
+*/
+void *procesar_pedazo(void *argumento)
+{
+	pedazo_carga_t *pedazo = argumento;
+	char *linea = pedazo->inicio;
+	while (linea < pedazo->fin && !pedazo->error) {
+		size_t restante = (size_t)(pedazo->fin - linea);
+		char *fin_de_linea = memchr(linea, '\n', restante);
+		if (!fin_de_linea) {
+			pedazo->ultima_linea = malloc(restante + 1);
+			if (!pedazo->ultima_linea) {
+				pedazo->error = true;
+				break;
+			}
+			memcpy(pedazo->ultima_linea, linea, restante);
+			separar_linea(pedazo, pedazo->ultima_linea, restante);
+			break;
+		}
+		separar_linea(pedazo, linea, (size_t)(fin_de_linea - linea));
+		linea = fin_de_linea + 1;
+	}
+	return NULL;
+}
+
+/**
+ * Recibe un archivo mapeado y lo divide en la cantidad de pedazos dada, de
+ * manera que cada pedazo empiece al principio de una línea (algunos pedazos
+ * pueden quedar vacíos).
+*/
+void dividir_en_pedazos(char *mapeo, size_t largo, pedazo_carga_t *pedazos,
+			size_t cantidad)
+{
+	char *fin = mapeo + largo;
+	char *inicio = mapeo;
+	for (size_t i = 0; i < cantidad; i++) {
+		pedazos[i].inicio = inicio;
+		char *corte = i + 1 == cantidad ?
+				      fin :
+				      mapeo + largo / cantidad * (i + 1);
+		if (corte < inicio)
+			corte = inicio;
+		if (corte < fin && corte > mapeo && corte[-1] != '\n') {
+			char *fin_de_linea = memchr(corte, '\n',
+						    (size_t)(fin - corte));
+			corte = fin_de_linea ? fin_de_linea + 1 : fin;
+		}
+		pedazos[i].fin = corte;
+		inicio = corte;
+	}
+}
+
+/**
+ * Recibe la cantidad de hilos pedida y el largo del archivo.
+ *
+ * Devuelve la cantidad de hilos a usar: la pedida (sin pasar de uno por
+ * byte), o si es 0, uno por procesador, sin pasar de uno por BYTES_POR_HILO.
+*/
+size_t hilos_para(size_t hilos, size_t largo)
+{
+	if (!hilos) {
+		long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+		hilos = procesadores > 0 ? (size_t)procesadores : 1;
+		if (hilos > largo / BYTES_POR_HILO + 1)
+			hilos = largo / BYTES_POR_HILO + 1;
+	}
+	if (hilos > largo)
+		hilos = largo ? largo : 1;
+	return hilos;
+}
+
+/**
+ * Recibe una carga con el archivo ya mapeado, procesa sus pedazos en
+ * paralelo (los que no consiguen un hilo se procesan en este), reserva lugar
+ * en el hash para todos los pares, y los inserta en el orden del archivo.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+*/
+bool cargar_pedazos(hash_carga_t *carga, size_t hilos)
+{
+	pedazo_carga_t *pedazos = calloc(hilos, sizeof(pedazo_carga_t));
+	pthread_t *hilos_creados = calloc(hilos, sizeof(pthread_t));
+	bool *creados = calloc(hilos, sizeof(bool));
+	bool ok = pedazos && hilos_creados && creados;
+	if (ok) {
+		dividir_en_pedazos(carga->mapeo, carga->largo, pedazos, hilos);
+		for (size_t i = 1; i < hilos; i++)
+			creados[i] = pthread_create(&hilos_creados[i], NULL,
+						    procesar_pedazo,
+						    &pedazos[i]) == 0;
+		procesar_pedazo(&pedazos[0]);
+		for (size_t i = 1; i < hilos; i++) {
+			if (creados[i])
+				pthread_join(hilos_creados[i], NULL);
+			else
+				procesar_pedazo(&pedazos[i]);
+		}
+	}
+	size_t total = 0;
+	for (size_t i = 0; ok && i < hilos; i++) {
+		ok = !pedazos[i].error;
+		total += pedazos[i].cantidad;
+		carga->ignoradas += pedazos[i].ignoradas;
+		if (pedazos[i].ultima_linea)
+			carga->ultima_linea = pedazos[i].ultima_linea;
+	}
+	ok = ok && hash_reservar(carga->hash, total);
+	for (size_t i = 0; ok && i < hilos; i++)
+		for (size_t j = 0; ok && j < pedazos[i].cantidad; j++)
+			ok = hash_insertar(carga->hash, pedazos[i].pares[j].clave,
+					   pedazos[i].pares[j].valor,
+					   NULL) != NULL;
+	for (size_t i = 0; pedazos && i < hilos; i++) {
+		free(pedazos[i].pares);
+		if (pedazos[i].ultima_linea != carga->ultima_linea)
+			free(pedazos[i].ultima_linea);
+	}
+	free(pedazos);
+	free(hilos_creados);
+	free(creados);
+	return ok;
+}
+
+/*
+ * Carga el archivo de la ruta dada usando la cantidad de hilos dada (o uno
+ * por procesador si es 0).
+ *
+ * El archivo se mapea en privado y con permiso de escritura, para poder
+ * terminar cada clave y cada valor con un cero en el lugar de la
+ * tabulación y del fin de línea: las páginas modificadas se copian en
+ * memoria, pero el archivo no cambia.
+ *
+ * Devuelve la carga o NULL en caso de error.
+ */
+hash_carga_t *hash_cargar_archivo(const char *ruta,
+				  const hash_opciones_t *opciones,
+				  size_t hilos)
+{
+	if (!ruta || (opciones && opciones->pool_claves))
+		return NULL;
+	hash_carga_t *carga = calloc(1, sizeof(hash_carga_t));
+	if (!carga)
+		return NULL;
+	hash_opciones_t opciones_carga = { 0 };
+	if (opciones)
+		opciones_carga = *opciones;
+	opciones_carga.flags |= HASH_CLAVES_PRESTADAS;
+	carga->hash = hash_crear_con_opciones(3, &opciones_carga);
+	int archivo = open(ruta, O_RDONLY);
+	struct stat estado;
+	bool ok = carga->hash && archivo >= 0 && fstat(archivo, &estado) == 0;
+	if (ok && estado.st_size > 0) {
+		carga->largo = (size_t)estado.st_size;
+		carga->mapeo = mmap(NULL, carga->largo, PROT_READ | PROT_WRITE,
+				    MAP_PRIVATE, archivo, 0);
+		if (carga->mapeo == MAP_FAILED) {
+			carga->mapeo = NULL;
+			ok = false;
+		} else {
+			madvise(carga->mapeo, carga->largo, MADV_SEQUENTIAL);
+		}
+	}
+	if (archivo >= 0)
+		close(archivo);
+	if (ok && carga->mapeo)
+		ok = cargar_pedazos(carga, hilos_para(hilos, carga->largo));
+	if (!ok) {
+		hash_carga_destruir(carga);
+		return NULL;
+	}
+	return carga;
+}
+
+/*
+ * Devuelve el hash cargado, o NULL en caso de error.
+ */
+hash_t *hash_carga_hash(hash_carga_t *carga)
+{
+	if (!carga)
+		return NULL;
+	return carga->hash;
+}
+
+/*
+ * Devuelve la cantidad de líneas sin tabulación del archivo o 0 en caso de
+ * error.
+ */
+size_t hash_carga_lineas_ignoradas(hash_carga_t *carga)
+{
+	if (!carga)
+		return 0;
+	return carga->ignoradas;
+}
+
+/*
+ * Destruye el hash cargado (sin liberar sus valores) y desmapea el archivo.
+ */
+void hash_carga_destruir(hash_carga_t *carga)
+{
+	if (!carga)
+		return;
+	hash_destruir(carga->hash);
+	if (carga->mapeo)
+		munmap(carga->mapeo, carga->largo);
+	free(carga->ultima_linea);
+	free(carga);
+}
@@ -0,0 +1,50 @@
+#ifndef __HASH_CARGA_H__
+#define __HASH_CARGA_H__
+
+#include <stddef.h>
+#include "hash.h"
+
+/*
+ * Carga de un hash desde un archivo de texto con una línea clave<TAB>valor
+ * por par. El archivo se mapea en memoria, se divide en pedazos que se
+ * procesan en paralelo, y las claves y los valores del hash apuntan
+ * directamente al archivo mapeado, sin copiarse.
+ */
+typedef struct hash_carga hash_carga_t;
+
+/*
+ * Carga el archivo de la ruta dada usando la cantidad de hilos dada (o uno
+ * por procesador si es 0). El hash se crea con las opciones dadas (que
+ * pueden ser NULL) más HASH_CLAVES_PRESTADAS, así que las opciones no pueden
+ * tener pool_claves.
+ *
+ * Las líneas sin tabulación se ignoran (ver hash_carga_lineas_ignoradas), un
+ * \r antes del fin de línea no forma parte del valor, y si una clave se
+ * repite queda el valor de la última línea.
+ *
+ * Devuelve la carga o NULL en caso de error.
+ */
+hash_carga_t *hash_cargar_archivo(const char *ruta,
+				  const hash_opciones_t *opciones,
+				  size_t hilos);
+
+/*
+ * Devuelve el hash cargado, cuyos valores son strings (char *). Las claves y
+ * los valores pertenecen a la carga, y son válidos hasta destruirla. Se
+ * pueden agregar claves al hash, que no se copian (y deben seguir existiendo
+ * mientras estén en el hash).
+ */
+hash_t *hash_carga_hash(hash_carga_t *carga);
+
+/*
+ * Devuelve la cantidad de líneas sin tabulación del archivo o 0 en caso de
+ * error.
+ */
+size_t hash_carga_lineas_ignoradas(hash_carga_t *carga);
+
+/*
+ * Destruye el hash cargado (sin liberar sus valores) y desmapea el archivo.
+ */
+void hash_carga_destruir(hash_carga_t *carga);
+
+#endif /* __HASH_CARGA_H__ */
@@ -0,0 +1,468 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hash_compartido.h"
+#include "funciones_hash.h"
+
+#define MARCA_COMPARTIDO 0x315241504d4f4348ULL /* "HCOMPAR1" */
+#define POSICIONES_MINIMAS 8
+#define ALINEACION 8
+
+/*
+ * El segmento empieza con la cabecera, sigue con las posiciones (el
+ * desplazamiento de la primera entrada de cada una, o 0 si está vacía) y
+ * termina con las entradas, una detrás de otra. usado es la cantidad de
+ * bytes de entradas ocupados, y solo cambia con el mutex tomado.
+ *
+ * La marca se escribe al final de la creación, así que un segmento sin
+ * marca todavía no se puede abrir.
+ */
+typedef struct cabecera_compartida {
+	_Atomic uint64_t marca;
+	uint64_t tamanio;
+	uint64_t posiciones;
+	uint64_t inicio_entradas;
+	_Atomic uint64_t usado;
+	_Atomic uint64_t cantidad;
+	pthread_mutex_t escritura;
+} cabecera_compartida_t;
+
+/*
+ * Cada entrada tiene la huella FNV-1a de la clave, el desplazamiento de la
+ * siguiente entrada de la misma posición (o 0), el tamaño del valor, el
+ * largo de la clave y si la entrada quita la clave, seguidos de la clave con
+ * su 0 final y, alineado a 8 bytes, el valor.
+ */
+typedef struct entrada_compartida {
+	uint64_t huella;
+	uint64_t siguiente;
+	uint64_t tamanio;
+	uint32_t largo_clave;
+	uint32_t quitada;
+	char datos[];
+} entrada_compartida_t;
+
+struct hash_compartido {
+	char *segmento;
+	size_t tamanio;
+	bool escritura;
+};
+
+/**
+ * Devuelve la cantidad de bytes redondeada hacia arriba a un múltiplo de
+ * ALINEACION.
+*/
+size_t alinear_compartido(size_t bytes)
+{
+	return (bytes + ALINEACION - 1) & ~(size_t)(ALINEACION - 1);
+}
+
+/**
+ * Devuelve la cabecera del segmento del hash.
+*/
+cabecera_compartida_t *cabecera_de(hash_compartido_t *hash)
+{
+	return (cabecera_compartida_t *)hash->segmento;
+}
+
+/**
+ * Devuelve la posición del hash que le corresponde a la huella dada.
+*/
+_Atomic uint64_t *posicion_compartida_de(hash_compartido_t *hash,
+					 uint64_t huella)
+{
+	_Atomic uint64_t *posiciones =
+		(_Atomic uint64_t *)(hash->segmento +
+				     sizeof(cabecera_compartida_t));
+	return &posiciones[huella & (cabecera_de(hash)->posiciones - 1)];
+}
+
+/**
+ * Devuelve la cantidad de bytes desde el principio de una entrada con una
+ * clave del largo dado hasta su valor.
+*/
+size_t inicio_del_valor(size_t largo_clave)
+{
+	return alinear_compartido(sizeof(entrada_compartida_t) + largo_clave +
+				  1);
+}
+
+/**
+ * Recibe un hash, una clave y su huella, y recorre las entradas de su
+ * posición, de la más nueva a la más vieja. La posición se lee con
+ * memory_order_acquire, que se corresponde con la escritura de
+ * agregar_entrada_compartida, así que las entradas que se alcanzan desde
+ * ella ya están completas.
+ *
+ * Devuelve la entrada más nueva con la clave (que puede ser una que la
+ * quita) o NULL si no hay ninguna.
+*/
+entrada_compartida_t *buscar_entrada(hash_compartido_t *hash,
+				     const char *clave, uint64_t huella)
+{
+	uint64_t desplazamiento = atomic_load_explicit(
+		posicion_compartida_de(hash, huella), memory_order_acquire);
+	while (desplazamiento) {
+		entrada_compartida_t *entrada =
+			(entrada_compartida_t *)(hash->segmento +
+						 desplazamiento);
+		if (entrada->huella == huella &&
+		    strcmp(entrada->datos, clave) == 0)
+			return entrada;
+		desplazamiento = entrada->siguiente;
+	}
+	return NULL;
+}
+
+/**
+ * Recibe un hash con el mutex tomado, y agrega al principio de la posición
+ * de la clave una entrada con la clave y el valor (o una que quita la
+ * clave). El lugar se reserva antes de escribir la entrada, y la entrada se
+ * publica recién cuando está completa, con una única escritura de la
+ * posición: si el proceso muere en el medio, se pierde el lugar, pero las
+ * búsquedas nunca ven una entrada a medias.
+ *
+ * Devuelve true si pudo agregarla o false si no queda lugar.
+*/
+bool agregar_entrada_compartida(hash_compartido_t *hash, const char *clave,
+				uint64_t huella, const void *valor,
+				size_t tamanio, bool quitada)
+{
+	cabecera_compartida_t *cabecera = cabecera_de(hash);
+	size_t largo = strlen(clave);
+	uint64_t usado =
+		atomic_load_explicit(&cabecera->usado, memory_order_relaxed);
+	size_t libres = cabecera->tamanio - cabecera->inicio_entradas - usado;
+	if (largo > UINT32_MAX || tamanio > libres)
+		return false;
+	size_t bytes = inicio_del_valor(largo) + alinear_compartido(tamanio);
+	if (bytes > libres)
+		return false;
+	uint64_t desplazamiento = cabecera->inicio_entradas + usado;
+	atomic_store_explicit(&cabecera->usado, usado + bytes,
+			      memory_order_relaxed);
+	entrada_compartida_t *entrada =
+		(entrada_compartida_t *)(hash->segmento + desplazamiento);
+	entrada->huella = huella;
+	entrada->tamanio = tamanio;
+	entrada->largo_clave = (uint32_t)largo;
+	entrada->quitada = quitada;
+	memcpy(entrada->datos, clave, largo + 1);
+	if (tamanio)
+		memcpy((char *)entrada + inicio_del_valor(largo), valor,
+		       tamanio);
+	_Atomic uint64_t *posicion = posicion_compartida_de(hash, huella);
+	entrada->siguiente =
+		atomic_load_explicit(posicion, memory_order_relaxed);
+	atomic_store_explicit(posicion, desplazamiento, memory_order_release);
+	return true;
+}
+
+/**
+ * Recibe un hash con el mutex tomado cuyo escritor anterior murió con el
+ * mutex tomado, y vuelve a contar sus claves, porque pudo haber muerto
+ * entre publicar una entrada y actualizar la cantidad. Una entrada cuenta
+ * si no quita su clave y es la más nueva con esa clave en su posición.
+*/
+void recontar_claves(hash_compartido_t *hash)
+{
+	cabecera_compartida_t *cabecera = cabecera_de(hash);
+	uint64_t cantidad = 0;
+	for (uint64_t i = 0; i < cabecera->posiciones; i++) {
+		uint64_t desplazamiento = atomic_load_explicit(
+			posicion_compartida_de(hash, i), memory_order_relaxed);
+		while (desplazamiento) {
+			entrada_compartida_t *entrada =
+				(entrada_compartida_t *)(hash->segmento +
+							 desplazamiento);
+			if (!entrada->quitada &&
+			    buscar_entrada(hash, entrada->datos,
+					   entrada->huella) == entrada)
+				cantidad++;
+			desplazamiento = entrada->siguiente;
+		}
+	}
+	atomic_store_explicit(&cabecera->cantidad, cantidad,
+			      memory_order_relaxed);
+}
+
+/**
+ * Toma el mutex de escritura del hash. Si su dueño anterior murió con el
+ * mutex tomado, recuenta las claves y lo marca como consistente: por cómo
+ * agregar_entrada_compartida publica las entradas, el contenido del
+ * segmento siempre es válido.
+ *
+ * Devuelve true si pudo tomarlo o false en caso de error.
+*/
+bool bloquear_escritura(hash_compartido_t *hash)
+{
+	pthread_mutex_t *mutex = &cabecera_de(hash)->escritura;
+	int resultado = pthread_mutex_lock(mutex);
+	if (resultado == EOWNERDEAD) {
+		recontar_claves(hash);
+		if (pthread_mutex_consistent(mutex) == 0)
+			return true;
+		pthread_mutex_unlock(mutex);
+		return false;
+	}
+	return resultado == 0;
+}
+
+/**
+ * Recibe un segmento recién creado (lleno de ceros) del tamaño dado, y
+ * escribe su cabecera, con un mutex robusto y compartido entre procesos.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+*/
+bool inicializar_cabecera(cabecera_compartida_t *cabecera, size_t tamanio,
+			  size_t posiciones)
+{
+	cabecera->tamanio = tamanio;
+	cabecera->posiciones = posiciones;
+	cabecera->inicio_entradas =
+		sizeof(cabecera_compartida_t) + posiciones * sizeof(uint64_t);
+	pthread_mutexattr_t atributos;
+	if (pthread_mutexattr_init(&atributos) != 0)
+		return false;
+	bool ok = pthread_mutexattr_setpshared(&atributos,
+					       PTHREAD_PROCESS_SHARED) == 0 &&
+		  pthread_mutexattr_setrobust(&atributos,
+					      PTHREAD_MUTEX_ROBUST) == 0 &&
+		  pthread_mutex_init(&cabecera->escritura, &atributos) == 0;
+	pthread_mutexattr_destroy(&atributos);
+	if (ok)
+		atomic_store_explicit(&cabecera->marca, MARCA_COMPARTIDO,
+				      memory_order_release);
+	return ok;
+}
+
+/*
+ * Crea el segmento de memoria compartida con el nombre dado, con permisos
+ * solo para el usuario, y lo abre para escritura. El tamaño del segmento se
+ * fija acá: las páginas se reservan recién cuando se escriben.
+ *
+ * Devuelve un puntero al hash o NULL en caso de error (o si ya existe un
+ * segmento con ese nombre).
+ */
+hash_compartido_t *hash_compartido_crear(const char *nombre, size_t claves,
+					 size_t bytes)
+{
+	if (!nombre || claves > SIZE_MAX / (2 * sizeof(uint64_t)))
+		return NULL;
+	size_t posiciones = POSICIONES_MINIMAS;
+	while (posiciones < claves)
+		posiciones *= 2;
+	size_t inicio =
+		sizeof(cabecera_compartida_t) + posiciones * sizeof(uint64_t);
+	if (bytes > (size_t)INT64_MAX - inicio)
+		return NULL;
+	hash_compartido_t *hash = calloc(1, sizeof(hash_compartido_t));
+	if (!hash)
+		return NULL;
+	int descriptor = shm_open(nombre, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (descriptor < 0) {
+		free(hash);
+		return NULL;
+	}
+	hash->tamanio = inicio + bytes;
+	hash->escritura = true;
+	bool ok = ftruncate(descriptor, (off_t)hash->tamanio) == 0;
+	if (ok) {
+		hash->segmento = mmap(NULL, hash->tamanio,
+				      PROT_READ | PROT_WRITE, MAP_SHARED,
+				      descriptor, 0);
+		ok = hash->segmento != MAP_FAILED;
+	}
+	close(descriptor);
+	ok = ok && inicializar_cabecera(cabecera_de(hash), hash->tamanio,
+					posiciones);
+	if (!ok) {
+		if (hash->segmento && hash->segmento != MAP_FAILED)
+			munmap(hash->segmento, hash->tamanio);
+		shm_unlink(nombre);
+		free(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+/**
+ * Recibe un segmento mapeado de tamanio bytes.
+ *
+ * Devuelve true si es un hash compartido terminado de crear y su cabecera
+ * es coherente con el tamaño, o false en caso contrario.
+*/
+bool cabecera_valida(const cabecera_compartida_t *cabecera, size_t tamanio)
+{
+	if (atomic_load_explicit(&cabecera->marca, memory_order_acquire) !=
+	    MARCA_COMPARTIDO)
+		return false;
+	uint64_t posiciones = cabecera->posiciones;
+	return cabecera->tamanio == tamanio && posiciones &&
+	       !(posiciones & (posiciones - 1)) &&
+	       posiciones <= tamanio / sizeof(uint64_t) &&
+	       cabecera->inicio_entradas ==
+		       sizeof(cabecera_compartida_t) +
+			       posiciones * sizeof(uint64_t) &&
+	       cabecera->inicio_entradas <= tamanio &&
+	       atomic_load_explicit(&cabecera->usado, memory_order_relaxed) <=
+		       tamanio - cabecera->inicio_entradas;
+}
+
+/*
+ * Abre un segmento creado con hash_compartido_crear, para escritura o solo
+ * para lectura (en cuyo caso se mapea sin permiso de escritura).
+ *
+ * Devuelve un puntero al hash o NULL en caso de error (o si el segmento no
+ * es un hash compartido o todavía no terminó de crearse).
+ */
+hash_compartido_t *hash_compartido_abrir(const char *nombre, bool escritura)
+{
+	if (!nombre)
+		return NULL;
+	hash_compartido_t *hash = calloc(1, sizeof(hash_compartido_t));
+	if (!hash)
+		return NULL;
+	int descriptor = shm_open(nombre, escritura ? O_RDWR : O_RDONLY, 0);
+	struct stat estado;
+	bool ok = descriptor >= 0 && fstat(descriptor, &estado) == 0 &&
+		  (size_t)estado.st_size >= sizeof(cabecera_compartida_t);
+	if (ok) {
+		hash->tamanio = (size_t)estado.st_size;
+		hash->escritura = escritura;
+		hash->segmento = mmap(NULL, hash->tamanio,
+				      PROT_READ | (escritura ? PROT_WRITE : 0),
+				      MAP_SHARED, descriptor, 0);
+		ok = hash->segmento != MAP_FAILED;
+	}
+	if (descriptor >= 0)
+		close(descriptor);
+	if (ok && !cabecera_valida(cabecera_de(hash), hash->tamanio)) {
+		munmap(hash->segmento, hash->tamanio);
+		ok = false;
+	}
+	if (!ok) {
+		free(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+/*
+ * Inserta o reemplaza el valor asociado a la clave dada, agregando una
+ * entrada nueva que oculta a la anterior.
+ *
+ * Devuelve true si pudo guardar el valor o false en caso de error.
+ */
+bool hash_compartido_insertar(hash_compartido_t *hash, const char *clave,
+			      const void *valor, size_t tamanio)
+{
+	if (!hash || !clave || (!valor && tamanio) || !hash->escritura)
+		return false;
+	uint64_t huella = hash_fnv1a(clave);
+	if (!bloquear_escritura(hash))
+		return false;
+	entrada_compartida_t *anterior = buscar_entrada(hash, clave, huella);
+	bool agregada = agregar_entrada_compartida(hash, clave, huella, valor,
+						   tamanio, false);
+	if (agregada && (!anterior || anterior->quitada))
+		atomic_fetch_add_explicit(&cabecera_de(hash)->cantidad, 1,
+					  memory_order_relaxed);
+	pthread_mutex_unlock(&cabecera_de(hash)->escritura);
+	return agregada;
+}
+
+/*
+ * Quita la clave dada del hash, agregando una entrada que la quita.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario (o de error).
+ */
+bool hash_compartido_quitar(hash_compartido_t *hash, const char *clave)
+{
+	if (!hash || !clave || !hash->escritura)
+		return false;
+	uint64_t huella = hash_fnv1a(clave);
+	if (!bloquear_escritura(hash))
+		return false;
+	entrada_compartida_t *anterior = buscar_entrada(hash, clave, huella);
+	bool quitada = anterior && !anterior->quitada &&
+		       agregar_entrada_compartida(hash, clave, huella, NULL, 0,
+						  true);
+	if (quitada)
+		atomic_fetch_sub_explicit(&cabecera_de(hash)->cantidad, 1,
+					  memory_order_relaxed);
+	pthread_mutex_unlock(&cabecera_de(hash)->escritura);
+	return quitada;
+}
+
+/*
+ * Devuelve el valor asociado a la clave dada y guarda su tamaño en *tamanio
+ * (si tamanio no es NULL), o devuelve NULL si la clave no está. No toma el
+ * mutex.
+ */
+const void *hash_compartido_obtener(hash_compartido_t *hash,
+				    const char *clave, size_t *tamanio)
+{
+	if (!hash || !clave)
+		return NULL;
+	entrada_compartida_t *entrada =
+		buscar_entrada(hash, clave, hash_fnv1a(clave));
+	if (!entrada || entrada->quitada)
+		return NULL;
+	if (tamanio)
+		*tamanio = entrada->tamanio;
+	return (char *)entrada + inicio_del_valor(entrada->largo_clave);
+}
+
+/*
+ * Devuelve la cantidad de claves del hash o 0 en caso de error.
+ */
+size_t hash_compartido_cantidad(hash_compartido_t *hash)
+{
+	if (!hash)
+		return 0;
+	return atomic_load_explicit(&cabecera_de(hash)->cantidad,
+				    memory_order_relaxed);
+}
+
+/*
+ * Devuelve la cantidad de bytes ocupados del segmento o 0 en caso de error.
+ */
+size_t hash_compartido_bytes_usados(hash_compartido_t *hash)
+{
+	if (!hash)
+		return 0;
+	return cabecera_de(hash)->inicio_entradas +
+	       atomic_load_explicit(&cabecera_de(hash)->usado,
+				    memory_order_relaxed);
+}
+
+/*
+ * Desmapea el segmento en este proceso y libera el hash.
+ */
+void hash_compartido_cerrar(hash_compartido_t *hash)
+{
+	if (!hash)
+		return;
+	munmap(hash->segmento, hash->tamanio);
+	free(hash);
+}
+
+/*
+ * Elimina el segmento con el nombre dado.
+ *
+ * Devuelve true si pudo eliminarlo o false en caso de error.
+ */
+bool hash_compartido_eliminar(const char *nombre)
+{
+	if (!nombre)
+		return false;
+	return shm_unlink(nombre) == 0;
+}
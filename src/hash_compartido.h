@@ -0,0 +1,103 @@
+#ifndef __HASH_COMPARTIDO_H__
+#define __HASH_COMPARTIDO_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Hash compartido: un hash de claves a valores de bytes guardado en un
+ * segmento de memoria compartida POSIX, que varios procesos mapean a la vez
+ * sin copiarlo. Un proceso lo crea y lo llena, y los demás lo abren y
+ * buscan directamente en el segmento.
+ *
+ * Dentro del segmento todo se referencia por desplazamientos desde su
+ * principio (y no por punteros), porque cada proceso lo mapea en otra
+ * dirección. Las entradas nunca se modifican ni se mueven: reemplazar o
+ * quitar una clave agrega una entrada nueva al principio de su posición que
+ * oculta a las anteriores. Por eso las búsquedas no toman ningún lock, y los
+ * valores obtenidos siguen siendo válidos mientras el segmento esté
+ * abierto. Los escritores se turnan con un mutex robusto compartido, así
+ * que si un proceso muere mientras escribe, el siguiente escritor sigue sin
+ * quedar bloqueado.
+ *
+ * El lugar de las entradas se reserva al crear el segmento y no se recupera
+ * al reemplazar ni al quitar claves, así que está pensado para tablas que se
+ * cargan una vez y después se leen.
+ */
+typedef struct hash_compartido hash_compartido_t;
+
+/*
+ * Crea el segmento de memoria compartida con el nombre dado (que debe
+ * empezar con '/', ver shm_open) y lo abre para escritura. El segmento
+ * tiene una posición por clave esperada (redondeado a una potencia de 2) y
+ * lugar para bytes bytes de entradas: cada entrada ocupa 32 bytes más la
+ * clave con su 0 final y el valor, redondeados a múltiplos de 8.
+ *
+ * Devuelve un puntero al hash o NULL en caso de error (o si ya existe un
+ * segmento con ese nombre).
+ */
+hash_compartido_t *hash_compartido_crear(const char *nombre, size_t claves,
+					 size_t bytes);
+
+/*
+ * Abre un segmento creado con hash_compartido_crear (por este u otro
+ * proceso), para escritura o solo para lectura.
+ *
+ * Devuelve un puntero al hash o NULL en caso de error (o si el segmento no
+ * es un hash compartido o todavía no terminó de crearse).
+ */
+hash_compartido_t *hash_compartido_abrir(const char *nombre, bool escritura);
+
+/*
+ * Inserta o reemplaza el valor asociado a la clave dada, copiando los
+ * tamanio bytes del valor al segmento.
+ *
+ * Devuelve true si pudo guardar el valor o false en caso de error (si el
+ * hash se abrió solo para lectura o si no queda lugar en el segmento).
+ */
+bool hash_compartido_insertar(hash_compartido_t *hash, const char *clave,
+			      const void *valor, size_t tamanio);
+
+/*
+ * Quita la clave dada del hash.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario (o de error).
+ */
+bool hash_compartido_quitar(hash_compartido_t *hash, const char *clave);
+
+/*
+ * Devuelve el valor asociado a la clave dada (alineado a 8 bytes) y guarda
+ * su tamaño en *tamanio (si tamanio no es NULL), o devuelve NULL si la
+ * clave no está. El valor está dentro del segmento y sigue siendo válido
+ * hasta cerrarlo, aunque otro proceso reemplace o quite la clave.
+ */
+const void *hash_compartido_obtener(hash_compartido_t *hash,
+				    const char *clave, size_t *tamanio);
+
+/*
+ * Devuelve la cantidad de claves del hash o 0 en caso de error.
+ */
+size_t hash_compartido_cantidad(hash_compartido_t *hash);
+
+/*
+ * Devuelve la cantidad de bytes ocupados del segmento (la cabecera, las
+ * posiciones y las entradas, incluidas las reemplazadas o quitadas) o 0 en
+ * caso de error.
+ */
+size_t hash_compartido_bytes_usados(hash_compartido_t *hash);
+
+/*
+ * Desmapea el segmento en este proceso. El segmento sigue existiendo para
+ * los demás procesos, y hasta que se elimine.
+ */
+void hash_compartido_cerrar(hash_compartido_t *hash);
+
+/*
+ * Elimina el segmento con el nombre dado. Los procesos que lo tienen abierto
+ * pueden seguir usándolo hasta cerrarlo.
+ *
+ * Devuelve true si pudo eliminarlo o false en caso de error.
+ */
+bool hash_compartido_eliminar(const char *nombre);
+
+#endif /* __HASH_COMPARTIDO_H__ */
@@ -0,0 +1,813 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hash.h"
+#include "hash_durable.h"
+#include "funciones_hash.h"
+
+#define OPERACIONES_POR_SINCRONIZACION 64
+#define BYTES_PARA_COMPACTAR (16 * 1024 * 1024)
+
+#define OPERACION_INSERTAR 1
+#define OPERACION_QUITAR 2
+
+/*
+ * Cada operación del registro es un tipo (1 byte), el largo de la clave y el
+ * del valor (4 bytes cada uno), la clave sin el 0 final, el valor, y el
+ * hash FNV-1a de todo lo anterior (8 bytes), que permite reconocer una
+ * operación escrita a medias.
+ */
+#define ENCABEZADO_OPERACION 9
+#define BYTES_SUMA 8
+
+/*
+ * La instantánea empieza con MARCA_INSTANTANEA y la cantidad de claves (8
+ * bytes), sigue con el largo de la clave y del valor (4 bytes cada uno), la
+ * clave y el valor de cada clave, y termina con el hash FNV-1a de todo lo
+ * anterior. Los números se escriben en el orden de bytes de la máquina.
+ */
+#define MARCA_INSTANTANEA "HDURABL1"
+#define BYTES_MARCA 8
+#define ENCABEZADO_INSTANTANEA (BYTES_MARCA + 8)
+#define ENCABEZADO_CLAVE 8
+
+typedef struct valor_durable {
+	size_t tamanio;
+	char datos[];
+} valor_durable_t;
+
+struct hash_durable {
+	hash_t *hash;
+	char *ruta_registro;
+	char *ruta_instantanea;
+	char *ruta_temporal;
+	int registro;
+	char *pendientes;
+	size_t bytes_pendientes;
+	size_t capacidad_pendientes;
+	size_t operaciones_pendientes;
+	size_t bytes_registro;
+	size_t bytes_sincronizados;
+	bool registro_a_medias;
+	size_t bytes_instantanea;
+	size_t operaciones_por_sincronizacion;
+	size_t bytes_para_compactar;
+};
+
+/**
+ * Recibe un valor de tamanio bytes.
+ *
+ * Devuelve una copia del valor, o NULL en caso de error.
+*/
+valor_durable_t *crear_valor_durable(const void *valor, size_t tamanio)
+{
+	valor_durable_t *copia = malloc(sizeof(valor_durable_t) + tamanio);
+	if (!copia)
+		return NULL;
+	copia->tamanio = tamanio;
+	if (tamanio)
+		memcpy(copia->datos, valor, tamanio);
+	return copia;
+}
+
+/**
+ * Recibe una ruta y un sufijo.
+ *
+ * Devuelve un string nuevo con la ruta seguida del sufijo, o NULL en caso de
+ * error.
+*/
+char *ruta_con_sufijo(const char *ruta, const char *sufijo)
+{
+	size_t largo = strlen(ruta);
+	char *resultado = malloc(largo + strlen(sufijo) + 1);
+	if (!resultado)
+		return NULL;
+	memcpy(resultado, ruta, largo);
+	strcpy(resultado + largo, sufijo);
+	return resultado;
+}
+
+/**
+ * Recibe un descriptor de archivo y escribe en él los largo bytes de datos,
+ * aunque write escriba menos de una vez.
+ *
+ * Devuelve true si pudo escribirlos o false en caso de error.
+*/
+bool escribir_completo(int archivo, const char *datos, size_t largo)
+{
+	while (largo > 0) {
+		ssize_t escritos = write(archivo, datos, largo);
+		if (escritos < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		datos += escritos;
+		largo -= (size_t)escritos;
+	}
+	return true;
+}
+
+/**
+ * Recibe una ruta y lee el archivo completo con una sola reserva, guardando
+ * su contenido en *datos (que debe liberarse) y su largo en *largo. Si el
+ * archivo no existe, se guarda NULL y 0.
+ *
+ * Devuelve true si pudo leerlo (o no existe) o false en caso de error.
+*/
+bool leer_archivo_completo(const char *ruta, char **datos, size_t *largo)
+{
+	*datos = NULL;
+	*largo = 0;
+	int archivo = open(ruta, O_RDONLY);
+	if (archivo < 0)
+		return errno == ENOENT;
+	struct stat estado;
+	bool ok = fstat(archivo, &estado) == 0;
+	if (!ok || estado.st_size == 0) {
+		close(archivo);
+		return ok;
+	}
+	size_t total = (size_t)estado.st_size;
+	char *contenido = malloc(total);
+	size_t leidos = 0;
+	while (contenido && leidos < total) {
+		ssize_t leido = read(archivo, contenido + leidos, total - leidos);
+		if (leido < 0 && errno == EINTR)
+			continue;
+		if (leido <= 0)
+			break;
+		leidos += (size_t)leido;
+	}
+	close(archivo);
+	if (!contenido || leidos < total) {
+		free(contenido);
+		return false;
+	}
+	*datos = contenido;
+	*largo = total;
+	return true;
+}
+
+/**
+ * Recibe un buffer y guarda en él el número de 32 o 64 bits dado.
+*/
+void guardar_u32(char *destino, uint32_t numero)
+{
+	memcpy(destino, &numero, sizeof(numero));
+}
+
+void guardar_u64(char *destino, uint64_t numero)
+{
+	memcpy(destino, &numero, sizeof(numero));
+}
+
+/**
+ * Recibe un buffer y devuelve el número de 32 o 64 bits guardado en él.
+*/
+uint32_t cargar_u32(const char *origen)
+{
+	uint32_t numero;
+	memcpy(&numero, origen, sizeof(numero));
+	return numero;
+}
+
+uint64_t cargar_u64(const char *origen)
+{
+	uint64_t numero;
+	memcpy(&numero, origen, sizeof(numero));
+	return numero;
+}
+
+/**
+ * Recibe un hash y una clave, y le asocia el valor dado (reemplazando y
+ * liberando el anterior, si había).
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (en cuyo caso el
+ * valor no se guarda ni se libera).
+*/
+bool aplicar_insercion(hash_t *hash, const char *clave, valor_durable_t *valor)
+{
+	void *anterior = NULL;
+	if (!hash_insertar(hash, clave, valor, &anterior))
+		return false;
+	free(anterior);
+	return true;
+}
+
+/**
+ * Recibe un hash y una clave, y quita y libera su valor.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario.
+*/
+bool aplicar_quitado(hash_t *hash, const char *clave)
+{
+	valor_durable_t *valor = hash_quitar(hash, clave);
+	free(valor);
+	return valor != NULL;
+}
+
+/**
+ * Recibe los datos de un registro y la posición de una operación.
+ *
+ * Devuelve el largo de la operación si está completa y su suma coincide, o 0
+ * si está escrita a medias (o dañada).
+*/
+size_t largo_de_operacion(const char *datos, size_t largo, size_t posicion)
+{
+	if (largo - posicion < ENCABEZADO_OPERACION + BYTES_SUMA)
+		return 0;
+	const char *operacion = datos + posicion;
+	if (operacion[0] != OPERACION_INSERTAR &&
+	    operacion[0] != OPERACION_QUITAR)
+		return 0;
+	size_t contenido = ENCABEZADO_OPERACION +
+			   (size_t)cargar_u32(operacion + 1) +
+			   (size_t)cargar_u32(operacion + 5);
+	if (largo - posicion - BYTES_SUMA < contenido)
+		return 0;
+	uint64_t suma = hash_fnv1a_bytes(hash_fnv1a(""), operacion, contenido);
+	if (suma != cargar_u64(operacion + contenido))
+		return 0;
+	return contenido + BYTES_SUMA;
+}
+
+/**
+ * Recibe los datos de un registro y recorre sus operaciones completas,
+ * contando en *inserciones las que son inserciones.
+ *
+ * Devuelve el largo de la parte del registro que tiene operaciones
+ * completas.
+*/
+size_t largo_valido_del_registro(const char *datos, size_t largo,
+				 size_t *inserciones)
+{
+	size_t posicion = 0;
+	*inserciones = 0;
+	size_t largo_operacion;
+	while ((largo_operacion = largo_de_operacion(datos, largo, posicion))) {
+		if (datos[posicion] == OPERACION_INSERTAR)
+			(*inserciones)++;
+		posicion += largo_operacion;
+	}
+	return posicion;
+}
+
+/**
+ * Recibe un hash y los primeros largo bytes de un registro, que deben tener
+ * solo operaciones completas, y las aplica al hash en orden.
+ *
+ * Devuelve true si pudo aplicarlas o false en caso de error.
+*/
+bool aplicar_registro(hash_t *hash, const char *datos, size_t largo)
+{
+	char clave[256];
+	char *clave_larga = NULL;
+	size_t posicion = 0;
+	bool ok = true;
+	while (ok && posicion < largo) {
+		const char *operacion = datos + posicion;
+		size_t largo_clave = cargar_u32(operacion + 1);
+		size_t tamanio = cargar_u32(operacion + 5);
+		const char *origen = operacion + ENCABEZADO_OPERACION;
+		char *destino = clave;
+		if (largo_clave >= sizeof(clave)) {
+			free(clave_larga);
+			destino = clave_larga = malloc(largo_clave + 1);
+			if (!destino)
+				return false;
+		}
+		memcpy(destino, origen, largo_clave);
+		destino[largo_clave] = 0;
+		if (operacion[0] == OPERACION_QUITAR) {
+			aplicar_quitado(hash, destino);
+		} else {
+			valor_durable_t *valor = crear_valor_durable(
+				origen + largo_clave, tamanio);
+			ok = valor && aplicar_insercion(hash, destino, valor);
+			if (!ok)
+				free(valor);
+		}
+		posicion += ENCABEZADO_OPERACION + largo_clave + tamanio +
+			    BYTES_SUMA;
+	}
+	free(clave_larga);
+	return ok;
+}
+
+/**
+ * Recibe los datos de una instantánea y verifica su marca y su suma.
+ *
+ * Devuelve la cantidad de claves de la instantánea, o guarda false en
+ * *valida si está dañada.
+*/
+size_t claves_de_instantanea(const char *datos, size_t largo, bool *valida)
+{
+	*valida = largo >= ENCABEZADO_INSTANTANEA + BYTES_SUMA &&
+		  memcmp(datos, MARCA_INSTANTANEA, BYTES_MARCA) == 0;
+	if (!*valida)
+		return 0;
+	uint64_t suma =
+		hash_fnv1a_bytes(hash_fnv1a(""), datos, largo - BYTES_SUMA);
+	*valida = suma == cargar_u64(datos + largo - BYTES_SUMA);
+	return *valida ? (size_t)cargar_u64(datos + BYTES_MARCA) : 0;
+}
+
+/**
+ * Recibe un hash y los datos de una instantánea válida con la cantidad de
+ * claves dada, y agrega sus claves al hash.
+ *
+ * Devuelve true si pudo agregarlas o false en caso de error (o si la
+ * instantánea no tiene la cantidad de claves que dice).
+*/
+bool aplicar_instantanea(hash_t *hash, const char *datos, size_t largo,
+			 size_t claves)
+{
+	char clave[256];
+	char *clave_larga = NULL;
+	size_t posicion = ENCABEZADO_INSTANTANEA;
+	size_t fin = largo - BYTES_SUMA;
+	bool ok = true;
+	for (size_t i = 0; ok && i < claves; i++) {
+		ok = fin - posicion >= ENCABEZADO_CLAVE;
+		if (!ok)
+			break;
+		size_t largo_clave = cargar_u32(datos + posicion);
+		size_t tamanio = cargar_u32(datos + posicion + 4);
+		posicion += ENCABEZADO_CLAVE;
+		ok = fin - posicion >= largo_clave + tamanio;
+		char *destino = clave;
+		if (ok && largo_clave >= sizeof(clave)) {
+			free(clave_larga);
+			destino = clave_larga = malloc(largo_clave + 1);
+			ok = destino != NULL;
+		}
+		if (!ok)
+			break;
+		memcpy(destino, datos + posicion, largo_clave);
+		destino[largo_clave] = 0;
+		valor_durable_t *valor = crear_valor_durable(
+			datos + posicion + largo_clave, tamanio);
+		ok = valor && aplicar_insercion(hash, destino, valor);
+		if (!ok)
+			free(valor);
+		posicion += largo_clave + tamanio;
+	}
+	free(clave_larga);
+	return ok && posicion == fin;
+}
+
+/**
+ * Recibe un hash durable recién creado y reconstruye su contenido a partir
+ * de la instantánea y el registro, reservando de una vez lugar para todas
+ * las claves. Si el registro termina con una operación incompleta, lo
+ * recorta para que las operaciones nuevas se agreguen a continuación de la
+ * última completa.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+*/
+bool recuperar_hash_durable(hash_durable_t *durable)
+{
+	char *instantanea, *registro;
+	size_t largo_instantanea, largo_registro;
+	if (!leer_archivo_completo(durable->ruta_instantanea, &instantanea,
+				   &largo_instantanea))
+		return false;
+	if (!leer_archivo_completo(durable->ruta_registro, &registro,
+				   &largo_registro)) {
+		free(instantanea);
+		return false;
+	}
+	bool ok = true;
+	size_t claves = 0;
+	if (instantanea)
+		claves = claves_de_instantanea(instantanea, largo_instantanea,
+					       &ok);
+	size_t inserciones = 0;
+	size_t largo_valido = 0;
+	if (registro)
+		largo_valido = largo_valido_del_registro(
+			registro, largo_registro, &inserciones);
+	ok = ok && hash_reservar(durable->hash, claves + inserciones);
+	if (ok && instantanea)
+		ok = aplicar_instantanea(durable->hash, instantanea,
+					 largo_instantanea, claves);
+	if (ok && registro)
+		ok = aplicar_registro(durable->hash, registro, largo_valido);
+	if (ok && largo_valido < largo_registro)
+		ok = ftruncate(durable->registro, (off_t)largo_valido) == 0 &&
+		     fdatasync(durable->registro) == 0;
+	durable->bytes_instantanea = largo_instantanea;
+	durable->bytes_registro = largo_valido;
+	durable->bytes_sincronizados = largo_valido;
+	free(instantanea);
+	free(registro);
+	return ok;
+}
+
+/**
+ * Libera el valor de un hash durable.
+*/
+void liberar_valor_durable(void *valor)
+{
+	free(valor);
+}
+
+/**
+ * Libera un hash durable y todo lo que contiene, sin sincronizarlo.
+*/
+void liberar_hash_durable(hash_durable_t *durable)
+{
+	hash_destruir_todo(durable->hash, liberar_valor_durable);
+	if (durable->registro >= 0)
+		close(durable->registro);
+	free(durable->ruta_registro);
+	free(durable->ruta_instantanea);
+	free(durable->ruta_temporal);
+	free(durable->pendientes);
+	free(durable);
+}
+
+/*
+ * Abre el hash durable guardado en la ruta dada, con las opciones dadas (que
+ * pueden ser NULL), y lo reconstruye leyendo la instantánea y el registro
+ * completos.
+ *
+ * Devuelve un puntero al hash o NULL en caso de error.
+ */
+hash_durable_t *hash_durable_abrir(const char *ruta,
+				   const hash_durable_opciones_t *opciones)
+{
+	if (!ruta)
+		return NULL;
+	hash_durable_t *durable = calloc(1, sizeof(hash_durable_t));
+	if (!durable)
+		return NULL;
+	durable->registro = -1;
+	durable->operaciones_por_sincronizacion =
+		opciones && opciones->operaciones_por_sincronizacion ?
+			opciones->operaciones_por_sincronizacion :
+			OPERACIONES_POR_SINCRONIZACION;
+	durable->bytes_para_compactar =
+		opciones && opciones->bytes_para_compactar ?
+			opciones->bytes_para_compactar :
+			BYTES_PARA_COMPACTAR;
+	durable->hash = hash_crear(3);
+	durable->ruta_registro = ruta_con_sufijo(ruta, ".registro");
+	durable->ruta_instantanea = ruta_con_sufijo(ruta, ".instantanea");
+	durable->ruta_temporal = ruta_con_sufijo(ruta, ".instantanea.tmp");
+	if (durable->hash && durable->ruta_registro &&
+	    durable->ruta_instantanea && durable->ruta_temporal)
+		durable->registro = open(durable->ruta_registro,
+					 O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (durable->registro < 0 || !recuperar_hash_durable(durable)) {
+		liberar_hash_durable(durable);
+		return NULL;
+	}
+	return durable;
+}
+
+/**
+ * Recibe un hash durable y se asegura de que haya lugar para agregar
+ * largo bytes más a sus operaciones pendientes.
+ *
+ * Devuelve true si hay lugar o false en caso de error.
+*/
+bool reservar_pendientes(hash_durable_t *durable, size_t largo)
+{
+	if (durable->capacidad_pendientes - durable->bytes_pendientes >= largo)
+		return true;
+	size_t capacidad = durable->capacidad_pendientes ?
+				   durable->capacidad_pendientes :
+				   4096;
+	while (capacidad - durable->bytes_pendientes < largo)
+		capacidad *= 2;
+	char *pendientes = realloc(durable->pendientes, capacidad);
+	if (!pendientes)
+		return false;
+	durable->pendientes = pendientes;
+	durable->capacidad_pendientes = capacidad;
+	return true;
+}
+
+/**
+ * Recibe un hash durable y una operación, y la agrega a las operaciones
+ * pendientes. Antes debe haberse reservado lugar con reservar_pendientes.
+*/
+void agregar_pendiente(hash_durable_t *durable, char tipo, const char *clave,
+		       size_t largo_clave, const void *valor, size_t tamanio)
+{
+	char *operacion = durable->pendientes + durable->bytes_pendientes;
+	operacion[0] = tipo;
+	guardar_u32(operacion + 1, (uint32_t)largo_clave);
+	guardar_u32(operacion + 5, (uint32_t)tamanio);
+	memcpy(operacion + ENCABEZADO_OPERACION, clave, largo_clave);
+	if (tamanio)
+		memcpy(operacion + ENCABEZADO_OPERACION + largo_clave, valor,
+		       tamanio);
+	size_t contenido = ENCABEZADO_OPERACION + largo_clave + tamanio;
+	guardar_u64(operacion + contenido,
+		    hash_fnv1a_bytes(hash_fnv1a(""), operacion, contenido));
+	durable->bytes_pendientes += contenido + BYTES_SUMA;
+	durable->bytes_registro += contenido + BYTES_SUMA;
+	durable->operaciones_pendientes++;
+}
+
+/**
+ * Recibe un hash durable al que se le acaba de agregar una operación, y lo
+ * sincroniza o lo compacta si corresponde. Un error al compactar no es un
+ * error de la operación, porque el registro sigue teniéndola.
+ *
+ * Devuelve true si pudo sincronizarlo (o no hacía falta) o false en caso de
+ * error.
+*/
+bool despues_de_operar(hash_durable_t *durable)
+{
+	if (durable->operaciones_pendientes <
+	    durable->operaciones_por_sincronizacion)
+		return true;
+	if (!hash_durable_sincronizar(durable))
+		return false;
+	if (durable->bytes_registro >= durable->bytes_para_compactar &&
+	    durable->bytes_registro > durable->bytes_instantanea)
+		hash_durable_compactar(durable);
+	return true;
+}
+
+/*
+ * Inserta o reemplaza el valor asociado a la clave dada, copiando el valor,
+ * y agrega la operación al registro.
+ *
+ * Devuelve true si pudo guardar el valor o false en caso de error. Si el
+ * error fue al sincronizar, el valor ya quedó guardado en memoria y la
+ * operación sigue pendiente hasta la próxima sincronización.
+ */
+bool hash_durable_insertar(hash_durable_t *hash, const char *clave,
+			   const void *valor, size_t tamanio)
+{
+	if (!hash || !clave || (!valor && tamanio) || tamanio > UINT32_MAX)
+		return false;
+	size_t largo_clave = strlen(clave);
+	if (largo_clave > UINT32_MAX ||
+	    !reservar_pendientes(hash, ENCABEZADO_OPERACION + largo_clave +
+						 tamanio + BYTES_SUMA))
+		return false;
+	valor_durable_t *copia = crear_valor_durable(valor, tamanio);
+	if (!copia)
+		return false;
+	if (!aplicar_insercion(hash->hash, clave, copia)) {
+		free(copia);
+		return false;
+	}
+	agregar_pendiente(hash, OPERACION_INSERTAR, clave, largo_clave, valor,
+			  tamanio);
+	return despues_de_operar(hash);
+}
+
+/*
+ * Quita la clave dada del hash y agrega la operación al registro (solo si la
+ * clave estaba).
+ *
+ * Devuelve true si la clave estaba o false en caso contrario (o de error).
+ * Si el error fue al sincronizar, la clave ya se quitó de memoria y la
+ * operación sigue pendiente hasta la próxima sincronización.
+ */
+bool hash_durable_quitar(hash_durable_t *hash, const char *clave)
+{
+	if (!hash || !clave || !hash_contiene(hash->hash, clave))
+		return false;
+	size_t largo_clave = strlen(clave);
+	if (!reservar_pendientes(hash, ENCABEZADO_OPERACION + largo_clave +
+					       BYTES_SUMA))
+		return false;
+	aplicar_quitado(hash->hash, clave);
+	agregar_pendiente(hash, OPERACION_QUITAR, clave, largo_clave, NULL, 0);
+	return despues_de_operar(hash);
+}
+
+/*
+ * Devuelve el valor asociado a la clave dada y guarda su tamaño en *tamanio
+ * (si tamanio no es NULL), o devuelve NULL si la clave no está.
+ */
+const void *hash_durable_obtener(hash_durable_t *hash, const char *clave,
+				 size_t *tamanio)
+{
+	if (!hash || !clave)
+		return NULL;
+	valor_durable_t *valor = hash_obtener(hash->hash, clave);
+	if (!valor)
+		return NULL;
+	if (tamanio)
+		*tamanio = valor->tamanio;
+	return valor->datos;
+}
+
+/*
+ * Devuelve la cantidad de claves del hash o 0 en caso de error.
+ */
+size_t hash_durable_cantidad(hash_durable_t *hash)
+{
+	if (!hash)
+		return 0;
+	return hash_cantidad(hash->hash);
+}
+
+/**
+ * Recibe un hash durable y corta su registro en el largo que tenía en la
+ * última sincronización, descartando lo que haya quedado de una escritura
+ * fallida. Si no, un reintento agregaría las operaciones detrás de una
+ * escrita a medias, y al abrirlo se descartarían junto con ella.
+ *
+ * Devuelve true si pudo o false en caso de error (en cuyo caso hay que
+ * volver a intentarlo antes de escribir).
+*/
+bool descartar_escritura_fallida(hash_durable_t *durable)
+{
+	durable->registro_a_medias =
+		ftruncate(durable->registro,
+			  (off_t)durable->bytes_sincronizados) < 0;
+	return !durable->registro_a_medias;
+}
+
+/*
+ * Escribe en el registro las operaciones pendientes con una sola escritura
+ * y espera a que lleguen al disco (commit en grupo). Si falla, el registro
+ * vuelve al largo de la última sincronización y las operaciones siguen
+ * pendientes, así que se puede volver a intentar.
+ *
+ * Devuelve true si pudo o false en caso de error.
+ */
+bool hash_durable_sincronizar(hash_durable_t *hash)
+{
+	if (!hash)
+		return false;
+	if (!hash->operaciones_pendientes)
+		return true;
+	if (hash->registro_a_medias && !descartar_escritura_fallida(hash))
+		return false;
+	if (!escribir_completo(hash->registro, hash->pendientes,
+			       hash->bytes_pendientes) ||
+	    fdatasync(hash->registro) < 0) {
+		descartar_escritura_fallida(hash);
+		return false;
+	}
+	hash->bytes_sincronizados = hash->bytes_registro;
+	hash->bytes_pendientes = 0;
+	hash->operaciones_pendientes = 0;
+	return true;
+}
+
+typedef struct estructura_auxiliar_para_instantanea {
+	char *datos;
+	size_t largo;
+	uint64_t suma;
+	int archivo;
+	bool error;
+} aux_instantanea_t;
+
+/**
+ * Recibe los datos de una instantánea en construcción y escribe en el
+ * archivo los que tiene acumulados, actualizando la suma.
+ *
+ * Devuelve false en caso de error.
+*/
+bool volcar_instantanea(aux_instantanea_t *aux)
+{
+	aux->suma = hash_fnv1a_bytes(aux->suma, aux->datos, aux->largo);
+	aux->error = aux->error ||
+		     !escribir_completo(aux->archivo, aux->datos, aux->largo);
+	aux->largo = 0;
+	return !aux->error;
+}
+
+#define BUFFER_INSTANTANEA (64 * 1024)
+
+/**
+ * Recibe una clave, su valor y los datos de una instantánea en
+ * construcción, y agrega la clave a la instantánea.
+ *
+ * Devuelve false (para cortar el recorrido) en caso de error.
+*/
+bool agregar_a_instantanea(const char *clave, void *valor, void *aux)
+{
+	aux_instantanea_t *instantanea = aux;
+	valor_durable_t *copia = valor;
+	size_t largo_clave = strlen(clave);
+	char encabezado[ENCABEZADO_CLAVE];
+	guardar_u32(encabezado, (uint32_t)largo_clave);
+	guardar_u32(encabezado + 4, (uint32_t)copia->tamanio);
+	const char *pedazos[] = { encabezado, clave, copia->datos };
+	size_t largos[] = { ENCABEZADO_CLAVE, largo_clave, copia->tamanio };
+	for (int i = 0; i < 3; i++) {
+		const char *pedazo = pedazos[i];
+		size_t largo = largos[i];
+		while (largo > 0) {
+			if (instantanea->largo == BUFFER_INSTANTANEA &&
+			    !volcar_instantanea(instantanea))
+				return false;
+			size_t copiados = BUFFER_INSTANTANEA - instantanea->largo;
+			if (copiados > largo)
+				copiados = largo;
+			memcpy(instantanea->datos + instantanea->largo, pedazo,
+			       copiados);
+			instantanea->largo += copiados;
+			pedazo += copiados;
+			largo -= copiados;
+		}
+	}
+	return true;
+}
+
+/**
+ * Recibe la ruta de un archivo y sincroniza el directorio que lo contiene,
+ * para que un rename hecho en él llegue al disco.
+ *
+ * Devuelve true si pudo o false en caso de error.
+*/
+bool sincronizar_directorio(const char *ruta)
+{
+	const char *barra = strrchr(ruta, '/');
+	char *directorio = barra ? strndup(ruta, (size_t)(barra - ruta) + 1) :
+				   strdup(".");
+	if (!directorio)
+		return false;
+	int archivo = open(directorio, O_RDONLY);
+	free(directorio);
+	if (archivo < 0)
+		return false;
+	bool ok = fsync(archivo) == 0;
+	close(archivo);
+	return ok;
+}
+
+/*
+ * Escribe una instantánea con el contenido del hash en un archivo temporal,
+ * lo renombra sobre la instantánea anterior, y recién entonces vacía el
+ * registro. Si el proceso se cae antes de vaciar el registro, al abrirlo se
+ * vuelven a aplicar sus operaciones sobre la instantánea nueva, lo que deja
+ * el mismo contenido.
+ *
+ * Devuelve true si pudo o false en caso de error.
+ */
+bool hash_durable_compactar(hash_durable_t *hash)
+{
+	if (!hash || !hash_durable_sincronizar(hash))
+		return false;
+	aux_instantanea_t aux = { .suma = hash_fnv1a("") };
+	aux.datos = malloc(BUFFER_INSTANTANEA);
+	aux.archivo = open(hash->ruta_temporal, O_WRONLY | O_CREAT | O_TRUNC,
+			   0644);
+	if (!aux.datos || aux.archivo < 0) {
+		free(aux.datos);
+		if (aux.archivo >= 0)
+			close(aux.archivo);
+		return false;
+	}
+	memcpy(aux.datos, MARCA_INSTANTANEA, BYTES_MARCA);
+	guardar_u64(aux.datos + BYTES_MARCA, hash_cantidad(hash->hash));
+	aux.largo = ENCABEZADO_INSTANTANEA;
+	size_t claves = hash_cantidad(hash->hash);
+	bool ok = hash_con_cada_clave(hash->hash, agregar_a_instantanea,
+				      &aux) == claves &&
+		  volcar_instantanea(&aux);
+	if (ok) {
+		char suma[BYTES_SUMA];
+		guardar_u64(suma, aux.suma);
+		ok = escribir_completo(aux.archivo, suma, BYTES_SUMA);
+	}
+	struct stat estado;
+	ok = ok && fsync(aux.archivo) == 0 && fstat(aux.archivo, &estado) == 0;
+	close(aux.archivo);
+	free(aux.datos);
+	ok = ok && rename(hash->ruta_temporal, hash->ruta_instantanea) == 0 &&
+	     sincronizar_directorio(hash->ruta_instantanea);
+	if (!ok) {
+		unlink(hash->ruta_temporal);
+		return false;
+	}
+	hash->bytes_instantanea = (size_t)estado.st_size;
+	if (ftruncate(hash->registro, 0) < 0)
+		return false;
+	hash->bytes_registro = 0;
+	hash->bytes_sincronizados = 0;
+	return fdatasync(hash->registro) == 0;
+}
+
+/*
+ * Sincroniza el hash y lo cierra, liberando la memoria reservada.
+ *
+ * Devuelve true si pudo sincronizarlo o false en caso de error.
+ */
+bool hash_durable_cerrar(hash_durable_t *hash)
+{
+	if (!hash)
+		return false;
+	bool ok = hash_durable_sincronizar(hash);
+	liberar_hash_durable(hash);
+	return ok;
+}
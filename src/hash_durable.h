@@ -0,0 +1,109 @@
+#ifndef __HASH_DURABLE_H__
+#define __HASH_DURABLE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Hash durable: un hash de claves a valores de bytes que sobrevive a que el
+ * proceso termine (o se caiga). Cada inserción y cada quitado se agregan al
+ * final de un registro binario (<ruta>.registro), y cada tanto el registro
+ * se compacta en una instantánea (<ruta>.instantanea) con el contenido
+ * completo del hash. Al abrirlo se reconstruye el hash a partir de la
+ * instantánea y de los registros escritos después.
+ *
+ * El hash durable copia los valores, así que no hay que liberarlos.
+ */
+typedef struct hash_durable hash_durable_t;
+
+/*
+ * Opciones de apertura de un hash durable.
+ *
+ * operaciones_por_sincronizacion es la cantidad de operaciones que se
+ * acumulan en memoria antes de escribirlas juntas en el registro y esperar a
+ * que lleguen al disco (64 por defecto, y 1 para esperar en cada operación).
+ * Si el proceso se cae, se pierden a lo sumo las operaciones acumuladas
+ * desde la última sincronización.
+ *
+ * bytes_para_compactar es el tamaño del registro a partir del cual se
+ * compacta en una instantánea (16 MiB por defecto), siempre que además el
+ * registro sea más grande que la última instantánea.
+ */
+typedef struct hash_durable_opciones {
+	size_t operaciones_por_sincronizacion;
+	size_t bytes_para_compactar;
+} hash_durable_opciones_t;
+
+/*
+ * Abre el hash durable guardado en la ruta dada (creándolo vacío si no
+ * existe), con las opciones dadas (que pueden ser NULL). Si el registro
+ * termina con una operación escrita a medias, se descarta.
+ *
+ * Devuelve un puntero al hash o NULL en caso de error (o si la instantánea
+ * está dañada).
+ */
+hash_durable_t *hash_durable_abrir(const char *ruta,
+				   const hash_durable_opciones_t *opciones);
+
+/*
+ * Inserta o reemplaza el valor asociado a la clave dada, copiando los
+ * tamanio bytes del valor.
+ *
+ * Devuelve true si pudo guardar el valor o false en caso de error. Si el
+ * error fue al sincronizar, el valor ya quedó guardado en memoria pero
+ * todavía no en el disco: la operación sigue pendiente y se vuelve a
+ * escribir en la próxima sincronización.
+ */
+bool hash_durable_insertar(hash_durable_t *hash, const char *clave,
+			   const void *valor, size_t tamanio);
+
+/*
+ * Quita la clave dada del hash.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario (o de error).
+ * Si el error fue al sincronizar, la clave ya se quitó de memoria pero
+ * todavía no del disco: la operación sigue pendiente y se vuelve a escribir
+ * en la próxima sincronización.
+ */
+bool hash_durable_quitar(hash_durable_t *hash, const char *clave);
+
+/*
+ * Devuelve el valor asociado a la clave dada y guarda su tamaño en *tamanio
+ * (si tamanio no es NULL), o devuelve NULL si la clave no está. El valor
+ * pertenece al hash y deja de ser válido al reemplazar o quitar la clave.
+ */
+const void *hash_durable_obtener(hash_durable_t *hash, const char *clave,
+				 size_t *tamanio);
+
+/*
+ * Devuelve la cantidad de claves del hash o 0 en caso de error.
+ */
+size_t hash_durable_cantidad(hash_durable_t *hash);
+
+/*
+ * Escribe en el registro las operaciones acumuladas y espera a que lleguen
+ * al disco.
+ *
+ * Devuelve true si pudo o false en caso de error. En caso de error lo que se
+ * llegó a escribir se descarta y las operaciones siguen acumuladas, así que
+ * se puede volver a intentar.
+ */
+bool hash_durable_sincronizar(hash_durable_t *hash);
+
+/*
+ * Escribe una instantánea con el contenido del hash, reemplazando a la
+ * anterior, y vacía el registro.
+ *
+ * Devuelve true si pudo o false en caso de error (en cuyo caso se siguen
+ * usando la instantánea y el registro anteriores).
+ */
+bool hash_durable_compactar(hash_durable_t *hash);
+
+/*
+ * Sincroniza el hash y lo cierra, liberando la memoria reservada.
+ *
+ * Devuelve true si pudo sincronizarlo o false en caso de error.
+ */
+bool hash_durable_cerrar(hash_durable_t *hash);
+
+#endif /* __HASH_DURABLE_H__ */
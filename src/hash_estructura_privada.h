@@ -3,16 +3,49 @@
 
 #include "hash.h"
 #include "lista.h"
+#include "arbol.h"
+#include "rueda_temporal.h"
+#include "filtro.h"
+#include "tabla_compacta.h"
+#include "tabla_cuckoo.h"
 
 struct hash {
 	lista_t **tabla;
+	arbol_t **arboles;
 	size_t capacidad;
 	size_t cantidad;
+	size_t capacidad_minima;
+	double factor_carga_maximo;
+	double factor_carga_minimo;
+	double factor_crecimiento;
+	unsigned int flags;
+	pool_claves_t *pool_claves;
+	rueda_temporal_t *rueda;
+	uint64_t (*reloj)(void *contexto);
+	void *contexto_reloj;
+	void (*destructor_expirados)(void *);
+	filtro_t *filtro;
+	pool_t *pool_nodos;
+	hash_estadisticas_filtro_t estadisticas_filtro;
+	tabla_compacta_t *compacta;
+	tabla_cuckoo_t *cuckoo;
+	memoria_t *memoria;
+	size_t *referencias_tablas;
+	uint64_t semilla;
 };
 
 typedef struct par_clave_valor {
 	char *clave;
 	void *valor;
+	temporizador_t *temporizador;
 } par_cv_t;
 
+/*
+ * Suma los valores de los caracteres de la clave (sin signo). Es la función
+ * de la que sale la posición de las claves en los hash sin semilla.
+ *
+ * Devuelve la suma.
+ */
+int funcion_hash(const char *clave);
+
 #endif // HASH_ESTRUCTURA_PRIVADA_H_
\ No newline at end of file
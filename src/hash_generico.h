@@ -0,0 +1,231 @@
+#ifndef __HASH_GENERICO_H__
+#define __HASH_GENERICO_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * Macros que generan un hash especializado para un tipo de clave y un tipo
+ * de valor dados. Las claves y los valores se guardan dentro del arreglo de
+ * espacios (direccionamiento abierto con sondeo lineal), así que un valor
+ * chico (un contador, un struct, un offset) no necesita memoria propia, y la
+ * función hash y la comparación se invocan directamente, por lo que el
+ * compilador puede expandirlas en línea.
+ *
+ * HASH_DEFINIR(nombre, TipoClave, TipoValor, fn_hash, fn_igual) define el
+ * tipo nombre_t y las funciones:
+ *
+ *   nombre_t *nombre_crear(size_t capacidad);
+ *   nombre_t *nombre_insertar(nombre_t *, TipoClave, TipoValor);
+ *   TipoValor *nombre_obtener(nombre_t *, TipoClave);
+ *   TipoValor *nombre_obtener_o_insertar(nombre_t *, TipoClave, TipoValor);
+ *   bool nombre_quitar(nombre_t *, TipoClave, TipoValor *quitado);
+ *   bool nombre_contiene(nombre_t *, TipoClave);
+ *   size_t nombre_cantidad(nombre_t *);
+ *   size_t nombre_con_cada_clave(nombre_t *,
+ *                                bool (*f)(TipoClave, TipoValor *, void *),
+ *                                void *aux);
+ *   void nombre_destruir(nombre_t *);
+ *
+ * Insertar solo agranda el arreglo cuando la clave es nueva, así que
+ * actualizar una clave que ya está nunca falla.
+ *
+ * fn_hash recibe una clave y devuelve un entero sin signo, y fn_igual recibe
+ * dos claves y devuelve true si son iguales. El hash no copia las claves: si
+ * TipoClave es un puntero, lo apuntado debe vivir tanto como el hash.
+ */
+
+#define HASH_GENERICO_FACTOR_CARGA 0.7
+#define HASH_GENERICO_ESPACIOS_MINIMOS 8
+
+/*
+ * Mezcla los bits del resultado de la función hash del usuario (finalizador
+ * de splitmix64), ya que el índice se toma de los bits bajos.
+ */
+static inline uint64_t hash_generico_mezclar(uint64_t valor)
+{
+	valor ^= valor >> 30;
+	valor *= 0xbf58476d1ce4e5b9ULL;
+	valor ^= valor >> 27;
+	valor *= 0x94d049bb133111ebULL;
+	valor ^= valor >> 31;
+	return valor;
+}
+
+#define HASH_DEFINIR(nombre, TipoClave, TipoValor, fn_hash, fn_igual)         \
+	typedef struct nombre##_espacio {                                     \
+		TipoClave clave;                                              \
+		TipoValor valor;                                              \
+		bool ocupado;                                                 \
+	} nombre##_espacio_t;                                                 \
+                                                                              \
+	typedef struct nombre {                                               \
+		nombre##_espacio_t *espacios;                                 \
+		size_t capacidad;                                             \
+		size_t cantidad;                                              \
+	} nombre##_t;                                                         \
+                                                                              \
+	static inline nombre##_t *nombre##_crear(size_t capacidad)            \
+	{                                                                     \
+		nombre##_t *hash = malloc(sizeof(nombre##_t));                \
+		if (!hash)                                                    \
+			return NULL;                                          \
+		hash->capacidad = HASH_GENERICO_ESPACIOS_MINIMOS;             \
+		while ((double)capacidad >                                    \
+		       (double)hash->capacidad * HASH_GENERICO_FACTOR_CARGA)  \
+			hash->capacidad *= 2;                                 \
+		hash->cantidad = 0;                                           \
+		hash->espacios =                                              \
+			calloc(hash->capacidad, sizeof(nombre##_espacio_t));  \
+		if (!hash->espacios) {                                        \
+			free(hash);                                           \
+			return NULL;                                          \
+		}                                                             \
+		return hash;                                                  \
+	}                                                                     \
+                                                                              \
+	static inline size_t nombre##_ideal(nombre##_t *hash, TipoClave clave) \
+	{                                                                     \
+		return (size_t)hash_generico_mezclar((uint64_t)fn_hash(clave)) & \
+		       (hash->capacidad - 1);                                 \
+	}                                                                     \
+                                                                              \
+	static inline size_t nombre##_buscar(nombre##_t *hash,                \
+					     TipoClave clave)                 \
+	{                                                                     \
+		size_t mascara = hash->capacidad - 1;                         \
+		size_t i = nombre##_ideal(hash, clave);                       \
+		while (hash->espacios[i].ocupado &&                           \
+		       !fn_igual(hash->espacios[i].clave, clave))             \
+			i = (i + 1) & mascara;                                \
+		return i;                                                     \
+	}                                                                     \
+                                                                              \
+	static inline int nombre##_rehash(nombre##_t *hash)                   \
+	{                                                                     \
+		nombre##_espacio_t *viejos = hash->espacios;                  \
+		size_t capacidad_vieja = hash->capacidad;                     \
+		nombre##_espacio_t *nuevos =                                  \
+			calloc(capacidad_vieja * 2, sizeof(nombre##_espacio_t)); \
+		if (!nuevos)                                                  \
+			return -1;                                            \
+		hash->espacios = nuevos;                                      \
+		hash->capacidad = capacidad_vieja * 2;                        \
+		for (size_t i = 0; i < capacidad_vieja; i++)                  \
+			if (viejos[i].ocupado)                                \
+				hash->espacios[nombre##_buscar(               \
+					hash, viejos[i].clave)] = viejos[i];  \
+		free(viejos);                                                 \
+		return 0;                                                     \
+	}                                                                     \
+                                                                              \
+	static inline TipoValor *nombre##_obtener_o_insertar(                 \
+		nombre##_t *hash, TipoClave clave, TipoValor inicial)         \
+	{                                                                     \
+		if (!hash)                                                    \
+			return NULL;                                          \
+		nombre##_espacio_t *espacio =                                 \
+			&hash->espacios[nombre##_buscar(hash, clave)];        \
+		if (espacio->ocupado)                                         \
+			return &espacio->valor;                               \
+		if ((double)(hash->cantidad + 1) >                            \
+		    (double)hash->capacidad * HASH_GENERICO_FACTOR_CARGA) {   \
+			if (nombre##_rehash(hash) == -1)                      \
+				return NULL;                                  \
+			espacio = &hash->espacios[nombre##_buscar(hash,       \
+								  clave)];    \
+		}                                                             \
+		espacio->ocupado = true;                                      \
+		espacio->clave = clave;                                       \
+		espacio->valor = inicial;                                     \
+		hash->cantidad++;                                             \
+		return &espacio->valor;                                       \
+	}                                                                     \
+                                                                              \
+	static inline nombre##_t *nombre##_insertar(                          \
+		nombre##_t *hash, TipoClave clave, TipoValor valor)           \
+	{                                                                     \
+		TipoValor *guardado =                                         \
+			nombre##_obtener_o_insertar(hash, clave, valor);      \
+		if (!guardado)                                                \
+			return NULL;                                          \
+		*guardado = valor;                                            \
+		return hash;                                                  \
+	}                                                                     \
+                                                                              \
+	static inline TipoValor *nombre##_obtener(nombre##_t *hash,           \
+						  TipoClave clave)            \
+	{                                                                     \
+		if (!hash)                                                    \
+			return NULL;                                          \
+		nombre##_espacio_t *espacio =                                 \
+			&hash->espacios[nombre##_buscar(hash, clave)];        \
+		return espacio->ocupado ? &espacio->valor : NULL;             \
+	}                                                                     \
+                                                                              \
+	static inline bool nombre##_contiene(nombre##_t *hash,                \
+					     TipoClave clave)                 \
+	{                                                                     \
+		return nombre##_obtener(hash, clave) != NULL;                 \
+	}                                                                     \
+                                                                              \
+	static inline bool nombre##_quitar(nombre##_t *hash, TipoClave clave, \
+					   TipoValor *quitado)                \
+	{                                                                     \
+		if (!hash)                                                    \
+			return false;                                         \
+		size_t mascara = hash->capacidad - 1;                         \
+		size_t hueco = nombre##_buscar(hash, clave);                  \
+		if (!hash->espacios[hueco].ocupado)                           \
+			return false;                                         \
+		if (quitado)                                                  \
+			*quitado = hash->espacios[hueco].valor;               \
+		hash->espacios[hueco].ocupado = false;                        \
+		hash->cantidad--;                                             \
+		for (size_t i = (hueco + 1) & mascara;                        \
+		     hash->espacios[i].ocupado; i = (i + 1) & mascara) {      \
+			size_t ideal =                                        \
+				nombre##_ideal(hash, hash->espacios[i].clave); \
+			if (((i - ideal) & mascara) >= ((i - hueco) & mascara)) { \
+				hash->espacios[hueco] = hash->espacios[i];    \
+				hash->espacios[i].ocupado = false;            \
+				hueco = i;                                    \
+			}                                                     \
+		}                                                             \
+		return true;                                                  \
+	}                                                                     \
+                                                                              \
+	static inline size_t nombre##_cantidad(nombre##_t *hash)              \
+	{                                                                     \
+		return hash ? hash->cantidad : 0;                             \
+	}                                                                     \
+                                                                              \
+	static inline size_t nombre##_con_cada_clave(                         \
+		nombre##_t *hash, bool (*f)(TipoClave, TipoValor *, void *),  \
+		void *aux)                                                    \
+	{                                                                     \
+		size_t invocaciones = 0;                                      \
+		if (!hash || !f)                                              \
+			return invocaciones;                                  \
+		for (size_t i = 0; i < hash->capacidad; i++) {                \
+			if (!hash->espacios[i].ocupado)                       \
+				continue;                                     \
+			invocaciones++;                                       \
+			if (!f(hash->espacios[i].clave,                       \
+			       &hash->espacios[i].valor, aux))                \
+				return invocaciones;                          \
+		}                                                             \
+		return invocaciones;                                          \
+	}                                                                     \
+                                                                              \
+	static inline void nombre##_destruir(nombre##_t *hash)                \
+	{                                                                     \
+		if (!hash)                                                    \
+			return;                                               \
+		free(hash->espacios);                                         \
+		free(hash);                                                   \
+	}
+
+#endif /* __HASH_GENERICO_H__ */
@@ -0,0 +1,287 @@
+#include <stdlib.h>
+#include <string.h>
+#include "hash_multi.h"
+#include "hash_estructura_privada.h"
+
+#define VALORES_INICIALES 2
+
+/*
+ * Valores de una clave: se reservan en un solo bloque junto con su cantidad
+ * y su capacidad, que se duplica cuando se llena.
+ */
+typedef struct grupo_multi {
+	size_t cantidad;
+	size_t capacidad;
+	void *valores[];
+} grupo_multi_t;
+
+struct hash_multi {
+	hash_t *grupos;
+	size_t valores;
+};
+
+/*
+ * Crea un hash multi con lugar para la cantidad de claves dada, cuyo hash
+ * interno se crea con las opciones dadas (que pueden ser NULL). El hash
+ * multi y los grupos de valores se reservan con la misma cuenta de memoria
+ * que el hash interno.
+ *
+ * Devuelve un puntero al hash creado o NULL en caso de error.
+ */
+hash_multi_t *hash_multi_crear(size_t capacidad,
+			       const hash_opciones_t *opciones)
+{
+	hash_t *grupos = hash_crear_con_opciones(capacidad, opciones);
+	if (!grupos)
+		return NULL;
+	hash_multi_t *hash =
+		memoria_reservar_ceros(grupos->memoria, 1, sizeof(hash_multi_t));
+	if (!hash) {
+		hash_destruir(grupos);
+		return NULL;
+	}
+	hash->grupos = grupos;
+	return hash;
+}
+
+/**
+ * Recibe la cuenta de memoria del hash interno y un grupo lleno (o NULL si
+ * la clave todavía no tiene valores), y reserva un grupo con el doble de
+ * capacidad (o VALORES_INICIALES) con los mismos valores. El grupo recibido
+ * no se libera.
+ *
+ * Devuelve el grupo nuevo o NULL en caso de error.
+*/
+grupo_multi_t *agrandar_grupo(memoria_t *memoria, grupo_multi_t *grupo)
+{
+	size_t capacidad = grupo ? grupo->capacidad * 2 : VALORES_INICIALES;
+	grupo_multi_t *nuevo = memoria_reservar(
+		memoria, sizeof(grupo_multi_t) + capacidad * sizeof(void *));
+	if (!nuevo)
+		return NULL;
+	nuevo->cantidad = grupo ? grupo->cantidad : 0;
+	nuevo->capacidad = capacidad;
+	if (grupo)
+		memcpy(nuevo->valores, grupo->valores,
+		       grupo->cantidad * sizeof(void *));
+	return nuevo;
+}
+
+/*
+ * Agrega el valor al final de los valores de la clave dada, creando la
+ * clave si no existía.
+ *
+ * Si el grupo de la clave está lleno, se copia a uno del doble de tamaño y
+ * se reemplaza en el hash interno. El grupo viejo se libera recién cuando
+ * el reemplazo funcionó, así que en caso de error la clave queda como
+ * estaba.
+ *
+ * Devuelve el hash o NULL en caso de error.
+ */
+hash_multi_t *hash_multi_insertar(hash_multi_t *hash, const char *clave,
+				  void *valor)
+{
+	if (!hash || !clave)
+		return NULL;
+	grupo_multi_t *grupo = hash_obtener(hash->grupos, clave);
+	if (!grupo || grupo->cantidad == grupo->capacidad) {
+		memoria_t *memoria = hash->grupos->memoria;
+		grupo_multi_t *nuevo = agrandar_grupo(memoria, grupo);
+		if (!nuevo)
+			return NULL;
+		if (!hash_insertar(hash->grupos, clave, nuevo, NULL)) {
+			memoria_liberar(memoria, nuevo);
+			return NULL;
+		}
+		memoria_liberar(memoria, grupo);
+		grupo = nuevo;
+	}
+	grupo->valores[grupo->cantidad++] = valor;
+	hash->valores++;
+	return hash;
+}
+
+/*
+ * Devuelve los valores de la clave dada como un arreglo contiguo, en orden
+ * de inserción, y guarda su cantidad en *cantidad (si no es NULL).
+ *
+ * Devuelve NULL (y guarda 0 en *cantidad) si la clave no existe o en caso
+ * de error.
+ */
+void *const *hash_multi_obtener_todos(hash_multi_t *hash, const char *clave,
+				      size_t *cantidad)
+{
+	grupo_multi_t *grupo =
+		hash && clave ? hash_obtener(hash->grupos, clave) : NULL;
+	if (cantidad)
+		*cantidad = grupo ? grupo->cantidad : 0;
+	return grupo ? grupo->valores : NULL;
+}
+
+/*
+ * Devuelve true si el hash tiene algún valor con la clave dada o false en
+ * caso contrario (o en caso de error).
+ */
+bool hash_multi_contiene(hash_multi_t *hash, const char *clave)
+{
+	if (!hash || !clave)
+		return false;
+	return hash_contiene(hash->grupos, clave);
+}
+
+/*
+ * Quita la primera aparición del valor entre los valores de la clave dada,
+ * corriendo los siguientes un lugar para conservar el orden. Si era el
+ * último valor de la clave, quita la clave y libera su grupo.
+ *
+ * Devuelve true si el valor estaba o false en caso contrario (o en caso de
+ * error).
+ */
+bool hash_multi_quitar_valor(hash_multi_t *hash, const char *clave,
+			     void *valor)
+{
+	if (!hash || !clave)
+		return false;
+	grupo_multi_t *grupo = hash_obtener(hash->grupos, clave);
+	size_t cantidad = grupo ? grupo->cantidad : 0;
+	size_t i = 0;
+	while (i < cantidad && grupo->valores[i] != valor)
+		i++;
+	if (i == cantidad)
+		return false;
+	if (cantidad == 1) {
+		memoria_liberar(hash->grupos->memoria,
+				hash_quitar(hash->grupos, clave));
+	} else {
+		memmove(grupo->valores + i, grupo->valores + i + 1,
+			(cantidad - i - 1) * sizeof(void *));
+		grupo->cantidad--;
+	}
+	hash->valores--;
+	return true;
+}
+
+/*
+ * Quita la clave dada con todos sus valores, invocando al destructor (si no
+ * es NULL) con cada uno.
+ *
+ * Devuelve la cantidad de valores quitados o 0 en caso de error.
+ */
+size_t hash_multi_quitar(hash_multi_t *hash, const char *clave,
+			 void (*destructor)(void *))
+{
+	if (!hash || !clave)
+		return 0;
+	grupo_multi_t *grupo = hash_quitar(hash->grupos, clave);
+	if (!grupo)
+		return 0;
+	size_t cantidad = grupo->cantidad;
+	for (size_t i = 0; destructor && i < cantidad; i++)
+		destructor(grupo->valores[i]);
+	memoria_liberar(hash->grupos->memoria, grupo);
+	hash->valores -= cantidad;
+	return cantidad;
+}
+
+/*
+ * Devuelve la cantidad de claves del hash o 0 en caso de error.
+ */
+size_t hash_multi_cantidad(hash_multi_t *hash)
+{
+	if (!hash)
+		return 0;
+	return hash_cantidad(hash->grupos);
+}
+
+/*
+ * Devuelve la cantidad de valores del hash, sumando los de todas las
+ * claves, o 0 en caso de error.
+ */
+size_t hash_multi_cantidad_valores(hash_multi_t *hash)
+{
+	if (!hash)
+		return 0;
+	return hash->valores;
+}
+
+typedef struct estructura_auxiliar_multi {
+	bool (*f)(const char *clave, void *const *valores, size_t cantidad,
+		  void *aux);
+	void *aux;
+	void (*destructor)(void *);
+	memoria_t *memoria;
+} aux_multi_t;
+
+/**
+ * Recibe una clave, su grupo y un puntero a aux_multi_t, e invoca a la
+ * función del usuario con los valores del grupo.
+ *
+ * Devuelve lo que devuelve la función.
+*/
+bool llamar_con_grupo(const char *clave, void *grupo, void *aux)
+{
+	aux_multi_t *multi = aux;
+	return multi->f(clave, ((grupo_multi_t *)grupo)->valores,
+			((grupo_multi_t *)grupo)->cantidad, multi->aux);
+}
+
+/*
+ * Recorre las claves del hash e invoca a la función con cada clave, sus
+ * valores, su cantidad y el puntero auxiliar, mientras la función devuelva
+ * true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función o 0 en caso de
+ * error.
+ */
+size_t hash_multi_con_cada_clave(hash_multi_t *hash,
+				 bool (*f)(const char *clave,
+					   void *const *valores,
+					   size_t cantidad, void *aux),
+				 void *aux)
+{
+	if (!hash || !f)
+		return 0;
+	aux_multi_t multi = { .f = f, .aux = aux };
+	return hash_con_cada_clave(hash->grupos, llamar_con_grupo, &multi);
+}
+
+/**
+ * Recibe una clave (que no usa), su grupo y un puntero a aux_multi_t, e
+ * invoca al destructor (si no es NULL) con cada valor del grupo. Después
+ * libera el grupo.
+ *
+ * Devuelve siempre true.
+*/
+bool destruir_grupo(const char *clave, void *grupo, void *aux)
+{
+	(void)clave;
+	aux_multi_t *multi = aux;
+	for (size_t i = 0;
+	     multi->destructor && i < ((grupo_multi_t *)grupo)->cantidad; i++)
+		multi->destructor(((grupo_multi_t *)grupo)->valores[i]);
+	memoria_liberar(multi->memoria, grupo);
+	return true;
+}
+
+/*
+ * Destruye el hash sin liberar los valores.
+ */
+void hash_multi_destruir(hash_multi_t *hash)
+{
+	hash_multi_destruir_todo(hash, NULL);
+}
+
+/*
+ * Destruye el hash invocando al destructor (si no es NULL) con cada valor.
+ */
+void hash_multi_destruir_todo(hash_multi_t *hash, void (*destructor)(void *))
+{
+	if (!hash)
+		return;
+	hash_t *grupos = hash->grupos;
+	aux_multi_t multi = { .destructor = destructor,
+			      .memoria = grupos->memoria };
+	hash_con_cada_clave(grupos, destruir_grupo, &multi);
+	memoria_liberar(grupos->memoria, hash);
+	hash_destruir(grupos);
+}
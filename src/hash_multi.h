@@ -0,0 +1,109 @@
+#ifndef __HASH_MULTI_H__
+#define __HASH_MULTI_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/*
+ * Hash con varios valores por clave (multimapa). Los valores de cada clave
+ * se guardan contiguos, en orden de inserción, en un mismo bloque junto con
+ * su cantidad, así que leerlos no sigue un puntero por valor y agregar uno
+ * no reserva memoria por valor.
+ */
+typedef struct hash_multi hash_multi_t;
+
+/*
+ * Crea un hash multi con lugar para la cantidad de claves dada, cuyo hash
+ * interno se crea con las opciones dadas (que pueden ser NULL). Los grupos
+ * de valores se reservan con el alocador de las opciones y cuentan para su
+ * limite_memoria, igual que el hash interno.
+ *
+ * Devuelve un puntero al hash creado o NULL en caso de error.
+ */
+hash_multi_t *hash_multi_crear(size_t capacidad,
+			       const hash_opciones_t *opciones);
+
+/*
+ * Agrega el valor al final de los valores de la clave dada, creando la
+ * clave si no existía. El mismo valor puede agregarse varias veces.
+ *
+ * Devuelve el hash o NULL en caso de error.
+ */
+hash_multi_t *hash_multi_insertar(hash_multi_t *hash, const char *clave,
+				  void *valor);
+
+/*
+ * Devuelve los valores de la clave dada como un arreglo contiguo, en orden
+ * de inserción, y guarda su cantidad en *cantidad (si no es NULL). El
+ * arreglo pertenece al hash y es válido hasta la próxima modificación de
+ * esa clave.
+ *
+ * Devuelve NULL (y guarda 0 en *cantidad) si la clave no existe o en caso
+ * de error.
+ */
+void *const *hash_multi_obtener_todos(hash_multi_t *hash, const char *clave,
+				      size_t *cantidad);
+
+/*
+ * Devuelve true si el hash tiene algún valor con la clave dada o false en
+ * caso contrario (o en caso de error).
+ */
+bool hash_multi_contiene(hash_multi_t *hash, const char *clave);
+
+/*
+ * Quita la primera aparición del valor entre los valores de la clave dada,
+ * conservando el orden de los demás. Si era el último valor de la clave,
+ * quita la clave.
+ *
+ * Devuelve true si el valor estaba o false en caso contrario (o en caso de
+ * error).
+ */
+bool hash_multi_quitar_valor(hash_multi_t *hash, const char *clave,
+			     void *valor);
+
+/*
+ * Quita la clave dada con todos sus valores, invocando al destructor (si no
+ * es NULL) con cada uno.
+ *
+ * Devuelve la cantidad de valores quitados o 0 en caso de error.
+ */
+size_t hash_multi_quitar(hash_multi_t *hash, const char *clave,
+			 void (*destructor)(void *));
+
+/*
+ * Devuelve la cantidad de claves del hash o 0 en caso de error.
+ */
+size_t hash_multi_cantidad(hash_multi_t *hash);
+
+/*
+ * Devuelve la cantidad de valores del hash, sumando los de todas las
+ * claves, o 0 en caso de error.
+ */
+size_t hash_multi_cantidad_valores(hash_multi_t *hash);
+
+/*
+ * Recorre las claves del hash e invoca a la función con cada clave, sus
+ * valores (contiguos, en orden de inserción), su cantidad y el puntero
+ * auxiliar, mientras la función devuelva true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función o 0 en caso de
+ * error.
+ */
+size_t hash_multi_con_cada_clave(hash_multi_t *hash,
+				 bool (*f)(const char *clave,
+					   void *const *valores,
+					   size_t cantidad, void *aux),
+				 void *aux);
+
+/*
+ * Destruye el hash sin liberar los valores.
+ */
+void hash_multi_destruir(hash_multi_t *hash);
+
+/*
+ * Destruye el hash invocando al destructor con cada valor.
+ */
+void hash_multi_destruir_todo(hash_multi_t *hash, void (*destructor)(void *));
+
+#endif /* __HASH_MULTI_H__ */
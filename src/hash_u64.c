@@ -0,0 +1,269 @@
+#include <stdlib.h>
+#include "hash_u64.h"
+#include "funciones_hash.h"
+
+#define FACTOR_CARGA_MAXIMO_U64 0.7
+#define ESPACIOS_MINIMOS_U64 8
+
+typedef struct espacio_u64 {
+	uint64_t clave;
+	void *valor;
+	bool ocupado;
+} espacio_u64_t;
+
+struct hash_u64 {
+	espacio_u64_t *espacios;
+	size_t capacidad;
+	size_t cantidad;
+};
+
+/**
+ * Recibe una cantidad de elementos y devuelve la menor potencia de 2 de
+ * espacios que permite guardarlos sin superar el factor de carga máximo.
+*/
+size_t espacios_para_u64(size_t cantidad)
+{
+	size_t espacios = ESPACIOS_MINIMOS_U64;
+	while ((double)cantidad > (double)espacios * FACTOR_CARGA_MAXIMO_U64)
+		espacios *= 2;
+	return espacios;
+}
+
+/*
+ * Crea el hash reservando la memoria necesaria para el.
+ *
+ * Capacidad indica la cantidad de elementos que se espera almacenar. El hash
+ * se crea con la cantidad de espacios necesaria para guardarlos sin tener
+ * que agrandarse.
+ *
+ * Devuelve un puntero al hash creado o NULL en caso de no poder crearlo.
+ */
+hash_u64_t *hash_u64_crear(size_t capacidad)
+{
+	hash_u64_t *hash = malloc(sizeof(hash_u64_t));
+	if (!hash)
+		return NULL;
+	hash->capacidad = espacios_para_u64(capacidad);
+	hash->cantidad = 0;
+	hash->espacios = calloc(hash->capacidad, sizeof(espacio_u64_t));
+	if (!hash->espacios) {
+		free(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+/**
+ * Recibe un hash y una clave.
+ *
+ * Devuelve el índice del espacio que contiene la clave o, si la clave no
+ * está, el índice del espacio vacío en el que debería insertarse.
+*/
+size_t buscar_espacio_u64(hash_u64_t *hash, uint64_t clave)
+{
+	size_t mascara = hash->capacidad - 1;
+	size_t i = mezclar_u64(clave) & mascara;
+	while (hash->espacios[i].ocupado && hash->espacios[i].clave != clave)
+		i = (i + 1) & mascara;
+	return i;
+}
+
+/**
+ * Recibe un hash y duplica su cantidad de espacios, reubicando cada
+ * elemento en la tabla nueva.
+ *
+ * Devuelve cero si se pudo agrandar el hash, o -1 en caso de error (el hash
+ * queda como se recibió).
+*/
+int rehash_u64(hash_u64_t *hash)
+{
+	espacio_u64_t *espacios_viejos = hash->espacios;
+	size_t capacidad_vieja = hash->capacidad;
+	espacio_u64_t *espacios_nuevos =
+		calloc(capacidad_vieja * 2, sizeof(espacio_u64_t));
+	if (!espacios_nuevos)
+		return -1;
+	hash->espacios = espacios_nuevos;
+	hash->capacidad = capacidad_vieja * 2;
+	for (size_t i = 0; i < capacidad_vieja; i++) {
+		if (!espacios_viejos[i].ocupado)
+			continue;
+		size_t destino =
+			buscar_espacio_u64(hash, espacios_viejos[i].clave);
+		hash->espacios[destino] = espacios_viejos[i];
+	}
+	free(espacios_viejos);
+	return 0;
+}
+
+/*
+ * Inserta o actualiza un elemento en el hash asociado a la clave dada.
+ *
+ * Si la clave ya existía y se reemplaza el elemento, se almacena un puntero al
+ * elemento reemplazado en *anterior, si anterior no es NULL.
+ *
+ * Si la clave no existía y anterior no es NULL, se almacena NULL en *anterior.
+ *
+ * El hash solo se agranda al insertar una clave nueva, así que actualizar
+ * una clave existente nunca falla.
+ *
+ * Devuelve el hash si pudo guardar el elemento o NULL si no pudo.
+ */
+hash_u64_t *hash_u64_insertar(hash_u64_t *hash, uint64_t clave,
+			      void *elemento, void **anterior)
+{
+	if (!hash)
+		return NULL;
+	espacio_u64_t *espacio = &hash->espacios[buscar_espacio_u64(hash, clave)];
+	if (espacio->ocupado) {
+		if (anterior)
+			*anterior = espacio->valor;
+		espacio->valor = elemento;
+		return hash;
+	}
+	if ((double)(hash->cantidad + 1) >
+	    (double)hash->capacidad * FACTOR_CARGA_MAXIMO_U64) {
+		if (rehash_u64(hash) == -1)
+			return NULL;
+		espacio = &hash->espacios[buscar_espacio_u64(hash, clave)];
+	}
+	if (anterior)
+		*anterior = NULL;
+	espacio->ocupado = true;
+	espacio->clave = clave;
+	espacio->valor = elemento;
+	hash->cantidad++;
+	return hash;
+}
+
+/**
+ * Recibe un hash y el índice de un espacio que se acaba de vaciar.
+ *
+ * Desplaza hacia atrás los elementos siguientes del mismo grupo contiguo que
+ * pueden ocupar el hueco, para que las búsquedas no se corten en él. Así no
+ * hacen falta marcas de borrado.
+*/
+void cerrar_hueco_u64(hash_u64_t *hash, size_t hueco)
+{
+	size_t mascara = hash->capacidad - 1;
+	size_t i = (hueco + 1) & mascara;
+	while (hash->espacios[i].ocupado) {
+		size_t ideal = mezclar_u64(hash->espacios[i].clave) & mascara;
+		size_t distancia_actual = (i - ideal) & mascara;
+		size_t distancia_al_hueco = (i - hueco) & mascara;
+		if (distancia_actual >= distancia_al_hueco) {
+			hash->espacios[hueco] = hash->espacios[i];
+			hash->espacios[i].ocupado = false;
+			hueco = i;
+		}
+		i = (i + 1) & mascara;
+	}
+}
+
+/*
+ * Quita un elemento del hash y lo devuelve.
+ *
+ * Si no encuentra el elemento o en caso de error devuelve NULL
+ */
+void *hash_u64_quitar(hash_u64_t *hash, uint64_t clave)
+{
+	if (!hash)
+		return NULL;
+	size_t i = buscar_espacio_u64(hash, clave);
+	if (!hash->espacios[i].ocupado)
+		return NULL;
+	void *elemento = hash->espacios[i].valor;
+	hash->espacios[i].ocupado = false;
+	hash->cantidad--;
+	cerrar_hueco_u64(hash, i);
+	return elemento;
+}
+
+/*
+ * Devuelve un elemento del hash con la clave dada o NULL si dicho
+ * elemento no existe (o en caso de error).
+ */
+void *hash_u64_obtener(hash_u64_t *hash, uint64_t clave)
+{
+	if (!hash)
+		return NULL;
+	espacio_u64_t *espacio = &hash->espacios[buscar_espacio_u64(hash, clave)];
+	return espacio->ocupado ? espacio->valor : NULL;
+}
+
+/*
+ * Devuelve true si el hash contiene un elemento almacenado con la
+ * clave dada o false en caso contrario (o en caso de error).
+ */
+bool hash_u64_contiene(hash_u64_t *hash, uint64_t clave)
+{
+	if (!hash)
+		return false;
+	return hash->espacios[buscar_espacio_u64(hash, clave)].ocupado;
+}
+
+/*
+ * Devuelve la cantidad de elementos almacenados en el hash o 0 en
+ * caso de error.
+ */
+size_t hash_u64_cantidad(hash_u64_t *hash)
+{
+	if (!hash)
+		return 0;
+	return hash->cantidad;
+}
+
+/*
+ * Destruye el hash liberando la memoria reservada.
+ */
+void hash_u64_destruir(hash_u64_t *hash)
+{
+	hash_u64_destruir_todo(hash, NULL);
+}
+
+/*
+ * Destruye el hash liberando la memoria reservada y asegurandose de
+ * invocar la funcion destructora con cada elemento almacenado en el
+ * hash.
+ */
+void hash_u64_destruir_todo(hash_u64_t *hash, void (*destructor)(void *))
+{
+	if (!hash)
+		return;
+	for (size_t i = 0; destructor && i < hash->capacidad; i++)
+		if (hash->espacios[i].ocupado)
+			destructor(hash->espacios[i].valor);
+	free(hash->espacios);
+	free(hash);
+}
+
+/*
+ * Recorre cada una de las claves almacenadas en el hash e invoca a la
+ * función f, pasandole como parámetros la clave, el valor asociado a la clave
+ * y el puntero auxiliar.
+ *
+ * Mientras que queden mas claves o la funcion retorne true, la
+ * iteración continúa. Cuando no quedan mas claves o la función
+ * devuelve false, la iteración se corta y la función principal
+ * retorna.
+ *
+ * Devuelve la cantidad de claves totales iteradas (la cantidad de
+ * veces que fue invocada la función) o 0 en caso de error.
+ */
+size_t hash_u64_con_cada_clave(hash_u64_t *hash,
+			       bool (*f)(uint64_t clave, void *valor,
+					 void *aux),
+			       void *aux)
+{
+	size_t invocaciones = 0;
+	if (!hash || !f)
+		return invocaciones;
+	for (size_t i = 0; i < hash->capacidad; i++) {
+		if (!hash->espacios[i].ocupado)
+			continue;
+		invocaciones++;
+		if (!f(hash->espacios[i].clave, hash->espacios[i].valor, aux))
+			return invocaciones;
+	}
+	return invocaciones;
+}
@@ -0,0 +1,94 @@
+#ifndef __HASH_U64_H__
+#define __HASH_U64_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hash con claves enteras de 64 bits. Las claves y los valores se guardan
+ * directamente en un arreglo de espacios (direccionamiento abierto con
+ * sondeo lineal), sin reservar memoria por clave ni comparar strings.
+ */
+typedef struct hash_u64 hash_u64_t;
+
+/*
+ * Crea el hash reservando la memoria necesaria para el.
+ *
+ * Capacidad indica la cantidad de elementos que se espera almacenar. El hash
+ * se crea con la cantidad de espacios necesaria para guardarlos sin tener
+ * que agrandarse.
+ *
+ * Devuelve un puntero al hash creado o NULL en caso de no poder crearlo.
+ */
+hash_u64_t *hash_u64_crear(size_t capacidad);
+
+/*
+ * Inserta o actualiza un elemento en el hash asociado a la clave dada.
+ *
+ * Si la clave ya existía y se reemplaza el elemento, se almacena un puntero al
+ * elemento reemplazado en *anterior, si anterior no es NULL.
+ *
+ * Si la clave no existía y anterior no es NULL, se almacena NULL en *anterior.
+ *
+ * Devuelve el hash si pudo guardar el elemento o NULL si no pudo.
+ */
+hash_u64_t *hash_u64_insertar(hash_u64_t *hash, uint64_t clave,
+			      void *elemento, void **anterior);
+
+/*
+ * Quita un elemento del hash y lo devuelve.
+ *
+ * Si no encuentra el elemento o en caso de error devuelve NULL
+ */
+void *hash_u64_quitar(hash_u64_t *hash, uint64_t clave);
+
+/*
+ * Devuelve un elemento del hash con la clave dada o NULL si dicho
+ * elemento no existe (o en caso de error).
+ */
+void *hash_u64_obtener(hash_u64_t *hash, uint64_t clave);
+
+/*
+ * Devuelve true si el hash contiene un elemento almacenado con la
+ * clave dada o false en caso contrario (o en caso de error).
+ */
+bool hash_u64_contiene(hash_u64_t *hash, uint64_t clave);
+
+/*
+ * Devuelve la cantidad de elementos almacenados en el hash o 0 en
+ * caso de error.
+ */
+size_t hash_u64_cantidad(hash_u64_t *hash);
+
+/*
+ * Destruye el hash liberando la memoria reservada.
+ */
+void hash_u64_destruir(hash_u64_t *hash);
+
+/*
+ * Destruye el hash liberando la memoria reservada y asegurandose de
+ * invocar la funcion destructora con cada elemento almacenado en el
+ * hash.
+ */
+void hash_u64_destruir_todo(hash_u64_t *hash, void (*destructor)(void *));
+
+/*
+ * Recorre cada una de las claves almacenadas en el hash e invoca a la
+ * función f, pasandole como parámetros la clave, el valor asociado a la clave
+ * y el puntero auxiliar.
+ *
+ * Mientras que queden mas claves o la funcion retorne true, la
+ * iteración continúa. Cuando no quedan mas claves o la función
+ * devuelve false, la iteración se corta y la función principal
+ * retorna.
+ *
+ * Devuelve la cantidad de claves totales iteradas (la cantidad de
+ * veces que fue invocada la función) o 0 en caso de error.
+ */
+size_t hash_u64_con_cada_clave(hash_u64_t *hash,
+			       bool (*f)(uint64_t clave, void *valor,
+					 void *aux),
+			       void *aux);
+
+#endif /* __HASH_U64_H__ */
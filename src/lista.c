@@ -1,41 +1,223 @@
+#ifndef LISTA_DESENROLLADA
+
 #include "lista.h"
 #include <stdlib.h>
 
-typedef struct nodo {
+/*
+ * Si se define LISTA_DOBLEMENTE_ENLAZADA, cada nodo guarda también un puntero
+ * al anterior, para poder quitar un nodo en O(1) con lista_quitar_nodo.
+ */
+typedef struct lista_nodo {
 	void *elemento;
-	struct nodo *siguiente;
+	struct lista_nodo *siguiente;
+#ifdef LISTA_DOBLEMENTE_ENLAZADA
+	struct lista_nodo *anterior;
+#endif
 } nodo_t;
 
 struct lista {
 	nodo_t *nodo_inicio;
 	nodo_t *nodo_ultimo;
 	size_t tamanio;
+	pool_t *pool;
+	bool pool_propio;
+	memoria_t *memoria;
+	size_t referencias_extra;
 };
 
 struct lista_iterador {
 	nodo_t *corriente;
+	memoria_t *memoria;
 };
 
 /**
- * Recibe un void pointer. 
+ * Recibe una lista y un void pointer. 
  * Crea y devuelve un struct nodo que almacena el elemento al que apunta 
- * el puntero, y el siguiente del nodo es NULL.
+ * el puntero, y el siguiente del nodo es NULL. El nodo se reserva en el pool
+ * de la lista, si tiene.
+ * 
+ * Devuelve NULL en caso de error.
 */
-nodo_t *nodo_crear(void *elemento)
+nodo_t *nodo_crear(lista_t *lista, void *elemento)
 {
-	nodo_t *nodo = malloc(sizeof(nodo_t));
+	nodo_t *nodo = lista->pool ? pool_reservar(lista->pool) :
+				     memoria_reservar(lista->memoria, sizeof(nodo_t));
+	if (!nodo)
+		return NULL;
 	nodo->elemento = elemento;
 	nodo->siguiente = NULL;
 	return nodo;
 }
 
+/**
+ * Recibe una lista y un nodo creado con nodo_crear, y lo libera.
+*/
+void nodo_destruir(lista_t *lista, nodo_t *nodo)
+{
+	if (lista->pool)
+		pool_liberar(lista->pool, nodo);
+	else
+		memoria_liberar(lista->memoria, nodo);
+}
+
+/**
+ * Recibe una lista, un nodo nuevo y el nodo de la lista después del cual se
+ * debe enganchar (o NULL para engancharlo al principio), y lo engancha.
+*/
+void enganchar_nodo(lista_t *lista, nodo_t *nodo_nuevo, nodo_t *anterior)
+{
+	nodo_t *siguiente = anterior ? anterior->siguiente : lista->nodo_inicio;
+	nodo_nuevo->siguiente = siguiente;
+	if (anterior)
+		anterior->siguiente = nodo_nuevo;
+	else
+		lista->nodo_inicio = nodo_nuevo;
+	if (!siguiente)
+		lista->nodo_ultimo = nodo_nuevo;
+#ifdef LISTA_DOBLEMENTE_ENLAZADA
+	nodo_nuevo->anterior = anterior;
+	if (siguiente)
+		siguiente->anterior = nodo_nuevo;
+#endif
+	lista->tamanio++;
+}
+
+/**
+ * Recibe una lista, un nodo de la misma y el nodo que lo precede (o NULL si
+ * es el primero). Desengancha el nodo, lo libera y devuelve su elemento.
+*/
+void *desenganchar_nodo(lista_t *lista, nodo_t *nodo, nodo_t *anterior)
+{
+	if (anterior)
+		anterior->siguiente = nodo->siguiente;
+	else
+		lista->nodo_inicio = nodo->siguiente;
+	if (lista->nodo_ultimo == nodo)
+		lista->nodo_ultimo = anterior;
+#ifdef LISTA_DOBLEMENTE_ENLAZADA
+	if (nodo->siguiente)
+		nodo->siguiente->anterior = anterior;
+#endif
+	void *elemento = nodo->elemento;
+	nodo_destruir(lista, nodo);
+	lista->tamanio--;
+	return elemento;
+}
+
+/**
+ * Recibe una lista y una cadena de cantidad nodos enlazados (que no
+ * pertenecen a ninguna lista) desde primero hasta ultimo, y la engancha al
+ * final de la lista.
+*/
+void enganchar_cadena(lista_t *lista, nodo_t *primero, nodo_t *ultimo,
+		      size_t cantidad)
+{
+	if (cantidad == 0)
+		return;
+	if (lista->nodo_ultimo)
+		lista->nodo_ultimo->siguiente = primero;
+	else
+		lista->nodo_inicio = primero;
+#ifdef LISTA_DOBLEMENTE_ENLAZADA
+	primero->anterior = lista->nodo_ultimo;
+#endif
+	lista->nodo_ultimo = ultimo;
+	lista->tamanio += cantidad;
+}
+
+/**
+ * Recibe una lista y una cadena de nodos creados con nodo_crear que no
+ * pertenece a la lista, y libera los nodos.
+*/
+void destruir_cadena(lista_t *lista, nodo_t *nodo)
+{
+	while (nodo) {
+		nodo_t *siguiente = nodo->siguiente;
+		nodo_destruir(lista, nodo);
+		nodo = siguiente;
+	}
+}
+
+/**
+ * Recibe una lista y un nodo de la misma, y devuelve el nodo que lo precede
+ * (o NULL si es el primero). Es O(1) si la lista es doblemente enlazada, y
+ * recorre la lista si no.
+*/
+nodo_t *nodo_anterior(lista_t *lista, nodo_t *nodo)
+{
+#ifdef LISTA_DOBLEMENTE_ENLAZADA
+	(void)lista;
+	return nodo->anterior;
+#else
+	nodo_t *anterior = NULL;
+	nodo_t *actual = lista->nodo_inicio;
+	while (actual != nodo) {
+		anterior = actual;
+		actual = actual->siguiente;
+	}
+	return anterior;
+#endif
+}
+
 /**
  * Crea la lista reservando la memoria necesaria.
  * Devuelve un puntero a la lista creada o NULL en caso de error.
  */
 lista_t *lista_crear()
 {
-	return calloc(1, sizeof(lista_t));
+	return lista_crear_con_memoria(NULL, NULL);
+}
+
+/**
+ * Crea un pool del tamaño de los nodos de la lista, para compartir entre
+ * varias listas creadas con lista_crear_con_pool.
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *lista_crear_pool_de_nodos()
+{
+	return lista_crear_pool_de_nodos_con_memoria(NULL);
+}
+
+/**
+ * Crea un pool igual que lista_crear_pool_de_nodos, cuyos bloques se
+ * reservan con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *lista_crear_pool_de_nodos_con_memoria(memoria_t *memoria)
+{
+	return pool_crear_con_memoria(sizeof(nodo_t), memoria);
+}
+
+/**
+ * Crea una lista igual que lista_crear, pero que reserva y libera sus nodos
+ * en el pool dado. Si pool es NULL, la lista es igual a una creada con
+ * lista_crear.
+ *
+ * Devuelve un puntero a la lista creada o NULL en caso de error.
+ */
+lista_t *lista_crear_con_pool(pool_t *pool)
+{
+	return lista_crear_con_memoria(pool, NULL);
+}
+
+/**
+ * Crea una lista igual que lista_crear_con_pool, que reserva la lista, los
+ * iteradores y los nodos que no van en un pool con la cuenta de memoria
+ * dada. Si memoria es NULL, la lista es igual a una creada con
+ * lista_crear_con_pool.
+ *
+ * Devuelve un puntero a la lista creada o NULL en caso de error.
+ */
+lista_t *lista_crear_con_memoria(pool_t *pool, memoria_t *memoria)
+{
+	lista_t *lista = memoria_reservar_ceros(memoria, 1, sizeof(lista_t));
+	if (!lista)
+		return NULL;
+	lista->pool = pool;
+	lista->memoria = memoria;
+	return lista;
 }
 
 /**
@@ -47,31 +229,138 @@ lista_t *lista_insertar(lista_t *lista, void *elemento)
 {
 	if (!lista)
 		return NULL;
-	nodo_t *nodo_nuevo = nodo_crear(elemento);
+	nodo_t *nodo_nuevo = nodo_crear(lista, elemento);
 	if (!nodo_nuevo)
 		return NULL;
-	if (!lista->nodo_inicio) {
-		lista->nodo_inicio = nodo_nuevo;
-		lista->nodo_ultimo = nodo_nuevo;
-	} else {
-		lista->nodo_ultimo->siguiente = nodo_nuevo;
-		lista->nodo_ultimo = nodo_nuevo;
+	enganchar_nodo(lista, nodo_nuevo, lista->nodo_ultimo);
+	return lista;
+}
+
+/**
+ * Inserta un elemento al final de la lista, igual que lista_insertar.
+ *
+ * Devuelve el nodo en el que quedó el elemento, que sirve para quitarlo con
+ * lista_quitar_nodo, o NULL en caso de error.
+ */
+lista_nodo_t *lista_insertar_nodo(lista_t *lista, void *elemento)
+{
+	if (!lista_insertar(lista, elemento))
+		return NULL;
+	return lista->nodo_ultimo;
+}
+
+/**
+ * Devuelve el elemento guardado en el nodo dado o NULL en caso de error.
+ */
+void *lista_nodo_elemento(lista_nodo_t *nodo)
+{
+	if (!nodo)
+		return NULL;
+	return nodo->elemento;
+}
+
+/**
+ * Inserta al final de la lista los cantidad elementos del vector dado, en
+ * orden. Todos los nodos se reservan juntos: en el pool de la lista si tiene
+ * uno o, si la lista está vacía y no tiene pool, en un pool propio de la
+ * lista (que se libera al destruirla). Si falla no inserta ninguno.
+ *
+ * Devuelve NULL si no pudo insertar los elementos a causa de un error, o la
+ * lista en caso de exito.
+ */
+lista_t *lista_insertar_lote(lista_t *lista, void **elementos,
+			     size_t cantidad)
+{
+	if (!lista || (!elementos && cantidad > 0))
+		return NULL;
+	if (!lista->pool && lista->tamanio == 0 && cantidad > 1) {
+		lista->pool =
+			lista_crear_pool_de_nodos_con_memoria(lista->memoria);
+		if (!lista->pool)
+			return NULL;
+		lista->pool_propio = true;
 	}
-	lista->tamanio++;
+	if (lista->pool && !pool_preparar(lista->pool, cantidad))
+		return NULL;
+	nodo_t *primero = NULL;
+	nodo_t *ultimo = NULL;
+	for (size_t i = 0; i < cantidad; i++) {
+		nodo_t *nodo = nodo_crear(lista, elementos[i]);
+		if (!nodo) {
+			destruir_cadena(lista, primero);
+			return NULL;
+		}
+#ifdef LISTA_DOBLEMENTE_ENLAZADA
+		nodo->anterior = ultimo;
+#endif
+		if (ultimo)
+			ultimo->siguiente = nodo;
+		else
+			primero = nodo;
+		ultimo = nodo;
+	}
+	enganchar_cadena(lista, primero, ultimo, cantidad);
 	return lista;
 }
 
 /**
- * Recibe un puntero a lista_t y uno a nodo_t. 
- * Inserta el nodo al principio de la lista.
+ * Si origen tiene un pool propio (el que crea lista_insertar_lote), se lo
+ * pasa a destino para que los nodos de origen puedan pasar a destino sin
+ * copiarlos: destino lo absorbe en su pool o, si está vacía y todavía no
+ * tiene uno, lo adopta como pool propio. Origen queda sin pool.
+ *
+ * Devuelve true si se pudo pasar el pool.
 */
-void insertar_al_principio(lista_t *lista, nodo_t *nodo_nuevo)
+bool pasar_pool_propio(lista_t *destino, lista_t *origen)
 {
-	if (lista->tamanio == 0) {
-		lista->nodo_ultimo = nodo_nuevo;
+	if (!origen->pool_propio)
+		return false;
+	if (destino->pool) {
+		if (!pool_absorber(destino->pool, origen->pool))
+			return false;
+	} else if (destino->tamanio == 0 &&
+		   destino->memoria == origen->memoria) {
+		destino->pool = origen->pool;
+		destino->pool_propio = true;
+	} else {
+		return false;
 	}
-	nodo_nuevo->siguiente = lista->nodo_inicio;
-	lista->nodo_inicio = nodo_nuevo;
+	origen->pool = NULL;
+	origen->pool_propio = false;
+	return true;
+}
+
+/**
+ * Mueve todos los elementos de origen al final de destino, en orden, y deja
+ * origen vacía (pero no la destruye). Es O(1), porque engancha los nodos de
+ * origen sin copiarlos, si las dos listas reservan sus nodos en el mismo
+ * pool (o las dos fuera de un pool, con la misma cuenta de memoria) o si
+ * origen tiene un pool propio que destino puede absorber o adoptar; si no,
+ * mueve los elementos de a uno.
+ *
+ * Devuelve destino, o NULL en caso de error (en cuyo caso los elementos que
+ * no se pudieron mover siguen en origen).
+ */
+lista_t *lista_concatenar(lista_t *destino, lista_t *origen)
+{
+	if (!destino || !origen || destino == origen)
+		return NULL;
+	if ((destino->pool == origen->pool &&
+	     (destino->pool || destino->memoria == origen->memoria)) ||
+	    pasar_pool_propio(destino, origen)) {
+		enganchar_cadena(destino, origen->nodo_inicio,
+				 origen->nodo_ultimo, origen->tamanio);
+		origen->nodo_inicio = NULL;
+		origen->nodo_ultimo = NULL;
+		origen->tamanio = 0;
+		return destino;
+	}
+	while (origen->nodo_inicio) {
+		if (!lista_insertar(destino, origen->nodo_inicio->elemento))
+			return NULL;
+		desenganchar_nodo(origen, origen->nodo_inicio, NULL);
+	}
+	return destino;
 }
 
 /**
@@ -87,34 +376,19 @@ lista_t *lista_insertar_en_posicion(lista_t *lista, void *elemento,
 {
 	if (!lista || posicion >= lista->tamanio)
 		return lista_insertar(lista, elemento);
-	nodo_t *nodo_nuevo = nodo_crear(elemento);
+	nodo_t *nodo_nuevo = nodo_crear(lista, elemento);
 	if (!nodo_nuevo)
 		return NULL;
-	if (posicion == 0) {
-		insertar_al_principio(lista, nodo_nuevo);
-	} else {
-		nodo_t *nodo_actual = lista->nodo_inicio;
+	nodo_t *nodo_actual = NULL;
+	if (posicion > 0) {
+		nodo_actual = lista->nodo_inicio;
 		for (int i = 0; i < posicion - 1; i++)
 			nodo_actual = nodo_actual->siguiente;
-		nodo_nuevo->siguiente = nodo_actual->siguiente;
-		nodo_actual->siguiente = nodo_nuevo;
 	}
-	lista->tamanio++;
+	enganchar_nodo(lista, nodo_nuevo, nodo_actual);
 	return lista;
 }
 
-/**
- * Recibe una lista con un nodo y lo quita, dejando la lista vacía.
-*/
-void *quitar_unico_elemento(lista_t *lista)
-{
-	lista->nodo_ultimo = NULL;
-	void *elemento = lista->nodo_inicio->elemento;
-	free(lista->nodo_inicio);
-	lista->nodo_inicio = NULL;
-	return elemento;
-}
-
 /**
  * Quita de la lista el elemento que se encuentra en la ultima posición.
  *
@@ -124,20 +398,8 @@ void *lista_quitar(lista_t *lista)
 {
 	if (!lista || lista->tamanio == 0)
 		return NULL;
-	void *elemento;
-	if (lista->tamanio == 1) {
-		elemento = quitar_unico_elemento(lista);
-	} else {
-		nodo_t *nodo_actual = lista->nodo_inicio;
-		while (nodo_actual->siguiente->siguiente)
-			nodo_actual = nodo_actual->siguiente;
-		nodo_t *nodo_quitar = lista->nodo_ultimo;
-		elemento = nodo_quitar->elemento;
-		lista->nodo_ultimo = nodo_actual;
-		free(nodo_quitar);
-	}
-	lista->tamanio--;
-	return elemento;
+	return desenganchar_nodo(lista, lista->nodo_ultimo,
+				 nodo_anterior(lista, lista->nodo_ultimo));
 }
 
 /**
@@ -151,25 +413,80 @@ void *lista_quitar(lista_t *lista)
  */
 void *lista_quitar_de_posicion(lista_t *lista, size_t posicion)
 {
-	void *elemento;
-	nodo_t *nodo_a_quitar;
 	if (!lista || lista->tamanio == 0 || posicion >= lista->tamanio)
 		return lista_quitar(lista);
-	if (posicion == 0) {
-		nodo_a_quitar = lista->nodo_inicio;
-		elemento = nodo_a_quitar->elemento;
-		lista->nodo_inicio = nodo_a_quitar->siguiente;
-	} else {
-		nodo_t *nodo_actual = lista->nodo_inicio;
-		for (int i = 0; i < posicion - 1; i++)
-			nodo_actual = nodo_actual->siguiente;
-		nodo_a_quitar = nodo_actual->siguiente;
-		elemento = nodo_a_quitar->elemento;
-		nodo_actual->siguiente = nodo_a_quitar->siguiente;
+	nodo_t *nodo_actual = NULL;
+	nodo_t *nodo_a_quitar = lista->nodo_inicio;
+	for (int i = 0; i < posicion; i++) {
+		nodo_actual = nodo_a_quitar;
+		nodo_a_quitar = nodo_a_quitar->siguiente;
 	}
-	free(nodo_a_quitar);
-	lista->tamanio--;
-	return elemento;
+	return desenganchar_nodo(lista, nodo_a_quitar, nodo_actual);
+}
+
+/**
+ * Quita de la lista el nodo dado, que debe pertenecer a la lista, y
+ * devuelve su elemento. Es O(1) si la lista se compiló doblemente enlazada
+ * (LISTA_DOBLEMENTE_ENLAZADA), y O(n) si no.
+ *
+ * Devuelve el elemento removido de la lista o NULL en caso de error.
+ */
+void *lista_quitar_nodo(lista_t *lista, lista_nodo_t *nodo)
+{
+	if (!lista || !nodo || lista->tamanio == 0)
+		return NULL;
+	return desenganchar_nodo(lista, nodo, nodo_anterior(lista, nodo));
+}
+
+/**
+ * Quita de la lista el primer elemento que cumple la condición
+ * comparador(elemento, contexto) == 0, recorriendo la lista una sola vez.
+ *
+ * Devuelve el elemento removido de la lista o NULL si no existe (o en caso
+ * de error).
+ */
+void *lista_quitar_elemento(lista_t *lista, int (*comparador)(void *, void *),
+			    void *contexto)
+{
+	if (!lista || !comparador)
+		return NULL;
+	nodo_t *anterior = NULL;
+	nodo_t *nodo_actual = lista->nodo_inicio;
+	while (nodo_actual) {
+		if (comparador(nodo_actual->elemento, contexto) == 0)
+			return desenganchar_nodo(lista, nodo_actual, anterior);
+		anterior = nodo_actual;
+		nodo_actual = nodo_actual->siguiente;
+	}
+	return NULL;
+}
+
+/**
+ * Quita de la lista todos los elementos para los que
+ * predicado(elemento, aux) devuelve true, recorriendo la lista una sola vez.
+ * El predicado se invoca una vez por elemento, en orden.
+ *
+ * Devuelve la cantidad de elementos quitados o 0 en caso de error.
+ */
+size_t lista_quitar_si(lista_t *lista, bool (*predicado)(void *, void *),
+		       void *aux)
+{
+	if (!lista || !predicado)
+		return 0;
+	size_t quitados = 0;
+	nodo_t *anterior = NULL;
+	nodo_t *nodo_actual = lista->nodo_inicio;
+	while (nodo_actual) {
+		nodo_t *siguiente = nodo_actual->siguiente;
+		if (predicado(nodo_actual->elemento, aux)) {
+			desenganchar_nodo(lista, nodo_actual, anterior);
+			quitados++;
+		} else {
+			anterior = nodo_actual;
+		}
+		nodo_actual = siguiente;
+	}
+	return quitados;
 }
 
 /**
@@ -266,13 +583,47 @@ void lista_destruir(lista_t *lista)
  */
 void lista_destruir_todo(lista_t *lista, void (*funcion)(void *))
 {
+	if (lista && lista->referencias_extra > 0) {
+		lista->referencias_extra--;
+		return;
+	}
 	while (lista && lista->nodo_inicio) {
 		if (funcion) {
 			funcion(lista->nodo_inicio->elemento);
 		}
 		lista_quitar_de_posicion(lista, 0);
 	}
-	free(lista);
+	if (!lista)
+		return;
+	if (lista->pool_propio)
+		pool_destruir(lista->pool);
+	memoria_liberar(lista->memoria, lista);
+}
+
+/**
+ * Agrega una referencia a la lista, que desde ahora se comparte entre quienes
+ * tienen una referencia: cada lista_destruir (o lista_destruir_todo) suelta
+ * una, y la lista solo se destruye (y sus elementos solo se pasan a la
+ * función destructora) al soltar la última. Mientras la lista esté
+ * compartida no debe modificarse.
+ *
+ * Devuelve la lista, o NULL en caso de error.
+ */
+lista_t *lista_compartir(lista_t *lista)
+{
+	if (!lista)
+		return NULL;
+	lista->referencias_extra++;
+	return lista;
+}
+
+/**
+ * Devuelve true si la lista tiene más de una referencia (ver lista_compartir)
+ * o false en caso contrario o de error.
+ */
+bool lista_compartida(lista_t *lista)
+{
+	return lista && lista->referencias_extra > 0;
 }
 
 /**
@@ -290,8 +641,12 @@ lista_iterador_t *lista_iterador_crear(lista_t *lista)
 {
 	if (!lista)
 		return NULL;
-	lista_iterador_t *iterador = malloc(sizeof(lista_iterador_t));
+	lista_iterador_t *iterador =
+		memoria_reservar(lista->memoria, sizeof(lista_iterador_t));
+	if (!iterador)
+		return NULL;
 	iterador->corriente = lista->nodo_inicio;
+	iterador->memoria = lista->memoria;
 	return iterador;
 }
 
@@ -338,7 +693,8 @@ void *lista_iterador_elemento_actual(lista_iterador_t *iterador)
  */
 void lista_iterador_destruir(lista_iterador_t *iterador)
 {
-	free(iterador);
+	if (iterador)
+		memoria_liberar(iterador->memoria, iterador);
 }
 
 /**
@@ -366,3 +722,5 @@ size_t lista_con_cada_elemento(lista_t *lista, bool (*funcion)(void *, void *),
 	}
 	return contador;
 }
+
+#endif /* LISTA_DESENROLLADA */
@@ -3,17 +3,57 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "pool.h"
 
 typedef struct lista lista_t;
 
 typedef struct lista_iterador lista_iterador_t;
 
+typedef struct lista_nodo lista_nodo_t;
+
 /**
  * Crea la lista reservando la memoria necesaria.
  * Devuelve un puntero a la lista creada o NULL en caso de error.
  */
 lista_t *lista_crear();
 
+/**
+ * Crea un pool del tamaño de los nodos de la lista, para compartir entre
+ * varias listas creadas con lista_crear_con_pool.
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *lista_crear_pool_de_nodos();
+
+/**
+ * Crea una lista igual que lista_crear, pero que reserva y libera sus nodos
+ * en el pool dado (creado con lista_crear_pool_de_nodos), en vez de usar
+ * malloc y free por cada nodo. El pool debe destruirse después que todas las
+ * listas que lo usan. Si pool es NULL, la lista es igual a una creada con
+ * lista_crear.
+ *
+ * Devuelve un puntero a la lista creada o NULL en caso de error.
+ */
+lista_t *lista_crear_con_pool(pool_t *pool);
+
+/**
+ * Crea un pool igual que lista_crear_pool_de_nodos, cuyos bloques se
+ * reservan con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *lista_crear_pool_de_nodos_con_memoria(memoria_t *memoria);
+
+/**
+ * Crea una lista igual que lista_crear_con_pool, que reserva la lista, los
+ * iteradores y los nodos que no van en un pool con la cuenta de memoria dada
+ * (en vez de usar malloc y free). Si memoria es NULL, la lista es igual a una
+ * creada con lista_crear_con_pool.
+ *
+ * Devuelve un puntero a la lista creada o NULL en caso de error.
+ */
+lista_t *lista_crear_con_memoria(pool_t *pool, memoria_t *memoria);
+
 /**
  * Inserta un elemento al final de la lista.
  *
@@ -21,6 +61,45 @@ lista_t *lista_crear();
  */
 lista_t *lista_insertar(lista_t *lista, void *elemento);
 
+/**
+ * Inserta un elemento al final de la lista, igual que lista_insertar.
+ *
+ * Devuelve el nodo en el que quedó el elemento, que sirve para quitarlo con
+ * lista_quitar_nodo, o NULL en caso de error. En la lista desenrollada
+ * (LISTA_DESENROLLADA) el nodo es el mismo elemento, que no puede ser NULL.
+ */
+lista_nodo_t *lista_insertar_nodo(lista_t *lista, void *elemento);
+
+/**
+ * Devuelve el elemento guardado en el nodo dado o NULL en caso de error.
+ */
+void *lista_nodo_elemento(lista_nodo_t *nodo);
+
+/**
+ * Inserta al final de la lista los cantidad elementos del vector dado, en
+ * orden. Todos los nodos se reservan juntos: en el pool de la lista si tiene
+ * uno o, si la lista está vacía y no tiene pool, en un pool propio de la
+ * lista (que se libera al destruirla). Si falla no inserta ninguno.
+ *
+ * Devuelve NULL si no pudo insertar los elementos a causa de un error, o la
+ * lista en caso de exito.
+ */
+lista_t *lista_insertar_lote(lista_t *lista, void **elementos,
+			     size_t cantidad);
+
+/**
+ * Mueve todos los elementos de origen al final de destino, en orden, y deja
+ * origen vacía (pero no la destruye). Es O(1), porque engancha los nodos de
+ * origen sin copiarlos, si las dos listas reservan sus nodos en el mismo
+ * pool (o las dos fuera de un pool, con la misma cuenta de memoria) o si
+ * origen tiene un pool propio que destino puede absorber o adoptar; si no,
+ * mueve los elementos de a uno.
+ *
+ * Devuelve destino, o NULL en caso de error (en cuyo caso los elementos que
+ * no se pudieron mover siguen en origen).
+ */
+lista_t *lista_concatenar(lista_t *destino, lista_t *origen);
+
 /**
  * Inserta un elemento en la posicion indicada, donde 0 es insertar
  * como primer elemento y 1 es insertar luego del primer elemento.  
@@ -50,6 +129,35 @@ void *lista_quitar(lista_t *lista);
  */
 void *lista_quitar_de_posicion(lista_t *lista, size_t posicion);
 
+/**
+ * Quita de la lista el nodo dado, que debe pertenecer a la lista, y
+ * devuelve su elemento. Es O(1) si la lista se compiló doblemente enlazada
+ * (LISTA_DOBLEMENTE_ENLAZADA), y O(n) si no.
+ *
+ * Devuelve el elemento removido de la lista o NULL en caso de error.
+ */
+void *lista_quitar_nodo(lista_t *lista, lista_nodo_t *nodo);
+
+/**
+ * Quita de la lista el primer elemento que cumple la condición
+ * comparador(elemento, contexto) == 0, recorriendo la lista una sola vez.
+ *
+ * Devuelve el elemento removido de la lista o NULL si no existe (o en caso
+ * de error).
+ */
+void *lista_quitar_elemento(lista_t *lista, int (*comparador)(void *, void *),
+			    void *contexto);
+
+/**
+ * Quita de la lista todos los elementos para los que
+ * predicado(elemento, aux) devuelve true, recorriendo la lista una sola vez.
+ * El predicado se invoca una vez por elemento, en orden.
+ *
+ * Devuelve la cantidad de elementos quitados o 0 en caso de error.
+ */
+size_t lista_quitar_si(lista_t *lista, bool (*predicado)(void *, void *),
+		       void *aux);
+
 /**
  * Devuelve el elemento en la posicion indicada, donde 0 es el primer
  * elemento.
@@ -102,6 +210,23 @@ void lista_destruir(lista_t *lista);
  */
 void lista_destruir_todo(lista_t *lista, void (*funcion)(void *));
 
+/**
+ * Agrega una referencia a la lista, que desde ahora se comparte entre quienes
+ * tienen una referencia: cada lista_destruir (o lista_destruir_todo) suelta
+ * una, y la lista solo se destruye (y sus elementos solo se pasan a la
+ * función destructora) al soltar la última. Mientras la lista esté
+ * compartida no debe modificarse.
+ *
+ * Devuelve la lista, o NULL en caso de error.
+ */
+lista_t *lista_compartir(lista_t *lista);
+
+/**
+ * Devuelve true si la lista tiene más de una referencia (ver lista_compartir)
+ * o false en caso contrario o de error.
+ */
+bool lista_compartida(lista_t *lista);
+
 /**
  * Crea un iterador para una lista. El iterador creado es válido desde
  * el momento de su creación hasta que no haya mas elementos por
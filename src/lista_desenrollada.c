@@ -0,0 +1,821 @@
+#ifdef LISTA_DESENROLLADA
+
+#include "lista.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Implementación de lista_t como lista desenrollada: cada bloque guarda
+ * hasta ELEMENTOS_POR_BLOQUE elementos contiguos, así que recorrer la lista
+ * sigue un puntero cada varios elementos en vez de uno por elemento, y se
+ * reserva memoria una vez por bloque en vez de una vez por elemento. Se
+ * compila en lugar de lista.c definiendo LISTA_DESENROLLADA.
+ *
+ * Ningún bloque queda vacío: el bloque que se vacía se libera.
+ */
+#define ELEMENTOS_POR_BLOQUE 14
+#define MITAD_BLOQUE (ELEMENTOS_POR_BLOQUE / 2)
+
+typedef struct bloque {
+	size_t cantidad;
+	struct bloque *siguiente;
+	void *elementos[ELEMENTOS_POR_BLOQUE];
+} bloque_t;
+
+struct lista {
+	bloque_t *bloque_inicio;
+	bloque_t *bloque_ultimo;
+	size_t tamanio;
+	pool_t *pool;
+	bool pool_propio;
+	memoria_t *memoria;
+	size_t referencias_extra;
+};
+
+struct lista_iterador {
+	bloque_t *bloque;
+	size_t indice;
+	memoria_t *memoria;
+};
+
+/**
+ * Recibe una lista, y crea y devuelve un bloque vacío (reservado en el pool
+ * de la lista, si tiene), o NULL en caso de error.
+*/
+bloque_t *bloque_crear(lista_t *lista)
+{
+	bloque_t *bloque = lista->pool ? pool_reservar(lista->pool) :
+					 memoria_reservar(lista->memoria,
+							  sizeof(bloque_t));
+	if (!bloque)
+		return NULL;
+	bloque->cantidad = 0;
+	bloque->siguiente = NULL;
+	return bloque;
+}
+
+/**
+ * Recibe una lista y un bloque creado con bloque_crear, y lo libera.
+*/
+void bloque_destruir(lista_t *lista, bloque_t *bloque)
+{
+	if (lista->pool)
+		pool_liberar(lista->pool, bloque);
+	else
+		memoria_liberar(lista->memoria, bloque);
+}
+
+/**
+ * Recibe una lista y una cadena de bloques enlazados (que no pertenecen a
+ * ninguna lista) desde primero hasta ultimo, y la engancha al final de la
+ * lista. No actualiza el tamaño de la lista.
+*/
+void enganchar_bloques(lista_t *lista, bloque_t *primero, bloque_t *ultimo)
+{
+	if (lista->bloque_ultimo)
+		lista->bloque_ultimo->siguiente = primero;
+	else
+		lista->bloque_inicio = primero;
+	lista->bloque_ultimo = ultimo;
+}
+
+/**
+ * Recibe una lista y una cadena de bloques creados con bloque_crear que no
+ * pertenece a la lista, y libera los bloques.
+*/
+void destruir_bloques(lista_t *lista, bloque_t *bloque)
+{
+	while (bloque) {
+		bloque_t *siguiente = bloque->siguiente;
+		bloque_destruir(lista, bloque);
+		bloque = siguiente;
+	}
+}
+
+/**
+ * Crea la lista reservando la memoria necesaria.
+ * Devuelve un puntero a la lista creada o NULL en caso de error.
+ */
+lista_t *lista_crear()
+{
+	return lista_crear_con_memoria(NULL, NULL);
+}
+
+/**
+ * Crea un pool del tamaño de los bloques de la lista, para compartir entre
+ * varias listas creadas con lista_crear_con_pool.
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *lista_crear_pool_de_nodos()
+{
+	return lista_crear_pool_de_nodos_con_memoria(NULL);
+}
+
+/**
+ * Crea un pool igual que lista_crear_pool_de_nodos, cuyos bloques se
+ * reservan con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *lista_crear_pool_de_nodos_con_memoria(memoria_t *memoria)
+{
+	return pool_crear_con_memoria(sizeof(bloque_t), memoria);
+}
+
+/**
+ * Crea una lista igual que lista_crear, pero que reserva y libera sus
+ * bloques en el pool dado. Si pool es NULL, la lista es igual a una creada
+ * con lista_crear.
+ *
+ * Devuelve un puntero a la lista creada o NULL en caso de error.
+ */
+lista_t *lista_crear_con_pool(pool_t *pool)
+{
+	return lista_crear_con_memoria(pool, NULL);
+}
+
+/**
+ * Crea una lista igual que lista_crear_con_pool, que reserva la lista, los
+ * iteradores y los bloques que no van en un pool con la cuenta de memoria
+ * dada. Si memoria es NULL, la lista es igual a una creada con
+ * lista_crear_con_pool.
+ *
+ * Devuelve un puntero a la lista creada o NULL en caso de error.
+ */
+lista_t *lista_crear_con_memoria(pool_t *pool, memoria_t *memoria)
+{
+	lista_t *lista = memoria_reservar_ceros(memoria, 1, sizeof(lista_t));
+	if (!lista)
+		return NULL;
+	lista->pool = pool;
+	lista->memoria = memoria;
+	return lista;
+}
+
+/**
+ * Inserta un elemento al final de la lista.
+ *
+ * Devuelve NULL si no pudo insertar el elemento a causa de un error, o la lista en caso de exito.
+ */
+lista_t *lista_insertar(lista_t *lista, void *elemento)
+{
+	if (!lista)
+		return NULL;
+	bloque_t *ultimo = lista->bloque_ultimo;
+	if (!ultimo || ultimo->cantidad == ELEMENTOS_POR_BLOQUE) {
+		bloque_t *bloque_nuevo = bloque_crear(lista);
+		if (!bloque_nuevo)
+			return NULL;
+		if (ultimo)
+			ultimo->siguiente = bloque_nuevo;
+		else
+			lista->bloque_inicio = bloque_nuevo;
+		lista->bloque_ultimo = bloque_nuevo;
+		ultimo = bloque_nuevo;
+	}
+	ultimo->elementos[ultimo->cantidad++] = elemento;
+	lista->tamanio++;
+	return lista;
+}
+
+/**
+ * Inserta un elemento al final de la lista, igual que lista_insertar.
+ *
+ * En la lista desenrollada los elementos se mueven de bloque al insertar y
+ * quitar, así que el nodo que se devuelve es el mismo elemento (que no puede
+ * ser NULL). Devuelve NULL en caso de error.
+ */
+lista_nodo_t *lista_insertar_nodo(lista_t *lista, void *elemento)
+{
+	if (!elemento || !lista_insertar(lista, elemento))
+		return NULL;
+	return (lista_nodo_t *)elemento;
+}
+
+/**
+ * Devuelve el elemento guardado en el nodo dado o NULL en caso de error.
+ */
+void *lista_nodo_elemento(lista_nodo_t *nodo)
+{
+	return nodo;
+}
+
+/**
+ * Inserta al final de la lista los cantidad elementos del vector dado, en
+ * orden. Completa el último bloque y reserva juntos los bloques que faltan:
+ * en el pool de la lista si tiene uno o, si la lista está vacía y no tiene
+ * pool, en un pool propio de la lista (que se libera al destruirla). Si
+ * falla no inserta ninguno.
+ *
+ * Devuelve NULL si no pudo insertar los elementos a causa de un error, o la
+ * lista en caso de exito.
+ */
+lista_t *lista_insertar_lote(lista_t *lista, void **elementos,
+			     size_t cantidad)
+{
+	if (!lista || (!elementos && cantidad > 0))
+		return NULL;
+	bloque_t *ultimo = lista->bloque_ultimo;
+	size_t en_el_ultimo =
+		ultimo ? ELEMENTOS_POR_BLOQUE - ultimo->cantidad : 0;
+	if (en_el_ultimo > cantidad)
+		en_el_ultimo = cantidad;
+	size_t restantes = cantidad - en_el_ultimo;
+	size_t bloques =
+		(restantes + ELEMENTOS_POR_BLOQUE - 1) / ELEMENTOS_POR_BLOQUE;
+	if (!lista->pool && lista->tamanio == 0 && bloques > 1) {
+		lista->pool =
+			lista_crear_pool_de_nodos_con_memoria(lista->memoria);
+		if (!lista->pool)
+			return NULL;
+		lista->pool_propio = true;
+	}
+	if (lista->pool && !pool_preparar(lista->pool, bloques))
+		return NULL;
+	bloque_t *primero = NULL;
+	bloque_t *anterior = NULL;
+	void **siguientes = elementos + en_el_ultimo;
+	for (size_t i = 0; i < bloques; i++) {
+		bloque_t *bloque = bloque_crear(lista);
+		if (!bloque) {
+			destruir_bloques(lista, primero);
+			return NULL;
+		}
+		bloque->cantidad = restantes < ELEMENTOS_POR_BLOQUE ?
+					   restantes :
+					   ELEMENTOS_POR_BLOQUE;
+		memcpy(bloque->elementos, siguientes,
+		       bloque->cantidad * sizeof(void *));
+		siguientes += bloque->cantidad;
+		restantes -= bloque->cantidad;
+		if (anterior)
+			anterior->siguiente = bloque;
+		else
+			primero = bloque;
+		anterior = bloque;
+	}
+	if (en_el_ultimo > 0) {
+		memcpy(ultimo->elementos + ultimo->cantidad, elementos,
+		       en_el_ultimo * sizeof(void *));
+		ultimo->cantidad += en_el_ultimo;
+	}
+	if (primero)
+		enganchar_bloques(lista, primero, anterior);
+	lista->tamanio += cantidad;
+	return lista;
+}
+
+/**
+ * Si origen tiene un pool propio (el que crea lista_insertar_lote), se lo
+ * pasa a destino para que los bloques de origen puedan pasar a destino sin
+ * copiarlos: destino lo absorbe en su pool o, si está vacía y todavía no
+ * tiene uno, lo adopta como pool propio. Origen queda sin pool.
+ *
+ * Devuelve true si se pudo pasar el pool.
+*/
+bool pasar_pool_propio(lista_t *destino, lista_t *origen)
+{
+	if (!origen->pool_propio)
+		return false;
+	if (destino->pool) {
+		if (!pool_absorber(destino->pool, origen->pool))
+			return false;
+	} else if (destino->tamanio == 0 &&
+		   destino->memoria == origen->memoria) {
+		destino->pool = origen->pool;
+		destino->pool_propio = true;
+	} else {
+		return false;
+	}
+	origen->pool = NULL;
+	origen->pool_propio = false;
+	return true;
+}
+
+/**
+ * Mueve todos los elementos de origen al final de destino, en orden, y deja
+ * origen vacía (pero no la destruye). Es O(1), porque engancha los bloques
+ * de origen sin copiarlos, si las dos listas reservan sus bloques en el
+ * mismo pool (o las dos fuera de un pool, con la misma cuenta de memoria) o
+ * si origen tiene un pool propio que destino puede absorber o adoptar; si
+ * no, copia los elementos de cada bloque con lista_insertar_lote.
+ *
+ * Devuelve destino, o NULL en caso de error (en cuyo caso los elementos que
+ * no se pudieron mover siguen en origen).
+ */
+lista_t *lista_concatenar(lista_t *destino, lista_t *origen)
+{
+	if (!destino || !origen || destino == origen)
+		return NULL;
+	if ((destino->pool == origen->pool &&
+	     (destino->pool || destino->memoria == origen->memoria)) ||
+	    pasar_pool_propio(destino, origen)) {
+		if (origen->bloque_inicio)
+			enganchar_bloques(destino, origen->bloque_inicio,
+					  origen->bloque_ultimo);
+		destino->tamanio += origen->tamanio;
+		origen->bloque_inicio = NULL;
+		origen->bloque_ultimo = NULL;
+		origen->tamanio = 0;
+		return destino;
+	}
+	while (origen->bloque_inicio) {
+		bloque_t *bloque = origen->bloque_inicio;
+		if (!lista_insertar_lote(destino, bloque->elementos,
+					 bloque->cantidad))
+			return NULL;
+		origen->bloque_inicio = bloque->siguiente;
+		if (origen->bloque_ultimo == bloque)
+			origen->bloque_ultimo = NULL;
+		origen->tamanio -= bloque->cantidad;
+		bloque_destruir(origen, bloque);
+	}
+	return destino;
+}
+
+/**
+ * Recibe una lista y una posición existente de la misma.
+ *
+ * Devuelve el bloque que contiene esa posición, guarda en *indice la
+ * posición dentro del bloque, y en *anterior el bloque previo (o NULL si es
+ * el primero), si anterior no es NULL.
+*/
+bloque_t *ubicar_posicion(lista_t *lista, size_t posicion, size_t *indice,
+			  bloque_t **anterior)
+{
+	bloque_t *bloque_anterior = NULL;
+	bloque_t *bloque = lista->bloque_inicio;
+	while (posicion >= bloque->cantidad) {
+		posicion -= bloque->cantidad;
+		bloque_anterior = bloque;
+		bloque = bloque->siguiente;
+	}
+	*indice = posicion;
+	if (anterior)
+		*anterior = bloque_anterior;
+	return bloque;
+}
+
+/**
+ * Recibe una lista y un bloque lleno de la misma, y pasa la segunda mitad de
+ * sus elementos a un bloque nuevo que queda a continuación.
+ *
+ * Devuelve el bloque nuevo, o NULL en caso de error.
+*/
+bloque_t *partir_bloque(lista_t *lista, bloque_t *bloque)
+{
+	bloque_t *bloque_nuevo = bloque_crear(lista);
+	if (!bloque_nuevo)
+		return NULL;
+	bloque_nuevo->cantidad = bloque->cantidad - MITAD_BLOQUE;
+	memcpy(bloque_nuevo->elementos, bloque->elementos + MITAD_BLOQUE,
+	       bloque_nuevo->cantidad * sizeof(void *));
+	bloque->cantidad = MITAD_BLOQUE;
+	bloque_nuevo->siguiente = bloque->siguiente;
+	bloque->siguiente = bloque_nuevo;
+	if (lista->bloque_ultimo == bloque)
+		lista->bloque_ultimo = bloque_nuevo;
+	return bloque_nuevo;
+}
+
+/**
+ * Inserta un elemento en la posicion indicada, donde 0 es insertar
+ * como primer elemento y 1 es insertar luego del primer elemento.
+ * En caso de no existir la posicion indicada, lo inserta al final.
+ *
+ * Devuelve NULL si no pudo insertar el elemento a causa de un error,
+ * o la lista en caso de exito.
+ */
+lista_t *lista_insertar_en_posicion(lista_t *lista, void *elemento,
+				    size_t posicion)
+{
+	if (!lista || posicion >= lista->tamanio)
+		return lista_insertar(lista, elemento);
+	size_t indice;
+	bloque_t *bloque = ubicar_posicion(lista, posicion, &indice, NULL);
+	if (bloque->cantidad == ELEMENTOS_POR_BLOQUE) {
+		bloque_t *bloque_nuevo = partir_bloque(lista, bloque);
+		if (!bloque_nuevo)
+			return NULL;
+		if (indice > MITAD_BLOQUE) {
+			indice -= MITAD_BLOQUE;
+			bloque = bloque_nuevo;
+		}
+	}
+	memmove(bloque->elementos + indice + 1, bloque->elementos + indice,
+		(bloque->cantidad - indice) * sizeof(void *));
+	bloque->elementos[indice] = elemento;
+	bloque->cantidad++;
+	lista->tamanio++;
+	return lista;
+}
+
+/**
+ * Recibe una lista, un bloque de la misma y el bloque anterior (o NULL si
+ * es el primero). Si el bloque quedó vacío lo libera, y si quedó con menos
+ * de la mitad de su capacidad y sus elementos entran junto a los del
+ * siguiente, absorbe al siguiente.
+*/
+void acomodar_bloque(lista_t *lista, bloque_t *bloque, bloque_t *anterior)
+{
+	if (bloque->cantidad == 0) {
+		if (anterior)
+			anterior->siguiente = bloque->siguiente;
+		else
+			lista->bloque_inicio = bloque->siguiente;
+		if (lista->bloque_ultimo == bloque)
+			lista->bloque_ultimo = anterior;
+		bloque_destruir(lista, bloque);
+		return;
+	}
+	bloque_t *siguiente = bloque->siguiente;
+	if (bloque->cantidad >= MITAD_BLOQUE || !siguiente ||
+	    bloque->cantidad + siguiente->cantidad > ELEMENTOS_POR_BLOQUE)
+		return;
+	memcpy(bloque->elementos + bloque->cantidad, siguiente->elementos,
+	       siguiente->cantidad * sizeof(void *));
+	bloque->cantidad += siguiente->cantidad;
+	bloque->siguiente = siguiente->siguiente;
+	if (lista->bloque_ultimo == siguiente)
+		lista->bloque_ultimo = bloque;
+	bloque_destruir(lista, siguiente);
+}
+
+/**
+ * Recibe una lista, un bloque de la misma, el bloque anterior (o NULL si es
+ * el primero) y una posición dentro del bloque.
+ *
+ * Quita el elemento de esa posición y lo devuelve.
+*/
+void *quitar_de_bloque(lista_t *lista, bloque_t *bloque, bloque_t *anterior,
+		       size_t indice)
+{
+	void *elemento = bloque->elementos[indice];
+	memmove(bloque->elementos + indice, bloque->elementos + indice + 1,
+		(bloque->cantidad - indice - 1) * sizeof(void *));
+	bloque->cantidad--;
+	lista->tamanio--;
+	acomodar_bloque(lista, bloque, anterior);
+	return elemento;
+}
+
+/**
+ * Quita de la lista el elemento que se encuentra en la ultima posición.
+ *
+ * Devuelve el elemento removido de la lista o NULL en caso de error.
+ */
+void *lista_quitar(lista_t *lista)
+{
+	if (!lista || lista->tamanio == 0)
+		return NULL;
+	return lista_quitar_de_posicion(lista, lista->tamanio - 1);
+}
+
+/**
+ * Quita de la lista el elemento que se encuentra en la posición
+ * indicada, donde 0 es el primer elemento de la lista.
+ *
+ * En caso de no existir esa posición se intentará borrar el último
+ * elemento.
+ *
+ * Devuelve el elemento removido de la lista o NULL en caso de error.
+ */
+void *lista_quitar_de_posicion(lista_t *lista, size_t posicion)
+{
+	if (!lista || lista->tamanio == 0)
+		return NULL;
+	if (posicion >= lista->tamanio)
+		posicion = lista->tamanio - 1;
+	size_t indice;
+	bloque_t *anterior;
+	bloque_t *bloque = ubicar_posicion(lista, posicion, &indice, &anterior);
+	return quitar_de_bloque(lista, bloque, anterior, indice);
+}
+
+/**
+ * Quita de la lista el primer elemento que cumple la condición
+ * comparador(elemento, contexto) == 0, recorriendo la lista una sola vez.
+ *
+ * Devuelve el elemento removido de la lista o NULL si no existe (o en caso
+ * de error).
+ */
+void *lista_quitar_elemento(lista_t *lista, int (*comparador)(void *, void *),
+			    void *contexto)
+{
+	if (!lista || !comparador)
+		return NULL;
+	bloque_t *anterior = NULL;
+	for (bloque_t *bloque = lista->bloque_inicio; bloque;
+	     bloque = bloque->siguiente) {
+		for (size_t i = 0; i < bloque->cantidad; i++)
+			if (comparador(bloque->elementos[i], contexto) == 0)
+				return quitar_de_bloque(lista, bloque, anterior,
+							i);
+		anterior = bloque;
+	}
+	return NULL;
+}
+
+/**
+ * Quita de la lista todos los elementos para los que
+ * predicado(elemento, aux) devuelve true, recorriendo la lista una sola vez.
+ * El predicado se invoca una vez por elemento, en orden.
+ *
+ * Cada bloque se compacta en el lugar, y los que quedan vacíos se liberan.
+ * Los bloques que quedan chicos no se juntan con el siguiente.
+ *
+ * Devuelve la cantidad de elementos quitados o 0 en caso de error.
+ */
+size_t lista_quitar_si(lista_t *lista, bool (*predicado)(void *, void *),
+		       void *aux)
+{
+	if (!lista || !predicado)
+		return 0;
+	size_t quitados = 0;
+	bloque_t *anterior = NULL;
+	bloque_t *bloque = lista->bloque_inicio;
+	while (bloque) {
+		bloque_t *siguiente = bloque->siguiente;
+		size_t quedan = 0;
+		for (size_t i = 0; i < bloque->cantidad; i++)
+			if (!predicado(bloque->elementos[i], aux))
+				bloque->elementos[quedan++] =
+					bloque->elementos[i];
+		quitados += bloque->cantidad - quedan;
+		lista->tamanio -= bloque->cantidad - quedan;
+		bloque->cantidad = quedan;
+		if (quedan == 0)
+			acomodar_bloque(lista, bloque, anterior);
+		else
+			anterior = bloque;
+		bloque = siguiente;
+	}
+	return quitados;
+}
+
+/**
+ * Recibe un elemento de la lista y uno buscado, y devuelve 0 si son el mismo
+ * puntero.
+*/
+int comparar_punteros(void *elemento, void *buscado)
+{
+	return elemento != buscado;
+}
+
+/**
+ * Quita de la lista el nodo dado, que en la lista desenrollada es el mismo
+ * elemento, y lo devuelve. Recorre la lista buscando el elemento, así que
+ * es O(n).
+ *
+ * Devuelve el elemento removido de la lista o NULL en caso de error.
+ */
+void *lista_quitar_nodo(lista_t *lista, lista_nodo_t *nodo)
+{
+	if (!nodo)
+		return NULL;
+	return lista_quitar_elemento(lista, comparar_punteros, nodo);
+}
+
+/**
+ * Devuelve el elemento en la posicion indicada, donde 0 es el primer
+ * elemento.
+ *
+ * Si no existe dicha posicion devuelve NULL.
+ */
+void *lista_elemento_en_posicion(lista_t *lista, size_t posicion)
+{
+	if (!lista || posicion >= lista->tamanio)
+		return NULL;
+	size_t indice;
+	bloque_t *bloque = ubicar_posicion(lista, posicion, &indice, NULL);
+	return bloque->elementos[indice];
+}
+
+/**
+ * Devuelve el primer elemento de la lista que cumple la condición
+ * comparador(elemento, contexto) == 0.
+ *
+ * Si no existe el elemento devuelve NULL.
+ */
+void *lista_buscar_elemento(lista_t *lista, int (*comparador)(void *, void *),
+			    void *contexto)
+{
+	if (!lista || lista->tamanio == 0 || !comparador)
+		return NULL;
+	for (bloque_t *bloque = lista->bloque_inicio; bloque;
+	     bloque = bloque->siguiente)
+		for (size_t i = 0; i < bloque->cantidad; i++)
+			if (comparador(bloque->elementos[i], contexto) == 0)
+				return bloque->elementos[i];
+	return NULL;
+}
+
+/**
+ * Devuelve el primer elemento de la lista o NULL si la lista se
+ * encuentra vacía o no existe.
+ */
+void *lista_primero(lista_t *lista)
+{
+	if (!lista || lista->tamanio == 0)
+		return NULL;
+	return lista->bloque_inicio->elementos[0];
+}
+
+/**
+ * Devuelve el último elemento de la lista o NULL si la lista se
+ * encuentra vacía o no existe.
+ */
+void *lista_ultimo(lista_t *lista)
+{
+	if (!lista || lista->tamanio == 0)
+		return NULL;
+	return lista->bloque_ultimo->elementos[lista->bloque_ultimo->cantidad -
+					       1];
+}
+
+/**
+ * Devuelve true si la lista está vacía (o no existe)
+ * o false en caso contrario.
+ */
+bool lista_vacia(lista_t *lista)
+{
+	return (lista == NULL || lista->tamanio == 0);
+}
+
+/**
+ * Devuelve la cantidad de elementos almacenados en la lista.
+ * Una lista que no existe no puede tener elementos.
+ */
+size_t lista_tamanio(lista_t *lista)
+{
+	if (lista == NULL)
+		return 0;
+	return lista->tamanio;
+}
+
+/**
+ * Libera la memoria reservada por la lista.
+ */
+void lista_destruir(lista_t *lista)
+{
+	lista_destruir_todo(lista, NULL);
+}
+
+/**
+ * Libera la memoria reservada por la lista pero además aplica la función
+ * destructora dada (si no es NULL) a cada uno de los elementos presentes en la
+ * lista.
+ */
+void lista_destruir_todo(lista_t *lista, void (*funcion)(void *))
+{
+	if (!lista)
+		return;
+	if (lista->referencias_extra > 0) {
+		lista->referencias_extra--;
+		return;
+	}
+	bloque_t *bloque = lista->bloque_inicio;
+	while (bloque) {
+		for (size_t i = 0; funcion && i < bloque->cantidad; i++)
+			funcion(bloque->elementos[i]);
+		bloque_t *siguiente = bloque->siguiente;
+		bloque_destruir(lista, bloque);
+		bloque = siguiente;
+	}
+	if (lista->pool_propio)
+		pool_destruir(lista->pool);
+	memoria_liberar(lista->memoria, lista);
+}
+
+/**
+ * Agrega una referencia a la lista, que desde ahora se comparte entre quienes
+ * tienen una referencia: cada lista_destruir (o lista_destruir_todo) suelta
+ * una, y la lista solo se destruye (y sus elementos solo se pasan a la
+ * función destructora) al soltar la última. Mientras la lista esté
+ * compartida no debe modificarse.
+ *
+ * Devuelve la lista, o NULL en caso de error.
+ */
+lista_t *lista_compartir(lista_t *lista)
+{
+	if (!lista)
+		return NULL;
+	lista->referencias_extra++;
+	return lista;
+}
+
+/**
+ * Devuelve true si la lista tiene más de una referencia (ver lista_compartir)
+ * o false en caso contrario o de error.
+ */
+bool lista_compartida(lista_t *lista)
+{
+	return lista && lista->referencias_extra > 0;
+}
+
+/**
+ * Crea un iterador para una lista. El iterador creado es válido desde
+ * el momento de su creación hasta que no haya mas elementos por
+ * recorrer o se modifique la lista iterada (agregando o quitando
+ * elementos de la lista).
+ *
+ * Al momento de la creación, el iterador queda listo para devolver el
+ * primer elemento utilizando lista_iterador_elemento_actual.
+ *
+ * Devuelve el puntero al iterador creado o NULL en caso de error.
+ */
+lista_iterador_t *lista_iterador_crear(lista_t *lista)
+{
+	if (!lista)
+		return NULL;
+	lista_iterador_t *iterador =
+		memoria_reservar(lista->memoria, sizeof(lista_iterador_t));
+	if (!iterador)
+		return NULL;
+	iterador->memoria = lista->memoria;
+	iterador->bloque = lista->bloque_inicio;
+	iterador->indice = 0;
+	return iterador;
+}
+
+/**
+ * Devuelve true si hay mas elementos sobre los cuales iterar o false
+ * si no hay mas.
+ */
+bool lista_iterador_tiene_siguiente(lista_iterador_t *iterador)
+{
+	if (!iterador || !iterador->bloque)
+		return false;
+	return true;
+}
+
+/**
+ * Avanza el iterador al siguiente elemento.
+ * Devuelve true si pudo avanzar el iterador o false en caso de
+ * que no queden elementos o en caso de error.
+ *
+ * Una vez llegado al último elemento, si se invoca a
+ * lista_iterador_elemento_actual, el resultado siempre será NULL.
+ */
+bool lista_iterador_avanzar(lista_iterador_t *iterador)
+{
+	if (lista_iterador_tiene_siguiente(iterador) == false)
+		return false;
+	iterador->indice++;
+	if (iterador->indice == iterador->bloque->cantidad) {
+		iterador->bloque = iterador->bloque->siguiente;
+		iterador->indice = 0;
+	}
+	return lista_iterador_tiene_siguiente(iterador);
+}
+
+/**
+ * Devuelve el elemento actual del iterador o NULL en caso de que no
+ * exista dicho elemento o en caso de error.
+ */
+void *lista_iterador_elemento_actual(lista_iterador_t *iterador)
+{
+	if (!iterador || !iterador->bloque)
+		return NULL;
+	return iterador->bloque->elementos[iterador->indice];
+}
+
+/**
+ * Libera la memoria reservada por el iterador.
+ */
+void lista_iterador_destruir(lista_iterador_t *iterador)
+{
+	if (iterador)
+		memoria_liberar(iterador->memoria, iterador);
+}
+
+/**
+ * Iterador interno. Recorre la lista e invoca la funcion con cada elemento de
+ * la misma como primer parámetro. Dicha función puede devolver true si se
+ * deben seguir recorriendo elementos o false si se debe dejar de
+ * iterar elementos.
+ *
+ * El puntero contexto se pasa como segundo argumento a la función del usuario.
+ *
+ * La función devuelve la cantidad de elementos iterados o 0 en caso de error
+ * (errores de memoria, función o lista NULL, etc).
+ *
+ */
+size_t lista_con_cada_elemento(lista_t *lista, bool (*funcion)(void *, void *),
+			       void *contexto)
+{
+	if (lista_vacia(lista) || !funcion)
+		return 0;
+	size_t contador = 0;
+	for (bloque_t *bloque = lista->bloque_inicio; bloque;
+	     bloque = bloque->siguiente)
+		for (size_t i = 0; i < bloque->cantidad; i++) {
+			if (!funcion(bloque->elementos[i], contexto))
+				return contador;
+			contador++;
+		}
+	return contador;
+}
+
+#endif /* LISTA_DESENROLLADA */
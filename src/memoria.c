@@ -0,0 +1,189 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memoria.h"
+
+/*
+ * Cada reserva empieza con una cabecera del tamaño de max_align_t (para no
+ * perder la alineación de lo que sigue) con el tamaño total de la reserva.
+ */
+typedef union cabecera {
+	size_t tamanio;
+	max_align_t alineacion;
+} cabecera_t;
+
+struct memoria {
+	alocador_t alocador;
+	size_t usada;
+	size_t limite;
+};
+
+/**
+ * Alocador por defecto: reserva con malloc, ignorando el contexto.
+*/
+static void *reservar_con_malloc(void *contexto, size_t tamanio)
+{
+	(void)contexto;
+	return malloc(tamanio);
+}
+
+/**
+ * Alocador por defecto: redimensiona con realloc, ignorando el contexto.
+*/
+static void *redimensionar_con_realloc(void *contexto, void *puntero,
+				       size_t tamanio)
+{
+	(void)contexto;
+	return realloc(puntero, tamanio);
+}
+
+/**
+ * Alocador por defecto: libera con free, ignorando el contexto.
+*/
+static void liberar_con_free(void *contexto, void *puntero)
+{
+	(void)contexto;
+	free(puntero);
+}
+
+/*
+ * Crea una cuenta de memoria que reserva con el alocador dado (o con malloc
+ * y free si es NULL), y en la que la memoria usada no puede superar el
+ * límite en bytes (o no tiene límite si es 0).
+ *
+ * Devuelve un puntero a la cuenta creada o NULL en caso de error.
+ */
+memoria_t *memoria_crear(const alocador_t *alocador, size_t limite)
+{
+	alocador_t por_defecto = { .reservar = reservar_con_malloc,
+				   .redimensionar = redimensionar_con_realloc,
+				   .liberar = liberar_con_free };
+	if (!alocador)
+		alocador = &por_defecto;
+	if (!alocador->reservar || !alocador->redimensionar ||
+	    !alocador->liberar)
+		return NULL;
+	memoria_t *memoria =
+		alocador->reservar(alocador->contexto, sizeof(memoria_t));
+	if (!memoria)
+		return NULL;
+	memoria->alocador = *alocador;
+	memoria->usada = 0;
+	memoria->limite = limite;
+	return memoria;
+}
+
+/**
+ * Recibe una cuenta y una cantidad de bytes a agregar a la memoria usada.
+ *
+ * Devuelve true si se pueden agregar sin superar el límite.
+*/
+bool entra_en_el_limite(memoria_t *memoria, size_t bytes)
+{
+	return memoria->limite == 0 ||
+	       (bytes <= memoria->limite &&
+		memoria->usada <= memoria->limite - bytes);
+}
+
+/*
+ * Reserva tamanio bytes. Devuelve NULL en caso de error o si la reserva
+ * haría superar el límite.
+ */
+void *memoria_reservar(memoria_t *memoria, size_t tamanio)
+{
+	if (!memoria)
+		return malloc(tamanio);
+	if (tamanio > SIZE_MAX - sizeof(cabecera_t))
+		return NULL;
+	size_t total = tamanio + sizeof(cabecera_t);
+	if (!entra_en_el_limite(memoria, total))
+		return NULL;
+	cabecera_t *cabecera =
+		memoria->alocador.reservar(memoria->alocador.contexto, total);
+	if (!cabecera)
+		return NULL;
+	cabecera->tamanio = total;
+	memoria->usada += total;
+	return cabecera + 1;
+}
+
+/*
+ * Reserva cantidad * tamanio bytes inicializados en cero. Devuelve NULL en
+ * caso de error o si la reserva haría superar el límite.
+ */
+void *memoria_reservar_ceros(memoria_t *memoria, size_t cantidad,
+			     size_t tamanio)
+{
+	if (!memoria)
+		return calloc(cantidad, tamanio);
+	if (tamanio != 0 && cantidad > SIZE_MAX / tamanio)
+		return NULL;
+	void *reserva = memoria_reservar(memoria, cantidad * tamanio);
+	if (reserva)
+		memset(reserva, 0, cantidad * tamanio);
+	return reserva;
+}
+
+/*
+ * Cambia el tamaño de una reserva (o reserva, si puntero es NULL), igual que
+ * realloc. Devuelve NULL en caso de error o si la reserva haría superar el
+ * límite, y en ese caso la reserva original no se modifica.
+ */
+void *memoria_redimensionar(memoria_t *memoria, void *puntero, size_t tamanio)
+{
+	if (!memoria)
+		return realloc(puntero, tamanio);
+	if (!puntero)
+		return memoria_reservar(memoria, tamanio);
+	if (tamanio > SIZE_MAX - sizeof(cabecera_t))
+		return NULL;
+	cabecera_t *cabecera = (cabecera_t *)puntero - 1;
+	size_t anterior = cabecera->tamanio;
+	size_t total = tamanio + sizeof(cabecera_t);
+	if (total > anterior && !entra_en_el_limite(memoria, total - anterior))
+		return NULL;
+	cabecera = memoria->alocador.redimensionar(memoria->alocador.contexto,
+						   cabecera, total);
+	if (!cabecera)
+		return NULL;
+	cabecera->tamanio = total;
+	memoria->usada = memoria->usada - anterior + total;
+	return cabecera + 1;
+}
+
+/*
+ * Libera una reserva hecha con esta cuenta (o no hace nada si es NULL).
+ */
+void memoria_liberar(memoria_t *memoria, void *puntero)
+{
+	if (!memoria) {
+		free(puntero);
+		return;
+	}
+	if (!puntero)
+		return;
+	cabecera_t *cabecera = (cabecera_t *)puntero - 1;
+	memoria->usada -= cabecera->tamanio;
+	memoria->alocador.liberar(memoria->alocador.contexto, cabecera);
+}
+
+/*
+ * Devuelve la cantidad de bytes reservados con la cuenta y todavía no
+ * liberados, incluyendo las cabeceras, o 0 si memoria es NULL.
+ */
+size_t memoria_usada(memoria_t *memoria)
+{
+	if (!memoria)
+		return 0;
+	return memoria->usada;
+}
+
+/*
+ * Destruye la cuenta. No libera las reservas que sigan sin liberar.
+ */
+void memoria_destruir(memoria_t *memoria)
+{
+	if (!memoria)
+		return;
+	memoria->alocador.liberar(memoria->alocador.contexto, memoria);
+}
@@ -0,0 +1,73 @@
+#ifndef __MEMORIA_H__
+#define __MEMORIA_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Funciones de reserva de memoria provistas por el usuario. Las tres reciben
+ * el mismo contexto, y se comportan como malloc, realloc y free.
+ */
+typedef struct alocador {
+	void *(*reservar)(void *contexto, size_t tamanio);
+	void *(*redimensionar)(void *contexto, void *puntero, size_t tamanio);
+	void (*liberar)(void *contexto, void *puntero);
+	void *contexto;
+} alocador_t;
+
+/*
+ * Cuenta de la memoria reservada por una estructura (y las que la componen),
+ * con un límite opcional. Cada reserva guarda su tamaño en una cabecera, así
+ * que al liberarla se descuenta exactamente lo que se había contado.
+ *
+ * Todas las funciones aceptan una memoria NULL, y en ese caso equivalen a
+ * malloc, calloc, realloc y free, sin cabecera ni cuenta.
+ */
+typedef struct memoria memoria_t;
+
+/*
+ * Crea una cuenta de memoria que reserva con el alocador dado (o con malloc
+ * y free si es NULL), y en la que la memoria usada no puede superar el
+ * límite en bytes (o no tiene límite si es 0).
+ *
+ * Devuelve un puntero a la cuenta creada o NULL en caso de error.
+ */
+memoria_t *memoria_crear(const alocador_t *alocador, size_t limite);
+
+/*
+ * Reserva tamanio bytes. Devuelve NULL en caso de error o si la reserva
+ * haría superar el límite.
+ */
+void *memoria_reservar(memoria_t *memoria, size_t tamanio);
+
+/*
+ * Reserva cantidad * tamanio bytes inicializados en cero. Devuelve NULL en
+ * caso de error o si la reserva haría superar el límite.
+ */
+void *memoria_reservar_ceros(memoria_t *memoria, size_t cantidad,
+			     size_t tamanio);
+
+/*
+ * Cambia el tamaño de una reserva (o reserva, si puntero es NULL), igual que
+ * realloc. Devuelve NULL en caso de error o si la reserva haría superar el
+ * límite, y en ese caso la reserva original no se modifica.
+ */
+void *memoria_redimensionar(memoria_t *memoria, void *puntero, size_t tamanio);
+
+/*
+ * Libera una reserva hecha con esta cuenta (o no hace nada si es NULL).
+ */
+void memoria_liberar(memoria_t *memoria, void *puntero);
+
+/*
+ * Devuelve la cantidad de bytes reservados con la cuenta y todavía no
+ * liberados, incluyendo las cabeceras, o 0 si memoria es NULL.
+ */
+size_t memoria_usada(memoria_t *memoria);
+
+/*
+ * Destruye la cuenta. No libera las reservas que sigan sin liberar.
+ */
+void memoria_destruir(memoria_t *memoria);
+
+#endif /* __MEMORIA_H__ */
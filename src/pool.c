@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include "pool.h"
+
+#define OBJETOS_PRIMER_BLOQUE 64
+#define OBJETOS_MAXIMOS_POR_BLOQUE 4096
+
+/*
+ * Cada bloque empieza con el puntero al bloque reservado anteriormente, y a
+ * continuación tiene sus objetos. Un objeto libre guarda en sus primeros
+ * bytes el puntero al siguiente objeto libre.
+ */
+typedef struct bloque_pool {
+	struct bloque_pool *anterior;
+	max_align_t objetos[];
+} bloque_pool_t;
+
+struct pool {
+	size_t tamanio_objeto;
+	void *libres;
+	size_t cantidad_libres;
+	bloque_pool_t *bloques;
+	char *sin_usar;
+	size_t cantidad_sin_usar;
+	size_t objetos_proximo_bloque;
+	size_t cantidad_bloques;
+	memoria_t *memoria;
+};
+
+/*
+ * Crea un pool de objetos del tamaño dado.
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *pool_crear(size_t tamanio_objeto)
+{
+	return pool_crear_con_memoria(tamanio_objeto, NULL);
+}
+
+/*
+ * Crea un pool igual que pool_crear, pero que reserva el pool y sus bloques
+ * con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *pool_crear_con_memoria(size_t tamanio_objeto, memoria_t *memoria)
+{
+	if (tamanio_objeto == 0)
+		return NULL;
+	pool_t *pool = memoria_reservar_ceros(memoria, 1, sizeof(pool_t));
+	if (!pool)
+		return NULL;
+	pool->memoria = memoria;
+	if (tamanio_objeto < sizeof(void *))
+		tamanio_objeto = sizeof(void *);
+	pool->tamanio_objeto = (tamanio_objeto + sizeof(void *) - 1) /
+			       sizeof(void *) * sizeof(void *);
+	pool->objetos_proximo_bloque = OBJETOS_PRIMER_BLOQUE;
+	return pool;
+}
+
+/**
+ * Recibe un pool sin objetos sin usar y una cantidad de objetos, y reserva
+ * un bloque nuevo con esa cantidad de objetos.
+ *
+ * Devuelve true si pudo reservarlo o false en caso de error.
+*/
+bool agregar_bloque(pool_t *pool, size_t objetos)
+{
+	bloque_pool_t *bloque = memoria_reservar(
+		pool->memoria,
+		sizeof(bloque_pool_t) + objetos * pool->tamanio_objeto);
+	if (!bloque)
+		return false;
+	bloque->anterior = pool->bloques;
+	pool->bloques = bloque;
+	pool->sin_usar = (char *)bloque->objetos;
+	pool->cantidad_sin_usar = objetos;
+	pool->cantidad_bloques++;
+	return true;
+}
+
+/*
+ * Devuelve un objeto del pool (sin inicializar), o NULL en caso de error.
+ */
+void *pool_reservar(pool_t *pool)
+{
+	if (!pool)
+		return NULL;
+	if (pool->libres) {
+		void *objeto = pool->libres;
+		pool->libres = *(void **)objeto;
+		pool->cantidad_libres--;
+		return objeto;
+	}
+	if (pool->cantidad_sin_usar == 0) {
+		if (!agregar_bloque(pool, pool->objetos_proximo_bloque))
+			return NULL;
+		if (pool->objetos_proximo_bloque < OBJETOS_MAXIMOS_POR_BLOQUE)
+			pool->objetos_proximo_bloque *= 2;
+	}
+	void *objeto = pool->sin_usar;
+	pool->sin_usar += pool->tamanio_objeto;
+	pool->cantidad_sin_usar--;
+	return objeto;
+}
+
+/*
+ * Devuelve al pool un objeto reservado con pool_reservar.
+ */
+void pool_liberar(pool_t *pool, void *objeto)
+{
+	if (!pool || !objeto)
+		return;
+	*(void **)objeto = pool->libres;
+	pool->libres = objeto;
+	pool->cantidad_libres++;
+}
+
+/*
+ * Se asegura de que las próximas cantidad reservas no llamen a malloc. Si
+ * hace falta, reserva un único bloque con todos los objetos que faltan.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+ */
+bool pool_preparar(pool_t *pool, size_t cantidad)
+{
+	if (!pool)
+		return false;
+	if (pool->cantidad_libres + pool->cantidad_sin_usar >= cantidad)
+		return true;
+	while (pool->cantidad_sin_usar > 0) {
+		pool_liberar(pool, pool->sin_usar);
+		pool->sin_usar += pool->tamanio_objeto;
+		pool->cantidad_sin_usar--;
+	}
+	return agregar_bloque(pool, cantidad - pool->cantidad_libres);
+}
+
+/*
+ * Pasa al pool todos los objetos de otro (tanto los reservados como los
+ * libres) y destruye otro, sin mover ningún objeto: los objetos que se
+ * reservaron en otro se liberan después en pool. Tarda en proporción a la
+ * cantidad de bloques y de objetos libres de otro, no a la de reservados.
+ * Los dos pools tienen que tener objetos del mismo tamaño y reservar con la
+ * misma cuenta de memoria.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (en cuyo caso no
+ * modifica ninguno de los dos pools).
+ */
+bool pool_absorber(pool_t *pool, pool_t *otro)
+{
+	if (!pool || !otro || pool == otro ||
+	    pool->tamanio_objeto != otro->tamanio_objeto ||
+	    pool->memoria != otro->memoria)
+		return false;
+	if (otro->bloques) {
+		bloque_pool_t *mas_viejo = otro->bloques;
+		while (mas_viejo->anterior)
+			mas_viejo = mas_viejo->anterior;
+		mas_viejo->anterior = pool->bloques;
+		pool->bloques = otro->bloques;
+		pool->cantidad_bloques += otro->cantidad_bloques;
+	}
+	while (otro->cantidad_sin_usar > 0) {
+		pool_liberar(pool, otro->sin_usar);
+		otro->sin_usar += otro->tamanio_objeto;
+		otro->cantidad_sin_usar--;
+	}
+	while (otro->libres) {
+		void *objeto = otro->libres;
+		otro->libres = *(void **)objeto;
+		pool_liberar(pool, objeto);
+	}
+	memoria_liberar(otro->memoria, otro);
+	return true;
+}
+
+/*
+ * Devuelve la cantidad de bloques que reservó el pool (es decir, la cantidad
+ * de veces que llamó a malloc) o 0 en caso de error.
+ */
+size_t pool_cantidad_bloques(pool_t *pool)
+{
+	if (!pool)
+		return 0;
+	return pool->cantidad_bloques;
+}
+
+/*
+ * Destruye el pool, liberando la memoria de todos sus objetos.
+ */
+void pool_destruir(pool_t *pool)
+{
+	if (!pool)
+		return;
+	while (pool->bloques) {
+		bloque_pool_t *anterior = pool->bloques->anterior;
+		memoria_liberar(pool->memoria, pool->bloques);
+		pool->bloques = anterior;
+	}
+	memoria_liberar(pool->memoria, pool);
+}
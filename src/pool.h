@@ -0,0 +1,74 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "memoria.h"
+
+/*
+ * Pool de objetos de un mismo tamaño. Reserva memoria en bloques de varios
+ * objetos (cada bloque nuevo del doble de objetos que el anterior, hasta un
+ * máximo), y los objetos liberados se guardan en una lista de libres para
+ * reutilizarlos, así que reservar y liberar no llaman a malloc ni a free en
+ * la mayoría de los casos. La memoria se devuelve recién al destruir el pool.
+ */
+typedef struct pool pool_t;
+
+/*
+ * Crea un pool de objetos del tamaño dado.
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *pool_crear(size_t tamanio_objeto);
+
+/*
+ * Crea un pool igual que pool_crear, pero que reserva el pool y sus bloques
+ * con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_t *pool_crear_con_memoria(size_t tamanio_objeto, memoria_t *memoria);
+
+/*
+ * Devuelve un objeto del pool (sin inicializar), o NULL en caso de error.
+ */
+void *pool_reservar(pool_t *pool);
+
+/*
+ * Devuelve al pool un objeto reservado con pool_reservar.
+ */
+void pool_liberar(pool_t *pool, void *objeto);
+
+/*
+ * Se asegura de que las próximas cantidad reservas no llamen a malloc. Si
+ * hace falta, reserva un único bloque con todos los objetos que faltan.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error.
+ */
+bool pool_preparar(pool_t *pool, size_t cantidad);
+
+/*
+ * Pasa al pool todos los objetos de otro (tanto los reservados como los
+ * libres) y destruye otro, sin mover ningún objeto: los objetos que se
+ * reservaron en otro se liberan después en pool. Tarda en proporción a la
+ * cantidad de bloques y de objetos libres de otro, no a la de reservados.
+ * Los dos pools tienen que tener objetos del mismo tamaño y reservar con la
+ * misma cuenta de memoria.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (en cuyo caso no
+ * modifica ninguno de los dos pools).
+ */
+bool pool_absorber(pool_t *pool, pool_t *otro);
+
+/*
+ * Devuelve la cantidad de bloques que reservó el pool (es decir, la cantidad
+ * de veces que llamó a malloc) o 0 en caso de error.
+ */
+size_t pool_cantidad_bloques(pool_t *pool);
+
+/*
+ * Destruye el pool, liberando la memoria de todos sus objetos.
+ */
+void pool_destruir(pool_t *pool);
+
+#endif /* __POOL_H__ */
@@ -0,0 +1,116 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "hash.h"
+#include "pool_claves.h"
+
+#define CAPACIDAD_POOL_INICIAL 16
+
+typedef struct entrada_pool {
+	size_t referencias;
+	char clave[];
+} entrada_pool_t;
+
+struct pool_claves {
+	hash_t *claves;
+};
+
+/**
+ * Recibe una clave devuelta por pool_claves_internar y devuelve la entrada
+ * del pool que la contiene.
+*/
+entrada_pool_t *entrada_de_clave(const char *clave)
+{
+	return (entrada_pool_t *)(clave - offsetof(entrada_pool_t, clave));
+}
+
+/*
+ * Crea un pool de claves vacío.
+ *
+ * El pool es a su vez un hash con claves prestadas, cuyas claves apuntan a la
+ * copia guardada en cada entrada, por lo que cada clave se almacena una sola
+ * vez.
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_claves_t *pool_claves_crear()
+{
+	pool_claves_t *pool = malloc(sizeof(pool_claves_t));
+	if (!pool)
+		return NULL;
+	hash_opciones_t opciones = { .flags = HASH_CLAVES_PRESTADAS };
+	pool->claves =
+		hash_crear_con_opciones(CAPACIDAD_POOL_INICIAL, &opciones);
+	if (!pool->claves) {
+		free(pool);
+		return NULL;
+	}
+	return pool;
+}
+
+/*
+ * Devuelve la copia internada de la clave dada, creándola si no existía, y
+ * suma una referencia a la misma.
+ *
+ * Devuelve NULL en caso de error.
+ */
+const char *pool_claves_internar(pool_claves_t *pool, const char *clave)
+{
+	if (!pool || !clave)
+		return NULL;
+	entrada_pool_t *entrada = hash_obtener(pool->claves, clave);
+	if (entrada) {
+		entrada->referencias++;
+		return entrada->clave;
+	}
+	size_t largo = strlen(clave);
+	entrada = malloc(sizeof(entrada_pool_t) + largo + 1);
+	if (!entrada)
+		return NULL;
+	memcpy(entrada->clave, clave, largo + 1);
+	entrada->referencias = 1;
+	if (!hash_insertar(pool->claves, entrada->clave, entrada, NULL)) {
+		free(entrada);
+		return NULL;
+	}
+	return entrada->clave;
+}
+
+/*
+ * Resta una referencia a una clave devuelta por pool_claves_internar. Si era
+ * la última referencia, la clave se libera.
+ */
+void pool_claves_soltar(pool_claves_t *pool, const char *clave)
+{
+	if (!pool || !clave)
+		return;
+	entrada_pool_t *entrada = entrada_de_clave(clave);
+	entrada->referencias--;
+	if (entrada->referencias == 0) {
+		hash_quitar(pool->claves, entrada->clave);
+		free(entrada);
+	}
+}
+
+/*
+ * Devuelve la cantidad de claves distintas almacenadas en el pool o 0 en
+ * caso de error.
+ */
+size_t pool_claves_cantidad(pool_claves_t *pool)
+{
+	if (!pool)
+		return 0;
+	return hash_cantidad(pool->claves);
+}
+
+/*
+ * Destruye el pool liberando todas las claves internadas. Ningún hash que use
+ * el pool puede seguir existiendo.
+ */
+void pool_claves_destruir(pool_claves_t *pool)
+{
+	if (!pool)
+		return;
+	hash_destruir_todo(pool->claves, free);
+	free(pool);
+}
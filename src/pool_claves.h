@@ -0,0 +1,45 @@
+#ifndef __POOL_CLAVES_H__
+#define __POOL_CLAVES_H__
+
+#include <stddef.h>
+
+/*
+ * Pool de claves internadas. Guarda una única copia de cada clave, con un
+ * contador de referencias, para que varios hash puedan compartirla.
+ */
+typedef struct pool_claves pool_claves_t;
+
+/*
+ * Crea un pool de claves vacío.
+ *
+ * Devuelve un puntero al pool creado o NULL en caso de error.
+ */
+pool_claves_t *pool_claves_crear();
+
+/*
+ * Devuelve la copia internada de la clave dada, creándola si no existía, y
+ * suma una referencia a la misma.
+ *
+ * Devuelve NULL en caso de error.
+ */
+const char *pool_claves_internar(pool_claves_t *pool, const char *clave);
+
+/*
+ * Resta una referencia a una clave devuelta por pool_claves_internar. Si era
+ * la última referencia, la clave se libera.
+ */
+void pool_claves_soltar(pool_claves_t *pool, const char *clave);
+
+/*
+ * Devuelve la cantidad de claves distintas almacenadas en el pool o 0 en
+ * caso de error.
+ */
+size_t pool_claves_cantidad(pool_claves_t *pool);
+
+/*
+ * Destruye el pool liberando todas las claves internadas. Ningún hash que use
+ * el pool puede seguir existiendo.
+ */
+void pool_claves_destruir(pool_claves_t *pool);
+
+#endif /* __POOL_CLAVES_H__ */
@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include "rueda_temporal.h"
+
+#define BITS_POR_NIVEL 6
+#define RANURAS_POR_NIVEL (1 << BITS_POR_NIVEL)
+#define MASCARA_RANURA (RANURAS_POR_NIVEL - 1)
+#define NIVELES 6
+#define NIVEL_LEJANOS NIVELES
+
+/*
+ * Cada nivel tiene 64 ranuras y cubre 64 veces más tiempo que el anterior.
+ * Un temporizador se ubica en el nivel del grupo de 6 bits más alto en el que
+ * su vencimiento difiere del tiempo actual, de manera que baja de nivel
+ * (cascada) recién cuando el tiempo actual entra en su bloque. Los que
+ * difieren por encima del último nivel se guardan en la lista de lejanos.
+ */
+struct rueda_temporal {
+	temporizador_t *ranuras[NIVELES][RANURAS_POR_NIVEL];
+	temporizador_t *lejanos;
+	size_t cantidad_por_nivel[NIVELES + 1];
+	size_t cantidad;
+	uint64_t actual;
+	memoria_t *memoria;
+};
+
+/*
+ * Crea una rueda vacía cuyo tiempo actual es el tick dado, reservándola con
+ * la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero a la rueda creada o NULL en caso de error.
+ */
+rueda_temporal_t *rueda_temporal_crear(uint64_t ahora, memoria_t *memoria)
+{
+	rueda_temporal_t *rueda =
+		memoria_reservar_ceros(memoria, 1, sizeof(rueda_temporal_t));
+	if (!rueda)
+		return NULL;
+	rueda->actual = ahora;
+	rueda->memoria = memoria;
+	return rueda;
+}
+
+/**
+ * Recibe una rueda y un temporizador agendado, y devuelve un puntero a la
+ * cabeza de la lista en la que está enganchado.
+*/
+temporizador_t **ranura_de_temporizador(rueda_temporal_t *rueda,
+					temporizador_t *temporizador)
+{
+	if (temporizador->nivel == NIVEL_LEJANOS)
+		return &rueda->lejanos;
+	return &rueda->ranuras[temporizador->nivel][temporizador->ranura];
+}
+
+/**
+ * Recibe una rueda y un temporizador, y calcula el nivel y la ranura que le
+ * corresponden según su vencimiento y el tiempo actual de la rueda. Luego
+ * lo engancha al principio de esa ranura.
+*/
+void ubicar_temporizador(rueda_temporal_t *rueda, temporizador_t *temporizador)
+{
+	uint64_t vencimiento = temporizador->vencimiento;
+	if (vencimiento < rueda->actual)
+		vencimiento = rueda->actual;
+	uint64_t diferencia = vencimiento ^ rueda->actual;
+	unsigned int nivel = 0;
+	while (nivel < NIVELES &&
+	       (diferencia >> (BITS_POR_NIVEL * (nivel + 1))) != 0)
+		nivel++;
+	temporizador->nivel = nivel;
+	temporizador->ranura = 0;
+	if (nivel < NIVELES)
+		temporizador->ranura =
+			(vencimiento >> (BITS_POR_NIVEL * nivel)) &
+			MASCARA_RANURA;
+	temporizador_t **cabeza = ranura_de_temporizador(rueda, temporizador);
+	temporizador->anterior = NULL;
+	temporizador->siguiente = *cabeza;
+	if (*cabeza)
+		(*cabeza)->anterior = temporizador;
+	*cabeza = temporizador;
+	rueda->cantidad_por_nivel[nivel]++;
+}
+
+/**
+ * Recibe una rueda y un temporizador agendado, y lo desengancha de su
+ * ranura.
+*/
+void desenganchar_temporizador(rueda_temporal_t *rueda,
+			       temporizador_t *temporizador)
+{
+	if (temporizador->anterior)
+		temporizador->anterior->siguiente = temporizador->siguiente;
+	else
+		*ranura_de_temporizador(rueda, temporizador) =
+			temporizador->siguiente;
+	if (temporizador->siguiente)
+		temporizador->siguiente->anterior = temporizador->anterior;
+	rueda->cantidad_por_nivel[temporizador->nivel]--;
+}
+
+/*
+ * Agenda el temporizador dado según su vencimiento. Si el vencimiento ya
+ * pasó, el temporizador vence en el próximo avance de la rueda.
+ */
+void rueda_temporal_agregar(rueda_temporal_t *rueda,
+			    temporizador_t *temporizador)
+{
+	if (!rueda || !temporizador)
+		return;
+	ubicar_temporizador(rueda, temporizador);
+	rueda->cantidad++;
+}
+
+/*
+ * Quita de la rueda un temporizador agendado, en O(1).
+ */
+void rueda_temporal_quitar(rueda_temporal_t *rueda,
+			   temporizador_t *temporizador)
+{
+	if (!rueda || !temporizador)
+		return;
+	desenganchar_temporizador(rueda, temporizador);
+	rueda->cantidad--;
+}
+
+/**
+ * Recibe una rueda y una ranura (o la lista de lejanos) y vuelve a ubicar
+ * cada uno de sus temporizadores según el tiempo actual de la rueda.
+*/
+void cascadear_ranura(rueda_temporal_t *rueda, temporizador_t **cabeza,
+		      unsigned int nivel)
+{
+	temporizador_t *temporizador = *cabeza;
+	*cabeza = NULL;
+	while (temporizador) {
+		temporizador_t *siguiente = temporizador->siguiente;
+		rueda->cantidad_por_nivel[nivel]--;
+		ubicar_temporizador(rueda, temporizador);
+		temporizador = siguiente;
+	}
+}
+
+/**
+ * Recibe una rueda y un tick, y baja de nivel las ranuras cuyo bloque
+ * comienza en ese tick.
+*/
+void cascadear_tick(rueda_temporal_t *rueda, uint64_t tick)
+{
+	if ((tick & ((1ULL << (BITS_POR_NIVEL * NIVELES)) - 1)) == 0)
+		cascadear_ranura(rueda, &rueda->lejanos, NIVEL_LEJANOS);
+	for (unsigned int nivel = NIVELES - 1; nivel >= 1; nivel--) {
+		uint64_t bloque = 1ULL << (BITS_POR_NIVEL * nivel);
+		if ((tick & (bloque - 1)) == 0)
+			cascadear_ranura(
+				rueda,
+				&rueda->ranuras[nivel][(tick >> (BITS_POR_NIVEL *
+								 nivel)) &
+						       MASCARA_RANURA],
+				nivel);
+	}
+}
+
+/**
+ * Recibe una rueda y devuelve el primer tick, a partir del actual, en el que
+ * puede ocurrir algo: si los niveles bajos están vacíos no hace falta
+ * recorrer tick por tick, sino que alcanza con saltar al inicio del próximo
+ * bloque del nivel ocupado más bajo.
+*/
+uint64_t proximo_tick_relevante(rueda_temporal_t *rueda)
+{
+	unsigned int nivel = 0;
+	while (nivel < NIVEL_LEJANOS && rueda->cantidad_por_nivel[nivel] == 0)
+		nivel++;
+	if (nivel == 0)
+		return rueda->actual;
+	uint64_t bloque = 1ULL << (BITS_POR_NIVEL * nivel);
+	return (rueda->actual + bloque - 1) & ~(bloque - 1);
+}
+
+/*
+ * Avanza el tiempo de la rueda hasta el tick dado (inclusive). Cada
+ * temporizador vencido se quita de la rueda y se pasa a la función vencido
+ * junto con el puntero auxiliar.
+ *
+ * Si maximo no es 0, se procesan a lo sumo maximo temporizadores y el avance
+ * se retoma en la siguiente invocación.
+ *
+ * Devuelve la cantidad de temporizadores vencidos procesados.
+ */
+size_t rueda_temporal_avanzar(rueda_temporal_t *rueda, uint64_t hasta,
+			      size_t maximo,
+			      void (*vencido)(temporizador_t *, void *),
+			      void *aux)
+{
+	size_t procesados = 0;
+	if (!rueda || !vencido)
+		return procesados;
+	while (rueda->actual <= hasta) {
+		if (rueda->cantidad == 0) {
+			rueda->actual = hasta + 1;
+			break;
+		}
+		uint64_t tick = proximo_tick_relevante(rueda);
+		if (tick > hasta) {
+			rueda->actual = hasta + 1;
+			break;
+		}
+		rueda->actual = tick;
+		cascadear_tick(rueda, tick);
+		temporizador_t **cabeza =
+			&rueda->ranuras[0][tick & MASCARA_RANURA];
+		while (*cabeza) {
+			if (maximo && procesados == maximo)
+				return procesados;
+			temporizador_t *temporizador = *cabeza;
+			rueda_temporal_quitar(rueda, temporizador);
+			vencido(temporizador, aux);
+			procesados++;
+		}
+		rueda->actual = tick + 1;
+	}
+	return procesados;
+}
+
+/*
+ * Devuelve la cantidad de temporizadores agendados o 0 en caso de error.
+ */
+size_t rueda_temporal_cantidad(rueda_temporal_t *rueda)
+{
+	if (!rueda)
+		return 0;
+	return rueda->cantidad;
+}
+
+/*
+ * Destruye la rueda. No libera los temporizadores agendados.
+ */
+void rueda_temporal_destruir(rueda_temporal_t *rueda)
+{
+	if (!rueda)
+		return;
+	memoria_liberar(rueda->memoria, rueda);
+}
@@ -0,0 +1,77 @@
+#ifndef __RUEDA_TEMPORAL_H__
+#define __RUEDA_TEMPORAL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "memoria.h"
+
+/*
+ * Rueda temporal jerárquica. Agenda temporizadores con un vencimiento
+ * (medido en ticks, por ejemplo milisegundos) y permite avanzar el tiempo
+ * procesando los vencidos, sin recorrer los temporizadores que todavía no
+ * vencieron.
+ */
+typedef struct rueda_temporal rueda_temporal_t;
+
+/*
+ * Temporizador agendable en una rueda. El usuario reserva la memoria del
+ * temporizador, completa vencimiento y dato, y lo agrega a la rueda. Los
+ * demás campos son de uso interno de la rueda.
+ */
+typedef struct temporizador {
+	uint64_t vencimiento;
+	void *dato;
+	struct temporizador *anterior;
+	struct temporizador *siguiente;
+	unsigned int nivel;
+	unsigned int ranura;
+} temporizador_t;
+
+/*
+ * Crea una rueda vacía cuyo tiempo actual es el tick dado, reservándola con
+ * la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero a la rueda creada o NULL en caso de error.
+ */
+rueda_temporal_t *rueda_temporal_crear(uint64_t ahora, memoria_t *memoria);
+
+/*
+ * Agenda el temporizador dado según su vencimiento. Si el vencimiento ya
+ * pasó, el temporizador vence en el próximo avance de la rueda.
+ */
+void rueda_temporal_agregar(rueda_temporal_t *rueda,
+			    temporizador_t *temporizador);
+
+/*
+ * Quita de la rueda un temporizador agendado, en O(1).
+ */
+void rueda_temporal_quitar(rueda_temporal_t *rueda,
+			   temporizador_t *temporizador);
+
+/*
+ * Avanza el tiempo de la rueda hasta el tick dado (inclusive). Cada
+ * temporizador vencido se quita de la rueda y se pasa a la función vencido
+ * junto con el puntero auxiliar.
+ *
+ * Si maximo no es 0, se procesan a lo sumo maximo temporizadores y el avance
+ * se retoma en la siguiente invocación.
+ *
+ * Devuelve la cantidad de temporizadores vencidos procesados.
+ */
+size_t rueda_temporal_avanzar(rueda_temporal_t *rueda, uint64_t hasta,
+			      size_t maximo,
+			      void (*vencido)(temporizador_t *, void *),
+			      void *aux);
+
+/*
+ * Devuelve la cantidad de temporizadores agendados o 0 en caso de error.
+ */
+size_t rueda_temporal_cantidad(rueda_temporal_t *rueda);
+
+/*
+ * Destruye la rueda. No libera los temporizadores agendados.
+ */
+void rueda_temporal_destruir(rueda_temporal_t *rueda);
+
+#endif /* __RUEDA_TEMPORAL_H__ */
@@ -0,0 +1,319 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tabla_compacta.h"
+
+#define CAPACIDAD_INDICE_MINIMA 8
+#define POSICION_VACIA -1
+#define POSICION_BORRADA -2
+
+typedef struct entrada {
+	uint64_t hash;
+	char *clave;
+	void *valor;
+} entrada_t;
+
+/*
+ * El índice tiene capacidad_indice posiciones (una potencia de 2) de ancho
+ * bytes cada una, con el número de entrada o POSICION_VACIA o
+ * POSICION_BORRADA. Las entradas quitadas quedan en el vector con clave NULL
+ * hasta la próxima vez que se redimensiona la tabla.
+ */
+struct tabla_compacta {
+	entrada_t *entradas;
+	size_t entradas_usadas;
+	size_t capacidad_entradas;
+	void *indice;
+	size_t capacidad_indice;
+	size_t ancho;
+	size_t cantidad;
+	memoria_t *memoria;
+};
+
+/**
+ * Recibe la capacidad de un índice y devuelve la cantidad de entradas que
+ * pueden referenciarse desde él: dos tercios de sus posiciones.
+*/
+size_t entradas_para_indice(size_t capacidad_indice)
+{
+	return capacidad_indice * 2 / 3;
+}
+
+/**
+ * Recibe la capacidad de un índice y devuelve el ancho en bytes que alcanza
+ * para guardar cualquier número de entrada (con signo).
+*/
+size_t ancho_para_indice(size_t capacidad_indice)
+{
+	if (capacidad_indice <= INT8_MAX + 1)
+		return sizeof(int8_t);
+	if (capacidad_indice <= INT16_MAX + 1)
+		return sizeof(int16_t);
+	if (capacidad_indice <= (size_t)INT32_MAX + 1)
+		return sizeof(int32_t);
+	return sizeof(int64_t);
+}
+
+/**
+ * Devuelve el contenido de la posición dada del índice de la tabla.
+*/
+int64_t leer_indice(tabla_compacta_t *tabla, size_t posicion)
+{
+	switch (tabla->ancho) {
+	case sizeof(int8_t):
+		return ((int8_t *)tabla->indice)[posicion];
+	case sizeof(int16_t):
+		return ((int16_t *)tabla->indice)[posicion];
+	case sizeof(int32_t):
+		return ((int32_t *)tabla->indice)[posicion];
+	default:
+		return ((int64_t *)tabla->indice)[posicion];
+	}
+}
+
+/**
+ * Guarda el valor dado en la posición dada del índice de la tabla.
+*/
+void escribir_indice(tabla_compacta_t *tabla, size_t posicion, int64_t valor)
+{
+	switch (tabla->ancho) {
+	case sizeof(int8_t):
+		((int8_t *)tabla->indice)[posicion] = (int8_t)valor;
+		break;
+	case sizeof(int16_t):
+		((int16_t *)tabla->indice)[posicion] = (int16_t)valor;
+		break;
+	case sizeof(int32_t):
+		((int32_t *)tabla->indice)[posicion] = (int32_t)valor;
+		break;
+	default:
+		((int64_t *)tabla->indice)[posicion] = valor;
+	}
+}
+
+/**
+ * Recibe una tabla y un hash, y devuelve la primera posición libre (vacía o
+ * borrada) del índice a partir de la que le corresponde al hash.
+*/
+size_t posicion_libre(tabla_compacta_t *tabla, uint64_t hash)
+{
+	size_t mascara = tabla->capacidad_indice - 1;
+	size_t posicion = hash & mascara;
+	while (leer_indice(tabla, posicion) >= 0)
+		posicion = (posicion + 1) & mascara;
+	return posicion;
+}
+
+/**
+ * Recibe una tabla, una clave y su hash.
+ *
+ * Devuelve la posición del índice que apunta a la entrada de la clave, o -1
+ * si la clave no está.
+*/
+int64_t posicion_de_clave(tabla_compacta_t *tabla, uint64_t hash,
+			  const char *clave)
+{
+	size_t mascara = tabla->capacidad_indice - 1;
+	size_t posicion = hash & mascara;
+	int64_t numero;
+	while ((numero = leer_indice(tabla, posicion)) != POSICION_VACIA) {
+		if (numero >= 0) {
+			entrada_t *entrada = &tabla->entradas[numero];
+			if (entrada->hash == hash &&
+			    strcmp(entrada->clave, clave) == 0)
+				return (int64_t)posicion;
+		}
+		posicion = (posicion + 1) & mascara;
+	}
+	return -1;
+}
+
+/**
+ * Recibe una tabla y una capacidad de índice, y reemplaza el índice y el
+ * vector de entradas por unos nuevos de esa capacidad, en los que las
+ * entradas quitadas ya no ocupan lugar.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (la tabla queda
+ * como se recibió).
+*/
+bool redimensionar(tabla_compacta_t *tabla, size_t capacidad_indice)
+{
+	size_t ancho = ancho_para_indice(capacidad_indice);
+	size_t capacidad_entradas = entradas_para_indice(capacidad_indice);
+	void *indice = memoria_reservar(tabla->memoria, capacidad_indice * ancho);
+	entrada_t *entradas = memoria_reservar(
+		tabla->memoria, capacidad_entradas * sizeof(entrada_t));
+	if (!indice || !entradas) {
+		memoria_liberar(tabla->memoria, indice);
+		memoria_liberar(tabla->memoria, entradas);
+		return false;
+	}
+	memset(indice, 0xff, capacidad_indice * ancho);
+	size_t usadas = 0;
+	for (size_t i = 0; i < tabla->entradas_usadas; i++)
+		if (tabla->entradas[i].clave)
+			entradas[usadas++] = tabla->entradas[i];
+	memoria_liberar(tabla->memoria, tabla->indice);
+	memoria_liberar(tabla->memoria, tabla->entradas);
+	tabla->indice = indice;
+	tabla->ancho = ancho;
+	tabla->capacidad_indice = capacidad_indice;
+	tabla->entradas = entradas;
+	tabla->capacidad_entradas = capacidad_entradas;
+	tabla->entradas_usadas = usadas;
+	for (size_t i = 0; i < usadas; i++)
+		escribir_indice(tabla, posicion_libre(tabla, entradas[i].hash),
+				(int64_t)i);
+	return true;
+}
+
+/**
+ * Recibe una cantidad de entradas y devuelve la capacidad de índice (una
+ * potencia de 2) necesaria para referenciarlas a todas.
+*/
+size_t indice_para_entradas(size_t entradas)
+{
+	size_t capacidad_indice = CAPACIDAD_INDICE_MINIMA;
+	while (entradas_para_indice(capacidad_indice) < entradas)
+		capacidad_indice *= 2;
+	return capacidad_indice;
+}
+
+/*
+ * Crea una tabla con lugar para al menos capacidad entradas, que se reserva
+ * con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero a la tabla creada o NULL en caso de error.
+ */
+tabla_compacta_t *tabla_compacta_crear(size_t capacidad, memoria_t *memoria)
+{
+	tabla_compacta_t *tabla =
+		memoria_reservar_ceros(memoria, 1, sizeof(tabla_compacta_t));
+	if (!tabla)
+		return NULL;
+	tabla->memoria = memoria;
+	if (!redimensionar(tabla, indice_para_entradas(capacidad))) {
+		memoria_liberar(memoria, tabla);
+		return NULL;
+	}
+	return tabla;
+}
+
+/*
+ * Redimensiona la tabla para que tenga lugar para al menos capacidad
+ * entradas (o para las que ya tiene, si son más), descartando las entradas
+ * quitadas. Sirve tanto para reservar lugar como para achicar la tabla.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (la tabla queda
+ * como se recibió).
+ */
+bool tabla_compacta_redimensionar(tabla_compacta_t *tabla, size_t capacidad)
+{
+	if (!tabla)
+		return false;
+	if (capacidad < tabla->cantidad)
+		capacidad = tabla->cantidad;
+	return redimensionar(tabla, indice_para_entradas(capacidad));
+}
+
+/*
+ * Busca la clave, cuyo hash de 64 bits es hash.
+ *
+ * Devuelve un puntero al valor guardado con esa clave (que sirve para
+ * reemplazarlo), o NULL si la clave no está.
+ */
+void **tabla_compacta_buscar(tabla_compacta_t *tabla, uint64_t hash,
+			     const char *clave)
+{
+	if (!tabla || !clave)
+		return NULL;
+	int64_t posicion = posicion_de_clave(tabla, hash, clave);
+	if (posicion < 0)
+		return NULL;
+	return &tabla->entradas[leer_indice(tabla, (size_t)posicion)].valor;
+}
+
+/*
+ * Agrega al final de la tabla una entrada con la clave (que no debe estar en
+ * la tabla), su hash de 64 bits y el valor. Si el vector de entradas está
+ * lleno, la tabla se redimensiona para el triple de las entradas vigentes
+ * (igual que en CPython), descartando las entradas quitadas.
+ *
+ * Devuelve true si pudo agregarla o false en caso de error.
+ */
+bool tabla_compacta_agregar(tabla_compacta_t *tabla, uint64_t hash,
+			    char *clave, void *valor)
+{
+	if (!tabla || !clave)
+		return false;
+	if (tabla->entradas_usadas == tabla->capacidad_entradas &&
+	    !redimensionar(tabla, indice_para_entradas(tabla->cantidad * 3)))
+		return false;
+	size_t numero = tabla->entradas_usadas++;
+	tabla->entradas[numero] =
+		(entrada_t){ .hash = hash, .clave = clave, .valor = valor };
+	escribir_indice(tabla, posicion_libre(tabla, hash), (int64_t)numero);
+	tabla->cantidad++;
+	return true;
+}
+
+/*
+ * Quita la entrada con la clave dada, y guarda la clave y el valor que tenía
+ * en *clave_quitada y *valor_quitado.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario.
+ */
+bool tabla_compacta_quitar(tabla_compacta_t *tabla, uint64_t hash,
+			   const char *clave, char **clave_quitada,
+			   void **valor_quitado)
+{
+	if (!tabla || !clave)
+		return false;
+	int64_t posicion = posicion_de_clave(tabla, hash, clave);
+	if (posicion < 0)
+		return false;
+	entrada_t *entrada =
+		&tabla->entradas[leer_indice(tabla, (size_t)posicion)];
+	*clave_quitada = entrada->clave;
+	*valor_quitado = entrada->valor;
+	entrada->clave = NULL;
+	escribir_indice(tabla, (size_t)posicion, POSICION_BORRADA);
+	tabla->cantidad--;
+	return true;
+}
+
+/*
+ * Recorre las entradas en orden de inserción e invoca a la función con la
+ * clave, el valor y el puntero auxiliar, mientras la función devuelva true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función.
+ */
+size_t tabla_compacta_con_cada_entrada(tabla_compacta_t *tabla,
+				       bool (*funcion)(char *clave,
+						       void *valor, void *aux),
+				       void *aux)
+{
+	size_t invocaciones = 0;
+	if (!tabla || !funcion)
+		return invocaciones;
+	for (size_t i = 0; i < tabla->entradas_usadas; i++) {
+		entrada_t *entrada = &tabla->entradas[i];
+		if (!entrada->clave)
+			continue;
+		invocaciones++;
+		if (!funcion(entrada->clave, entrada->valor, aux))
+			break;
+	}
+	return invocaciones;
+}
+
+/*
+ * Destruye la tabla. No libera las claves ni los valores.
+ */
+void tabla_compacta_destruir(tabla_compacta_t *tabla)
+{
+	if (!tabla)
+		return;
+	memoria_liberar(tabla->memoria, tabla->indice);
+	memoria_liberar(tabla->memoria, tabla->entradas);
+	memoria_liberar(tabla->memoria, tabla);
+}
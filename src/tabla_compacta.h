@@ -0,0 +1,83 @@
+#ifndef __TABLA_COMPACTA_H__
+#define __TABLA_COMPACTA_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "memoria.h"
+
+/*
+ * Tabla de hash compacta, con la misma organización que los diccionarios de
+ * CPython: las entradas (hash, clave, valor) se guardan contiguas en un
+ * vector al que solo se agrega al final, y un índice disperso de
+ * direccionamiento abierto guarda, para cada posición, el número de entrada
+ * en 1, 2, 4 u 8 bytes según la capacidad. Recorrer la tabla es recorrer el
+ * vector de entradas, en orden de inserción.
+ *
+ * La tabla no copia ni libera las claves.
+ */
+typedef struct tabla_compacta tabla_compacta_t;
+
+/*
+ * Crea una tabla con lugar para al menos capacidad entradas, que se reserva
+ * con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero a la tabla creada o NULL en caso de error.
+ */
+tabla_compacta_t *tabla_compacta_crear(size_t capacidad, memoria_t *memoria);
+
+/*
+ * Redimensiona la tabla para que tenga lugar para al menos capacidad
+ * entradas (o para las que ya tiene, si son más), descartando las entradas
+ * quitadas. Sirve tanto para reservar lugar como para achicar la tabla.
+ *
+ * Devuelve true si pudo hacerlo o false en caso de error (la tabla queda
+ * como se recibió).
+ */
+bool tabla_compacta_redimensionar(tabla_compacta_t *tabla, size_t capacidad);
+
+/*
+ * Busca la clave, cuyo hash de 64 bits es hash.
+ *
+ * Devuelve un puntero al valor guardado con esa clave (que sirve para
+ * reemplazarlo), o NULL si la clave no está.
+ */
+void **tabla_compacta_buscar(tabla_compacta_t *tabla, uint64_t hash,
+			     const char *clave);
+
+/*
+ * Agrega al final de la tabla una entrada con la clave (que no debe estar en
+ * la tabla), su hash de 64 bits y el valor.
+ *
+ * Devuelve true si pudo agregarla o false en caso de error.
+ */
+bool tabla_compacta_agregar(tabla_compacta_t *tabla, uint64_t hash,
+			    char *clave, void *valor);
+
+/*
+ * Quita la entrada con la clave dada, y guarda la clave y el valor que tenía
+ * en *clave_quitada y *valor_quitado.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario.
+ */
+bool tabla_compacta_quitar(tabla_compacta_t *tabla, uint64_t hash,
+			   const char *clave, char **clave_quitada,
+			   void **valor_quitado);
+
+/*
+ * Recorre las entradas en orden de inserción e invoca a la función con la
+ * clave, el valor y el puntero auxiliar, mientras la función devuelva true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función.
+ */
+size_t tabla_compacta_con_cada_entrada(tabla_compacta_t *tabla,
+				       bool (*funcion)(char *clave,
+						       void *valor, void *aux),
+				       void *aux);
+
+/*
+ * Destruye la tabla. No libera las claves ni los valores.
+ */
+void tabla_compacta_destruir(tabla_compacta_t *tabla);
+
+#endif /* __TABLA_COMPACTA_H__ */
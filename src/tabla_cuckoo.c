@@ -0,0 +1,539 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tabla_cuckoo.h"
+#include "funciones_hash.h"
+
+#define LUGARES_POR_BALDE 4
+#define LUGARES_DEPOSITO 8
+#define BALDES_MINIMOS 2
+#define BALDES_POR_BUSQUEDA 256
+#define ETIQUETA_VACIA 0
+
+/*
+ * Cada lugar ocupado tiene una etiqueta de 16 bits no nula, sacada de los
+ * bits altos del hash de su clave, que permite descartar casi todas las
+ * claves del balde sin compararlas. Los dos baldes de una clave son
+ * h & mascara y ese mismo número con un xor de la etiqueta mezclada, así que
+ * desde cualquiera de los dos se calcula el otro sin volver a calcular el
+ * hash de la clave (cuckoo de clave parcial).
+ */
+typedef struct balde {
+	uint16_t etiquetas[LUGARES_POR_BALDE];
+	char *claves[LUGARES_POR_BALDE];
+	void *valores[LUGARES_POR_BALDE];
+} balde_t;
+
+struct tabla_cuckoo {
+	balde_t *baldes;
+	size_t cantidad_baldes;
+	size_t cantidad;
+	char *claves_deposito[LUGARES_DEPOSITO];
+	void *valores_deposito[LUGARES_DEPOSITO];
+	size_t en_deposito;
+	memoria_t *memoria;
+};
+
+/*
+ * Un balde visitado por la búsqueda a lo ancho de desplazamientos: padre es
+ * el nodo desde el que se llegó (o -1 si es uno de los baldes de la clave
+ * nueva) y lugar_en_padre el lugar del padre cuya clave se movería a este
+ * balde.
+ */
+typedef struct nodo_busqueda {
+	size_t balde;
+	int padre;
+	int lugar_en_padre;
+} nodo_busqueda_t;
+
+/**
+ * Recibe el hash de una clave y devuelve su etiqueta, que nunca es
+ * ETIQUETA_VACIA.
+*/
+uint16_t etiqueta_de_hash(uint64_t hash)
+{
+	uint16_t etiqueta = (uint16_t)(hash >> 48);
+	return etiqueta == ETIQUETA_VACIA ? 1 : etiqueta;
+}
+
+/**
+ * Recibe una tabla, uno de los baldes de una clave y la etiqueta de la
+ * clave, y devuelve el otro balde de la clave.
+*/
+size_t balde_alternativo(tabla_cuckoo_t *tabla, size_t balde,
+			 uint16_t etiqueta)
+{
+	return (balde ^ mezclar_u64(etiqueta)) & (tabla->cantidad_baldes - 1);
+}
+
+/**
+ * Devuelve el lugar del balde en el que está la clave con la etiqueta dada,
+ * o -1 si no está.
+*/
+int lugar_de_clave(balde_t *balde, uint16_t etiqueta, const char *clave)
+{
+	for (int i = 0; i < LUGARES_POR_BALDE; i++)
+		if (balde->etiquetas[i] == etiqueta &&
+		    strcmp(balde->claves[i], clave) == 0)
+			return i;
+	return -1;
+}
+
+/**
+ * Devuelve un lugar libre del balde o -1 si está lleno.
+*/
+int lugar_libre(balde_t *balde)
+{
+	for (int i = 0; i < LUGARES_POR_BALDE; i++)
+		if (balde->etiquetas[i] == ETIQUETA_VACIA)
+			return i;
+	return -1;
+}
+
+/**
+ * Devuelve el lugar del depósito de la tabla en el que está la clave, o -1
+ * si no está.
+*/
+int lugar_en_deposito(tabla_cuckoo_t *tabla, const char *clave)
+{
+	for (size_t i = 0; i < tabla->en_deposito; i++)
+		if (strcmp(tabla->claves_deposito[i], clave) == 0)
+			return (int)i;
+	return -1;
+}
+
+/**
+ * Recibe un balde de origen y un lugar ocupado del mismo, y un balde de
+ * destino y un lugar libre del mismo, y mueve la clave de uno al otro.
+*/
+void mover_lugar(balde_t *origen, int lugar_origen, balde_t *destino,
+		 int lugar_destino)
+{
+	destino->etiquetas[lugar_destino] = origen->etiquetas[lugar_origen];
+	destino->claves[lugar_destino] = origen->claves[lugar_origen];
+	destino->valores[lugar_destino] = origen->valores[lugar_origen];
+	origen->etiquetas[lugar_origen] = ETIQUETA_VACIA;
+}
+
+/**
+ * Devuelve true si el balde ya fue visitado por la búsqueda.
+*/
+bool balde_visitado(nodo_busqueda_t *nodos, int cantidad_nodos, size_t balde)
+{
+	for (int i = 0; i < cantidad_nodos; i++)
+		if (nodos[i].balde == balde)
+			return true;
+	return false;
+}
+
+/**
+ * Recibe los nodos de una búsqueda, el último nodo del camino y el lugar
+ * de su balde cuya clave puede moverse a un lugar libre de su otro balde.
+ * Hace todos los desplazamientos del camino, empezando por el final.
+ *
+ * Devuelve el nodo inicial del camino (uno de los baldes de la clave nueva),
+ * y guarda en *lugar_final el lugar que quedó libre en él.
+*/
+nodo_busqueda_t *desplazar_camino(tabla_cuckoo_t *tabla,
+				  nodo_busqueda_t *nodos, int ultimo,
+				  int lugar, int *lugar_final)
+{
+	balde_t *balde = &tabla->baldes[nodos[ultimo].balde];
+	balde_t *destino = &tabla->baldes[balde_alternativo(
+		tabla, nodos[ultimo].balde, balde->etiquetas[lugar])];
+	mover_lugar(balde, lugar, destino, lugar_libre(destino));
+	nodo_busqueda_t *nodo = &nodos[ultimo];
+	while (nodo->padre >= 0) {
+		nodo_busqueda_t *padre = &nodos[nodo->padre];
+		mover_lugar(&tabla->baldes[padre->balde],
+			    nodo->lugar_en_padre, &tabla->baldes[nodo->balde],
+			    lugar);
+		lugar = nodo->lugar_en_padre;
+		nodo = padre;
+	}
+	*lugar_final = lugar;
+	return nodo;
+}
+
+/**
+ * Recibe una tabla, y los dos baldes y la etiqueta de una clave nueva.
+ * Busca a lo ancho, desde los dos baldes, una cadena de claves que se
+ * pueden desplazar cada una a su otro balde hasta llegar a un lugar libre,
+ * visitando a lo sumo BALDES_POR_BUSQUEDA baldes, y si la encuentra hace
+ * los desplazamientos.
+ *
+ * Devuelve el balde (uno de los dos de la clave) en el que quedó un lugar
+ * libre y guarda el lugar en *lugar, o devuelve NULL si no encontró camino.
+*/
+balde_t *liberar_lugar(tabla_cuckoo_t *tabla, size_t balde1, size_t balde2,
+		       int *lugar)
+{
+	nodo_busqueda_t nodos[BALDES_POR_BUSQUEDA];
+	int cantidad_nodos = 0;
+	nodos[cantidad_nodos++] = (nodo_busqueda_t){ balde1, -1, -1 };
+	if (balde2 != balde1)
+		nodos[cantidad_nodos++] = (nodo_busqueda_t){ balde2, -1, -1 };
+	for (int actual = 0; actual < cantidad_nodos; actual++) {
+		balde_t *balde = &tabla->baldes[nodos[actual].balde];
+		for (int i = 0; i < LUGARES_POR_BALDE; i++) {
+			size_t otro = balde_alternativo(
+				tabla, nodos[actual].balde,
+				balde->etiquetas[i]);
+			if (lugar_libre(&tabla->baldes[otro]) >= 0) {
+				nodo_busqueda_t *inicial = desplazar_camino(
+					tabla, nodos, actual, i, lugar);
+				return &tabla->baldes[inicial->balde];
+			}
+			if (cantidad_nodos < BALDES_POR_BUSQUEDA &&
+			    !balde_visitado(nodos, cantidad_nodos, otro))
+				nodos[cantidad_nodos++] = (nodo_busqueda_t){
+					otro, actual, i
+				};
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Recibe una tabla y una clave que no está en la tabla con su hash y su
+ * valor, y la guarda en uno de sus baldes, desplazando otras claves si hace
+ * falta. No actualiza la cantidad.
+ *
+ * Devuelve false si no encontró lugar.
+*/
+bool colocar_en_baldes(tabla_cuckoo_t *tabla, uint64_t hash, char *clave,
+		       void *valor)
+{
+	uint16_t etiqueta = etiqueta_de_hash(hash);
+	size_t balde1 = hash & (tabla->cantidad_baldes - 1);
+	size_t balde2 = balde_alternativo(tabla, balde1, etiqueta);
+	balde_t *balde = &tabla->baldes[balde1];
+	int lugar = lugar_libre(balde);
+	if (lugar < 0) {
+		balde = &tabla->baldes[balde2];
+		lugar = lugar_libre(balde);
+	}
+	if (lugar < 0)
+		balde = liberar_lugar(tabla, balde1, balde2, &lugar);
+	if (!balde)
+		return false;
+	balde->etiquetas[lugar] = etiqueta;
+	balde->claves[lugar] = clave;
+	balde->valores[lugar] = valor;
+	return true;
+}
+
+/**
+ * Recibe una tabla y una clave que no está en la tabla con su hash y su
+ * valor, y la guarda en uno de sus baldes (desplazando otras claves si hace
+ * falta) o, si no encuentra lugar, en el depósito. No actualiza la
+ * cantidad.
+ *
+ * Devuelve false si no hubo lugar ni en el depósito.
+*/
+bool colocar(tabla_cuckoo_t *tabla, uint64_t hash, char *clave, void *valor)
+{
+	if (colocar_en_baldes(tabla, hash, clave, valor))
+		return true;
+	if (tabla->en_deposito == LUGARES_DEPOSITO)
+		return false;
+	tabla->claves_deposito[tabla->en_deposito] = clave;
+	tabla->valores_deposito[tabla->en_deposito++] = valor;
+	return true;
+}
+
+/**
+ * Recibe una tabla y una cantidad de baldes, y vuelve a colocar todas las
+ * claves de la tabla en un arreglo nuevo con esa cantidad de baldes.
+ *
+ * Devuelve true si pudo hacerlo o false si no hubo memoria o las claves no
+ * entraron (la tabla queda como se recibió).
+*/
+bool reubicar_en_baldes(tabla_cuckoo_t *tabla, size_t cantidad_baldes)
+{
+	tabla_cuckoo_t nueva = { .cantidad_baldes = cantidad_baldes,
+				 .memoria = tabla->memoria };
+	nueva.baldes = memoria_reservar_ceros(tabla->memoria, cantidad_baldes,
+					      sizeof(balde_t));
+	if (!nueva.baldes)
+		return false;
+	for (size_t i = 0; i < tabla->cantidad_baldes; i++) {
+		balde_t *balde = &tabla->baldes[i];
+		for (int j = 0; j < LUGARES_POR_BALDE; j++) {
+			if (balde->etiquetas[j] == ETIQUETA_VACIA)
+				continue;
+			if (!colocar(&nueva, hash_fnv1a(balde->claves[j]),
+				     balde->claves[j], balde->valores[j])) {
+				memoria_liberar(tabla->memoria, nueva.baldes);
+				return false;
+			}
+		}
+	}
+	for (size_t i = 0; i < tabla->en_deposito; i++) {
+		char *clave = tabla->claves_deposito[i];
+		if (!colocar(&nueva, hash_fnv1a(clave), clave,
+			     tabla->valores_deposito[i])) {
+			memoria_liberar(tabla->memoria, nueva.baldes);
+			return false;
+		}
+	}
+	nueva.cantidad = tabla->cantidad;
+	memoria_liberar(tabla->memoria, tabla->baldes);
+	*tabla = nueva;
+	return true;
+}
+
+/**
+ * Recibe una tabla y duplica su cantidad de baldes (o la cuadruplica, o la
+ * multiplica por 8, si las claves no entran).
+ *
+ * Devuelve true si pudo agrandarla o false en caso de error.
+*/
+bool agrandar_baldes(tabla_cuckoo_t *tabla)
+{
+	size_t maximo = tabla->cantidad_baldes * 8;
+	for (size_t baldes = tabla->cantidad_baldes * 2; baldes <= maximo;
+	     baldes *= 2)
+		if (reubicar_en_baldes(tabla, baldes))
+			return true;
+	return false;
+}
+
+/**
+ * Recibe una cantidad de claves y devuelve la cantidad de baldes (una
+ * potencia de 2) que tienen lugar para todas.
+*/
+size_t baldes_para(size_t capacidad)
+{
+	size_t baldes = BALDES_MINIMOS;
+	while (baldes * LUGARES_POR_BALDE < capacidad)
+		baldes *= 2;
+	return baldes;
+}
+
+/*
+ * Crea una tabla con lugar para capacidad claves (que, como cada clave solo
+ * puede ir en dos baldes, se puede llenar antes de tener capacidad claves).
+ * La tabla se reserva con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero a la tabla creada o NULL en caso de error.
+ */
+tabla_cuckoo_t *tabla_cuckoo_crear(size_t capacidad, memoria_t *memoria)
+{
+	tabla_cuckoo_t *tabla =
+		memoria_reservar_ceros(memoria, 1, sizeof(tabla_cuckoo_t));
+	if (!tabla)
+		return NULL;
+	tabla->memoria = memoria;
+	tabla->cantidad_baldes = baldes_para(capacidad);
+	tabla->baldes = memoria_reservar_ceros(memoria, tabla->cantidad_baldes,
+					       sizeof(balde_t));
+	if (!tabla->baldes) {
+		memoria_liberar(memoria, tabla);
+		return NULL;
+	}
+	return tabla;
+}
+
+/*
+ * Devuelve un puntero al valor guardado con la clave dada (que sirve para
+ * reemplazarlo), o NULL si la clave no está. Revisa a lo sumo dos baldes, y
+ * el depósito solo si tiene claves.
+ */
+void **tabla_cuckoo_buscar(tabla_cuckoo_t *tabla, const char *clave)
+{
+	if (!tabla || !clave)
+		return NULL;
+	uint64_t hash = hash_fnv1a(clave);
+	uint16_t etiqueta = etiqueta_de_hash(hash);
+	size_t balde1 = hash & (tabla->cantidad_baldes - 1);
+	balde_t *balde = &tabla->baldes[balde1];
+	int lugar = lugar_de_clave(balde, etiqueta, clave);
+	if (lugar < 0) {
+		balde = &tabla->baldes[balde_alternativo(tabla, balde1,
+							 etiqueta)];
+		lugar = lugar_de_clave(balde, etiqueta, clave);
+	}
+	if (lugar >= 0)
+		return &balde->valores[lugar];
+	if (tabla->en_deposito == 0)
+		return NULL;
+	lugar = lugar_en_deposito(tabla, clave);
+	return lugar >= 0 ? &tabla->valores_deposito[lugar] : NULL;
+}
+
+/*
+ * Agrega a la tabla la clave (que no debe estar en la tabla) con el valor
+ * dado. Si no hay lugar en sus baldes ni en el depósito, la tabla se
+ * agranda.
+ *
+ * Devuelve true si pudo agregarla o false en caso de error.
+ */
+bool tabla_cuckoo_agregar(tabla_cuckoo_t *tabla, char *clave, void *valor)
+{
+	if (!tabla || !clave)
+		return false;
+	uint64_t hash = hash_fnv1a(clave);
+	while (!colocar(tabla, hash, clave, valor))
+		if (!agrandar_baldes(tabla))
+			return false;
+	tabla->cantidad++;
+	return true;
+}
+
+/**
+ * Recibe una tabla y un lugar ocupado de su depósito, y lo saca del
+ * depósito pasando a ese lugar la última clave del depósito.
+*/
+void sacar_del_deposito(tabla_cuckoo_t *tabla, size_t lugar)
+{
+	tabla->en_deposito--;
+	tabla->claves_deposito[lugar] =
+		tabla->claves_deposito[tabla->en_deposito];
+	tabla->valores_deposito[lugar] =
+		tabla->valores_deposito[tabla->en_deposito];
+}
+
+/**
+ * Recibe una tabla en la que se acaba de liberar un lugar de un balde, y
+ * trata de pasar las claves del depósito a los baldes, para que las
+ * búsquedas de claves ausentes no tengan que revisarlo.
+*/
+void vaciar_deposito(tabla_cuckoo_t *tabla)
+{
+	size_t i = tabla->en_deposito;
+	while (i-- > 0) {
+		char *clave = tabla->claves_deposito[i];
+		if (colocar_en_baldes(tabla, hash_fnv1a(clave), clave,
+				      tabla->valores_deposito[i]))
+			sacar_del_deposito(tabla, i);
+	}
+}
+
+/*
+ * Quita la clave dada, y guarda la clave y el valor que tenía en
+ * *clave_quitada y *valor_quitado. Si la clave estaba en un balde, las
+ * claves del depósito que entran en los baldes vuelven a ellos.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario.
+ */
+bool tabla_cuckoo_quitar(tabla_cuckoo_t *tabla, const char *clave,
+			 char **clave_quitada, void **valor_quitado)
+{
+	if (!tabla || !clave)
+		return false;
+	uint64_t hash = hash_fnv1a(clave);
+	uint16_t etiqueta = etiqueta_de_hash(hash);
+	size_t balde1 = hash & (tabla->cantidad_baldes - 1);
+	size_t baldes[2] = { balde1,
+			     balde_alternativo(tabla, balde1, etiqueta) };
+	for (int i = 0; i < 2; i++) {
+		balde_t *balde = &tabla->baldes[baldes[i]];
+		int lugar = lugar_de_clave(balde, etiqueta, clave);
+		if (lugar < 0)
+			continue;
+		*clave_quitada = balde->claves[lugar];
+		*valor_quitado = balde->valores[lugar];
+		balde->etiquetas[lugar] = ETIQUETA_VACIA;
+		tabla->cantidad--;
+		vaciar_deposito(tabla);
+		return true;
+	}
+	int lugar = lugar_en_deposito(tabla, clave);
+	if (lugar < 0)
+		return false;
+	*clave_quitada = tabla->claves_deposito[lugar];
+	*valor_quitado = tabla->valores_deposito[lugar];
+	sacar_del_deposito(tabla, (size_t)lugar);
+	tabla->cantidad--;
+	return true;
+}
+
+/*
+ * Redimensiona la tabla para que tenga lugar para capacidad claves (o para
+ * las que ya tiene, si son más). Si las claves no entran en esa cantidad de
+ * baldes, prueba con el doble (hasta 8 veces más), y si así la tabla no
+ * quedaría más chica que antes, la deja como está.
+ *
+ * Devuelve true si la tabla quedó con lugar para capacidad claves o false en
+ * caso de error.
+ */
+bool tabla_cuckoo_redimensionar(tabla_cuckoo_t *tabla, size_t capacidad)
+{
+	if (!tabla)
+		return false;
+	if (capacidad < tabla->cantidad)
+		capacidad = tabla->cantidad;
+	size_t minimo = baldes_para(capacidad);
+	for (size_t baldes = minimo; baldes <= minimo * 8; baldes *= 2) {
+		if (minimo <= tabla->cantidad_baldes &&
+		    baldes >= tabla->cantidad_baldes)
+			return true;
+		if (reubicar_en_baldes(tabla, baldes))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Devuelve la proporción de lugares ocupados de la tabla, entre 0 y 1.
+ */
+double tabla_cuckoo_factor_de_carga(tabla_cuckoo_t *tabla)
+{
+	if (!tabla)
+		return 0;
+	return (double)tabla->cantidad /
+	       (double)(tabla->cantidad_baldes * LUGARES_POR_BALDE);
+}
+
+/*
+ * Devuelve la cantidad de claves de la tabla que están en el depósito.
+ */
+size_t tabla_cuckoo_en_deposito(tabla_cuckoo_t *tabla)
+{
+	return tabla ? tabla->en_deposito : 0;
+}
+
+/*
+ * Recorre las claves de la tabla (sin un orden en particular) e invoca a la
+ * función con la clave, el valor y el puntero auxiliar, mientras la función
+ * devuelva true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función.
+ */
+size_t tabla_cuckoo_con_cada_entrada(tabla_cuckoo_t *tabla,
+				     bool (*funcion)(char *clave, void *valor,
+						     void *aux),
+				     void *aux)
+{
+	size_t invocaciones = 0;
+	if (!tabla || !funcion)
+		return invocaciones;
+	for (size_t i = 0; i < tabla->cantidad_baldes; i++) {
+		balde_t *balde = &tabla->baldes[i];
+		for (int j = 0; j < LUGARES_POR_BALDE; j++) {
+			if (balde->etiquetas[j] == ETIQUETA_VACIA)
+				continue;
+			invocaciones++;
+			if (!funcion(balde->claves[j], balde->valores[j], aux))
+				return invocaciones;
+		}
+	}
+	for (size_t i = 0; i < tabla->en_deposito; i++) {
+		invocaciones++;
+		if (!funcion(tabla->claves_deposito[i],
+			     tabla->valores_deposito[i], aux))
+			break;
+	}
+	return invocaciones;
+}
+
+/*
+ * Destruye la tabla. No libera las claves ni los valores.
+ */
+void tabla_cuckoo_destruir(tabla_cuckoo_t *tabla)
+{
+	if (!tabla)
+		return;
+	memoria_liberar(tabla->memoria, tabla->baldes);
+	memoria_liberar(tabla->memoria, tabla);
+}
@@ -0,0 +1,89 @@
+#ifndef __TABLA_CUCKOO_H__
+#define __TABLA_CUCKOO_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "memoria.h"
+
+/*
+ * Tabla de hash cuckoo por baldes: cada clave puede estar solo en uno de dos
+ * baldes de 4 lugares (o en un pequeño depósito de desborde), así que buscar
+ * una clave revisa a lo sumo dos baldes. Al insertar en dos baldes llenos,
+ * se busca a lo ancho una cadena de desplazamientos que libere un lugar.
+ *
+ * La tabla no copia ni libera las claves.
+ */
+typedef struct tabla_cuckoo tabla_cuckoo_t;
+
+/*
+ * Crea una tabla con lugar para capacidad claves (que, como cada clave solo
+ * puede ir en dos baldes, se puede llenar antes de tener capacidad claves).
+ * La tabla se reserva con la cuenta de memoria dada (que puede ser NULL).
+ *
+ * Devuelve un puntero a la tabla creada o NULL en caso de error.
+ */
+tabla_cuckoo_t *tabla_cuckoo_crear(size_t capacidad, memoria_t *memoria);
+
+/*
+ * Devuelve un puntero al valor guardado con la clave dada (que sirve para
+ * reemplazarlo), o NULL si la clave no está.
+ */
+void **tabla_cuckoo_buscar(tabla_cuckoo_t *tabla, const char *clave);
+
+/*
+ * Agrega a la tabla la clave (que no debe estar en la tabla) con el valor
+ * dado. Si no hay lugar, la tabla se agranda.
+ *
+ * Devuelve true si pudo agregarla o false en caso de error.
+ */
+bool tabla_cuckoo_agregar(tabla_cuckoo_t *tabla, char *clave, void *valor);
+
+/*
+ * Quita la clave dada, y guarda la clave y el valor que tenía en
+ * *clave_quitada y *valor_quitado. Si la clave estaba en un balde, las
+ * claves del depósito que entran en los baldes vuelven a ellos.
+ *
+ * Devuelve true si la clave estaba o false en caso contrario.
+ */
+bool tabla_cuckoo_quitar(tabla_cuckoo_t *tabla, const char *clave,
+			 char **clave_quitada, void **valor_quitado);
+
+/*
+ * Redimensiona la tabla para que tenga lugar para capacidad claves (o para
+ * las que ya tiene, si son más). Sirve tanto para reservar lugar como para
+ * achicar la tabla.
+ *
+ * Devuelve true si la tabla quedó con lugar para capacidad claves o false en
+ * caso de error.
+ */
+bool tabla_cuckoo_redimensionar(tabla_cuckoo_t *tabla, size_t capacidad);
+
+/*
+ * Devuelve la proporción de lugares ocupados de la tabla, entre 0 y 1.
+ */
+double tabla_cuckoo_factor_de_carga(tabla_cuckoo_t *tabla);
+
+/*
+ * Devuelve la cantidad de claves de la tabla que están en el depósito de
+ * desborde (que vuelven a los baldes cuando se quitan otras claves).
+ */
+size_t tabla_cuckoo_en_deposito(tabla_cuckoo_t *tabla);
+
+/*
+ * Recorre las claves de la tabla (sin un orden en particular) e invoca a la
+ * función con la clave, el valor y el puntero auxiliar, mientras la función
+ * devuelva true.
+ *
+ * Devuelve la cantidad de veces que se invocó a la función.
+ */
+size_t tabla_cuckoo_con_cada_entrada(tabla_cuckoo_t *tabla,
+				     bool (*funcion)(char *clave, void *valor,
+						     void *aux),
+				     void *aux);
+
+/*
+ * Destruye la tabla. No libera las claves ni los valores.
+ */
+void tabla_cuckoo_destruir(tabla_cuckoo_t *tabla);
+
+#endif /* __TABLA_CUCKOO_H__ */